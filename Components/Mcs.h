@@ -1,6 +1,8 @@
 #pragma once
 #ifndef __SDN_LAB_MCS_H
     #define __SDN_LAB_MCS_H
+    #include <string>
+    #include "ns3/wifi-mode.h"      // support WifiMode
         // lowest MCS & highest MCS
         #define __SDN_LAB_MCS_LOWEST    10
         #define __SDN_LAB_MCS_HIGHEST   49
@@ -301,6 +303,53 @@
                     }
                     return 0;
                 }
+
+                /**
+                 * get the MCS at an index (the same order as `GetModeNameAt`)
+                 * @i: the index
+                 */
+                static unsigned int GetMcsAt(unsigned int i){
+                    static const unsigned int mcsList[__SDN_LAB_MCS_LEN] = {110, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49};
+                    if(i >= __SDN_LAB_MCS_LEN){
+                        return 10;
+                    }
+                    return mcsList[i];
+                }
+                /**
+                 * get the index of an MCS (the reverse of `GetMcsAt`)
+                 * @mcs: the MCS, e.g., 10, 28, 110
+                 * <RETURN>
+                 * -1 if the MCS is not defined
+                 */
+                static int GetIndexOf(unsigned int mcs){
+                    unsigned int i;
+                    for(i = 0; i < __SDN_LAB_MCS_LEN; ++i){
+                        if(GetMcsAt(i) == mcs){
+                            return i;
+                        }
+                    }
+                    return -1;
+                }
+                /**
+                 * get the WifiMode at an index (the same order as `GetModeNameAt`)
+                 * all modes are looked up by name only once, so hot paths never touch strings
+                 * @i: the index
+                 */
+                static const ns3::WifiMode & GetModeAt(unsigned int i){
+                    static ns3::WifiMode modes[__SDN_LAB_MCS_LEN];
+                    static bool isInitialized = false;
+                    unsigned int j;
+                    if(!isInitialized){
+                        for(j = 0; j < __SDN_LAB_MCS_LEN; ++j){
+                            modes[j] = ns3::WifiMode(GetModeNameAt(j));
+                        }
+                        isInitialized = true;
+                    }
+                    if(i >= __SDN_LAB_MCS_LEN){
+                        i = 1;                  // __SDN_LAB_MCS_10 (the same as `GetModeNameAt`)
+                    }
+                    return modes[i];
+                }
             };
         }
 #endif
\ No newline at end of file
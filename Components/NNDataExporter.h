@@ -0,0 +1,223 @@
+#pragma once
+#ifndef __SDN_LAB_NNDATA_EXPORTER_H
+    #define __SDN_LAB_NNDATA_EXPORTER_H
+    #include <cstdio>                           // support FILE, fwrite, fseek
+    #include <cstring>                          // support memset
+    #include <string>
+    #include <vector>
+    #include "Modules/Toolbox/Error.h"          // Error to throw
+    #include "NNData.h"                         // __SDN_LAB_NNDATA_LEN, __SDN_LAB_MCS_NUM
+    #include "Station.h"
+    // file format (all little-endian, native alignment)
+    // [header: 64 bytes][record 0][record 1]...[record N-1][index: beaconNum * 24 bytes]
+    #define __SDN_LAB_NNDATA_EXPORTER_MAGIC             0x58444E4E  // "NNDX"
+    #define __SDN_LAB_NNDATA_EXPORTER_VERSION           1
+    #define __SDN_LAB_NNDATA_EXPORTER_HEADER_SIZE       64
+    #define __SDN_LAB_NNDATA_EXPORTER_BUFFER_SIZE       1048576     // 1MB write buffer
+    // flags
+    #define __SDN_LAB_NNDATA_EXPORTER_FLAG_COMPACT      0x1         // real numbers stored in float (instead of double)
+    namespace SdnLab{
+        /**
+         * a fixed-width feature/label record of a station at a beacon
+         * `T` is `double` (default) or `float` (compact)
+         * <NOTE>
+         * the layout follows the natural C alignment so that a reader can map it directly (numpy: `align=True`)
+         */
+        template<typename T>
+        struct NNDataRecord{
+            T beaconTime;                                   // the beacon time when this record is taken
+            unsigned int staid;                             // the station id (same as `NNFeature.staid`)
+            unsigned int beaconIndex;                       // the beacon index in this file
+            // features
+            T time[__SDN_LAB_NNDATA_LEN];
+            T rxPower[__SDN_LAB_NNDATA_LEN];
+            unsigned int bandwidth[__SDN_LAB_NNDATA_LEN];
+            // labels
+            unsigned int mcs[__SDN_LAB_MCS_NUM];
+            T mcsActivateTime[__SDN_LAB_MCS_NUM];
+        };
+        /**
+         * the file header (64 bytes)
+         * `recordNum`, `beaconNum` & `indexOffset` are 0 until the exporter is closed
+         */
+        struct NNDataExporterHeader{
+            unsigned int magic;
+            unsigned int version;
+            unsigned int flags;
+            unsigned int featureLen;                        // __SDN_LAB_NNDATA_LEN
+            unsigned int mcsNum;                            // __SDN_LAB_MCS_NUM
+            unsigned int recordSize;                        // sizeof(NNDataRecord<T>)
+            unsigned long long recordNum;                   // the number of records
+            unsigned long long beaconNum;                   // the number of beacons (index entries)
+            unsigned long long indexOffset;                 // the offset of the beacon index (bytes)
+            unsigned char reserved[16];
+        };
+        /**
+         * an index entry: where the records of a beacon begin
+         */
+        struct NNDataExporterIndex{
+            double beaconTime;
+            unsigned long long recordBegin;                 // the 1st record of this beacon
+            unsigned long long recordNum;                   // the record number of this beacon
+        };
+
+        class NNDataExporter{
+            private:
+            std::FILE * file = NULL;
+            char * buffer = NULL;                           // the stream buffer given to `file`
+            NNDataExporterHeader header;
+            std::vector<NNDataExporterIndex> index;         // index (kept in memory, written at `Close()`)
+            NNDataRecord<double> record;                    // record (double)
+            NNDataRecord<float> recordCompact;              // record (float)
+
+            /**
+             * fill a record from a station
+             */
+            template<typename T>
+            void _Fill(NNDataRecord<T> & rec, Station & station, double beaconTime){
+                unsigned int i;
+                double time[__SDN_LAB_NNDATA_LEN];
+                double rxPower[__SDN_LAB_NNDATA_LEN];
+                double mcsActivateTime[__SDN_LAB_MCS_NUM];
+                // features & labels
+                station.GetTimeList(time, __SDN_LAB_NNDATA_LEN);
+                station.GetRxPowerList(rxPower, __SDN_LAB_NNDATA_LEN);
+                station.GetBandwidthList(rec.bandwidth, __SDN_LAB_NNDATA_LEN);
+                station.GetNNData(rec.mcs, mcsActivateTime, __SDN_LAB_MCS_NUM);
+                // assign
+                rec.beaconTime = (T)beaconTime;
+                rec.staid = station.GetId();
+                rec.beaconIndex = (unsigned int)(this->index.size() - 1);
+                for(i = 0; i < __SDN_LAB_NNDATA_LEN; ++i){
+                    rec.time[i] = (T)time[i];
+                    rec.rxPower[i] = (T)rxPower[i];
+                }
+                for(i = 0; i < __SDN_LAB_MCS_NUM; ++i){
+                    rec.mcsActivateTime[i] = (T)mcsActivateTime[i];
+                }
+            };
+
+            public:
+            NNDataExporter(){
+                memset(&this->header, 0, sizeof(NNDataExporterHeader));
+                memset(&this->record, 0, sizeof(NNDataRecord<double>));
+                memset(&this->recordCompact, 0, sizeof(NNDataRecord<float>));
+            };
+            ~NNDataExporter(){
+                Close();
+            };
+
+            /**
+             * open a file to export (an opened file will be closed first)
+             * <INPUT>
+             * @filepath:       the file path
+             * @isCompact:      store real numbers in float to halve the file size
+             * <OUTPUT>
+             * @false:          the file cannot be opened
+             */
+            bool Open(const std::string & filepath, bool isCompact = false){
+                Close();
+                this->file = std::fopen(filepath.c_str(), "wb");
+                if(!this->file){
+                    return false;
+                }
+                // give a large buffer so each beacon only costs a few `write` calls
+                try{
+                    this->buffer = new char[__SDN_LAB_NNDATA_EXPORTER_BUFFER_SIZE];
+                }catch(const std::bad_alloc & e){
+                    Toolbox::Error err("/Components", "NNDataExporter.h", "NNDataExporter", "Open", "Cannot allocate the write buffer");
+                    err.SetType2MemoryShortage();
+                    throw err;
+                }
+                std::setvbuf(this->file, this->buffer, _IOFBF, __SDN_LAB_NNDATA_EXPORTER_BUFFER_SIZE);
+                // header (placeholder, rewritten at `Close()`)
+                memset(&this->header, 0, sizeof(NNDataExporterHeader));
+                this->header.magic = __SDN_LAB_NNDATA_EXPORTER_MAGIC;
+                this->header.version = __SDN_LAB_NNDATA_EXPORTER_VERSION;
+                this->header.flags = isCompact ? __SDN_LAB_NNDATA_EXPORTER_FLAG_COMPACT : 0;
+                this->header.featureLen = __SDN_LAB_NNDATA_LEN;
+                this->header.mcsNum = __SDN_LAB_MCS_NUM;
+                this->header.recordSize = isCompact ? sizeof(NNDataRecord<float>) : sizeof(NNDataRecord<double>);
+                std::fwrite(&this->header, sizeof(NNDataExporterHeader), 1, this->file);
+                this->index.clear();
+                return true;
+            };
+
+            /**
+             * close the file: append the index & rewrite the header
+             */
+            void Close(){
+                if(!this->file){
+                    return;
+                }
+                // index
+                this->header.beaconNum = this->index.size();
+                this->header.indexOffset = __SDN_LAB_NNDATA_EXPORTER_HEADER_SIZE + this->header.recordNum*this->header.recordSize;
+                if(!this->index.empty()){
+                    std::fwrite(&this->index[0], sizeof(NNDataExporterIndex), this->index.size(), this->file);
+                }
+                // header
+                std::fseek(this->file, 0, SEEK_SET);
+                std::fwrite(&this->header, sizeof(NNDataExporterHeader), 1, this->file);
+                std::fclose(this->file);
+                this->file = NULL;
+                // release the buffer after `fclose` (the stream uses it until then)
+                if(this->buffer){
+                    delete[] this->buffer;
+                    this->buffer = NULL;
+                }
+            };
+
+            /**
+             * start a new beacon (all records added afterwards belong to it)
+             * @beaconTime: the beacon time (second)
+             */
+            void BeginBeacon(double beaconTime){
+                NNDataExporterIndex item;
+                item.beaconTime = beaconTime;
+                item.recordBegin = this->header.recordNum;
+                item.recordNum = 0;
+                this->index.push_back(item);
+            };
+
+            /**
+             * add a record of a station into the current beacon
+             * @station:    the station
+             */
+            void AddRecord(Station & station){
+                if(!this->file){
+                    return;
+                }
+                if(this->index.empty()){
+                    BeginBeacon(0);
+                }
+                double beaconTime = this->index.back().beaconTime;
+                if(this->header.flags & __SDN_LAB_NNDATA_EXPORTER_FLAG_COMPACT){
+                    _Fill(this->recordCompact, station, beaconTime);
+                    std::fwrite(&this->recordCompact, sizeof(NNDataRecord<float>), 1, this->file);
+                }else{
+                    _Fill(this->record, station, beaconTime);
+                    std::fwrite(&this->record, sizeof(NNDataRecord<double>), 1, this->file);
+                }
+                ++(this->header.recordNum);
+                ++(this->index.back().recordNum);
+            };
+            void AddRecord(Station * station){
+                if(station){
+                    AddRecord(*station);
+                }
+            };
+
+            /*** Get & Set ***/
+            bool IsOpen(){
+                return this->file != NULL;
+            };
+            unsigned long long GetRecordNum(){
+                return this->header.recordNum;
+            };
+            unsigned long long GetBeaconNum(){
+                return this->index.size();
+            };
+        };
+    }
+#endif
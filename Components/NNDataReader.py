@@ -0,0 +1,76 @@
+import numpy as np
+
+# read the NN data exported by `Components/NNDataExporter.h` (a single file per run)
+# records are memory-mapped, so opening a file costs nothing until we touch the data
+class NNDataReader:
+    MAGIC = 0x58444E4E;             # "NNDX"
+    VERSION = 1;
+    HEADER_SIZE = 64;
+    FLAG_COMPACT = 0x1;
+    HEADER_DTYPE = np.dtype([("magic", "<u4"), ("version", "<u4"), ("flags", "<u4"), ("featureLen", "<u4"), ("mcsNum", "<u4"), ("recordSize", "<u4"),
+                             ("recordNum", "<u8"), ("beaconNum", "<u8"), ("indexOffset", "<u8"), ("reserved", "u1", 16)]);
+    INDEX_DTYPE = np.dtype([("beaconTime", "<f8"), ("recordBegin", "<u8"), ("recordNum", "<u8")]);
+
+    '''
+    init
+    @filepath:  the exported file
+    '''
+    def __init__(self, filepath):
+        self.header = np.fromfile(filepath, dtype = NNDataReader.HEADER_DTYPE, count = 1)[0];
+        if self.header["magic"] != NNDataReader.MAGIC:
+            raise Exception("%s is not an NN data file"%filepath);
+        if self.header["version"] != NNDataReader.VERSION:
+            raise Exception("NN data version %d is not supported"%self.header["version"]);
+        # record type (the same layout as `NNDataRecord<T>`)
+        real = "<f4" if self.header["flags"] & NNDataReader.FLAG_COMPACT else "<f8";
+        featureLen = int(self.header["featureLen"]);
+        mcsNum = int(self.header["mcsNum"]);
+        self.recordDtype = np.dtype([("beaconTime", real), ("staid", "<u4"), ("beaconIndex", "<u4"),
+                                     ("time", real, featureLen), ("rxPower", real, featureLen), ("bandwidth", "<u4", featureLen),
+                                     ("mcs", "<u4", mcsNum), ("mcsActivateTime", real, mcsNum)], align = True);
+        if self.recordDtype.itemsize != self.header["recordSize"]:
+            raise Exception("record size %d does not match %d"%(self.header["recordSize"], self.recordDtype.itemsize));
+        # records & index
+        recordNum = int(self.header["recordNum"]);
+        if recordNum > 0:
+            self.records = np.memmap(filepath, dtype = self.recordDtype, mode = "r", offset = NNDataReader.HEADER_SIZE, shape = (recordNum,));
+        else:
+            self.records = np.zeros(0, dtype = self.recordDtype);
+        self.index = np.fromfile(filepath, dtype = NNDataReader.INDEX_DTYPE, count = int(self.header["beaconNum"]), offset = int(self.header["indexOffset"])) if self.header["beaconNum"] > 0 else np.zeros(0, dtype = NNDataReader.INDEX_DTYPE);
+
+    '''
+    the number of records & beacons
+    '''
+    def GetRecordNum(self):
+        return len(self.records);
+    def GetBeaconNum(self):
+        return len(self.index);
+
+    '''
+    get all records of a beacon
+    @beaconIndex: the index of the beacon (starting at 0)
+    '''
+    def GetBeacon(self, beaconIndex):
+        item = self.index[beaconIndex];
+        return self.records[int(item["recordBegin"]) : int(item["recordBegin"] + item["recordNum"])];
+
+    '''
+    get all records of a station
+    @staid: the station id
+    '''
+    def GetStation(self, staid):
+        return self.records[self.records["staid"] == staid];
+
+    '''
+    get features & labels as arrays (the same order as `NNFeature` and `NNPredicted`)
+    <RETURN>
+    time, rxPower, bandwidth, mcs, mcsActivateTime
+    '''
+    def GetFeatures(self, records = None):
+        if records is None:
+            records = self.records;
+        return records["time"], records["rxPower"], records["bandwidth"];
+    def GetLabels(self, records = None):
+        if records is None:
+            records = self.records;
+        return records["mcs"], records["mcsActivateTime"];
@@ -2,8 +2,10 @@
 #ifndef __SDN_LAB_SETTINGS_H
     #define __SDN_LAB_SETTINGS_H
     #define __SDN_LAB_SETTINGS_NN_MEMORY_SIZE 4096
+    #define __SDN_LAB_SETTINGS_ENV_PROJECTNAME "SDN_LAB_PROJECTNAME"     // the project name when the program does not set one
     #include <fstream>
     #include <stdio.h>
+    #include <stdlib.h>
     #include <string>
     // headers - 3rd party
     #include "Modules/Toolbox/Error.h"                                  // Error
@@ -11,18 +13,43 @@
         class Settings{
             private:
                 // project related
-                const std::string SETTINGS_FILE_PATH = "./Components/Settings.txt";
                 const std::string PATH_PREFIX        = "./_dist/";
-                std::string PROJECTNAME              = "NULL";
                 const std::string FOLDERNAME_DEBUG   = "debug/";
                 const std::string FOLDERNAME_TMP     = "tmp/";
                 const std::string FOLDERNAME_REPORT  = "report/";
-                // overwrite the setting
-                void _Overwrite(){
-                    std::fstream file_in(Settings::SETTINGS_FILE_PATH, std::fstream::out);
-                    file_in << this->PROJECTNAME << '\n';
-                    file_in.close();
+                /**
+                 * the process-wide project & its paths
+                 * It is set once at startup (from the command line or `SDN_LAB_PROJECTNAME`) and only read
+                 * afterwards, so the `Settings` of every PHY/MAC share it without locks or file I/O.
+                 */
+                struct Registry{
+                    std::string projectName;            // "" or ending with '/'
+                    std::string pathProject;
+                    std::string pathProjectDebug;
+                    std::string pathProjectTmp;
+                    std::string pathProjectReport;
+                };
+                static Registry & _Registry(){
+                    static Registry registry = _Resolve(getenv(__SDN_LAB_SETTINGS_ENV_PROJECTNAME));
+                    return registry;
                 };
+                static Registry _Resolve(const char * strProjectName){
+                    const Settings sets(false);
+                    Registry registry;
+                    if (strProjectName && strProjectName[0] != '\0' && std::string(strProjectName) != "NULL"){
+                        registry.projectName = strProjectName;
+                        if(registry.projectName.back() != '/'){
+                            registry.projectName.append("/");
+                        }
+                    }
+                    registry.pathProject        = sets.PATH_PREFIX + registry.projectName;
+                    registry.pathProjectDebug   = registry.pathProject + sets.FOLDERNAME_DEBUG;
+                    registry.pathProjectTmp     = registry.pathProject + sets.FOLDERNAME_TMP;
+                    registry.pathProjectReport  = registry.pathProject + sets.FOLDERNAME_REPORT;
+                    return registry;
+                };
+                // build the constants only (no registry access)
+                explicit Settings(bool){};
 
             public:
                 // Report - Memory cost report (StationList & Station)
@@ -46,80 +73,47 @@
                 const std::string TRACK_FILE_AP_WIFI_MAC_STALIST            = "track_ap-wifi-mac_stationlist-";
                 const std::string TRACK_FILE_AP_WIFI_MAC_NN_INPUT           = "track_ap-wifi-mac_NN-INPUT-";
                 const std::string TRACK_FILE_AP_WIFI_MAC_NN_OUTPUT          = "track_ap-wifi-mac_NN-OUTPUT-";
+                const std::string TRACK_FILE_AP_WIFI_MAC_NN_DATA            = "track_ap-wifi-mac_NN-DATA.bin";     // all beacons in a file (read by `NNDataReader.py`)
 
                 // warning messages
                 const std::string ERR_WIFI_MANAGER_UNDEFINED = "=======\n[ERR] wifi manager is not define.\n======";
 
                 /**
-                 * constructor 
+                 * constructor
+                 * (no file I/O, the project comes from the process-wide registry)
                  */
-                Settings(){
-                    std::ifstream file_out(Settings::SETTINGS_FILE_PATH);
-                    if (file_out.is_open()){
-                        file_out >> this->PROJECTNAME;
-                        file_out.close();
-                    }else{
-                        _Overwrite();
-                    }
-                };
+                Settings(){};
 
                 /**
-                 * Set the Project Name
+                 * Set the Project Name of this process
+                 * call it once at startup, before any simulation object reads a path
+                 * (it overrides `SDN_LAB_PROJECTNAME`)
                  * @strProjectName: the name of the project (supporting const char *)
                  */
-                void SetProjectName(std::string strProjectName){
-                    SetProjectName(strProjectName.c_str());
+                void SetProjectName(const std::string & strProjectName){
+                    _Registry() = _Resolve(strProjectName.c_str());
                 };
                 void SetProjectName(const char * strProjectName){
                     if (strProjectName){
-                        this->PROJECTNAME = strProjectName;     // set
-                        if(this->PROJECTNAME.back() != '/'){
-                            this->PROJECTNAME.append("/");
-                        }
-                        _Overwrite();                           // overwritten setings
-                    }
-                };
-                void SetProjectName(char * strProjectName){
-                    if (strProjectName){
-                        this->PROJECTNAME = strProjectName;     // set
-                        if(this->PROJECTNAME.back() != '/'){
-                            this->PROJECTNAME.append("/");
-                        }
-                        _Overwrite();                           // overwritten setings
+                        _Registry() = _Resolve(strProjectName);
                     }
                 };
-                /* return a path */
+                /* return a path (resolved once per process) */
                 // project
-                std::string PathProject(){
-                    std::string projectName = "";
-                    if (this->PROJECTNAME != "NULL"){
-                        projectName = this->PROJECTNAME; 
-                    }
-                    return this->PATH_PREFIX + projectName;
+                const std::string & PathProject() const{
+                    return _Registry().pathProject;
                 };
                 // project-debug
-                std::string PathProjectDebug(){
-                    std::string projectName = "";
-                    if (this->PROJECTNAME != "NULL"){
-                        projectName = this->PROJECTNAME; 
-                    }
-                    return this->PATH_PREFIX + projectName + this->FOLDERNAME_DEBUG;
+                const std::string & PathProjectDebug() const{
+                    return _Registry().pathProjectDebug;
                 };
                 // project-tmp
-                std::string PathProjectTmp(){
-                    std::string projectName = "";
-                    if (this->PROJECTNAME != "NULL"){
-                        projectName = this->PROJECTNAME; 
-                    }
-                    return this->PATH_PREFIX + projectName + this->FOLDERNAME_TMP;
+                const std::string & PathProjectTmp() const{
+                    return _Registry().pathProjectTmp;
                 };
                 // project - report
-                std::string PathProjectReport(){
-                    std::string projectName = "";
-                    if (this->PROJECTNAME != "NULL"){
-                        projectName = this->PROJECTNAME; 
-                    }
-                    return this->PATH_PREFIX + projectName + this->FOLDERNAME_REPORT;
+                const std::string & PathProjectReport() const{
+                    return _Registry().pathProjectReport;
                 }
 
                 /*** Static functions to support ***/
@@ -8,6 +8,7 @@
     #include "ns3/mac48-address.h"              // support Mac48Address
     #include "PacketContext.h"
     #include "NNData.h"
+    #include "NNDataExporter.h"
     #include "Station.h"
     #include "Mac.h"                            // Mac constants
     #define __SDN_LAB_STATIONLIST_MEMORY_COST_BASE 112
@@ -93,6 +94,18 @@
                     }
                 }
             #endif
+            /**
+             * export all stations of a beacon as fixed-width records (a single file per run)
+             * @exporter:   an opened exporter
+             * @time:       the beacon time (second)
+             */
+            void Export2File(NNDataExporter & exporter, double time){
+                unsigned int i;
+                exporter.BeginBeacon(time);
+                for(i = 0; i < this->staListLen; i++){
+                    exporter.AddRecord(this->staList[i]);
+                }
+            }
             void SummaryAverageData2File(std::string & filepathPrefix, std::string & filepathSuffix){
                 unsigned int i;
                 std::string filepath;
@@ -46,14 +46,14 @@ int main(int argc, char *argv[]) {
     double rssi; 
 
     for(mcsIdx = 0; mcsIdx < Mcs::Len(); ++mcsIdx){
-        tmpWifiMode = WifiMode(Mcs::GetModeNameAt(mcsIdx));
+        tmpWifiMode = Mcs::GetModeAt(mcsIdx);
         for(berThresholdId = 0; berThresholdId < 5; ++berThresholdId){
             berThreshold = raOptimalBERThreshold[berThresholdId];
             snrThreshold = error->CalculateSnr(tmpWifiMode, berThreshold);
             noise = GetNoisePower(noiseFigure, tmpWifiMode.GetBandwidth(), temperature);
             rssi = snrThreshold*noise;
             // write
-            fm.AddCSVItem(Mcs::FromModeName(Mcs::GetModeNameAt(mcsIdx)));
+            fm.AddCSVItem(Mcs::GetMcsAt(mcsIdx));
             fm.AddCSVItem(Mcs::GetDateRateAt(mcsIdx));
 		    fm.AddCSVItem(berThreshold);
 		    fm.AddCSVItem(snrThreshold);
@@ -0,0 +1,324 @@
+#include "SweepRunner.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// the relative path defaults of rca (scratch/rca/Configuration.h): a run works in
+// its own folder, so they are passed as absolute paths unless given explicitly
+static const char * const RCA_PATH_DEFAULTS[][2] = {
+	{"TrafficPath", "./OptimalRawGroup/traffic/data-1-1.0.txt"},
+	{"RAWConfigFile", "./OptimalRawGroup/RawConfig-rca.txt"},
+	{"Outputpath", "./OptimalRawGroup/"},
+	{"folder", "./scratch/"},
+	{"file", "./scratch/mac-sta.txt"},
+};
+
+static double Now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+SweepRunner::SweepRunner() {
+	SetProjectName("sweep");
+}
+
+void SweepRunner::SetBinary(const string& binary) {
+	this->binary = AbsolutePath(binary);
+}
+
+void SweepRunner::SetProjectName(const string& projectname) {
+	this->projectname = projectname;
+	while (!this->projectname.empty() && this->projectname.back() == '/')
+		this->projectname.pop_back();
+	this->sweepDir = AbsolutePath("_dist/" + this->projectname) + "/";
+}
+
+void SweepRunner::SetArguments(const vector<string>& args) {
+	this->args.clear();
+	for (size_t a = 0; a < args.size(); a++) {
+		// the sweep owns the project name of its runs
+		if (args[a].compare(0, 14, "--projectname=") == 0)
+			continue;
+		this->args.push_back(ResolveArgument(args[a]));
+	}
+}
+
+bool SweepRunner::SetGrid(const string& grid) {
+	istringstream stream(grid);
+	string item;
+	this->axes.clear();
+	while (getline(stream, item, ';')) {
+		if (item.empty())
+			continue;
+		size_t eq = item.find('=');
+		if (eq == string::npos || eq == 0 || eq + 1 == item.size())
+			return false;
+		Axis axis;
+		axis.key = item.substr(0, eq);
+		if (axis.key.compare(0, 2, "--") == 0)
+			axis.key = axis.key.substr(2);
+		string values = item.substr(eq + 1);
+		size_t colon = values.find(':');
+		if (colon != string::npos && values.find(',') == string::npos) {
+			char * end;
+			long first = strtol(values.c_str(), &end, 10);
+			if (end != values.c_str() + colon)
+				return false;
+			long last = strtol(values.c_str() + colon + 1, &end, 10);
+			if (*end != '\0' || last < first)
+				return false;
+			for (long v = first; v <= last; v++)
+				axis.values.push_back(to_string(v));
+		}
+		else {
+			istringstream valueStream(values);
+			string value;
+			while (getline(valueStream, value, ','))
+				if (!value.empty())
+					axis.values.push_back(value);
+		}
+		if (axis.values.empty())
+			return false;
+		this->axes.push_back(axis);
+	}
+	return true;
+}
+
+uint32_t SweepRunner::Prepare() {
+	uint32_t total = 1;
+	for (size_t a = 0; a < this->axes.size(); a++)
+		total *= this->axes[a].values.size();
+
+	this->runs.clear();
+	vector<size_t> index(this->axes.size(), 0);
+	for (uint32_t i = 0; i < total; i++) {
+		Run run;
+		char prefix[16];
+		snprintf(prefix, sizeof(prefix), "%04u", i + 1);
+		run.tag = prefix;
+		for (size_t a = 0; a < this->axes.size(); a++) {
+			const string& value = this->axes[a].values[index[a]];
+			run.values.push_back(value);
+			string part = this->axes[a].key + "-" + value;
+			for (size_t c = 0; c < part.size(); c++)
+				if (!isalnum((unsigned char)part[c]) && part[c] != '.' && part[c] != '_' && part[c] != '-')
+					part[c] = '-';
+			run.tag += "_" + part;
+		}
+		run.dir = this->sweepDir + "runs/" + run.tag + "/";
+		run.pid = -1;
+		run.status = -1;
+		run.startTime = 0;
+		run.elapsed = 0;
+		this->runs.push_back(run);
+		// the last axis changes fastest
+		for (size_t a = this->axes.size(); a-- > 0;) {
+			if (++index[a] < this->axes[a].values.size())
+				break;
+			index[a] = 0;
+		}
+	}
+	return total;
+}
+
+uint32_t SweepRunner::Execute(uint32_t jobs) {
+	if (jobs == 0)
+		jobs = 1;
+	map<pid_t, size_t> running;
+	size_t next = 0;
+	size_t finished = 0;
+	uint32_t failed = 0;
+	while (finished < this->runs.size()) {
+		while (running.size() < jobs && next < this->runs.size()) {
+			Run& run = this->runs[next];
+			run.startTime = Now();
+			run.pid = Start(run);
+			if (run.pid < 0) {
+				cerr << "[sweep] cannot start " << run.tag << ": " << strerror(errno) << endl;
+				finished++;
+				failed++;
+			}
+			else
+				running[run.pid] = next;
+			next++;
+		}
+		if (running.empty())
+			continue;
+
+		int status;
+		pid_t pid = waitpid(-1, &status, 0);
+		if (pid < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		map<pid_t, size_t>::iterator it = running.find(pid);
+		if (it == running.end())
+			continue;
+		Run& run = this->runs[it->second];
+		running.erase(it);
+		run.status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+		run.elapsed = Now() - run.startTime;
+		finished++;
+		if (run.status != 0)
+			failed++;
+		cout << "[sweep] " << finished << "/" << this->runs.size() << " " << run.tag
+			<< (run.status == 0 ? " done" : " FAILED (" + to_string(run.status) + ")")
+			<< " in " << run.elapsed << " s" << endl;
+	}
+	return failed;
+}
+
+pid_t SweepRunner::Start(Run& run) const {
+	if (!CreatePath(run.dir))
+		return -1;
+
+	vector<string> argv;
+	argv.push_back(this->binary);
+	argv.push_back("--projectname=" + this->projectname);
+	for (size_t a = 0; a < this->args.size(); a++)
+		argv.push_back(this->args[a]);
+	for (size_t a = 0; a < this->axes.size(); a++)
+		argv.push_back(ResolveArgument("--" + this->axes[a].key + "=" + run.values[a]));
+	for (size_t d = 0; d < sizeof(RCA_PATH_DEFAULTS) / sizeof(RCA_PATH_DEFAULTS[0]); d++) {
+		string key = string("--") + RCA_PATH_DEFAULTS[d][0] + "=";
+		bool given = false;
+		for (size_t a = 1; a < argv.size() && !given; a++)
+			given = argv[a].compare(0, key.size(), key) == 0;
+		if (!given)
+			argv.push_back(key + AbsolutePath(RCA_PATH_DEFAULTS[d][1]));
+	}
+
+	// log the command line of the run
+	ofstream cmd((run.dir + "command.txt").c_str());
+	for (size_t a = 0; a < argv.size(); a++)
+		cmd << argv[a] << (a + 1 < argv.size() ? " " : "\n");
+	cmd.close();
+
+	pid_t pid = fork();
+	if (pid != 0)
+		return pid;
+
+	// child: work in the run folder, log there and become rca
+	if (chdir(run.dir.c_str()) != 0)
+		_exit(127);
+	int log = open("output.log", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (log >= 0) {
+		dup2(log, STDOUT_FILENO);
+		dup2(log, STDERR_FILENO);
+		close(log);
+	}
+	vector<char *> cargv;
+	for (size_t a = 0; a < argv.size(); a++)
+		cargv.push_back(const_cast<char *>(argv[a].c_str()));
+	cargv.push_back(NULL);
+	execv(this->binary.c_str(), &cargv[0]);
+	perror("execv");
+	_exit(127);
+}
+
+void SweepRunner::Merge() const {
+	ofstream index((this->sweepDir + "runs.csv").c_str());
+	ofstream merged((this->sweepDir + "merged.csv").c_str());
+	index << "run";
+	merged << "run";
+	for (size_t a = 0; a < this->axes.size(); a++) {
+		index << "," << this->axes[a].key;
+		merged << "," << this->axes[a].key;
+	}
+	index << ",status,elapsed\n";
+	merged << ",file,...\n";
+
+	for (size_t r = 0; r < this->runs.size(); r++) {
+		const Run& run = this->runs[r];
+		string values;
+		for (size_t a = 0; a < run.values.size(); a++)
+			values += "," + run.values[a];
+		index << run.tag << values << "," << run.status << "," << run.elapsed << "\n";
+
+		string report = run.dir + "_dist/" + this->projectname + "/report/";
+		vector<string> files;
+		ListCsv(report, "", files);
+		sort(files.begin(), files.end());
+		for (size_t f = 0; f < files.size(); f++) {
+			ifstream in((report + files[f]).c_str());
+			string line;
+			while (getline(in, line)) {
+				if (line.empty())
+					continue;
+				merged << run.tag << values << "," << files[f] << "," << line << "\n";
+			}
+		}
+	}
+	cout << "[sweep] merged into " << this->sweepDir << "merged.csv" << endl;
+}
+
+void SweepRunner::ListCsv(const string& dir, const string& rel, vector<string>& files) const {
+	DIR * handle = opendir((dir + rel).c_str());
+	if (!handle)
+		return;
+	struct dirent * entry;
+	while ((entry = readdir(handle)) != NULL) {
+		string name = entry->d_name;
+		if (name == "." || name == "..")
+			continue;
+		struct stat info;
+		if (stat((dir + rel + name).c_str(), &info) != 0)
+			continue;
+		if (S_ISDIR(info.st_mode))
+			ListCsv(dir, rel + name + "/", files);
+		else if (name.size() > 4 && name.compare(name.size() - 4, 4, ".csv") == 0)
+			files.push_back(rel + name);
+	}
+	closedir(handle);
+}
+
+string SweepRunner::AbsolutePath(const string& path) const {
+	if (!path.empty() && path[0] == '/')
+		return path;
+	char cwd[PATH_MAX];
+	if (!getcwd(cwd, sizeof(cwd)))
+		return path;
+	string rel = path.compare(0, 2, "./") == 0 ? path.substr(2) : path;
+	return string(cwd) + "/" + rel;
+}
+
+string SweepRunner::ResolveArgument(const string& arg) const {
+	// runs work in their own folder, so relative input paths must not stay relative
+	size_t eq = arg.find('=');
+	if (eq == string::npos)
+		return arg;
+	string value = arg.substr(eq + 1);
+	if (value.compare(0, 2, "./") != 0 && value.compare(0, 3, "../") != 0)
+		return arg;
+	char resolved[PATH_MAX];
+	if (!realpath(value.c_str(), resolved))
+		return arg;
+	string path = resolved;
+	if (value.back() == '/')
+		path += "/";
+	return arg.substr(0, eq + 1) + path;
+}
+
+bool SweepRunner::CreatePath(const string& path) const {
+	for (size_t pos = path.find('/', 1); pos != string::npos; pos = path.find('/', pos + 1)) {
+		string dir = path.substr(0, pos);
+		if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+			return false;
+	}
+	return true;
+}
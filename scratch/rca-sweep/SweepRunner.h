@@ -0,0 +1,95 @@
+#ifndef SWEEPRUNNER_H
+#define SWEEPRUNNER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Parallel parameter sweep of the rca scenario.
+ *
+ * Every point of the grid runs as its own rca process. A run works in its own
+ * directory (`<sweep>/runs/<tag>/`) with its own `_dist` tree, and gets the
+ * project name on its command line. Input paths given relative to the
+ * launch directory are made absolute before the runs start, and so are the
+ * relative path defaults of rca (traffic, RAW config & output paths) that
+ * the sweep does not set.
+ */
+class SweepRunner {
+private:
+	struct Axis {
+		string key;
+		vector<string> values;
+	};
+	struct Run {
+		string tag;
+		string dir;
+		vector<string> values;			// per axis
+		pid_t pid;
+		int status;
+		double startTime;				// second
+		double elapsed;					// second
+	};
+
+	string binary;						// the rca program
+	string projectname;
+	string sweepDir;					// _dist/<projectname>/
+	vector<string> args;				// fixed arguments of every run
+	vector<Axis> axes;
+	vector<Run> runs;
+
+	string AbsolutePath(const string& path) const;
+	string ResolveArgument(const string& arg) const;
+	bool CreatePath(const string& path) const;
+	void ListCsv(const string& dir, const string& rel, vector<string>& files) const;
+
+	pid_t Start(Run& run) const;
+
+public:
+	SweepRunner();
+
+	/**
+	 * @binary: the rca program (the runs are started with `execv`)
+	 * @projectname: the project name passed to every run and the sweep folder in `_dist/`
+	 */
+	void SetBinary(const string& binary);
+	void SetProjectName(const string& projectname);
+	/**
+	 * the arguments passed to every run
+	 * e.g. {"--isRAconstant", "--simulationTime=100", "--isMobStatic"}
+	 */
+	void SetArguments(const vector<string>& args);
+	/**
+	 * the parameter grid, axes separated by ';'
+	 * an axis is `key=v1,v2,...` or `key=first:last` (integers, both included)
+	 * e.g. "DataMode=MCS1_0,MCS1_1;seed=5:7"
+	 * <OUTPUT>
+	 * @false: the grid cannot be parsed
+	 */
+	bool SetGrid(const string& grid);
+
+	/**
+	 * expand the grid into runs (the last axis changes fastest)
+	 * <OUTPUT>
+	 * the number of runs
+	 */
+	uint32_t Prepare();
+	/**
+	 * run everything, `jobs` processes at a time
+	 * <OUTPUT>
+	 * the number of runs that failed
+	 */
+	uint32_t Execute(uint32_t jobs);
+	/**
+	 * merge the CSV files of all run reports into `<sweep>/merged.csv`
+	 * every row is prefixed with the run tag, the axis values and the file path
+	 * in the report folder; `<sweep>/runs.csv` lists the runs with their exit
+	 * status and wall time
+	 */
+	void Merge() const;
+};
+
+#endif /* SWEEPRUNNER_H */
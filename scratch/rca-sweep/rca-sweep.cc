@@ -0,0 +1,64 @@
+/**
+ * Run a parameter grid of the rca scenario on all cores
+ *
+ * e.g.
+ * ./waf --run "rca-sweep --projectname=Optimal --grid=DataMode=MCS1_0,MCS1_1;seed=5:7 -- --isRAconstant --simulationTime=100 --isLocRectangular --isLocUniform --isMobStatic"
+ *
+ * the arguments after `--` are passed to every run
+ * every run works in `_dist/<projectname>/runs/<tag>/` (its own `_dist` tree, `output.log` & `command.txt`)
+ * at the end, `_dist/<projectname>/merged.csv` holds the rows of all report CSV files and
+ * `_dist/<projectname>/runs.csv` the exit status & wall time of every run
+ */
+#include "ns3/core-module.h"
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include "SweepRunner.h"
+
+using namespace ns3;
+using namespace std;
+
+int main(int argc, char *argv[]) {
+	string projectname = "sweep";
+	string grid = "";
+	string binary = "";
+	uint32_t jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	bool merge = true;
+
+	CommandLine cmd;
+	cmd.AddValue("projectname", "the project name of every run and the sweep folder in _dist/", projectname);
+	cmd.AddValue("grid", "the parameter grid (axes separated by ';', an axis is key=v1,v2,... or key=first:last)", grid);
+	cmd.AddValue("binary", "the rca program (default: next to this program)", binary);
+	cmd.AddValue("jobs", "the number of runs at a time (default: the number of cores)", jobs);
+	cmd.AddValue("merge", "merge the report CSV files of all runs", merge);
+	// the arguments after `--` belong to the runs (`CommandLine` reads a string value up to the first space)
+	int own = 1;
+	while (own < argc && string(argv[own]) != "--")
+		own++;
+	vector<string> args(argv + (own < argc ? own + 1 : argc), argv + argc);
+	cmd.Parse(own, argv);
+
+	// waf builds scratch/<dir> into build/scratch/<dir>/<dir>
+	if (binary.empty()) {
+		binary = argv[0];
+		size_t slash = binary.rfind('/');
+		binary = (slash == string::npos ? string(".") : binary.substr(0, slash)) + "/../rca/rca";
+	}
+
+	SweepRunner runner;
+	runner.SetBinary(binary);
+	runner.SetProjectName(projectname);
+	runner.SetArguments(args);
+	if (!runner.SetGrid(grid)) {
+		cerr << "[sweep] cannot parse the grid: " << grid << endl;
+		return 1;
+	}
+	uint32_t total = runner.Prepare();
+	cout << "[sweep] " << total << " runs, " << jobs << " at a time" << endl;
+	uint32_t failed = runner.Execute(jobs);
+	if (merge)
+		runner.Merge();
+	if (failed > 0)
+		cerr << "[sweep] " << failed << " runs failed, see output.log in their folders" << endl;
+	return failed > 0 ? 1 : 0;
+}
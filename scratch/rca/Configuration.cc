@@ -73,6 +73,12 @@ Configuration::Configuration(int argc, char *argv[]) {
     cmd.AddValue("blockOffset", "The 1st page slice starts with the block with blockOffset", blockOffset);
     cmd.AddValue("timOffset", "Offset in number of Beacon Intervals from the DTIM that carries the first page slice of the page", timOffset);
     cmd.AddValue("Outputpath", "files path of each stations", OutputPath);
+    cmd.AddValue("rawOptimizer", "adapt slot counts, slot durations & AID grouping online", rawOptimizer);
+    cmd.AddValue("rawOptimizerPeriod", "the number of beacons between two RAW updates", rawOptimizerPeriod);
+    cmd.AddValue("slotAnalytics", "write per-slot contention records of every beacon", slotAnalytics);
+    cmd.AddValue("assocSnapshotSave", "save the associations to this file once every STA is associated", assocSnapshotSave);
+    cmd.AddValue("preAssociate", "associate every STA at time 0 without the handshake", preAssociate);
+    cmd.AddValue("assocSnapshotLoad", "restore the associations from this file at time 0 (skip the warm-up)", assocSnapshotLoad);
     // parse input
     cmd.Parse(argc, argv);
     // input check
@@ -87,6 +87,8 @@ struct Configuration {
 	RPSVector rps;
 	uint32_t nRps;						// Ordinal number of current RPS element; RPS Index
 	uint64_t totalRawSlots = 0;				// Total number of RAW slots in all RAW groups in all RPS elements
+	bool rawOptimizer = false;			// adapt the RAW configuration online (ns3::RawOptimizer)
+	uint32_t rawOptimizerPeriod = 10;	// beacons between two updates
 	std::string RawConfigString;    // RPS=2;{RAW=2;[0,1,1,204,2,0,1,16][0,1,1,412,1,0,17,32]}{RAW=1;[0,1,1,180,3,0,33,35]}
 
 	UintegerValue maxNumberOfPackets = 4294967295u; ///4294967295u //ami
@@ -133,6 +135,10 @@ struct Configuration {
 	string name = "test"; // empty string if no visualization TODO
 	string APPcapFile = "appcap"; // empty string if no visualization TODO
 	string NSSFile = "test.nss";
+	bool slotAnalytics = false;			// per-slot contention records (report/seed_*/slot-analytics.bin)
+	string assocSnapshotSave = "";		// save the associations once every STA is associated
+	string assocSnapshotLoad = "";		// start from the associations of an earlier run
+	bool preAssociate = false;			// associate every STA at time 0 (no handshake)
 
 	/*
 	 * Le's config params
@@ -702,12 +702,16 @@ void NodeEntry::OnCollision(std::string context, uint32_t nrOfBackoffSlots) {
 	if(showLog) cout << "Collision sensed" << endl;
 	stats->get(this->id).NumberOfCollisions++;
 	stats->get(this->id).TotalNumberOfBackedOffSlots += nrOfBackoffSlots;
+	if (this->slotAnalytics)
+		this->slotAnalytics->OnCollision(nrOfBackoffSlots);
 }
 
 void NodeEntry::OnTransmissionWillCrossRAWBoundary(std::string context, Time txDuration, Time remainingTimeInRawSlot) {
-	cout << "Transmission cancelled, tx duration " << txDuration << ", remaining time " << remainingTimeInRawSlot << endl;
+	if(showLog) cout << "Transmission cancelled, tx duration " << txDuration << ", remaining time " << remainingTimeInRawSlot << endl;
 
 	stats->get(this->id).NumberOfTransmissionsCancelledDueToCrossingRAWBoundary++;
+	if (this->slotAnalytics)
+		this->slotAnalytics->OnTransmissionWillCrossRAWBoundary();
 }
 
 void NodeEntry::OnMacTxRtsFailed(std::string context, Mac48Address address) {
@@ -741,6 +745,10 @@ void NodeEntry::SetDeassociatedCallback(std::function<void()> assocCallback) {
 	this->deAssociatedCallback = assocCallback;
 }
 
+void NodeEntry::SetSlotAnalytics(SlotAnalytics* slotAnalytics) {
+	this->slotAnalytics = slotAnalytics;
+}
+
 void NodeEntry::UpdateQueueLength() {
 	Ptr<WifiNetDevice> wifiDe;
 	wifiDe = this->device->GetObject<WifiNetDevice>();
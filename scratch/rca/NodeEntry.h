@@ -13,6 +13,7 @@
 #include "ns3/extension-headers.h"
 #include <functional>
 #include "Statistics.h"
+#include "SlotAnalytics.h"
 #include "ns3/drop-reason.h"
 #include "ns3/tcp-socket.h"
 #include "ns3/log.h"
@@ -112,9 +113,11 @@ public:
     
     void SetAssociatedCallback(std::function<void()> assocCallback);
     void SetDeassociatedCallback(std::function<void()> assocCallback);
+    void SetSlotAnalytics(SlotAnalytics* slotAnalytics);
 
 private:
     Statistics* stats;
+    SlotAnalytics* slotAnalytics = NULL;
 	Ptr<Node> node;
 	Ptr<NetDevice> device;
 
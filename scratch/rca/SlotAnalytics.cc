@@ -0,0 +1,256 @@
+#include "SlotAnalytics.h"
+#include <cstring>
+
+SlotAnalytics::SlotAnalytics() {
+	memset(&this->beacon, 0, sizeof(SlotAnalyticsBeacon));
+	Init(RPSVector());
+}
+
+SlotAnalytics::~SlotAnalytics() {
+	Close();
+}
+
+void SlotAnalytics::Init(const RPSVector& rps) {
+	uint16_t n = 0;
+	if (this->file && this->beaconStarted && !this->beaconFlushed) {
+		Flush(Simulator::Now().GetNanoSeconds());
+		this->beaconFlushed = true;
+	}
+	this->rpsFirstSlot.clear();
+	this->rpsHash.clear();
+	this->rpsFirstGroup.clear();
+	this->groupFirstSlot.clear();
+	this->slotDuration.clear();
+	for (uint32_t r = 0; r < rps.rpsset.size(); r++) {
+		this->rpsFirstSlot.push_back(n);
+		this->rpsHash.push_back(rps.rpsset[r]->GetHash());
+		this->rpsFirstGroup.push_back(this->groupFirstSlot.size());
+		for (uint32_t g = 0; g < rps.rpsset[r]->GetNumberOfRawGroups(); g++) {
+			RPS::RawAssignment raw = rps.rpsset[r]->GetRawAssigmentObj(g);
+			this->groupFirstSlot.push_back(n);
+			for (uint32_t s = 0; s < raw.GetSlotNum(); s++, n++) {
+				// the same slot length as ApWifiMac schedules
+				this->slotDuration.push_back(MicroSeconds(500 + raw.GetSlotDurationCount() * 120).GetNanoSeconds());
+			}
+		}
+	}
+	// sentinels
+	this->rpsFirstSlot.push_back(n);
+	this->rpsFirstGroup.push_back(this->groupFirstSlot.size());
+	this->totalSlots = n;
+	this->beacon.firstSlot = 0;
+	this->beacon.slotNum = 0;
+	this->visits.clear();
+
+	SlotAnalyticsSlot zero;
+	memset(&zero, 0, sizeof(SlotAnalyticsSlot));
+	this->slots.assign(n + 1, zero);
+	this->visits.reserve(n + 1);
+}
+
+bool SlotAnalytics::Open(const string& filepath, Ptr<WifiPhy> apPhy) {
+	Close();
+	this->file = std::fopen(filepath.c_str(), "wb");
+	if (!this->file)
+		return false;
+	this->buffer = new char[SLOT_ANALYTICS_BUFFER_SIZE];
+	std::setvbuf(this->file, this->buffer, _IOFBF, SLOT_ANALYTICS_BUFFER_SIZE);
+
+	SlotAnalyticsHeader header;
+	memset(&header, 0, sizeof(SlotAnalyticsHeader));
+	header.magic = SLOT_ANALYTICS_MAGIC;
+	header.version = SLOT_ANALYTICS_VERSION;
+	header.beaconSize = sizeof(SlotAnalyticsBeacon);
+	header.slotSize = sizeof(SlotAnalyticsSlot);
+	header.backoffBins = SLOT_ANALYTICS_BACKOFF_BINS;
+	header.totalSlots = this->totalSlots;
+	header.rpsNum = this->rpsFirstSlot.empty() ? 0 : this->rpsFirstSlot.size() - 1;
+	std::fwrite(&header, sizeof(SlotAnalyticsHeader), 1, this->file);
+
+	this->apPhy = apPhy;
+	this->beaconStarted = false;
+	this->lastStateEnd = Simulator::Now().GetNanoSeconds();
+	this->pendingEnd = this->pendingStart;
+	return true;
+}
+
+void SlotAnalytics::Close() {
+	if (!this->file)
+		return;
+	if (this->beaconStarted && !this->beaconFlushed)
+		Flush(Simulator::Now().GetNanoSeconds());
+	std::fclose(this->file);
+	this->file = NULL;
+	// release the buffer after `fclose` (the stream uses it until then)
+	delete[] this->buffer;
+	this->buffer = NULL;
+	this->apPhy = 0;
+	this->beaconStarted = false;
+}
+
+bool SlotAnalytics::IsOpen() const {
+	return this->file != NULL;
+}
+
+uint16_t SlotAnalytics::GetSlotIndex(uint16_t rps, uint16_t rawGroup, uint16_t slot) const {
+	if (rps == 0 || rawGroup == 0 || slot == 0 || rps >= this->rpsFirstSlot.size())
+		return this->totalSlots;
+	uint32_t group = this->rpsFirstGroup[rps - 1] + rawGroup - 1;
+	if (group >= this->rpsFirstGroup[rps])
+		return this->totalSlots;
+	uint32_t index = this->groupFirstSlot[group] + slot - 1;
+	uint32_t end = group + 1 < this->groupFirstSlot.size() ? this->groupFirstSlot[group + 1] : this->totalSlots;
+	return index < end ? index : this->totalSlots;
+}
+
+uint16_t SlotAnalytics::GetTotalSlots() const {
+	return this->totalSlots;
+}
+
+uint16_t SlotAnalytics::Locate(int64_t now) const {
+	for (size_t i = this->visits.size(); i-- > 0;) {
+		if (this->visits[i].start <= now)
+			return now < this->visits[i].end ? this->visits[i].slot : this->totalSlots;
+	}
+	return this->totalSlots;
+}
+
+void SlotAnalytics::Attribute(int64_t start, int64_t end, WifiPhy::State state, bool success) {
+	if (start < this->beaconStart)
+		start = this->beaconStart;
+	if (end <= start)
+		return;
+
+	uint64_t SlotAnalyticsSlot::*counter;
+	if (state == WifiPhy::IDLE)
+		counter = &SlotAnalyticsSlot::idleNs;
+	else if (state == WifiPhy::TX || state == WifiPhy::RX || state == WifiPhy::CCA_BUSY)
+		counter = &SlotAnalyticsSlot::busyNs;
+	else
+		return;
+
+	// visits do not overlap, so walk back until they end before `start`
+	int64_t outside = end - start;
+	for (size_t i = this->visits.size(); i-- > 0 && this->visits[i].end > start;) {
+		int64_t overlap = std::min(end, this->visits[i].end) - std::max(start, this->visits[i].start);
+		if (overlap <= 0)
+			continue;
+		SlotAnalyticsSlot& slot = this->slots[this->visits[i].slot];
+		slot.*counter += overlap;
+		if (success)
+			slot.successNs += overlap;
+		outside -= overlap;
+	}
+	SlotAnalyticsSlot& slot = this->slots[this->totalSlots];
+	slot.*counter += outside;
+	if (success)
+		slot.successNs += outside;
+}
+
+void SlotAnalytics::Flush(int64_t now) {
+	// close what the PHY has not logged yet
+	if (this->pendingEnd > this->pendingStart)
+		Attribute(this->pendingStart, std::min(this->pendingEnd, now), this->pendingState, false);
+	if (this->lastStateEnd < now)
+		Attribute(this->lastStateEnd, now, this->apPhy && !this->apPhy->IsStateIdle() ? WifiPhy::CCA_BUSY : WifiPhy::IDLE, false);
+
+	std::fwrite(&this->beacon, sizeof(SlotAnalyticsBeacon), 1, this->file);
+	if (this->beacon.slotNum > 0)
+		std::fwrite(&this->slots[this->beacon.firstSlot], sizeof(SlotAnalyticsSlot), this->beacon.slotNum, this->file);
+	std::fwrite(&this->slots[this->totalSlots], sizeof(SlotAnalyticsSlot), 1, this->file);
+}
+
+void SlotAnalytics::OnBeacon(const S1gBeaconHeader& beacon) {
+	if (!this->file)
+		return;
+	int64_t now = Simulator::Now().GetNanoSeconds();
+	if (this->beaconStarted) {
+		if (!this->beaconFlushed)
+			Flush(now);
+		this->beacon.beaconIndex++;
+	}
+	else
+		this->beacon.beaconIndex = 0;
+
+	// the RPS element sent in the beacon; equal elements are taken in turn, as ApWifiMac cycles through them
+	uint16_t rpsNum = this->rpsHash.size();
+	uint64_t hash = beacon.GetRpsHash();
+	uint16_t last = this->beaconStarted ? this->beacon.rps : 0;
+	this->beacon.beaconTime = Simulator::Now().GetSeconds();
+	this->beacon.rps = 0;
+	for (uint16_t i = 1; i <= rpsNum; i++) {
+		uint16_t r = (last + i - 1) % rpsNum;
+		if (this->rpsHash[r] == hash) {
+			this->beacon.rps = r + 1;
+			break;
+		}
+	}
+	this->beacon.firstSlot = this->beacon.rps > 0 ? this->rpsFirstSlot[this->beacon.rps - 1] : 0;
+	this->beacon.slotNum = this->beacon.rps > 0 ? this->rpsFirstSlot[this->beacon.rps] - this->beacon.firstSlot : 0;
+
+	// only the slice of this RPS (and outside RAW) is ever touched
+	memset(&this->slots[this->beacon.firstSlot], 0, sizeof(SlotAnalyticsSlot) * this->beacon.slotNum);
+	memset(&this->slots[this->totalSlots], 0, sizeof(SlotAnalyticsSlot));
+	this->visits.clear();
+	this->beaconStart = now;
+	this->beaconStarted = true;
+	this->beaconFlushed = false;
+}
+
+void SlotAnalytics::OnSlotStart(uint16_t rps, uint16_t rawGroup, uint16_t slot) {
+	if (!this->file || !this->beaconStarted)
+		return;
+	int64_t now = Simulator::Now().GetNanoSeconds();
+	uint16_t index = GetSlotIndex(rps, rawGroup, slot);
+	// the RPS, group & slot traces fire one by one at the same time, keep the last
+	if (!this->visits.empty() && this->visits.back().start == now)
+		this->visits.pop_back();
+	if (index < this->beacon.firstSlot || index >= this->beacon.firstSlot + this->beacon.slotNum)
+		return;
+	if (!this->visits.empty() && this->visits.back().end > now)
+		this->visits.back().end = now;
+	Visit visit = {now, now + this->slotDuration[index], index};
+	this->visits.push_back(visit);
+}
+
+void SlotAnalytics::OnApPhyState(Time start, Time duration, WifiPhy::State state) {
+	if (!this->file)
+		return;
+	int64_t now = Simulator::Now().GetNanoSeconds();
+	int64_t begin = start.GetNanoSeconds();
+	int64_t end = begin + duration.GetNanoSeconds();
+	if (this->pendingEnd > this->pendingStart && this->pendingEnd <= now) {
+		Attribute(this->pendingStart, this->pendingEnd, this->pendingState, false);
+		this->pendingEnd = this->pendingStart;
+	}
+	if (end > now) {
+		this->pendingStart = begin;
+		this->pendingEnd = end;
+		this->pendingState = state;
+	}
+	else
+		Attribute(begin, end, state, state == WifiPhy::RX && this->rxOkTime == now);
+	if (end > this->lastStateEnd)
+		this->lastStateEnd = end;
+}
+
+void SlotAnalytics::OnApPhyRxOk(Ptr<const Packet> packet, double snr, WifiMode mode, WifiPreamble preamble) {
+	this->rxOkTime = Simulator::Now().GetNanoSeconds();
+}
+
+void SlotAnalytics::OnCollision(uint32_t nrOfBackoffSlots) {
+	if (!this->file || !this->beaconStarted)
+		return;
+	SlotAnalyticsSlot& slot = this->slots[Locate(Simulator::Now().GetNanoSeconds())];
+	slot.collisions++;
+	uint32_t bin = 0;
+	if (nrOfBackoffSlots > 0)
+		for (bin = 1; (nrOfBackoffSlots >>= 1) && bin < SLOT_ANALYTICS_BACKOFF_BINS - 1; bin++);
+	slot.backoff[bin]++;
+}
+
+void SlotAnalytics::OnTransmissionWillCrossRAWBoundary() {
+	if (!this->file || !this->beaconStarted)
+		return;
+	this->slots[Locate(Simulator::Now().GetNanoSeconds())].crossings++;
+}
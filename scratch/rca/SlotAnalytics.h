@@ -0,0 +1,143 @@
+#ifndef SLOTANALYTICS_H
+#define SLOTANALYTICS_H
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/rps.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace ns3;
+
+// file format (all little-endian, native alignment)
+// [file header][beacon 0: SlotAnalyticsBeacon, (slotNum + 1) * SlotAnalyticsSlot][beacon 1]...
+// the last slot record of every beacon collects everything outside the RAW slots of that beacon
+#define SLOT_ANALYTICS_MAGIC			0x414C5352	// "RSLA"
+#define SLOT_ANALYTICS_VERSION			1
+#define SLOT_ANALYTICS_BACKOFF_BINS		12			// 0, [1, 2), [2, 4), ..., [512, 1024), >= 1024
+#define SLOT_ANALYTICS_BUFFER_SIZE		262144		// 256KB write buffer
+
+/**
+ * the counters of a slot in a beacon interval
+ */
+struct SlotAnalyticsSlot {
+	uint64_t idleNs;				// AP PHY idle
+	uint64_t busyNs;				// AP PHY TX, RX or CCA busy
+	uint64_t successNs;				// AP PHY RX that ended OK
+	uint32_t collisions;			// STA collisions (`Collision` trace)
+	uint32_t crossings;				// transmissions held back because they would cross the slot boundary
+	uint32_t backoff[SLOT_ANALYTICS_BACKOFF_BINS];	// backoff slots drawn after a collision
+};
+
+/**
+ * the header of a beacon record
+ */
+struct SlotAnalyticsBeacon {
+	double beaconTime;				// second
+	uint32_t beaconIndex;
+	uint16_t rps;					// RPS index (starting at 1)
+	uint16_t firstSlot;				// the compiled index of the 1st slot of this RPS
+	uint16_t slotNum;				// the slot number of this RPS (an extra outside-RAW record follows)
+	uint16_t reserved[3];
+};
+
+struct SlotAnalyticsHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t beaconSize;			// sizeof(SlotAnalyticsBeacon)
+	uint32_t slotSize;				// sizeof(SlotAnalyticsSlot)
+	uint32_t backoffBins;
+	uint32_t totalSlots;			// compiled slots over all RPS elements
+	uint32_t rpsNum;
+	uint32_t reserved;
+};
+
+/**
+ * Per-slot contention analytics of the RAW configuration.
+ *
+ * Every RAW slot of every RPS element gets a compiled index (RPS, then RAW
+ * group, then slot). Counters live in a fixed array indexed by it and the
+ * slice of the current RPS is written as one record per beacon, so the cost
+ * per event is an array update.
+ */
+class SlotAnalytics {
+private:
+	struct Visit {
+		int64_t start;				// ns
+		int64_t end;				// ns (the slot end as configured)
+		uint16_t slot;
+	};
+
+	// compiled slots
+	vector<uint16_t> rpsFirstSlot;		// per RPS
+	vector<uint64_t> rpsHash;			// per RPS, to recognize it in a beacon
+	vector<uint16_t> groupFirstSlot;	// per RAW group of all RPS elements
+	vector<uint16_t> rpsFirstGroup;		// per RPS, into `groupFirstSlot`
+	vector<int64_t> slotDuration;		// ns, per compiled slot
+	uint16_t totalSlots = 0;
+
+	// counters (`totalSlots` slots + outside RAW)
+	vector<SlotAnalyticsSlot> slots;
+	vector<Visit> visits;				// slots visited in this beacon interval (in time order)
+
+	// beacon
+	SlotAnalyticsBeacon beacon;
+	bool beaconStarted = false;
+	bool beaconFlushed = false;			// the record of this beacon has been written by `Init()`
+	int64_t beaconStart = 0;			// ns; nothing before it is attributed to this beacon
+
+	// AP PHY
+	Ptr<WifiPhy> apPhy;
+	int64_t lastStateEnd = 0;			// ns
+	int64_t rxOkTime = -1;				// ns; `RxOk` fires right before the RX state is logged
+	int64_t pendingStart = 0;			// ns; a TX is logged when it starts, so it waits here until it ends
+	int64_t pendingEnd = 0;
+	WifiPhy::State pendingState = WifiPhy::IDLE;
+
+	std::FILE * file = NULL;
+	char * buffer = NULL;
+
+	uint16_t Locate(int64_t now) const;
+	void Attribute(int64_t start, int64_t end, WifiPhy::State state, bool success);
+	void Flush(int64_t now);
+
+public:
+	SlotAnalytics();
+	~SlotAnalytics();
+
+	/**
+	 * compile the slot indexes of a RAW configuration
+	 * it may be called again at a beacon when the RAW configuration changes (the record of the
+	 * ending beacon interval is written first)
+	 */
+	void Init(const RPSVector& rps);
+	/**
+	 * start writing records
+	 * @apPhy: the PHY of the AP (idle/busy/success time)
+	 * <OUTPUT>
+	 * @false: the file cannot be opened
+	 */
+	bool Open(const string& filepath, Ptr<WifiPhy> apPhy);
+	void Close();
+	bool IsOpen() const;
+
+	/**
+	 * the compiled index of a slot (all values start at 1 as in the AP traces)
+	 * <OUTPUT>
+	 * `GetTotalSlots()` if the slot does not exist
+	 */
+	uint16_t GetSlotIndex(uint16_t rps, uint16_t rawGroup, uint16_t slot) const;
+	uint16_t GetTotalSlots() const;
+
+	// trace sinks
+	void OnBeacon(const S1gBeaconHeader& beacon);
+	void OnSlotStart(uint16_t rps, uint16_t rawGroup, uint16_t slot);
+	void OnApPhyState(Time start, Time duration, WifiPhy::State state);
+	void OnApPhyRxOk(Ptr<const Packet> packet, double snr, WifiMode mode, WifiPreamble preamble);
+	void OnCollision(uint32_t nrOfBackoffSlots);
+	void OnTransmissionWillCrossRAWBoundary();
+};
+
+#endif /* SLOTANALYTICS_H */
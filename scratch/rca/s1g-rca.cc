@@ -228,6 +228,9 @@ uint32_t StaNumFromTrafficPath(string TrafficPath){
 		}
 		file.close();
 	}
+	else {
+		NS_FATAL_ERROR("Unable to open the traffic file " << TrafficPath);
+	}
 	// return
 	return staIdMax - staIdMin + 1;
 }
@@ -354,7 +357,7 @@ RPSVector configureRAW(RPSVector rpslist, string RAWConfigFile) {
 				/*rpslist.rpsset[rpslist.rpsset.size() - 1]->GetRawAssigmentObj(
 						NRAWPERBEACON - 1).GetRawGroupAIDEnd();*/
 	} else
-		cout << "Unable to open RAW configuration file \n";
+		NS_FATAL_ERROR("Unable to open the RAW configuration file " << RAWConfigFile);
 
 	return rpslist;
 }
@@ -520,6 +523,10 @@ void onSTAAssociated(int i) {
 
 		// association complete, start sending packets
 		stats.TimeWhenEverySTAIsAssociated = Simulator::Now();
+		if (!config.assocSnapshotSave.empty()) {
+			S1gAssociationHelper assocHelper;
+			assocHelper.Save(config.assocSnapshotSave, apDevice.Get(0), staDeviceCont);
+		}
 
 		if (config.trafficType == "udp") {
 			configureUDPServer();
@@ -550,19 +557,33 @@ void onSTAAssociated(int i) {
 
 void RpsIndexTrace(uint16_t oldValue, uint16_t newValue) {
 	currentRps = newValue;
+	slotAnalytics.OnSlotStart(currentRps, currentRawGroup, currentRawSlot);
 	//cout << "RPS: " << newValue << " at " << Simulator::Now().GetMicroSeconds() << endl;
 }
 
 void RawGroupTrace(uint8_t oldValue, uint8_t newValue) {
 	currentRawGroup = newValue;
+	slotAnalytics.OnSlotStart(currentRps, currentRawGroup, currentRawSlot);
 	//cout << "	group " << std::to_string(newValue) << " at " << Simulator::Now().GetMicroSeconds() << endl;
 }
 
 void RawSlotTrace(uint8_t oldValue, uint8_t newValue) {
 	currentRawSlot = newValue;
+	slotAnalytics.OnSlotStart(currentRps, currentRawGroup, currentRawSlot);
 	//cout << "		slot " << std::to_string(newValue) << " at " << Simulator::Now().GetMicroSeconds() << endl;
 }
 
+void RpsUpdatedTrace(const RPSVector& rpsset) {
+	slotAnalytics.Init(rpsset);
+	config.totalRawSlots = slotAnalytics.GetTotalSlots();
+	transmissionsPerTIMGroupAndSlotFromAPSinceLastInterval.resize(config.totalRawSlots, 0);
+	transmissionsPerTIMGroupAndSlotFromSTASinceLastInterval.resize(config.totalRawSlots, 0);
+}
+
+void S1gBeaconBroadcastedTrace(S1gBeaconHeader beacon, RPS::RawAssignment raw) {
+	slotAnalytics.OnBeacon(beacon);
+}
+
 void configureNodes(NodeContainer& wifiStaNode, NetDeviceContainer& staDevice) {
 	cout << "Configuring STA Node trace sources..." << endl;
 
@@ -576,6 +597,7 @@ void configureNodes(NodeContainer& wifiStaNode, NetDeviceContainer& staDevice) {
 		n->SetAssociatedCallback([ = ] {onSTAAssociated(i);});
 		n->SetDeassociatedCallback([ = ] {onSTADeassociated(i);});
 
+		n->SetSlotAnalytics(&slotAnalytics);
 		nodes.push_back(n);
 		// hook up Associated and Deassociated events
 		Config::Connect(
@@ -690,70 +712,19 @@ int getBandwidth(string dataMode) {
 }
 
 string getWifiMode(string dataMode) {
-	if (dataMode == "MCS1_0")
-		return "OfdmRate300KbpsBW1MHz";
-	else if (dataMode == "MCS1_1")
-		return "OfdmRate600KbpsBW1MHz";
-	else if (dataMode == "MCS1_2")
-		return "OfdmRate900KbpsBW1MHz";
-	else if (dataMode == "MCS1_3")
-		return "OfdmRate1_2MbpsBW1MHz";
-	else if (dataMode == "MCS1_4")
-		return "OfdmRate1_8MbpsBW1MHz";
-	else if (dataMode == "MCS1_5")
-		return "OfdmRate2_4MbpsBW1MHz";
-	else if (dataMode == "MCS1_6")
-		return "OfdmRate2_7MbpsBW1MHz";
-	else if (dataMode == "MCS1_7")
-		return "OfdmRate3MbpsBW1MHz";
-	else if (dataMode == "MCS1_8")
-		return "OfdmRate3_6MbpsBW1MHz";
-	else if (dataMode == "MCS1_9")
-		return "OfdmRate4MbpsBW1MHz";
-	else if (dataMode == "MCS1_10")
-		return "OfdmRate150KbpsBW1MHz";
-
-	else if (dataMode == "MCS2_0")
-		return "OfdmRate650KbpsBW2MHz";
-	else if (dataMode == "MCS2_1")
-		return "OfdmRate1_3MbpsBW2MHz";
-	else if (dataMode == "MCS2_2")
-		return "OfdmRate1_95MbpsBW2MHz";
-	else if (dataMode == "MCS2_3")
-		return "OfdmRate2_6MbpsBW2MHz";
-	else if (dataMode == "MCS2_4")
-		return "OfdmRate3_9MbpsBW2MHz";
-	else if (dataMode == "MCS2_5")
-		return "OfdmRate5_2MbpsBW2MHz";
-	else if (dataMode == "MCS2_6")
-		return "OfdmRate5_85MbpsBW2MHz";
-	else if (dataMode == "MCS2_7")
-		return "OfdmRate6_5MbpsBW2MHz";
-	else if (dataMode == "MCS2_8")
-		return "OfdmRate7_8MbpsBW2MHz";
-
-	else if (dataMode == "MCS4_0")
-		return "OfdmRate1_35MbpsBW4MHz";
-	else if (dataMode == "MCS4_1")
-		return "OfdmRate2_7MbpsBW4MHz";
-	else if (dataMode == "MCS4_2")
-		return "OfdmRate4_05MbpsBW4MHz";
-	else if (dataMode == "MCS4_3")
-		return "OfdmRate5_4MbpsBW4MHz";
-	else if (dataMode == "MCS4_4")
-		return "OfdmRate8_1MbpsBW4MHz";
-	else if (dataMode == "MCS4_5")
-		return "OfdmRate10_8MbpsBW4MHz";
-	else if (dataMode == "MCS4_6")
-		return "OfdmRate12_15MbpsBW4MHz";
-	else if (dataMode == "MCS4_7")
-		return "OfdmRate13_5MbpsBW4MHz";
-	else if (dataMode == "MCS4_8")
-		return "OfdmRate16_2MbpsBW4MHz";
-	else if (dataMode == "MCS4_9")
-		return "OfdmRate18MbpsBW4MHz";
-
-	return "";
+	// "MCS<bandwidth>_<index>" -> SdnLab MCS (e.g., MCS1_0 -> 10, MCS1_10 -> 110) -> mode name
+	unsigned int bandwidth;
+	unsigned int index;
+	char tail;
+	if (sscanf(dataMode.c_str(), "MCS%u_%u%c", &bandwidth, &index, &tail) != 2)
+		return "";
+	if (bandwidth == 0 || bandwidth > 9 || index > 10)
+		return "";
+	unsigned int mcs = index == 10 ? bandwidth * 100 + 10 : bandwidth * 10 + index;
+	int mcsIdx = SdnLab::Mcs::GetIndexOf(mcs);
+	if (mcsIdx < 0)
+		return "";
+	return SdnLab::Mcs::GetModeNameAt(mcsIdx);
 }
 
 void OnAPPhyRxDrop(std::string context, Ptr<const Packet> packet,
@@ -831,22 +802,9 @@ void OnAPPacketToTransmitReceived(string context, Ptr<const Packet> packet, Mac4
 }
 
 void onChannelTransmission(Ptr<NetDevice> senderDevice, Ptr<Packet> packet) {
-	int rpsIndex = currentRps - 1;
-	int rawGroup = currentRawGroup - 1;
-	int slotIndex = currentRawSlot - 1;
-	//cout << rpsIndex << "		" << rawGroup << "		" << slotIndex << "		" << endl;
-
-	uint64_t iSlot = slotIndex;
-	if (rpsIndex > 0)
-		for (int r = rpsIndex - 1; r >= 0; r--)
-			for (int g = 0; g < config.rps.rpsset[r]->GetNumberOfRawGroups(); g++)
-				iSlot += config.rps.rpsset[r]->GetRawAssigmentObj(g).GetSlotNum();
-
-	if (rawGroup > 0)
-		for (int i = rawGroup - 1; i >= 0; i--)
-			iSlot += config.rps.rpsset[rpsIndex]->GetRawAssigmentObj(i).GetSlotNum();
-
-	if (rpsIndex >= 0 && rawGroup >= 0 && slotIndex >= 0)
+	uint16_t iSlot = slotAnalytics.GetSlotIndex(currentRps, currentRawGroup, currentRawSlot);
+
+	if (iSlot < slotAnalytics.GetTotalSlots())
 	{
 		if (senderDevice->GetAddress() == apDevice.Get(0)->GetAddress())
 		{
@@ -1232,7 +1190,7 @@ void configureUDPClients() {
 		}
 		trafficfile.close();
 	} else
-		cout << "Unable to open traffic file \n";
+		NS_FATAL_ERROR("Unable to open the traffic file " << config.TrafficPath);
 
 	double randomStart = 0.0;
 	for (std::map<uint16_t, float>::iterator it = traffic_sta.begin(); it != traffic_sta.end(); ++it) {
@@ -1410,6 +1368,7 @@ int main(int argc, char *argv[]) {
 			config.totalRawSlots, 0);
 	transmissionsPerTIMGroupAndSlotFromSTASinceLastInterval = vector<long>(
 			config.totalRawSlots, 0);
+	slotAnalytics.Init(config.rps);
 
 	RngSeedManager::SetSeed(config.seed);
 
@@ -1476,6 +1435,7 @@ int main(int argc, char *argv[]) {
 
 	NetDeviceContainer staDevice;
 	staDevice = wifi.Install(phy, mac, wifiStaNode);
+	staDeviceCont = staDevice;
 	
 	// set AP Wifi
 	mac.SetType (
@@ -1494,6 +1454,9 @@ int main(int argc, char *argv[]) {
 	mac.AddType("LogStaList", 			BooleanValue(config.ccMacAPLogStaList));
 	mac.AddType("LogPred", 				BooleanValue(config.ccMacAPLogPred));
 	mac.AddType("LogPredAll", 			BooleanValue(config.ccMacAPLogPredAll));
+	if (config.rawOptimizer)
+		mac.AddType("RawOptimizer", PointerValue(CreateObjectWithAttributes<RawOptimizer>(
+				"UpdatePeriod", UintegerValue(config.rawOptimizerPeriod))));
 
 	phy.Set("TxGain", DoubleValue(3.0));
 	phy.Set("RxGain", DoubleValue(3.0));
@@ -1516,6 +1479,19 @@ int main(int argc, char *argv[]) {
 	Config::ConnectWithoutContext(oss.str() + "RpsIndex", MakeCallback(&RpsIndexTrace));
 	Config::ConnectWithoutContext(oss.str() + "RawGroup", MakeCallback(&RawGroupTrace));
 	Config::ConnectWithoutContext(oss.str() + "RawSlot", MakeCallback(&RawSlotTrace));
+	Config::ConnectWithoutContext(oss.str() + "RpsUpdated", MakeCallback(&RpsUpdatedTrace));
+	if (config.slotAnalytics)
+	{
+		Ptr<WifiPhy> apPhy = DynamicCast<WifiNetDevice>(apDevice.Get(0))->GetPhy();
+		string slotAnalyticsFile = config.pathProjReport + "slot-analytics.bin";
+		if (!slotAnalytics.Open(slotAnalyticsFile, apPhy))
+			NS_ABORT_MSG("Cannot open " << slotAnalyticsFile);
+		Config::ConnectWithoutContext(oss.str() + "S1gBeaconBroadcasted", MakeCallback(&S1gBeaconBroadcastedTrace));
+		ostringstream ossPhy;
+		ossPhy << "/NodeList/" << wifiApNode.Get(0)->GetId() << "/DeviceList/0/$ns3::WifiNetDevice/Phy/State/";
+		Config::ConnectWithoutContext(ossPhy.str() + "State", MakeCallback(&SlotAnalytics::OnApPhyState, &slotAnalytics));
+		Config::ConnectWithoutContext(ossPhy.str() + "RxOk", MakeCallback(&SlotAnalytics::OnApPhyRxOk, &slotAnalytics));
+	}
 
 	/*** Mobility ***/
 	// retrieve the radius and calculate AP (x, y) as the center of a circle
@@ -1726,12 +1702,25 @@ int main(int argc, char *argv[]) {
 	eventManager.onAPNodeCreated(apposition.x, apposition.y);
 	eventManager.onStatisticsHeader();
 
+	// skip the warm-up: associate every STA directly or restore the associations of an earlier run
+	if (config.preAssociate) {
+		S1gAssociationHelper assocHelper;
+		cout << "Pre-associated " << assocHelper.PreAssociate(apDevice.Get(0), staDeviceCont) << " stations" << endl;
+	}
+	else if (!config.assocSnapshotLoad.empty()) {
+		S1gAssociationHelper assocHelper;
+		uint32_t restored = assocHelper.Load(config.assocSnapshotLoad, apDevice.Get(0), staDeviceCont);
+		cout << "Restored " << restored << " associations (warm-up of "
+				<< assocHelper.GetSnapshotTime().GetSeconds() << " s skipped)" << endl;
+	}
+
 	sendStatistics(true);
 	// schedule the througput
 	Simulator::Schedule(Seconds(1), &PrintStatistics, 0, 0, 0);
 	// allow up to a minute after the client & server apps are finished to process the queue
 	Simulator::Stop(Seconds(config.simulationTime + config.CoolDownPeriod));
 	Simulator::Run();
+	slotAnalytics.Close();
 
 	// Visualizer throughput
 	int pay = 0, totalSuccessfulPackets = 0, totalSentPackets = 0, totalPacketsEchoed = 0;
@@ -71,6 +71,7 @@ vector<NodeEntry*> nodes;
 
 vector<long> transmissionsPerTIMGroupAndSlotFromAPSinceLastInterval;
 vector<long> transmissionsPerTIMGroupAndSlotFromSTASinceLastInterval;
+SlotAnalytics slotAnalytics;
 
 ApplicationContainer serverApp;
 uint32_t AppStartTime = 0;
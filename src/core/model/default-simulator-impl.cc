@@ -27,8 +27,13 @@
 #include "pointer.h"
 #include "assert.h"
 #include "log.h"
+#include "abort.h"
+#include "string.h"
+#include "boolean.h"
 
 #include <cmath>
+#include <fstream>
+#include <iostream>
 
 
 /**
@@ -53,6 +58,25 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("EventTraceFile",
+                   "Record the schedule and expiration time of every event "
+                   "to this file (empty: no trace).",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::SetEventTraceFile),
+                   MakeStringChecker ())
+    .AddAttribute ("Profile",
+                   "Measure the wall clock time of the events by handler "
+                   "and print the ranked modules and handlers at Destroy.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::SetProfile),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ProfileFile",
+                   "Measure the wall clock time of the events by handler "
+                   "and write it to this file at Destroy, in the folded "
+                   "stack format of flame graph tools (empty: no file).",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::SetProfileFile),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -73,11 +97,16 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_unscheduledEvents = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  m_eventTrace = 0;
+  m_profile = false;
+  m_profiler = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
+  SetEventTraceFile ("");
+  delete m_profiler;
 }
 
 void
@@ -92,12 +121,26 @@ DefaultSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
+  SetEventTraceFile ("");
   SimulatorImpl::DoDispose ();
 }
 void
 DefaultSimulatorImpl::Destroy ()
 {
   NS_LOG_FUNCTION (this);
+  if (m_profiler != 0)
+    {
+      if (m_profile)
+        {
+          m_profiler->Print (std::clog);
+        }
+      if (!m_profileFile.empty ())
+        {
+          std::ofstream os (m_profileFile.c_str ());
+          NS_ABORT_MSG_UNLESS (os.is_open (), "Cannot open profile file " << m_profileFile);
+          m_profiler->PrintFolded (os);
+        }
+    }
   while (!m_destroyEvents.empty ()) 
     {
       Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
@@ -127,6 +170,54 @@ DefaultSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
   m_events = scheduler;
 }
 
+void
+DefaultSimulatorImpl::SetEventTraceFile (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  if (m_eventTrace != 0)
+    {
+      std::fclose (m_eventTrace);
+      m_eventTrace = 0;
+    }
+  if (!filename.empty ())
+    {
+      m_eventTrace = std::fopen (filename.c_str (), "wb");
+      NS_ABORT_MSG_IF (m_eventTrace == 0, "Cannot open event trace file " << filename);
+    }
+}
+
+void
+DefaultSimulatorImpl::TraceEvent (uint64_t ts)
+{
+  if (m_eventTrace != 0)
+    {
+      uint64_t record[2] = { m_currentTs, ts };
+      std::fwrite (record, sizeof (record), 1, m_eventTrace);
+    }
+}
+
+void
+DefaultSimulatorImpl::SetProfile (bool enable)
+{
+  NS_LOG_FUNCTION (this << enable);
+  m_profile = enable;
+  if (m_profiler == 0 && m_profile)
+    {
+      m_profiler = new EventProfiler ();
+    }
+}
+
+void
+DefaultSimulatorImpl::SetProfileFile (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_profileFile = filename;
+  if (m_profiler == 0 && !m_profileFile.empty ())
+    {
+      m_profiler = new EventProfiler ();
+    }
+}
+
 // System ID for non-distributed simulation is always zero
 uint32_t 
 DefaultSimulatorImpl::GetSystemId (void) const
@@ -146,7 +237,16 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler == 0)
+    {
+      next.impl->Invoke ();
+    }
+  else
+    {
+      uint64_t start = EventProfiler::GetTicks ();
+      next.impl->Invoke ();
+      m_profiler->Record (next.impl, EventProfiler::GetTicks () - start);
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -184,6 +284,7 @@ DefaultSimulatorImpl::ProcessEventsWithContext (void)
        ev.key.m_uid = m_uid;
        m_uid++;
        m_unscheduledEvents++;
+       TraceEvent (ev.key.m_ts);
        m_events->Insert (ev);
     }
 }
@@ -197,10 +298,18 @@ DefaultSimulatorImpl::Run (void)
   ProcessEventsWithContext ();
   m_stop = false;
 
+  if (m_profiler != 0)
+    {
+      m_profiler->Start ();
+    }
   while (!m_events->IsEmpty () && !m_stop) 
     {
       ProcessOneEvent ();
     }
+  if (m_profiler != 0)
+    {
+      m_profiler->Stop ();
+    }
 
   // If the simulator stopped naturally by lack of events, make a
   // consistency test to check that we didn't lose any events along the way.
@@ -241,6 +350,7 @@ DefaultSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
   ev.key.m_uid = m_uid;
   m_uid++;
   m_unscheduledEvents++;
+  TraceEvent (ev.key.m_ts);
   m_events->Insert (ev);
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
@@ -260,6 +370,7 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       ev.key.m_uid = m_uid;
       m_uid++;
       m_unscheduledEvents++;
+      TraceEvent (ev.key.m_ts);
       m_events->Insert (ev);
     }
   else
@@ -289,6 +400,7 @@ DefaultSimulatorImpl::ScheduleNow (EventImpl *event)
   ev.key.m_uid = m_uid;
   m_uid++;
   m_unscheduledEvents++;
+  TraceEvent (ev.key.m_ts);
   m_events->Insert (ev);
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
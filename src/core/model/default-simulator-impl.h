@@ -28,8 +28,11 @@
 #include "ns3/system-mutex.h"
 
 #include "ptr.h"
+#include "event-profiler.h"
 
 #include <list>
+#include <string>
+#include <cstdio>
 
 /**
  * \file
@@ -43,6 +46,10 @@ namespace ns3 {
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * With the Profile or ProfileFile attribute, e.g. set from the
+ * NS_ATTRIBUTE_DEFAULT environment variable, it measures the events
+ * with an EventProfiler and reports them at Destroy.
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -81,6 +88,36 @@ public:
 private:
   virtual void DoDispose (void);
 
+  /**
+   * Start (or, with an empty path, stop) recording every event
+   * inserted in the queue. The file is a sequence of pairs of
+   * native uint64_t: the time step at which the event is scheduled
+   * and the time step at which it expires. utils/bench-simulator
+   * replays it with --trace.
+   *
+   * \param [in] filename The path of the trace file.
+   */
+  void SetEventTraceFile (std::string filename);
+  /**
+   * Record an event inserted in the queue, if a trace is open.
+   *
+   * \param [in] ts The expiration time step of the event.
+   */
+  inline void TraceEvent (uint64_t ts);
+  /**
+   * Enable or disable the event profiler.
+   *
+   * \param [in] enable Print the profile at Destroy.
+   */
+  void SetProfile (bool enable);
+  /**
+   * Write the event profile, at Destroy, in the folded stack format of
+   * flame graph tools.
+   *
+   * \param [in] filename The path of the profile file (empty: none).
+   */
+  void SetProfileFile (std::string filename);
+
   /** Process the next event. */
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
@@ -132,6 +169,16 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** The event trace file, or 0. */
+  std::FILE *m_eventTrace;
+
+  /** Print the event profile at Destroy. */
+  bool m_profile;
+  /** The path of the folded event profile, or empty. */
+  std::string m_profileFile;
+  /** The event profiler, or 0 if neither profile is asked. */
+  EventProfiler *m_profiler;
 };
 
 } // namespace ns3
@@ -20,6 +20,8 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include <atomic>
+#include <new>
 
 /**
  * \file
@@ -31,6 +33,102 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** Size step of the free lists. */
+const std::size_t POOL_GRANULE = 16;
+/** Number of free lists: events up to 256 bytes are pooled. */
+const std::size_t POOL_CLASSES = 16;
+/** Blocks taken from the heap at once when a free list is empty. */
+const std::size_t POOL_CHUNK = 64;
+/** Size of the header of a block, which keeps the alignment of the event. */
+const std::size_t POOL_HEADER = 16;
+
+struct EventPool;
+
+/** The header of a block, before the event. */
+struct FreeBlock
+{
+  EventPool *owner; /**< The pool of the chunk of the block. */
+  FreeBlock *next;  /**< The next free block. */
+};
+
+/**
+ * The free lists and counters of a thread. A block released by
+ * another thread goes back to the pool it was carved by, through the
+ * returned lists, which the pool drains when its own list is empty.
+ * The pools are never deleted: the pool of a thread that exits is
+ * given to the next thread that allocates an event, so a block can
+ * always go back to its pool and the memory stays bounded by the
+ * number of threads alive at once.
+ */
+struct EventPool
+{
+  FreeBlock *free[POOL_CLASSES];                   /**< Free list per size class. */
+  std::atomic<FreeBlock *> returned[POOL_CLASSES]; /**< Blocks released by other threads. */
+  EventImpl::PoolStats stats;                      /**< The counters. */
+  std::atomic<bool> used;                          /**< A thread owns the pool. */
+  EventPool *next;                                 /**< The next pool, in g_eventPools. */
+};
+
+/** All the pools. */
+std::atomic<EventPool *> g_eventPools (0);
+
+/**
+ * \returns A pool no thread owns, now owned by the calling thread.
+ */
+EventPool *
+AcquireEventPool (void)
+{
+  for (EventPool *pool = g_eventPools.load (std::memory_order_acquire); pool != 0; pool = pool->next)
+    {
+      bool used = false;
+      if (pool->used.compare_exchange_strong (used, true, std::memory_order_acquire))
+        {
+          return pool;
+        }
+    }
+  EventPool *pool = new EventPool ();
+  pool->used.store (true, std::memory_order_relaxed);
+  pool->next = g_eventPools.load (std::memory_order_relaxed);
+  while (!g_eventPools.compare_exchange_weak (pool->next, pool, std::memory_order_release))
+    {
+    }
+  return pool;
+}
+
+/** The pool of a thread, released when the thread exits. */
+struct EventPoolOwner
+{
+  EventPool *pool;  /**< The pool, or 0 until the first event. */
+  ~EventPoolOwner ()
+  {
+    if (pool != 0)
+      {
+        pool->used.store (false, std::memory_order_release);
+      }
+  }
+};
+
+/** The pool of the thread. */
+thread_local EventPoolOwner g_eventPool;
+
+/**
+ * \returns The pool of the calling thread.
+ */
+inline EventPool *
+GetEventPool (void)
+{
+  EventPool *pool = g_eventPool.pool;
+  if (pool == 0)
+    {
+      pool = g_eventPool.pool = AcquireEventPool ();
+    }
+  return pool;
+}
+
+} // anonymous namespace
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -66,4 +164,86 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+EventImpl::PoolStats
+EventImpl::GetPoolStats (void)
+{
+  return GetEventPool ()->stats;
+}
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  EventPool *pool = GetEventPool ();
+  pool->stats.allocations++;
+  if (size > POOL_GRANULE * POOL_CLASSES)
+    {
+      pool->stats.oversized++;
+      return ::operator new (size);
+    }
+  std::size_t index = (size - 1) / POOL_GRANULE;
+  FreeBlock *block = pool->free[index];
+  if (block == 0)
+    {
+      // take back the blocks released by the other threads
+      block = pool->returned[index].exchange (0, std::memory_order_acquire);
+      for (FreeBlock *i = block; i != 0; i = i->next)
+        {
+          pool->stats.free++;
+        }
+    }
+  if (block != 0)
+    {
+      pool->free[index] = block->next;
+      pool->stats.reused++;
+      pool->stats.free--;
+      return reinterpret_cast<char *> (block) + POOL_HEADER;
+    }
+  // carve a new chunk: hand out its first block, keep the others
+  std::size_t blockSize = POOL_HEADER + (index + 1) * POOL_GRANULE;
+  char *chunk = static_cast<char *> (::operator new (blockSize * POOL_CHUNK));
+  for (std::size_t i = POOL_CHUNK - 1; i > 0; i--)
+    {
+      FreeBlock *free = reinterpret_cast<FreeBlock *> (chunk + i * blockSize);
+      free->owner = pool;
+      free->next = pool->free[index];
+      pool->free[index] = free;
+    }
+  reinterpret_cast<FreeBlock *> (chunk)->owner = pool;
+  pool->stats.chunks++;
+  pool->stats.free += POOL_CHUNK - 1;
+  return chunk + POOL_HEADER;
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  EventPool *pool = GetEventPool ();
+  pool->stats.releases++;
+  if (size > POOL_GRANULE * POOL_CLASSES)
+    {
+      ::operator delete (p);
+      return;
+    }
+  FreeBlock *block = reinterpret_cast<FreeBlock *> (static_cast<char *> (p) - POOL_HEADER);
+  std::size_t index = (size - 1) / POOL_GRANULE;
+  EventPool *owner = block->owner;
+  if (owner == pool)
+    {
+      block->next = pool->free[index];
+      pool->free[index] = block;
+      pool->stats.free++;
+      return;
+    }
+  block->next = owner->returned[index].load (std::memory_order_relaxed);
+  while (!owner->returned[index].compare_exchange_weak (block->next, block,
+                                                         std::memory_order_release,
+                                                         std::memory_order_relaxed))
+    {
+    }
+}
+
 } // namespace ns3
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +41,15 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Events are allocated from per-thread free lists, one per size class
+ * (multiples of 16 bytes, up to 256 bytes), so scheduling and running
+ * an event does not go through malloc/free once the simulation has
+ * warmed up. Larger events are left to the heap. An event released by
+ * another thread goes back to the free lists of the thread that
+ * allocated it. The memory of the free lists is kept until the end of
+ * the process, and the free lists of a thread that exits are reused
+ * by the next thread.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -66,6 +76,39 @@ public:
    */
   bool IsCancelled (void);
 
+  /** Counters of the event allocator. */
+  struct PoolStats
+  {
+    uint64_t allocations;  /**< Events allocated. */
+    uint64_t releases;     /**< Events released. */
+    uint64_t reused;       /**< Allocations served from a free list. */
+    uint64_t chunks;       /**< Chunks of blocks taken from the heap. */
+    uint64_t oversized;    /**< Allocations too large for the free lists. */
+    uint64_t free;         /**< Blocks waiting in the free lists of the thread. */
+  };
+  /**
+   * Get the counters of the event allocator of the calling thread
+   * (the simulation thread for the default simulator implementation).
+   *
+   * \returns The counters.
+   */
+  static PoolStats GetPoolStats (void);
+
+  /**
+   * Allocate an event from the free list of its size class.
+   *
+   * \param [in] size The size of the event.
+   * \returns The memory of the event.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Give the memory of an event back to the free list of its size class.
+   *
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size);
+
 protected:
   /**
    * Implementation for Invoke().
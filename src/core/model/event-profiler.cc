@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <iomanip>
+#include <map>
+#include <utility>
+
+/**
+ * \file
+ * \ingroup simulator
+ * Implementation of class ns3::EventProfiler.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace {
+
+/**
+ * \returns The wall clock time, in ns.
+ */
+int64_t
+GetWallClockNs (void)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>
+           (std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+}
+
+} // unnamed namespace
+
+EventProfiler::EventProfiler ()
+  : m_lastType (0),
+    m_lastCounter (0),
+    m_startTicks (0),
+    m_startNs (0),
+    m_runTicks (0),
+    m_runNs (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EventProfiler::Start (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_startNs = GetWallClockNs ();
+  m_startTicks = GetTicks ();
+}
+
+void
+EventProfiler::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_runTicks += GetTicks () - m_startTicks;
+  m_runNs += GetWallClockNs () - m_startNs;
+}
+
+void
+EventProfiler::GetEventName (const std::type_info &type, std::string &module, std::string &name)
+{
+  NS_LOG_FUNCTION (type.name ());
+  int status;
+  char *demangled = abi::__cxa_demangle (type.name (), 0, 0, &status);
+  name = status == 0 ? demangled : type.name ();
+  std::free (demangled);
+  module = name;
+
+  // The events of MakeEvent are local classes of its instantiations:
+  // "ns3::MakeEvent<...>(void (ns3::X::*)(...), ...)::EventMemberImpl1"
+  // or "ns3::MakeEvent<...>(void (*)(...), ...)::EventFunctionImpl1".
+  std::string::size_type i = name.find ("ns3::MakeEvent");
+  if (i != 0
+      || (name.find ("::EventMemberImpl") == std::string::npos
+          && name.find ("::EventFunctionImpl") == std::string::npos))
+    {
+      return;
+    }
+  // skip the template arguments
+  i += 14;
+  int depth = 0;
+  while (i < name.size () && (depth > 0 || name[i] == '<'))
+    {
+      depth += name[i] == '<' ? 1 : name[i] == '>' ? -1 : 0;
+      i++;
+    }
+  if (i == name.size () || name[i] != '(')
+    {
+      return;
+    }
+  // the first function argument is the handler
+  std::string::size_type start = ++i;
+  depth = 0;
+  while (i < name.size () && (depth > 0 || (name[i] != ',' && name[i] != ')')))
+    {
+      depth += (name[i] == '<' || name[i] == '(') ? 1 : (name[i] == '>' || name[i] == ')') ? -1 : 0;
+      i++;
+    }
+  name = name.substr (start, i - start);
+  std::string::size_type end = name.find ("::*)");
+  if (end == std::string::npos)
+    {
+      module = "function";
+      return;
+    }
+  // the class may have parentheses, e.g. "(anonymous namespace)::X"
+  start = end;
+  depth = 0;
+  while (start > 0 && (depth > 0 || name[start - 1] != '('))
+    {
+      start--;
+      depth += name[start] == ')' ? 1 : name[start] == '(' ? -1 : 0;
+    }
+  module = name.substr (start, end - start);
+}
+
+bool
+EventProfiler::LineGreater (const Line &a, const Line &b)
+{
+  return a.ticks > b.ticks;
+}
+
+void
+EventProfiler::GetLines (std::vector<Line> &events, std::vector<Line> &modules) const
+{
+  std::map<std::pair<std::string, std::string>, Line> byName;
+  std::map<std::string, Line> byModule;
+  for (Counters::const_iterator i = m_counters.begin (); i != m_counters.end (); i++)
+    {
+      std::string module;
+      std::string name;
+      GetEventName (*i->first, module, name);
+      Line &event = byName[std::make_pair (module, name)];
+      event.module = module;
+      event.name = name;
+      event.events += i->second.events;
+      event.ticks += i->second.ticks;
+      Line &total = byModule[module];
+      total.module = module;
+      total.events += i->second.events;
+      total.ticks += i->second.ticks;
+    }
+  events.clear ();
+  for (std::map<std::pair<std::string, std::string>, Line>::const_iterator i = byName.begin (); i != byName.end (); i++)
+    {
+      events.push_back (i->second);
+    }
+  modules.clear ();
+  for (std::map<std::string, Line>::const_iterator i = byModule.begin (); i != byModule.end (); i++)
+    {
+      modules.push_back (i->second);
+    }
+  Line simulator;
+  simulator.module = "(simulator)";
+  simulator.events = 0;
+  simulator.ticks = GetSimulatorTicks ();
+  modules.push_back (simulator);
+  std::stable_sort (events.begin (), events.end (), &EventProfiler::LineGreater);
+  std::stable_sort (modules.begin (), modules.end (), &EventProfiler::LineGreater);
+}
+
+uint64_t
+EventProfiler::GetSimulatorTicks (void) const
+{
+  uint64_t ticks = 0;
+  for (Counters::const_iterator i = m_counters.begin (); i != m_counters.end (); i++)
+    {
+      ticks += i->second.ticks;
+    }
+  return m_runTicks > ticks ? m_runTicks - ticks : 0;
+}
+
+void
+EventProfiler::Print (std::ostream &os, uint32_t maxEvents) const
+{
+  std::vector<Line> events;
+  std::vector<Line> modules;
+  GetLines (events, modules);
+  double nsPerTick = m_runTicks > 0 ? (double)m_runNs / m_runTicks : 0;
+  uint64_t nEvents = 0;
+  for (std::vector<Line>::const_iterator i = events.begin (); i != events.end (); i++)
+    {
+      nEvents += i->events;
+    }
+  std::ios::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << std::fixed
+     << "Simulator profile: " << nEvents << " events in "
+     << std::setprecision (3) << m_runNs * 1e-9 << " s" << std::endl;
+
+  std::vector<Line> *tables[2] = { &modules, &events };
+  for (uint32_t t = 0; t < 2; t++)
+    {
+      os << std::endl
+         << std::setw (5) << "rank" << std::setw (11) << "time (s)" << std::setw (7) << "%"
+         << std::setw (12) << "events" << std::setw (10) << "ns/event"
+         << "  " << (t == 0 ? "module" : "module  event") << std::endl;
+      uint32_t n = t == 0 ? tables[t]->size () : std::min<uint32_t> (tables[t]->size (), maxEvents);
+      for (uint32_t i = 0; i < n; i++)
+        {
+          const Line &line = (*tables[t])[i];
+          double ns = line.ticks * nsPerTick;
+          os << std::setw (5) << i + 1
+             << std::setw (11) << std::setprecision (3) << ns * 1e-9
+             << std::setw (7) << std::setprecision (1) << (m_runNs > 0 ? 100 * ns / m_runNs : 0)
+             << std::setw (12) << line.events
+             << std::setw (10) << std::setprecision (0) << (line.events > 0 ? ns / line.events : 0)
+             << "  " << line.module;
+          if (!line.name.empty ())
+            {
+              os << "  " << line.name;
+            }
+          os << std::endl;
+        }
+    }
+  os.flags (flags);
+  os.precision (precision);
+}
+
+void
+EventProfiler::PrintFolded (std::ostream &os) const
+{
+  std::vector<Line> events;
+  std::vector<Line> modules;
+  GetLines (events, modules);
+  double nsPerTick = m_runTicks > 0 ? (double)m_runNs / m_runTicks : 0;
+  for (std::vector<Line>::const_iterator i = events.begin (); i != events.end (); i++)
+    {
+      os << i->module << ";" << i->name << " " << (uint64_t)(i->ticks * nsPerTick) << std::endl;
+    }
+  os << "(simulator) " << (uint64_t)(GetSimulatorTicks () * nsPerTick) << std::endl;
+}
+
+} // namespace ns3
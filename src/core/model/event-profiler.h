@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "event-impl.h"
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#if defined (__x86_64__) || defined (__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * Declaration of class ns3::EventProfiler.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * Wall time and number of the events run by a simulator, by event
+ * handler.
+ *
+ * The simulator reads the time stamp counter before and after each
+ * event and records the difference against the dynamic type of the
+ * event. The events made by MakeEvent (all the Simulator::Schedule
+ * variants) have a type per handler signature, so an entry is a handler
+ * class and signature, e.g. the events of
+ * <tt>void (ns3::MacLow::*)()</tt>: handlers of a class with the same
+ * signature share their entry. The class of the handler is its module;
+ * the events of plain functions belong to the \c function module.
+ *
+ * The counter ticks are converted to seconds against the wall clock
+ * time of the Run calls, which also gives the time spent in the
+ * simulator itself (the event queue), reported as <tt>(simulator)</tt>.
+ */
+class EventProfiler
+{
+public:
+  /** Constructor. */
+  EventProfiler ();
+
+  /**
+   * \returns The current value of the time stamp counter (or of a
+   *          monotonic clock where it is not available).
+   */
+  static uint64_t GetTicks (void);
+
+  /** Start a simulation run. */
+  void Start (void);
+  /** End a simulation run. */
+  void Stop (void);
+  /**
+   * Record an event.
+   *
+   * \param [in] event The event.
+   * \param [in] ticks The ticks spent running it.
+   */
+  void Record (const EventImpl *event, uint64_t ticks);
+
+  /**
+   * Print the modules and the events ranked by decreasing time.
+   *
+   * \param [in] os The output stream.
+   * \param [in] maxEvents The number of events to print.
+   */
+  void Print (std::ostream &os, uint32_t maxEvents = 20) const;
+  /**
+   * Print the time of every event, in nanoseconds, in the folded stack
+   * format of flame graph tools: one <tt>module;event time</tt> line per
+   * entry.
+   *
+   * \param [in] os The output stream.
+   */
+  void PrintFolded (std::ostream &os) const;
+
+  /**
+   * Split the name of an event type in a module and an event name.
+   *
+   * \param [in] type The dynamic type of an event.
+   * \param [out] module The class of the handler, or \c function.
+   * \param [out] name The handler signature, or the type name of
+   *              events not made by MakeEvent.
+   */
+  static void GetEventName (const std::type_info &type, std::string &module, std::string &name);
+
+private:
+  /** The counters of an event type. */
+  struct Counter
+  {
+    uint64_t events;   /**< The number of events. */
+    uint64_t ticks;    /**< The ticks spent running them. */
+  };
+  /** The counters of a module or a handler, for the reports. */
+  struct Line
+  {
+    std::string module;   /**< The module. */
+    std::string name;     /**< The handler, empty for a module. */
+    uint64_t events;      /**< The number of events. */
+    uint64_t ticks;       /**< The ticks spent running them. */
+  };
+  /**
+   * Order of the lines in the reports.
+   *
+   * \param [in] a The first line.
+   * \param [in] b The second line.
+   * \returns \c true if \c a takes more time than \c b.
+   */
+  static bool LineGreater (const Line &a, const Line &b);
+  /**
+   * Merge the counters by handler: the event types may have a
+   * type_info per shared library.
+   *
+   * \param [out] events The handlers, ranked.
+   * \param [out] modules The modules, ranked.
+   */
+  void GetLines (std::vector<Line> &events, std::vector<Line> &modules) const;
+  /** \returns The ticks spent in the simulator, outside the events. */
+  uint64_t GetSimulatorTicks (void) const;
+
+  /** Container type for the counters, by event type. */
+  typedef std::unordered_map<const std::type_info *, Counter> Counters;
+  /** The counters. */
+  Counters m_counters;
+  /** The type of the last event recorded. */
+  const std::type_info *m_lastType;
+  /** The counter of the last event recorded. */
+  Counter *m_lastCounter;
+
+  /** The ticks at the start of the current run. */
+  uint64_t m_startTicks;
+  /** The wall clock time at the start of the current run, in ns. */
+  int64_t m_startNs;
+  /** The ticks of all the runs. */
+  uint64_t m_runTicks;
+  /** The wall clock time of all the runs, in ns. */
+  int64_t m_runNs;
+};
+
+inline uint64_t
+EventProfiler::GetTicks (void)
+{
+#if defined (__x86_64__) || defined (__i386__)
+  return __rdtsc ();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>
+           (std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+#endif
+}
+
+inline void
+EventProfiler::Record (const EventImpl *event, uint64_t ticks)
+{
+  const std::type_info *type = &typeid (*event);
+  if (type != m_lastType)
+    {
+      // a counter does not move when others are added to the map
+      m_lastCounter = &m_counters[type];
+      m_lastType = type;
+    }
+  m_lastCounter->events++;
+  m_lastCounter->ticks += ticks;
+}
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
@@ -0,0 +1,317 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+namespace {
+
+/**
+ * \ingroup scheduler
+ * Heap order of Bottom: the earliest event at the front.
+ */
+struct LaterEvent
+{
+  /**
+   * \param [in] a The first event.
+   * \param [in] b The second event.
+   * \returns \c true if \c a is later than \c b
+   */
+  bool operator () (const Scheduler::Event &a, const Scheduler::Event &b) const
+  {
+    return b < a;
+  }
+};
+
+} // anonymous namespace
+
+const uint32_t LadderScheduler::MAX_RUNGS;
+const uint32_t LadderScheduler::MAX_BUCKETS;
+const uint32_t LadderScheduler::THRESHOLD;
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (~(uint64_t)0),
+    m_topMax (0),
+    m_topStart (0),
+    m_nRungs (0),
+    m_qSize (0)
+{
+  NS_LOG_FUNCTION (this);
+  // the rungs are referenced while a child is pushed
+  m_rungs.reserve (MAX_RUNGS);
+}
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::GetCurrentStart (const Rung &rung)
+{
+  return rung.start + rung.current * rung.width;
+}
+uint32_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  uint32_t i = 0;
+  while (i < m_nRungs && ts < GetCurrentStart (m_rungs[i]))
+    {
+      i++;
+    }
+  return i;
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  m_qSize++;
+  if (ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+      return;
+    }
+  uint32_t i = FindRung (ts);
+  if (i < m_nRungs)
+    {
+      Rung &rung = m_rungs[i];
+      uint32_t bucket = (ts - rung.start) / rung.width;
+      NS_ASSERT (bucket < rung.nBuckets);
+      rung.buckets[bucket].push_back (ev);
+      rung.count++;
+      return;
+    }
+  m_bottom.push_back (ev);
+  std::push_heap (m_bottom.begin (), m_bottom.end (), LaterEvent ());
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  // filling Bottom does not change the content of the queue
+  const_cast<LadderScheduler *> (this)->Refill ();
+  return m_bottom.front ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Refill ();
+  std::pop_heap (m_bottom.begin (), m_bottom.end (), LaterEvent ());
+  Scheduler::Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_qSize--;
+  NS_LOG_DEBUG ("remove ts=" << ev.key.m_ts <<
+                ", key=" << ev.key.m_uid <<
+                ", from bottom=" << m_bottom.size ());
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  Bucket *bucket;
+  Rung *rung = 0;
+  if (ts >= m_topStart)
+    {
+      bucket = &m_top;
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i < m_nRungs)
+        {
+          rung = &m_rungs[i];
+          bucket = &rung->buckets[(ts - rung->start) / rung->width];
+        }
+      else
+        {
+          bucket = &m_bottom;
+        }
+    }
+  for (Bucket::iterator it = bucket->begin (); it != bucket->end (); ++it)
+    {
+      if (it->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (ev.impl == it->impl);
+          *it = bucket->back ();
+          bucket->pop_back ();
+          m_qSize--;
+          if (rung != 0)
+            {
+              rung->count--;
+            }
+          else if (bucket == &m_bottom)
+            {
+              std::make_heap (m_bottom.begin (), m_bottom.end (), LaterEvent ());
+            }
+          // the bounds of Top may now be loose, which only widens the next rung
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+LadderScheduler::Rung &
+LadderScheduler::PushRung (uint64_t start, uint64_t width, uint32_t nBuckets)
+{
+  NS_LOG_FUNCTION (this << start << width << nBuckets);
+  if (m_nRungs == m_rungs.size ())
+    {
+      m_rungs.push_back (Rung ());
+    }
+  Rung &rung = m_rungs[m_nRungs++];
+  rung.start = start;
+  rung.width = width;
+  rung.nBuckets = nBuckets;
+  rung.current = 0;
+  rung.count = 0;
+  if (rung.buckets.size () < nBuckets)
+    {
+      rung.buckets.resize (nBuckets);
+    }
+  return rung;
+}
+
+void
+LadderScheduler::MoveToBottom (Bucket &bucket)
+{
+  NS_ASSERT (m_bottom.empty ());
+  // Bottom hands its (empty) storage over to the bucket
+  m_bottom.swap (bucket);
+  std::make_heap (m_bottom.begin (), m_bottom.end (), LaterEvent ());
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  while (m_bottom.empty ())
+    {
+      if (m_nRungs == 0)
+        {
+          NS_ASSERT (!m_top.empty ());
+          uint32_t n = m_top.size ();
+          if (n <= THRESHOLD || m_topMin == m_topMax)
+            {
+              m_topStart = m_topMax + 1;
+              MoveToBottom (m_top);
+            }
+          else
+            {
+              uint32_t nBuckets = std::min (n, MAX_BUCKETS);
+              uint64_t width = (m_topMax - m_topMin) / nBuckets + 1;
+              Rung &rung = PushRung (m_topMin, width, nBuckets);
+              for (Bucket::const_iterator it = m_top.begin (); it != m_top.end (); ++it)
+                {
+                  rung.buckets[(it->key.m_ts - rung.start) / width].push_back (*it);
+                }
+              rung.count = n;
+              m_topStart = rung.start + nBuckets * width;
+              m_top.clear ();
+              NS_LOG_DEBUG ("rung 0 start=" << rung.start << ", width=" << width <<
+                            ", buckets=" << nBuckets << ", events=" << n);
+            }
+          m_topMin = ~(uint64_t)0;
+          m_topMax = 0;
+          continue;
+        }
+
+      Rung &rung = m_rungs[m_nRungs - 1];
+      if (rung.count == 0)
+        {
+          m_nRungs--;
+          continue;
+        }
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      Bucket &bucket = rung.buckets[rung.current++];
+      uint32_t n = bucket.size ();
+      rung.count -= n;
+      if (n > THRESHOLD && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+          uint64_t min = bucket.front ().key.m_ts;
+          uint64_t max = min;
+          for (Bucket::const_iterator it = bucket.begin (); it != bucket.end (); ++it)
+            {
+              min = std::min (min, it->key.m_ts);
+              max = std::max (max, it->key.m_ts);
+            }
+          if (min != max)
+            {
+              // the child covers what is left of the bucket, up to the next one
+              uint64_t end = GetCurrentStart (rung);
+              uint32_t nBuckets = std::min (n, MAX_BUCKETS);
+              uint64_t width = (end - min + nBuckets - 1) / nBuckets;
+              Rung &child = PushRung (min, width, nBuckets);
+              for (Bucket::const_iterator it = bucket.begin (); it != bucket.end (); ++it)
+                {
+                  child.buckets[(it->key.m_ts - min) / width].push_back (*it);
+                }
+              child.count = n;
+              bucket.clear ();
+              NS_LOG_DEBUG ("rung " << m_nRungs - 1 << " start=" << min << ", width=" << width <<
+                            ", buckets=" << nBuckets << ", events=" << n);
+              continue;
+            }
+        }
+      MoveToBottom (bucket);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Tang, Goh and Thng (2005). Events
+ * are kept in three tiers:
+ *  - Top: an unsorted array of the events far in the future.
+ *  - Ladder: up to MAX_RUNGS rungs of calendar buckets. The first rung
+ *    is built from Top when it is needed, and a bucket holding more
+ *    than THRESHOLD events is spread over a new, finer, rung instead
+ *    of being sorted.
+ *  - Bottom: a binary heap of the events of the bucket being dequeued.
+ *
+ * Unlike the CalendarScheduler, the bucket width is derived from the
+ * events actually present when a rung is built, so the queue never
+ * needs to be resized. Events are stored by value in vectors that are
+ * kept (with their capacity) when a rung or a bucket is emptied, so
+ * the steady state does not allocate.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Bucket type: an unsorted array of Events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    /** Start of the first bucket, in dimensionless time units. */
+    uint64_t start;
+    /** Duration of a bucket, in dimensionless time units. */
+    uint64_t width;
+    /** Number of buckets in use. */
+    uint32_t nBuckets;
+    /** Index of the next bucket to dequeue. */
+    uint32_t current;
+    /** Number of events in the rung. */
+    uint32_t count;
+    /** The buckets (there may be more than nBuckets, left from an earlier use). */
+    std::vector<Bucket> buckets;
+  };
+
+  /** Maximum number of rungs. */
+  static const uint32_t MAX_RUNGS = 8;
+  /** Maximum number of buckets of a rung. */
+  static const uint32_t MAX_BUCKETS = 4096;
+  /** A bucket holding more events is spread over a new rung. */
+  static const uint32_t THRESHOLD = 50;
+
+  /**
+   * Start of the first bucket not dequeued yet in a rung: an event
+   * earlier than this belongs to a lower rung or to Bottom.
+   *
+   * \param [in] rung The rung.
+   * \returns The dimensionless time.
+   */
+  static uint64_t GetCurrentStart (const Rung &rung);
+  /**
+   * Find the rung an event belongs to.
+   *
+   * \param [in] ts The dimensionless time of the event.
+   * \returns The index of the rung, or m_nRungs for Bottom.
+   */
+  uint32_t FindRung (uint64_t ts) const;
+  /**
+   * Make the next rung of the ladder available, reusing an earlier one.
+   *
+   * \param [in] start The start of its first bucket.
+   * \param [in] width The duration of a bucket.
+   * \param [in] nBuckets The number of buckets.
+   * \returns The rung.
+   */
+  Rung & PushRung (uint64_t start, uint64_t width, uint32_t nBuckets);
+  /**
+   * Move the events of a bucket (which it gives up) to Bottom,
+   * which must be empty.
+   *
+   * \param [in,out] bucket The bucket.
+   */
+  void MoveToBottom (Bucket &bucket);
+  /**
+   * Fill Bottom with the next events if it is empty.
+   */
+  void Refill (void);
+
+  /** Events beyond the ladder. */
+  Bucket m_top;
+  /** Smallest timestamp in Top. */
+  uint64_t m_topMin;
+  /** Largest timestamp in Top. */
+  uint64_t m_topMax;
+  /** Events from this timestamp on go to Top. */
+  uint64_t m_topStart;
+  /** The rungs, of which the first m_nRungs are in use. */
+  std::vector<Rung> m_rungs;
+  /** Number of rungs in use. */
+  uint32_t m_nRungs;
+  /** The events dequeued next, as a min-heap. */
+  Bucket m_bottom;
+  /** Number of events in queue. */
+  uint32_t m_qSize;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -0,0 +1,709 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+#include "simulator.h"
+#include "scheduler.h"
+#include "event-impl.h"
+#include "uinteger.h"
+
+#include "ptr.h"
+#include "assert.h"
+#include "abort.h"
+#include "log.h"
+
+#include <algorithm>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup simulator
+ * Implementation of class ns3::MultithreadedSimulatorImpl.
+ */
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+/** No event, or no stop time. */
+static const uint64_t NO_TS = ~(uint64_t)0;
+
+thread_local MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::m_current = 0;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Core")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("Lookahead",
+                   "The minimum delay of an event scheduled for a context "
+                   "of another partition, and the length of the windows "
+                   "run between two barriers.",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::m_lookahead),
+                   MakeTimeChecker (TimeStep (1)))
+    .AddAttribute ("MaxThreads",
+                   "The maximum number of worker threads (0: one per partition).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_maxThreads),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  m_distributed = false;
+  m_nThreads = 1;
+  m_stop = false;
+  m_stopTs = NO_TS;
+  m_currentTs = 0;
+  m_barrierCount = 0;
+  m_barrierGeneration = 0;
+  m_main = SystemThread::Self ();
+  // replaced by Simulator with the SchedulerType
+  SetScheduler (ObjectFactory ("ns3::MapScheduler"));
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      for (std::vector<Message>::iterator m = partition->inbox.begin (); m != partition->inbox.end (); ++m)
+        {
+          m->event->Unref ();
+        }
+      while (!partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      delete partition;
+    }
+  m_partitions.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  NS_ASSERT_MSG (GetCurrentPartition () == 0, "The scheduler cannot be changed while running");
+  m_schedulerFactory = schedulerFactory;
+  if (m_partitions.empty ())
+    {
+      SetPartition (0, 0);
+    }
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+      while (!(*i)->events->IsEmpty ())
+        {
+          scheduler->Insert ((*i)->events->RemoveNext ());
+        }
+      (*i)->events = scheduler;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetPartition (uint32_t context, uint32_t partition)
+{
+  NS_LOG_FUNCTION (this << context << partition);
+  NS_ASSERT_MSG (!m_distributed, "The partitions must be set before the first run");
+  while (m_partitions.size () <= partition)
+    {
+      Partition *p = new Partition ();
+      p->id = m_partitions.size ();
+      p->events = m_schedulerFactory.Create<Scheduler> ();
+      p->currentTs = 0;
+      p->currentUid = 0;
+      p->currentContext = 0xffffffff;
+      // uids are allocated from 4 (see DefaultSimulatorImpl)
+      p->uid = 4;
+      p->unscheduledEvents = 0;
+      p->sent = 0;
+      p->stopped = false;
+      p->stopTs = NO_TS;
+      m_partitions.push_back (p);
+    }
+  if (m_contextPartition.size () <= context)
+    {
+      m_contextPartition.resize (context + 1, 0);
+    }
+  m_contextPartition[context] = partition;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  return context < m_contextPartition.size () ? m_contextPartition[context] : 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetNPartitions (void) const
+{
+  return m_partitions.size ();
+}
+
+uint32_t
+MultithreadedSimulatorImpl::AllocateCounter (void)
+{
+  static std::atomic<uint32_t> counters (0);
+  return counters++;
+}
+
+bool
+MultithreadedSimulatorImpl::GetNextNumber (uint32_t counter, uint32_t &partition, uint64_t &number)
+{
+  Partition *current = m_current;
+  if (current == 0)
+    {
+      return false;
+    }
+  if (current->numbers.size () <= counter)
+    {
+      current->numbers.resize (counter + 1, 0);
+    }
+  partition = current->id;
+  number = current->numbers[counter]++;
+  return true;
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetCurrentPartition (void) const
+{
+  return m_current;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::Route (uint32_t context) const
+{
+  // everything stays in partition 0 until the first run
+  if (!m_distributed)
+    {
+      return m_partitions[0];
+    }
+  return m_partitions[GetPartition (context)];
+}
+
+uint32_t
+MultithreadedSimulatorImpl::Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = partition->uid;
+  partition->uid++;
+  partition->unscheduledEvents++;
+  partition->events->Insert (ev);
+  return ev.key.m_uid;
+}
+
+bool
+MultithreadedSimulatorImpl::MessageLess (const Message &a, const Message &b)
+{
+  if (a.ts != b.ts)
+    {
+      return a.ts < b.ts;
+    }
+  if (a.source != b.source)
+    {
+      return a.source < b.source;
+    }
+  return a.seq < b.seq;
+}
+
+void
+MultithreadedSimulatorImpl::Deliver (Partition *partition)
+{
+  std::vector<Message> inbox;
+  {
+    CriticalSection cs (partition->inboxMutex);
+    partition->inbox.swap (inbox);
+  }
+  // the senders run concurrently: sort to get the same uids in every run
+  std::sort (inbox.begin (), inbox.end (), &MultithreadedSimulatorImpl::MessageLess);
+  for (std::vector<Message>::const_iterator m = inbox.begin (); m != inbox.end (); ++m)
+    {
+      Insert (partition, m->ts, m->context, m->event);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Distribute (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_distributed)
+    {
+      return;
+    }
+  m_distributed = true;
+  Partition *first = m_partitions[0];
+  Ptr<Scheduler> events = first->events;
+  first->events = m_schedulerFactory.Create<Scheduler> ();
+  first->unscheduledEvents = 0;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      // the events keep their uids, so the EventIds stay valid
+      (*i)->uid = first->uid;
+      (*i)->currentTs = first->currentTs;
+    }
+  while (!events->IsEmpty ())
+    {
+      Scheduler::Event ev = events->RemoveNext ();
+      Partition *partition = Route (ev.key.m_context);
+      partition->events->Insert (ev);
+      partition->unscheduledEvents++;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+  partition->unscheduledEvents--;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  partition->currentTs = next.key.m_ts;
+  partition->currentContext = next.key.m_context;
+  partition->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::Barrier (void)
+{
+  if (m_nThreads == 1)
+    {
+      return;
+    }
+  uint32_t generation = m_barrierGeneration.load ();
+  if (m_barrierCount.fetch_add (1) + 1 == m_nThreads)
+    {
+      m_barrierCount.store (0);
+      m_barrierGeneration.fetch_add (1);
+    }
+  else
+    {
+      // windows are short: spin first, then let the other threads run
+      uint32_t spins = 0;
+      while (m_barrierGeneration.load () == generation)
+        {
+          if (++spins > 1000)
+            {
+              std::this_thread::yield ();
+            }
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Worker (uint32_t thread)
+{
+  uint32_t nPartitions = m_partitions.size ();
+  uint64_t lookahead = m_lookahead.GetTimeStep ();
+  for (;;)
+    {
+      uint64_t next = NO_TS;
+      for (uint32_t i = thread; i < nPartitions; i += m_nThreads)
+        {
+          Partition *partition = m_partitions[i];
+          Deliver (partition);
+          if (!partition->events->IsEmpty ())
+            {
+              next = std::min (next, partition->events->PeekNext ().key.m_ts);
+            }
+        }
+      m_nextTs[thread] = next;
+      // no event runs until the window starts: every thread decides alike,
+      // and the stop times set in a window apply from the next one on
+      bool stop = m_stop;
+      uint64_t stopTs = m_stopTs;
+      for (uint32_t i = 0; i < nPartitions; i++)
+        {
+          stopTs = std::min (stopTs, m_partitions[i]->stopTs);
+        }
+      Barrier ();
+
+      uint64_t start = *std::min_element (m_nextTs.begin (), m_nextTs.end ());
+      if (stop || start == NO_TS || start >= stopTs)
+        {
+          break;
+        }
+      uint64_t end = start + lookahead;
+      for (uint32_t i = thread; i < nPartitions; i += m_nThreads)
+        {
+          Partition *partition = m_partitions[i];
+          m_current = partition;
+          while (!partition->stopped && !partition->events->IsEmpty ())
+            {
+              uint64_t ts = partition->events->PeekNext ().key.m_ts;
+              if (ts >= end || ts >= stopTs || ts >= partition->stopTs)
+                {
+                  break;
+                }
+              ProcessOneEvent (partition);
+            }
+          m_current = 0;
+        }
+      Barrier ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::WorkerThread (std::pair<MultithreadedSimulatorImpl *, uint32_t> worker)
+{
+  worker.first->Worker (worker.second);
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Set the current threadId as the main threadId
+  m_main = SystemThread::Self ();
+  Distribute ();
+  m_stop = false;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      (*i)->stopped = false;
+      (*i)->stopTs = NO_TS;
+    }
+
+  uint32_t nPartitions = m_partitions.size ();
+  m_nThreads = m_maxThreads == 0 ? nPartitions : std::min (m_maxThreads, nPartitions);
+  m_nextTs.assign (m_nThreads, NO_TS);
+  m_barrierCount = 0;
+  NS_LOG_INFO ("run " << nPartitions << " partitions on " << m_nThreads << " threads");
+
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < m_nThreads; i++)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (&MultithreadedSimulatorImpl::WorkerThread,
+                                                                          std::make_pair (this, i)));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+  Worker (0);
+  for (std::vector<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+
+  uint64_t next = NO_TS;
+  int unscheduledEvents = 0;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      m_currentTs = std::max (m_currentTs, (*i)->currentTs);
+      m_stopTs = std::min (m_stopTs, (*i)->stopTs);
+      if (!(*i)->events->IsEmpty ())
+        {
+          next = std::min (next, (*i)->events->PeekNext ().key.m_ts);
+        }
+      unscheduledEvents += (*i)->unscheduledEvents;
+    }
+  if (next >= m_stopTs)
+    {
+      // the stop time has been reached, as the Stop event of DefaultSimulatorImpl
+      m_stopTs = NO_TS;
+    }
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  NS_ASSERT (next != NO_TS || unscheduledEvents == 0);
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if (!(*i)->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  Partition *partition = GetCurrentPartition ();
+  if (partition != 0)
+    {
+      // the other partitions run the window to its end, whatever the threads
+      partition->stopped = true;
+    }
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  uint64_t ts = Now ().GetTimeStep () + delay.GetTimeStep ();
+  Partition *partition = GetCurrentPartition ();
+  if (partition != 0)
+    {
+      // the other partitions read it at the next barrier
+      partition->stopTs = std::min (partition->stopTs, ts);
+    }
+  else
+    {
+      m_stopTs = std::min (m_stopTs, ts);
+    }
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  Partition *partition = GetCurrentPartition ();
+  if (partition == 0)
+    {
+      NS_ASSERT_MSG (SystemThread::Equals (m_main), "Simulator::Schedule Thread-unsafe invocation!");
+      partition = Route (0xffffffff);
+    }
+
+  Time tAbsolute = delay + Now ();
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= Now ());
+  uint64_t ts = (uint64_t) tAbsolute.GetTimeStep ();
+  uint32_t context = GetContext ();
+  uint32_t uid = Insert (partition, ts, context, event);
+  return EventId (event, ts, context, uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+  Partition *partition = GetCurrentPartition ();
+  Partition *target = Route (context);
+  uint64_t ts = (uint64_t) (delay + Now ()).GetTimeStep ();
+
+  if (partition == 0)
+    {
+      NS_ASSERT_MSG (SystemThread::Equals (m_main), "Simulator::ScheduleWithContext is only supported from the simulation threads");
+      Insert (target, ts, context, event);
+    }
+  else if (partition == target)
+    {
+      Insert (target, ts, context, event);
+    }
+  else
+    {
+      NS_ABORT_MSG_IF (delay < m_lookahead,
+                       "An event for context " << context << " of partition " << target->id <<
+                       " is scheduled from partition " << partition->id << " " << delay.As (Time::NS) <<
+                       " ahead, less than the Lookahead " << m_lookahead.As (Time::NS));
+      Message message;
+      message.ts = ts;
+      message.context = context;
+      message.source = partition->id;
+      message.seq = partition->sent;
+      message.event = event;
+      partition->sent++;
+      CriticalSection cs (target->inboxMutex);
+      target->inbox.push_back (message);
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  EventId id (Ptr<EventImpl> (event, false), Now ().GetTimeStep (), 0xffffffff, 2);
+  CriticalSection cs (m_destroyEventsMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  Partition *partition = GetCurrentPartition ();
+  return TimeStep (partition != 0 ? partition->currentTs : m_currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - Now ().GetTimeStep ());
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *partition = Route (id.GetContext ());
+  NS_ASSERT_MSG (GetCurrentPartition () == 0 || GetCurrentPartition () == partition,
+                 "An event of another partition cannot be removed");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  partition->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0 ||
+          id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (const_cast<SystemMutex &> (m_destroyEventsMutex));
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  const Partition *partition = Route (id.GetContext ());
+  if (id.PeekEventImpl () == 0 ||
+      id.GetTs () < partition->currentTs ||
+      (id.GetTs () == partition->currentTs &&
+       id.GetUid () <= partition->currentUid) ||
+      id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  Partition *partition = GetCurrentPartition ();
+  return partition != 0 ? partition->currentContext : 0xffffffff;
+}
+
+} // namespace ns3
@@ -0,0 +1,280 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+#include "system-thread.h"
+#include "system-mutex.h"
+#include "nstime.h"
+#include "ptr.h"
+
+#include <atomic>
+#include <list>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * Declaration of class ns3::MultithreadedSimulatorImpl.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * A shared-memory parallel simulator implementation.
+ *
+ * Every context (node) belongs to a partition, set with SetPartition
+ * (contexts left alone belong to partition 0). Each partition has its
+ * own event queue and clock, and the partitions are shared among up to
+ * MaxThreads worker threads. The threads advance in windows of
+ * Lookahead: every thread runs the events of its partitions earlier
+ * than the smallest next event time of all the partitions plus
+ * Lookahead, then all the threads meet at a barrier.
+ *
+ * An event scheduled for a context of another partition (with
+ * ScheduleWithContext) must be at least Lookahead away, so it never
+ * belongs to the window being run. It is queued to its partition and
+ * inserted at the next barrier, in an order that does not depend on the
+ * threads.
+ *
+ * The partitions must not share any mutable object: models are not
+ * thread-safe. In particular a packet crossing partitions must not
+ * share its buffer with a packet of the sending partition (serialize
+ * it, as the MPI remote channels do). The same holds for the global
+ * state of the models: a model that numbers its objects with a global
+ * counter must take the numbers from GetNextNumber (as the packet and
+ * packet metadata uids do), and the random variables must be created
+ * before Run, since the stream numbers are global. Only then does a run
+ * give the same results with any number of threads.
+ *
+ * Events scheduled before the first Run are kept in partition 0 and
+ * moved to their partitions when Run starts, so SetPartition may be
+ * called at any time before. Stop (delay) called outside Run stops
+ * every partition before the first event at or after the stop time.
+ * Called by an event, it stops the partition of the event in the same
+ * way, and the other ones from the next window on (so at the stop time
+ * too if the delay is at least Lookahead). Stop () stops the partition
+ * that calls it at once and the other ones at the end of the window.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * Assign a context to a partition, before the first Run.
+   *
+   * \param [in] context The context (usually a node id).
+   * \param [in] partition The partition, from 0.
+   */
+  void SetPartition (uint32_t context, uint32_t partition);
+  /**
+   * \param [in] context The context.
+   * \returns The partition of the context.
+   */
+  uint32_t GetPartition (uint32_t context) const;
+  /** \returns The number of partitions. */
+  uint32_t GetNPartitions (void) const;
+
+  /** \returns A new counter for GetNextNumber. */
+  static uint32_t AllocateCounter (void);
+  /**
+   * Take the next number of a counter of the partition run by the
+   * calling thread. The numbers of a partition do not depend on the
+   * other partitions, so the models that number their objects with
+   * them get the same numbers with any number of threads.
+   *
+   * \param [in] counter The counter, from AllocateCounter.
+   * \param [out] partition The partition run by the calling thread.
+   * \param [out] number The next number of the counter in this
+   *              partition, from 0.
+   * \returns \c false if the calling thread does not run a partition
+   *          of a MultithreadedSimulatorImpl.
+   */
+  static bool GetNextNumber (uint32_t counter, uint32_t &partition, uint64_t &number);
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event sent to another partition, inserted at the next barrier. */
+  struct Message
+  {
+    uint64_t ts;        /**< The event time step. */
+    uint32_t context;   /**< The event context. */
+    uint32_t source;    /**< The sending partition. */
+    uint64_t seq;       /**< The message number in the sending partition. */
+    EventImpl *event;   /**< The event implementation. */
+  };
+  /**
+   * Order of insertion of the messages.
+   *
+   * \param [in] a The first message.
+   * \param [in] b The second message.
+   * \returns \c true if \c a is inserted before \c b.
+   */
+  static bool MessageLess (const Message &a, const Message &b);
+
+  /** A partition: an event queue and its clock. */
+  struct Partition
+  {
+    uint32_t id;                  /**< The partition index. */
+    Ptr<Scheduler> events;        /**< The event queue. */
+    uint64_t currentTs;           /**< Time step of the current event. */
+    uint32_t currentUid;          /**< Uid of the current event. */
+    uint32_t currentContext;      /**< Context of the current event. */
+    uint32_t uid;                 /**< The next event uid. */
+    int unscheduledEvents;        /**< Events in the queue. */
+    uint64_t sent;                /**< Messages sent to other partitions. */
+    bool stopped;                 /**< Stop was called by an event of the partition. */
+    uint64_t stopTs;              /**< The earliest stop time set by an event of the partition. */
+    std::vector<uint64_t> numbers; /**< The counters of GetNextNumber. */
+    std::vector<Message> inbox;   /**< Messages from other partitions. */
+    SystemMutex inboxMutex;       /**< Protects the inbox. */
+  };
+
+  /**
+   * \returns The partition run by the calling thread, or 0 outside Run.
+   */
+  Partition * GetCurrentPartition (void) const;
+  /**
+   * \param [in] context A context.
+   * \returns The partition an event of the context goes to now.
+   */
+  Partition * Route (uint32_t context) const;
+  /**
+   * Insert an event in a partition.
+   *
+   * \param [in] partition The partition.
+   * \param [in] ts The event time step.
+   * \param [in] context The event context.
+   * \param [in] event The event implementation.
+   * \returns The event uid.
+   */
+  uint32_t Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event);
+  /**
+   * Run the next event of a partition.
+   *
+   * \param [in] partition The partition.
+   */
+  void ProcessOneEvent (Partition *partition);
+  /**
+   * Insert the messages received by a partition.
+   *
+   * \param [in] partition The partition.
+   */
+  void Deliver (Partition *partition);
+  /** Move the events scheduled before the first Run to their partitions. */
+  void Distribute (void);
+  /**
+   * Run the partitions of a thread until the simulation ends.
+   *
+   * \param [in] thread The thread index.
+   */
+  void Worker (uint32_t thread);
+  /**
+   * Entry point of the worker threads.
+   *
+   * \param [in] worker The simulator and the thread index.
+   */
+  static void WorkerThread (std::pair<MultithreadedSimulatorImpl *, uint32_t> worker);
+  /** Wait until all the threads reach the barrier. */
+  void Barrier (void);
+
+  /** Container type for the destroy events. */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Protects the destroy events. */
+  SystemMutex m_destroyEventsMutex;
+
+  /** The partitions. */
+  std::vector<Partition *> m_partitions;
+  /** The partition of each context (indexed by context). */
+  std::vector<uint32_t> m_contextPartition;
+  /** The events have been moved to their partitions. */
+  bool m_distributed;
+  /** The scheduler of the partitions. */
+  ObjectFactory m_schedulerFactory;
+
+  /** The minimum delay of an event sent to another partition. */
+  Time m_lookahead;
+  /** The maximum number of worker threads (0: one per partition). */
+  uint32_t m_maxThreads;
+  /** The number of worker threads of the current run. */
+  uint32_t m_nThreads;
+  /** The next event time step of the partitions of each thread. */
+  std::vector<uint64_t> m_nextTs;
+
+  /** Stop at the end of the window. */
+  std::atomic<bool> m_stop;
+  /**
+   * Do not run events from this time step on. Only set outside Run:
+   * the events set the stopTs of their partition.
+   */
+  uint64_t m_stopTs;
+  /** Time step seen by the main thread outside Run. */
+  uint64_t m_currentTs;
+  /** Main execution thread. */
+  SystemThread::ThreadId m_main;
+
+  /** Threads at the barrier. */
+  std::atomic<uint32_t> m_barrierCount;
+  /** Barrier generation, incremented when all the threads are there. */
+  std::atomic<uint32_t> m_barrierGeneration;
+
+  /** The partition run by the calling thread. */
+  static thread_local Partition *m_current;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/event-profiler.h"
+#include "ns3/make-event.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace ns3;
+
+namespace {
+
+class Handler
+{
+public:
+  void Tick (uint32_t n)
+  {
+    if (n > 0)
+      {
+        Simulator::Schedule (MicroSeconds (1), &Handler::Tick, this, n - 1);
+      }
+  }
+};
+
+void
+Tock (int n)
+{
+  if (n > 0)
+    {
+      Simulator::Schedule (MicroSeconds (1), &Tock, n - 1);
+    }
+}
+
+} // unnamed namespace
+
+/**
+ * Check the names of the events made by MakeEvent.
+ */
+class EventProfilerNameTestCase : public TestCase
+{
+public:
+  EventProfilerNameTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the name of an event and release it.
+   *
+   * \param event The event.
+   * \param module The expected module.
+   * \param name The expected name.
+   */
+  void Check (EventImpl *event, std::string module, std::string name);
+};
+
+EventProfilerNameTestCase::EventProfilerNameTestCase ()
+  : TestCase ("Check the events are named after their handler")
+{
+}
+
+void
+EventProfilerNameTestCase::Check (EventImpl *event, std::string module, std::string name)
+{
+  std::string m;
+  std::string n;
+  EventProfiler::GetEventName (typeid (*event), m, n);
+  event->Unref ();
+  NS_TEST_EXPECT_MSG_EQ (m, module, "wrong module");
+  NS_TEST_EXPECT_MSG_EQ (n, name, "wrong event name");
+}
+
+void
+EventProfilerNameTestCase::DoRun (void)
+{
+  Handler handler;
+  Check (MakeEvent (&Handler::Tick, &handler, 1),
+         "(anonymous namespace)::Handler", "void ((anonymous namespace)::Handler::*)(unsigned int)");
+  Check (MakeEvent (&Tock, 1), "function", "void (*)(int)");
+  Check (MakeEvent (&Simulator::Stop), "function", "void (*)()");
+}
+
+/**
+ * Run a simulation with the profile file and check every handler is
+ * in it.
+ */
+class EventProfilerFileTestCase : public TestCase
+{
+public:
+  EventProfilerFileTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+EventProfilerFileTestCase::EventProfilerFileTestCase ()
+  : TestCase ("Check the folded profile of a simulation")
+{
+}
+
+void
+EventProfilerFileTestCase::DoTeardown (void)
+{
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFile", StringValue (""));
+}
+
+void
+EventProfilerFileTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("event-profile.folded");
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFile", StringValue (filename));
+  Handler handler;
+  Simulator::Schedule (MicroSeconds (1), &Handler::Tick, &handler, 100);
+  Simulator::Schedule (MicroSeconds (1), &Tock, 10);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::ifstream is (filename.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (is.is_open (), true, "no profile file");
+  std::map<std::string, uint64_t> lines;
+  std::string line;
+  while (std::getline (is, line))
+    {
+      std::string::size_type space = line.rfind (' ');
+      NS_TEST_ASSERT_MSG_NE (space, std::string::npos, "bad line " << line);
+      std::istringstream value (line.substr (space + 1));
+      uint64_t ns = 0;
+      value >> ns;
+      NS_TEST_EXPECT_MSG_EQ (value.fail (), false, "bad time in " << line);
+      lines[line.substr (0, space)] = ns;
+    }
+  NS_TEST_EXPECT_MSG_EQ (lines.size (), 3, "wrong number of lines");
+  NS_TEST_EXPECT_MSG_EQ (lines.count ("(anonymous namespace)::Handler;void ((anonymous namespace)::Handler::*)(unsigned int)"),
+                         1, "no line for the method");
+  NS_TEST_EXPECT_MSG_EQ (lines.count ("function;void (*)(int)"), 1, "no line for the function");
+  NS_TEST_EXPECT_MSG_EQ (lines.count ("(simulator)"), 1, "no line for the simulator");
+}
+
+class EventProfilerTestSuite : public TestSuite
+{
+public:
+  EventProfilerTestSuite ()
+    : TestSuite ("event-profiler")
+  {
+    AddTestCase (new EventProfilerNameTestCase (), TestCase::QUICK);
+    AddTestCase (new EventProfilerFileTestCase (), TestCase::QUICK);
+  }
+} g_eventProfilerTestSuite;
@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+
+#include <vector>
+
+using namespace ns3;
+
+#define CONTEXTS 8
+#define PARTITIONS 4
+
+/**
+ * Chains of events in 8 contexts spread over 4 partitions, with
+ * events sent from every context to the next one (in another
+ * partition) one lookahead ahead, numbered by the receiving partition.
+ * An event stops the simulation less than a lookahead ahead.
+ */
+class MultithreadedSimulatorTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorTestCase (uint32_t threads, uint64_t *digest);
+  void Tick (uint32_t context, uint32_t n, uint64_t ts);
+  void Ping (uint32_t source, uint64_t ts);
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  uint32_t m_threads;
+  uint64_t *m_digest;
+  uint32_t m_counter;
+  uint64_t m_stopTs;
+  // every entry is only written by the partition of its context
+  std::vector<uint64_t> m_ticks[CONTEXTS];
+  std::vector<uint64_t> m_pings[CONTEXTS];
+  uint32_t m_errors[CONTEXTS];
+};
+
+MultithreadedSimulatorTestCase::MultithreadedSimulatorTestCase (uint32_t threads, uint64_t *digest)
+  : TestCase ("Check the partitions run in windows of lookahead on " +
+              std::string (threads == 0 ? "one thread per partition" : threads == 1 ? "1 thread" : "2 threads")),
+    m_threads (threads),
+    m_digest (digest),
+    m_counter (MultithreadedSimulatorImpl::AllocateCounter ()),
+    m_stopTs (0)
+{
+}
+
+void
+MultithreadedSimulatorTestCase::Tick (uint32_t context, uint32_t n, uint64_t ts)
+{
+  if (Simulator::GetContext () != context || (uint64_t)Simulator::Now ().GetNanoSeconds () != ts)
+    {
+      m_errors[context]++;
+    }
+  m_ticks[context].push_back (ts);
+  if (context == 3 && n == 7000)
+    {
+      m_stopTs = ts + 5000;
+      Simulator::Stop (MicroSeconds (5));
+    }
+  if (n == 0)
+    {
+      return;
+    }
+  uint64_t delay = 100 + context * 7;
+  Simulator::ScheduleWithContext (context, NanoSeconds (delay),
+                                  &MultithreadedSimulatorTestCase::Tick, this, context, n - 1, ts + delay);
+  if (n % 10 == 0)
+    {
+      Simulator::ScheduleWithContext ((context + 1) % CONTEXTS, MicroSeconds (10),
+                                      &MultithreadedSimulatorTestCase::Ping, this, context, ts);
+    }
+}
+
+void
+MultithreadedSimulatorTestCase::Ping (uint32_t source, uint64_t ts)
+{
+  uint32_t context = Simulator::GetContext ();
+  if (context != (source + 1) % CONTEXTS || (uint64_t)Simulator::Now ().GetNanoSeconds () != ts + 10000)
+    {
+      m_errors[context]++;
+    }
+  uint32_t partition;
+  uint64_t number;
+  if (!MultithreadedSimulatorImpl::GetNextNumber (m_counter, partition, number)
+      || partition != context % PARTITIONS)
+    {
+      m_errors[context]++;
+    }
+  m_pings[context].push_back ((ts * CONTEXTS + source) * 31 + number);
+}
+
+void
+MultithreadedSimulatorTestCase::DoSetup (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue (m_threads));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::Lookahead", TimeValue (MicroSeconds (10)));
+}
+
+void
+MultithreadedSimulatorTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+void
+MultithreadedSimulatorTestCase::DoRun (void)
+{
+  for (uint32_t c = 0; c < CONTEXTS; c++)
+    {
+      m_ticks[c].clear ();
+      m_pings[c].clear ();
+      m_errors[c] = 0;
+      // scheduled before the partitions are set
+      Simulator::ScheduleWithContext (c, NanoSeconds (c),
+                                      &MultithreadedSimulatorTestCase::Tick, this, c, 10000, c);
+    }
+  Ptr<MultithreadedSimulatorImpl> impl = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_NE (impl, 0, "wrong simulator implementation");
+  for (uint32_t c = 0; c < CONTEXTS; c++)
+    {
+      impl->SetPartition (c, c % PARTITIONS);
+    }
+  NS_TEST_ASSERT_MSG_EQ (impl->GetNPartitions (), PARTITIONS, "wrong number of partitions");
+
+  Simulator::Stop (MicroSeconds (500));
+  Simulator::Run ();
+  Time end = Simulator::Now ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_GT (m_stopTs, 0, "the stop event did not run");
+  NS_TEST_EXPECT_MSG_LT (m_ticks[3].back (), m_stopTs, "events run after the stop time in the stopping partition");
+  NS_TEST_EXPECT_MSG_LT (end.GetNanoSeconds (), int64_t (m_stopTs + 10000), "events run a window after the stop time");
+  uint64_t digest = 0;
+  for (uint32_t c = 0; c < CONTEXTS; c++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_errors[c], 0, "events run at the wrong time or context");
+      NS_TEST_EXPECT_MSG_GT (m_ticks[c].size (), 0, "context " << c << " did not run");
+      NS_TEST_EXPECT_MSG_GT (m_pings[c].size (), 0, "context " << c << " received nothing");
+      for (uint32_t i = 1; i < m_ticks[c].size (); i++)
+        {
+          NS_TEST_EXPECT_MSG_GT (m_ticks[c][i], m_ticks[c][i - 1], "events out of order");
+        }
+      for (uint32_t i = 0; i < m_pings[c].size (); i++)
+        {
+          digest = digest * 31 + m_pings[c][i];
+        }
+      digest = digest * 31 + m_ticks[c].size ();
+    }
+  // the first case sets the reference: the results do not depend on the threads
+  if (*m_digest == 0)
+    {
+      *m_digest = digest;
+    }
+  NS_TEST_EXPECT_MSG_EQ (digest, *m_digest, "the results depend on the threads");
+}
+
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ()
+    : TestSuite ("multithreaded-simulator"),
+      m_digest (0)
+  {
+    AddTestCase (new MultithreadedSimulatorTestCase (1, &m_digest), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorTestCase (2, &m_digest), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorTestCase (0, &m_digest), TestCase::QUICK);
+  }
+private:
+  uint64_t m_digest;
+} g_multithreadedSimulatorTestSuite;
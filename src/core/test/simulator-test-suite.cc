@@ -19,10 +19,15 @@
  */
 #include "ns3/test.h"
 #include "ns3/simulator.h"
+#include "ns3/event-impl.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/make-event.h"
+#include "ns3/system-thread.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -459,6 +464,197 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class LadderSchedulerTestCase : public TestCase
+{
+public:
+  LadderSchedulerTestCase ();
+  virtual void DoRun (void);
+};
+
+LadderSchedulerTestCase::LadderSchedulerTestCase ()
+  : TestCase ("Check that the ladder queue keeps the event order across its rungs")
+{
+}
+void
+LadderSchedulerTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = CreateObject<LadderScheduler> ();
+  std::vector<Scheduler::Event> removable;
+  uint32_t uid = 0;
+  uint32_t inserted = 0;
+  uint32_t removed = 0;
+  uint64_t seed = 1;
+  uint64_t now = 0;
+
+  // bursts of clustered events (to grow child rungs), spread ones (to fill
+  // Top), ties and cancellations, interleaved with dequeuing
+  for (uint32_t round = 0; round < 20; round++)
+    {
+      for (uint32_t i = 0; i < 2000; i++)
+        {
+          seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+          uint64_t r = seed >> 33;
+          Scheduler::Event ev;
+          ev.impl = 0;
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          switch (r % 4)
+            {
+            case 0:
+              ev.key.m_ts = now + r % 1000000000;
+              break;
+            case 1:
+              ev.key.m_ts = now + 5000 + r % 64;
+              break;
+            case 2:
+              ev.key.m_ts = now + 1000;
+              break;
+            default:
+              ev.key.m_ts = now + r % 100000;
+              break;
+            }
+          scheduler->Insert (ev);
+          inserted++;
+          if (r % 7 == 0)
+            {
+              removable.push_back (ev);
+            }
+        }
+      for (uint32_t i = 0; i < removable.size (); i++)
+        {
+          scheduler->Remove (removable[i]);
+          removed++;
+        }
+      removable.clear ();
+
+      Scheduler::EventKey last = scheduler->PeekNext ().key;
+      for (uint32_t i = 0; i < 1500 && !scheduler->IsEmpty (); i++)
+        {
+          Scheduler::EventKey next = scheduler->PeekNext ().key;
+          Scheduler::Event ev = scheduler->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, next.m_uid, "PeekNext and RemoveNext disagree");
+          NS_TEST_ASSERT_MSG_EQ ((i == 0 || last < ev.key), true, "events out of order");
+          last = ev.key;
+          removed++;
+        }
+      now = last.m_ts;
+    }
+
+  Scheduler::EventKey last = scheduler->PeekNext ().key;
+  while (!scheduler->IsEmpty ())
+    {
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ ((ev.key.m_uid == last.m_uid || last < ev.key), true, "events out of order");
+      last = ev.key;
+      removed++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (removed, inserted, "events lost");
+}
+
+class EventPoolTestCase : public TestCase
+{
+public:
+  EventPoolTestCase ();
+  virtual void DoRun (void);
+  void Event (uint32_t n, Ptr<Object> object);
+  uint32_t m_count;
+};
+
+EventPoolTestCase::EventPoolTestCase ()
+  : TestCase ("Check that events are recycled by the event allocator")
+{
+}
+void
+EventPoolTestCase::Event (uint32_t n, Ptr<Object> object)
+{
+  m_count++;
+  if (n > 0)
+    {
+      Simulator::Schedule (MicroSeconds (1), &EventPoolTestCase::Event, this, n - 1, object);
+    }
+}
+void
+EventPoolTestCase::DoRun (void)
+{
+  m_count = 0;
+  EventImpl::PoolStats before = EventImpl::GetPoolStats ();
+  Ptr<Object> object = CreateObject<Object> ();
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Simulator::Schedule (MicroSeconds (i), &EventPoolTestCase::Event, this, 100, object);
+    }
+  EventId cancelled = Simulator::Schedule (Seconds (1), &EventPoolTestCase::Event, this, 0, object);
+  Simulator::Cancel (cancelled);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  // the EventId holds the last reference to its event
+  cancelled = EventId ();
+  EventImpl::PoolStats after = EventImpl::GetPoolStats ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_count, 100 * 101, "events lost");
+  NS_TEST_ASSERT_MSG_EQ (object->GetReferenceCount (), 1, "events not released");
+  uint64_t allocations = after.allocations - before.allocations;
+  uint64_t releases = after.releases - before.releases;
+  NS_TEST_ASSERT_MSG_EQ ((allocations >= 100 * 101 + 1), true, "events not counted");
+  NS_TEST_ASSERT_MSG_EQ (releases, allocations, "events leaked");
+  // at most 101 events live at once: all others come from the free lists
+  NS_TEST_ASSERT_MSG_EQ ((after.reused - before.reused >= allocations - 128), true, "events not recycled");
+  NS_TEST_ASSERT_MSG_EQ ((after.free >= before.free), true, "blocks lost");
+}
+
+class EventPoolThreadTestCase : public TestCase
+{
+public:
+  EventPoolThreadTestCase ();
+  virtual void DoRun (void);
+  void Produce (void);
+  static void Nothing (void);
+  std::vector<EventImpl *> m_events;
+  EventImpl::PoolStats m_before;
+  EventImpl::PoolStats m_after;
+};
+
+EventPoolThreadTestCase::EventPoolThreadTestCase ()
+  : TestCase ("Check that events released by another thread go back to their allocator")
+{
+}
+void
+EventPoolThreadTestCase::Nothing (void)
+{
+}
+void
+EventPoolThreadTestCase::Produce (void)
+{
+  m_before = EventImpl::GetPoolStats ();
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      m_events.push_back (MakeEvent (&EventPoolThreadTestCase::Nothing));
+    }
+  m_after = EventImpl::GetPoolStats ();
+}
+void
+EventPoolThreadTestCase::DoRun (void)
+{
+  for (uint32_t round = 0; round < 10; round++)
+    {
+      // every round runs a new thread, which takes the free lists of the last one
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&EventPoolThreadTestCase::Produce, this));
+      thread->Start ();
+      thread->Join ();
+      for (std::vector<EventImpl *>::iterator i = m_events.begin (); i != m_events.end (); i++)
+        {
+          (*i)->Unref ();
+        }
+      m_events.clear ();
+      NS_TEST_ASSERT_MSG_EQ (m_after.allocations - m_before.allocations, 1000, "events not counted");
+      if (round > 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_after.chunks, m_before.chunks, "the released events did not go back to their allocator");
+          NS_TEST_ASSERT_MSG_EQ (m_after.reused - m_before.reused, 1000, "events not recycled");
+        }
+    }
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +671,10 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new LadderSchedulerTestCase (), TestCase::QUICK);
+    AddTestCase (new EventPoolTestCase (), TestCase::QUICK);
+    AddTestCase (new EventPoolThreadTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
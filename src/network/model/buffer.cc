@@ -68,6 +68,10 @@ uint32_t Buffer::g_recommendedStart = 0;
  * which the compiler assigns to zero-memory which is initialized to _zero_
  * before the constructors run so this ensures perfect handling of crazy 
  * constructor orderings.
+ * The free list and its destructor are per thread, so that the partitions
+ * of a multithreaded simulation do not share it. A buffer released by
+ * another thread than the one which created it goes to the free list of
+ * the releasing thread.
  */
 #define MAGIC_DESTROYED (~(long) 0)
 #define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
@@ -75,9 +79,9 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
 #define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
 #define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+thread_local uint32_t Buffer::g_maxSize = 0;
+thread_local Buffer::FreeList *Buffer::g_freeList = 0;
+thread_local struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
 {
@@ -94,12 +98,25 @@ Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
     }
 }
 
+void
+Buffer::CreateFreeList (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_freeList = new Buffer::FreeList ();
+  // the destructor of a thread_local is only registered once it is used
+  (void) &g_localStaticDestructor;
+}
+
 void
 Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
+  if (IS_UNINITIALIZED (g_freeList))
+    {
+      // the buffer was created by another thread
+      CreateFreeList ();
+    }
   g_maxSize = std::max (g_maxSize, data->m_size);
   /* feed into free list */
   if (data->m_size < g_maxSize ||
@@ -122,7 +139,7 @@ Buffer::Create (uint32_t dataSize)
   /* try to find a buffer correctly sized. */
   if (IS_UNINITIALIZED (g_freeList))
     {
-      g_freeList = new Buffer::FreeList ();
+      CreateFreeList ();
     }
   else if (IS_INITIALIZED (g_freeList))
     {
@@ -426,6 +443,23 @@ Buffer::AddAtEnd (const Buffer &o)
       return;
     }
 
+  if (m_data != o.m_data)
+    {
+      /**
+       * Append the bytes of o in place: AddAtEnd only reallocates
+       * the data if it has no room left or if its end is used by
+       * another buffer, and our zero area stays virtual. Appending
+       * thus copies the bytes of o once, not the bytes of both.
+       */
+      uint32_t size = o.GetSize ();
+      AddAtEnd (size);
+      Buffer::Iterator dst = End ();
+      dst.Prev (size);
+      dst.Write (o.Begin (), o.End ());
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+
   Buffer dst = CreateFullCopy ();
   Buffer src = o.CreateFullCopy ();
 
@@ -843,27 +877,36 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  // the written bytes are all before or all after our zero area
+  uint8_t *to;
+  if (m_current <= m_zeroStart)
+    {
+      to = &m_data[m_current];
+    }
+  else
+    {
+      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
+  m_current += size;
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (to, 0, toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
   memcpy (to, from, toCopy);
-  m_current += toCopy;
 }
 
 void 
@@ -794,9 +794,13 @@ private:
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  /**
+   * \brief Create the free list of the calling thread
+   */
+  static void CreateFreeList (void);
+  static thread_local uint32_t g_maxSize; //!< Max observed data size (per thread)
+  static thread_local FreeList *g_freeList; //!< Buffer data container (per thread)
+  static thread_local struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor (per thread)
 #endif
 };
 
@@ -655,8 +655,18 @@ public:
    * \param data the buffer data storage
    */
   static void Deallocate (struct PacketMetadata::Data *data);
+  /**
+   * \brief Allocate the uid of a new header or trailer
+   *
+   * The partitions of a MultithreadedSimulatorImpl each have their
+   * own counter, m_chunkUid is used outside them.
+   *
+   * \returns the new chunk uid
+   */
+  static uint16_t AllocateChunkUid (void);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
+  static thread_local DataFreeList m_freeList; //!< the metadata data storage (per thread)
+  static thread_local bool m_freeListDestroyed; //!< the thread has destroyed its free list
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
@@ -667,8 +677,8 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  static thread_local uint32_t m_maxSize; //!< maximum metadata size (per thread)
+  static uint16_t m_chunkUid; //!< Chunk Uid, outside the partitions of a MultithreadedSimulatorImpl
 
   struct Data *m_data; //!< Metadata storage
   /*
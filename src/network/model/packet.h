@@ -21,6 +21,7 @@
 #define PACKET_H
 
 #include <stdint.h>
+#include <atomic>
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -713,6 +714,20 @@ private:
 
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /**
+   * \brief Allocate the uid of a new packet
+   *
+   * The upper 32 bits are the system id (zero for non-distributed
+   * simulations) and the lower 32 bits are taken from the global
+   * counter. A packet created by a partition of a
+   * MultithreadedSimulatorImpl takes them from a counter of the
+   * partition instead, and the partition index + 1 goes to the
+   * upper 16 bits, so the uids do not depend on the threads.
+   *
+   * \returns the new uid
+   */
+  static uint64_t AllocateUid (void);
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
@@ -721,7 +736,7 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  static std::atomic<uint32_t> m_globalUid; //!< Global counter of packets Uid
 };
 
 /**
@@ -304,6 +304,28 @@ BufferTest::DoRun (void)
   ENSURE_WRITTEN_BYTES (buffer, 7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x66);
   ENSURE_WRITTEN_BYTES (frag0, 7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x66);
 
+  // appending in place must not change the buffers sharing the data
+  buffer = Buffer (2);
+  buffer.AddAtEnd (1);
+  i = buffer.End ();
+  i.Prev (1);
+  i.WriteU8 (0x11);
+  Buffer shared = buffer;
+  Buffer tail;
+  tail.AddAtStart (2);
+  i = tail.Begin ();
+  i.WriteU8 (0x22);
+  i.WriteU8 (0x33);
+  buffer.AddAtEnd (tail);
+  ENSURE_WRITTEN_BYTES (buffer, 5, 0x00, 0x00, 0x11, 0x22, 0x33);
+  ENSURE_WRITTEN_BYTES (shared, 3, 0x00, 0x00, 0x11);
+  shared.AddAtEnd (tail);
+  i = shared.End ();
+  i.Prev (1);
+  i.WriteU8 (0x44);
+  ENSURE_WRITTEN_BYTES (shared, 5, 0x00, 0x00, 0x11, 0x22, 0x44);
+  ENSURE_WRITTEN_BYTES (buffer, 5, 0x00, 0x00, 0x11, 0x22, 0x33);
+
   buffer = Buffer (5);
   buffer.AddAtStart (2);
   i = buffer.Begin ();
@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "s1g-association-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/ap-wifi-mac.h"
+#include "ns3/sta-wifi-mac.h"
+#include "ns3/aid-bitmap.h"
+#include "ns3/mgt-headers.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include <fstream>
+#include <map>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("S1gAssociationHelper");
+
+static const char *SNAPSHOT_MAGIC = "s1g-association-snapshot";
+static const uint32_t SNAPSHOT_VERSION = 1;
+
+static Ptr<ApWifiMac>
+GetApMac (Ptr<NetDevice> device)
+{
+  Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice> (device);
+  Ptr<ApWifiMac> mac = wifi == 0 ? 0 : DynamicCast<ApWifiMac> (wifi->GetMac ());
+  NS_ABORT_MSG_IF (mac == 0, "the AP device has no ApWifiMac");
+  return mac;
+}
+
+static Ptr<StaWifiMac>
+GetStaMac (Ptr<NetDevice> device)
+{
+  Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice> (device);
+  return wifi == 0 ? 0 : DynamicCast<StaWifiMac> (wifi->GetMac ());
+}
+
+S1gAssociationHelper::S1gAssociationHelper ()
+  : m_snapshotTime (Seconds (0))
+{
+}
+
+bool
+S1gAssociationHelper::Associate (Ptr<ApWifiMac> ap, Ptr<StaWifiMac> sta)
+{
+  MgtAssocResponseHeader assocResp;
+  bool success = ap->Associate (sta->GetAddress (), sta->GetAssocRequest (), assocResp);
+  sta->Associate (ap->GetAddress (), assocResp);
+  return success;
+}
+
+uint32_t
+S1gAssociationHelper::PreAssociate (Ptr<NetDevice> ap, const NetDeviceContainer &stas) const
+{
+  Ptr<ApWifiMac> apMac = GetApMac (ap);
+  uint32_t n = 0;
+  for (NetDeviceContainer::Iterator i = stas.Begin (); i != stas.End (); i++)
+    {
+      Ptr<StaWifiMac> sta = GetStaMac (*i);
+      if (sta == 0)
+        {
+          continue;
+        }
+      //the AP derives the AID from the address
+      uint16_t aid = AidBitmap::GetAid (sta->GetAddress ());
+      NS_ABORT_MSG_IF (apMac->IsAssociated (aid) && apMac->GetAssociatedAddress (aid) != sta->GetAddress (),
+                       "AID " << aid << " of " << sta->GetAddress () << " is taken by " << apMac->GetAssociatedAddress (aid));
+      if (Associate (apMac, sta))
+        {
+          n++;
+        }
+    }
+  NS_LOG_INFO ("pre-associated " << n << " STAs");
+  return n;
+}
+
+uint32_t
+S1gAssociationHelper::Save (std::string filename, Ptr<NetDevice> ap, const NetDeviceContainer &stas) const
+{
+  Ptr<ApWifiMac> apMac = GetApMac (ap);
+  std::ofstream file (filename.c_str ());
+  NS_ABORT_MSG_IF (!file.is_open (), "cannot write the association snapshot " << filename);
+  file << SNAPSHOT_MAGIC << " " << SNAPSHOT_VERSION << "\n";
+  file << "time " << Simulator::Now ().GetSeconds () << "\n";
+  file << "rng " << RngSeedManager::GetSeed () << " " << RngSeedManager::GetRun () << "\n";
+  file << "ap " << apMac->GetAddress () << "\n";
+  uint32_t n = 0;
+  for (NetDeviceContainer::Iterator i = stas.Begin (); i != stas.End (); i++)
+    {
+      Ptr<StaWifiMac> sta = GetStaMac (*i);
+      if (sta == 0 || !sta->IsAssociated () || sta->GetBssid () != apMac->GetAddress ())
+        {
+          continue;
+        }
+      uint16_t aid = sta->GetAID ();
+      if (!apMac->IsAssociated (aid) || apMac->GetAssociatedAddress (aid) != sta->GetAddress ())
+        {
+          continue; //the AP has not seen the acknowledgement of the response yet
+        }
+      file << "sta " << sta->GetAddress () << " " << aid << "\n";
+      n++;
+    }
+  NS_LOG_INFO ("saved " << n << " associations to " << filename);
+  return n;
+}
+
+uint32_t
+S1gAssociationHelper::Load (std::string filename, Ptr<NetDevice> ap, const NetDeviceContainer &stas)
+{
+  Ptr<ApWifiMac> apMac = GetApMac (ap);
+  std::ifstream file (filename.c_str ());
+  NS_ABORT_MSG_IF (!file.is_open (), "cannot read the association snapshot " << filename);
+
+  std::string magic;
+  uint32_t version = 0;
+  file >> magic >> version;
+  NS_ABORT_MSG_IF (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION,
+                   filename << " is not an association snapshot (version " << SNAPSHOT_VERSION << ")");
+
+  std::map<Mac48Address, uint16_t> aids;
+  std::string key;
+  while (file >> key)
+    {
+      if (key == "time")
+        {
+          double seconds;
+          file >> seconds;
+          m_snapshotTime = Seconds (seconds);
+        }
+      else if (key == "rng")
+        {
+          uint32_t seed, run;
+          file >> seed >> run;
+        }
+      else if (key == "ap")
+        {
+          Mac48Address address;
+          file >> address;
+          NS_ABORT_MSG_IF (address != apMac->GetAddress (),
+                           "the snapshot AP " << address << " is not " << apMac->GetAddress ());
+        }
+      else if (key == "sta")
+        {
+          Mac48Address address;
+          uint16_t aid;
+          file >> address >> aid;
+          aids[address] = aid;
+        }
+      NS_ABORT_MSG_IF (file.fail (), "malformed association snapshot " << filename);
+    }
+
+  uint32_t n = 0;
+  for (NetDeviceContainer::Iterator i = stas.Begin (); i != stas.End (); i++)
+    {
+      Ptr<StaWifiMac> sta = GetStaMac (*i);
+      if (sta == 0)
+        {
+          continue;
+        }
+      std::map<Mac48Address, uint16_t>::const_iterator it = aids.find (sta->GetAddress ());
+      if (it == aids.end ())
+        {
+          continue;
+        }
+      NS_ABORT_MSG_IF (it->second != AidBitmap::GetAid (sta->GetAddress ()),
+                       "the snapshot AID of " << it->first << " does not match this topology");
+      if (Associate (apMac, sta))
+        {
+          n++;
+        }
+    }
+  NS_LOG_INFO ("restored " << n << " of " << aids.size () << " associations from " << filename);
+  return n;
+}
+
+Time
+S1gAssociationHelper::GetSnapshotTime (void) const
+{
+  return m_snapshotTime;
+}
+
+} //namespace ns3
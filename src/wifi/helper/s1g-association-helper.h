@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef S1G_ASSOCIATION_HELPER_H
+#define S1G_ASSOCIATION_HELPER_H
+
+#include <string>
+#include "ns3/net-device-container.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+class ApWifiMac;
+class StaWifiMac;
+
+/**
+ * \brief associate the STAs of a BSS without the over-the-air handshake
+ *
+ * PreAssociate installs the association of every STA with the AP at time
+ * zero, for studies that do not measure association.
+ *
+ * The association phase of a static topology is the same in every run, so
+ * it can be simulated once and saved as a snapshot (the AP, and the address
+ * and AID of every associated STA). A later run restores the snapshot
+ * before Simulator::Run: every STA of the snapshot is associated without
+ * over-the-air frames, through the same request and response processing as
+ * the handshake, so the station managers, the AID tables of the AP and the
+ * StaWifiMac Assoc trace end up as after the warm-up.
+ *
+ * The snapshot is a text file:
+ * \verbatim
+   s1g-association-snapshot 1
+   time <warm-up end in seconds>
+   rng <seed> <run>
+   ap <address>
+   sta <address> <aid>
+   ...
+   \endverbatim
+ */
+class S1gAssociationHelper
+{
+public:
+  S1gAssociationHelper ();
+
+  /**
+   * Associate every STA of \p stas with \p ap, as if the handshake had
+   * completed: AIDs, supported rates and capabilities are installed on
+   * both sides and the StaWifiMac Assoc trace fires. Call it before
+   * Simulator::Run, once the traces are connected.
+   *
+   * \param ap the AP device
+   * \param stas the STA devices
+   * \return the number of STAs associated
+   */
+  uint32_t PreAssociate (Ptr<NetDevice> ap, const NetDeviceContainer &stas) const;
+  /**
+   * Save the associations of \p stas with \p ap.
+   *
+   * \param filename the snapshot file
+   * \param ap the AP device
+   * \param stas the STA devices
+   * \return the number of associated STAs written
+   */
+  uint32_t Save (std::string filename, Ptr<NetDevice> ap, const NetDeviceContainer &stas) const;
+  /**
+   * Restore the associations of a snapshot. The AP must have the address
+   * recorded in the snapshot; STAs of \p stas missing from the snapshot are
+   * left unassociated.
+   *
+   * \param filename the snapshot file
+   * \param ap the AP device
+   * \param stas the STA devices
+   * \return the number of STAs associated
+   */
+  uint32_t Load (std::string filename, Ptr<NetDevice> ap, const NetDeviceContainer &stas);
+  /**
+   * \return the simulation time at which the loaded snapshot was saved
+   */
+  Time GetSnapshotTime (void) const;
+
+  /**
+   * Associate a STA with an AP without over-the-air frames.
+   *
+   * \param ap the AP
+   * \param sta the STA
+   * \return true if the AP accepted the STA
+   */
+  static bool Associate (Ptr<ApWifiMac> ap, Ptr<StaWifiMac> sta);
+
+private:
+  Time m_snapshotTime; //!< the warm-up end of the loaded snapshot
+};
+
+} //namespace ns3
+
+#endif /* S1G_ASSOCIATION_HELPER_H */
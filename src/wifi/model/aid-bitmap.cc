@@ -0,0 +1,94 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "aid-bitmap.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+AidBitmap::AidBitmap ()
+  : m_words (MAX_AID / 64, 0)
+{
+}
+
+void
+AidBitmap::Set (uint16_t aid)
+{
+  NS_ASSERT (aid < MAX_AID);
+  m_words[aid >> 6] |= ((uint64_t)1 << (aid & 0x3f));
+}
+
+void
+AidBitmap::Clear (uint16_t aid)
+{
+  NS_ASSERT (aid < MAX_AID);
+  m_words[aid >> 6] &= ~((uint64_t)1 << (aid & 0x3f));
+}
+
+void
+AidBitmap::Reset (void)
+{
+  for (std::vector<uint64_t>::iterator it = m_words.begin (); it != m_words.end (); it++)
+    {
+      *it = 0;
+    }
+}
+
+bool
+AidBitmap::Test (uint16_t aid) const
+{
+  if (aid >= MAX_AID)
+    {
+      return false;
+    }
+  return (m_words[aid >> 6] >> (aid & 0x3f)) & 1;
+}
+
+bool
+AidBitmap::IsEmpty (void) const
+{
+  for (std::vector<uint64_t>::const_iterator it = m_words.begin (); it != m_words.end (); it++)
+    {
+      if (*it != 0)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+uint32_t
+AidBitmap::GetCount (void) const
+{
+  uint32_t count = 0;
+  for (std::vector<uint64_t>::const_iterator it = m_words.begin (); it != m_words.end (); it++)
+    {
+      count += __builtin_popcountll (*it);
+    }
+  return count;
+}
+
+uint16_t
+AidBitmap::GetAid (Mac48Address address)
+{
+  uint8_t mac[6];
+  address.CopyTo (mac);
+  uint8_t aid_l = mac[5];
+  uint8_t aid_h = mac[4] & 0x1f;
+  return (aid_h << 8) | (aid_l << 0);
+}
+
+} //namespace ns3
@@ -0,0 +1,83 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AID_BITMAP_H
+#define AID_BITMAP_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "ns3/mac48-address.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * A set of S1G association identifiers (AIDs) stored as a bitmap, one bit
+ * per AID. It is shared (by reference) between the AP and its EdcaTxopN
+ * instances to express per-RAW-slot access and per-beacon sleep state.
+ */
+class AidBitmap : public SimpleRefCount<AidBitmap>
+{
+public:
+  /// AIDs are 13 bits
+  static const uint32_t MAX_AID = 8192;
+
+  AidBitmap ();
+
+  /**
+   * \param aid the AID to add
+   */
+  void Set (uint16_t aid);
+  /**
+   * \param aid the AID to remove
+   */
+  void Clear (uint16_t aid);
+  /**
+   * Remove all AIDs.
+   */
+  void Reset (void);
+  /**
+   * \param aid the AID to test
+   * \return true if the AID is in the set
+   */
+  bool Test (uint16_t aid) const;
+  /**
+   * \return true if no AID is in the set
+   */
+  bool IsEmpty (void) const;
+  /**
+   * \return the number of AIDs in the set
+   */
+  uint32_t GetCount (void) const;
+
+  /**
+   * The AID of a station, as assigned by ApWifiMac from the last two bytes
+   * of its MAC address.
+   *
+   * \param address the MAC address of the station
+   * \return the AID
+   */
+  static uint16_t GetAid (Mac48Address address);
+
+private:
+  std::vector<uint64_t> m_words; //!< bit (aid % 64) of word (aid / 64)
+};
+
+} //namespace ns3
+
+#endif /* AID_BITMAP_H */
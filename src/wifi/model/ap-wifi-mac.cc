@@ -40,6 +40,7 @@
 #include "ns3/uinteger.h"
 #include "wifi-mac-queue.h"
 #include <map>
+#include <algorithm>
 
 // debug headers
 #ifdef __SDN_LAB_DEBUG
@@ -68,12 +69,22 @@ using namespace SdnLab;
       string path = set.PathProjectDebug() + set.TRACK_FILE_AP_WIFI_MAC_STALIST + to_string(time.GetSeconds()) + set.TRACK_FILE_FORM_SUFFIX; \
       stalist->Summary2File(path); \
     }
-  // debug print - station list cropped & transferred to NN
-  #define __SDN_LAB_AP_WIFI_MAC_PRINT_DATA_TO_STATIONLIST(stalist, set) \
+  // debug print - station list cropped & transferred to NN (appended to a single binary file per run)
+  #ifdef __SDN_LAB_DEBUG_NN_COMPACT
+    #define __SDN_LAB_AP_WIFI_MAC_NN_DATA_COMPACT true
+  #else
+    #define __SDN_LAB_AP_WIFI_MAC_NN_DATA_COMPACT false
+  #endif
+  #define __SDN_LAB_AP_WIFI_MAC_OPEN_NN_DATA_EXPORTER(set, exporter) \
+    { \
+      string path = set.PathProjectDebug() + set.TRACK_FILE_AP_WIFI_MAC_NN_DATA; \
+      if(!exporter.Open(path, __SDN_LAB_AP_WIFI_MAC_NN_DATA_COMPACT)){ \
+        NS_FATAL_ERROR ("Cannot open the NN data file " << path); \
+      } \
+    }
+  #define __SDN_LAB_AP_WIFI_MAC_PRINT_DATA_TO_STATIONLIST(stalist, set, exporter) \
     if(stalist){ \
-      Time time = Simulator::Now(); \
-      string path = set.PathProjectDebug() + set.TRACK_FILE_AP_WIFI_MAC_NN_INPUT + to_string(time.GetSeconds()) + set.TRACK_FILE_FORM_SUFFIX; \
-      stalist->Summary2File(path, __SDN_LAB_NNDATA_LEN); \
+      stalist->Export2File(exporter, Simulator::Now().GetSeconds()); \
     }
   // debug print - data back from NN
   #define __SDN_LAB_AP_WIFI_MAC_PRINT_DATA_FROM_STATIONLIST(stalist, set) \
@@ -85,7 +96,8 @@ using namespace SdnLab;
 #else
   #define __SDN_LAB_AP_WIFI_MAC_REPROT_MEMORY_COST(stalist, set)
   #define __SDN_LAB_AP_WIFI_MAC_PRINT_STATIONLIST(stalist, set)
-  #define __SDN_LAB_AP_WIFI_MAC_PRINT_DATA_TO_STATIONLIST(stalist, set)
+  #define __SDN_LAB_AP_WIFI_MAC_OPEN_NN_DATA_EXPORTER(set, exporter)
+  #define __SDN_LAB_AP_WIFI_MAC_PRINT_DATA_TO_STATIONLIST(stalist, set, exporter)
   #define __SDN_LAB_AP_WIFI_MAC_PRINT_DATA_FROM_STATIONLIST(stalist, set)
 #endif
 
@@ -109,6 +121,54 @@ NS_OBJECT_ENSURE_REGISTERED (ApWifiMac);
 
 #define LOG_TRAFFIC(msg)	if(true) NS_LOG_DEBUG(Simulator::Now().GetMicroSeconds() << " " << msg << std::endl);
 
+/**
+ * Listener for PHY events. Forwards the end of receptions to the AP.
+ */
+class ApPhyListener : public ns3::WifiPhyListener
+{
+public:
+  /**
+   * Create an ApPhyListener for the given AP.
+   *
+   * \param mac
+   */
+  ApPhyListener (ns3::ApWifiMac *mac)
+    : m_mac (mac)
+  {
+  }
+  virtual ~ApPhyListener ()
+  {
+  }
+  virtual void NotifyRxStart (Time duration)
+  {
+  }
+  virtual void NotifyRxEndOk (void)
+  {
+    m_mac->NotifyRxEnd (true);
+  }
+  virtual void NotifyRxEndError (void)
+  {
+    m_mac->NotifyRxEnd (false);
+  }
+  virtual void NotifyTxStart (Time duration, double txPowerDbm)
+  {
+  }
+  virtual void NotifyMaybeCcaBusyStart (Time duration)
+  {
+  }
+  virtual void NotifySwitchingStart (Time duration)
+  {
+  }
+  virtual void NotifySleep (void)
+  {
+  }
+  virtual void NotifyWakeup (void)
+  {
+  }
+private:
+  ns3::ApWifiMac *m_mac; //!< the AP to notify
+};
+
 TypeId
 ApWifiMac::GetTypeId (void)
 {
@@ -181,6 +241,13 @@ ApWifiMac::GetTypeId (void)
     .AddTraceSource ("S1gBeaconBroadcasted", "Fired when a beacon is transmitted",
                     MakeTraceSourceAccessor(&ApWifiMac::m_transmitBeaconTrace),
                     "ns3::ApWifiMac::S1gBeaconTracedCallback")
+    .AddAttribute ("RawOptimizer", "The optimizer that adapts the RAW configuration (none: the RAW configuration is static).",
+                   PointerValue (),
+                   MakePointerAccessor (&ApWifiMac::m_rawOptimizer),
+                   MakePointerChecker<RawOptimizer> ())
+    .AddTraceSource ("RpsUpdated", "Fired when the RAW optimizer has changed the RPS elements",
+                    MakeTraceSourceAccessor(&ApWifiMac::m_rpsUpdatedTrace),
+                    "ns3::ApWifiMac::RpsUpdatedCallback")
     .AddTraceSource ("RpsIndex", "Fired when RPS index changes",
             MakeTraceSourceAccessor(&ApWifiMac::m_rpsIndexTrace),
             "ns3::TracedValueCallback::Uint16")
@@ -247,15 +314,26 @@ ApWifiMac::ApWifiMac ()
   AuthenThreshold = 0;
   currentRawGroup = 0;
   //m_SlotFormat = 0;
-  m_AidToMacAddr.clear ();
-  m_accessList.clear ();
-  m_supportPageSlicingList.clear();
-  m_sleepList.clear ();
+  m_staTable.assign (AidBitmap::MAX_AID, StaEntry ());
+  m_nAssignedAids = 0;
+  m_sleepList = Create<AidBitmap> ();
+  m_phyListener = 0;
+  m_rpsGeneration = 1;
+  m_rawSlotAccessGeneration = 0;
+  m_beaconTemplatesGeneration = 0;
+  for (EdcaQueues::iterator i = m_edca.begin (); i != m_edca.end (); ++i)
+    {
+      i->second->GetEdcaQueue ()->SetOccupancyCallback (MakeCallback (&ApWifiMac::NotifyQueueOccupancy, this));
+    }
   m_DTIMCount = 0;
   //m_DTIMOffset = 0;
 
   // debug print - memory cost
   __SDN_LAB_AP_WIFI_MAC_REPROT_MEMORY_COST(this->stationList, this->settings);  
+  // debug print - open the NN data file once for the whole run
+  #ifdef __SDN_LAB_DEBUG_NN
+    __SDN_LAB_AP_WIFI_MAC_OPEN_NN_DATA_EXPORTER(this->settings, this->nnDataExporter);
+  #endif
 }
 
 ApWifiMac::~ApWifiMac ()
@@ -273,9 +351,62 @@ ApWifiMac::DoDispose ()
   m_beaconDca = 0;
   m_enableBeaconGeneration = false;
   m_beaconEvent.Cancel ();
+  // write the index & header of the NN data (if exported)
+  this->nnDataExporter.Close();
+  m_S1gRawCtr.Flush ();
+  for (EdcaQueues::iterator i = m_edca.begin (); i != m_edca.end (); ++i)
+    {
+      i->second->GetEdcaQueue ()->SetOccupancyCallback (WifiMacQueue::OccupancyCallback ());
+    }
+  if (m_phyListener != 0)
+    {
+      m_phy->UnregisterListener (m_phyListener);
+      delete m_phyListener;
+      m_phyListener = 0;
+    }
+  if (m_rawOptimizer != 0)
+    {
+      // the RPSs it created are freed with it: m_rpsset must not keep them
+      m_rpsset.rpsset.clear ();
+      m_rpsGenerations.clear ();
+      m_rawOptimizer->Dispose ();
+      m_rawOptimizer = 0;
+    }
   RegularWifiMac::DoDispose ();
 }
 
+ApWifiMac::StaEntry::StaEntry ()
+  : assigned (false),
+    pageSlicing (false)
+{
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      buffered[i] = 0;
+    }
+}
+
+void
+ApWifiMac::NotifyQueueOccupancy (const WifiMacQueue *queue, const WifiMacHeader &hdr, int32_t delta)
+{
+  uint16_t aid = AidBitmap::GetAid (hdr.GetAddr1 ());
+  for (EdcaQueues::const_iterator i = m_edca.begin (); i != m_edca.end (); ++i)
+    {
+      if (PeekPointer (i->second->GetEdcaQueue ()) == queue)
+        {
+          m_staTable[aid].buffered[i->first] += delta;
+          return;
+        }
+    }
+}
+
+bool
+ApWifiMac::IsPaged (uint16_t aid) const
+{
+  const StaEntry &sta = m_staTable[aid];
+  return sta.assigned && m_associatedAids.Test (aid)
+         && (sta.buffered[AC_BE] | sta.buffered[AC_BK] | sta.buffered[AC_VI] | sta.buffered[AC_VO]) != 0;
+}
+
 void
 ApWifiMac::SetAddress (Mac48Address address)
 {
@@ -388,6 +519,29 @@ ApWifiMac::SetWifiRemoteStationManager (Ptr<WifiRemoteStationManager> stationMan
   RegularWifiMac::SetWifiRemoteStationManager (stationManager);
 }
 
+void
+ApWifiMac::SetWifiPhy (Ptr<WifiPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  if (m_phyListener != 0)
+    {
+      m_phy->UnregisterListener (m_phyListener);
+      delete m_phyListener;
+    }
+  RegularWifiMac::SetWifiPhy (phy);
+  m_phyListener = new ApPhyListener (this);
+  m_phy->RegisterListener (m_phyListener);
+}
+
+void
+ApWifiMac::NotifyRxEnd (bool success)
+{
+  if (m_rawOptimizer != 0)
+    {
+      m_rawOptimizer->NotifyRxEnd (m_rpsIndexTrace, m_rawGroupTrace, success);
+    }
+}
+
 void
 ApWifiMac::SetLinkUpCallback (Callback<void> linkUp)
 {
@@ -424,6 +578,9 @@ ApWifiMac::SetTotalStaNum (uint32_t num)
 {
   NS_LOG_FUNCTION (this << num);
   m_totalStaNum = num;
+  // every station is a peer of the duplicate detection and sequence numbering
+  m_rxMiddle->Reserve (num);
+  m_txMiddle->Reserve (num);
   //m_S1gRawCtr.RAWGroupping (m_totalStaNum, 1, m_beaconInterval.GetMicroSeconds ());
   //m_S1gRawCtr.configureRAW ();
     
@@ -553,17 +710,8 @@ ApWifiMac::ForwardDown (Ptr<const Packet> packet, Mac48Address from,
   int aid = 0;
   if (!to.IsBroadcast ())
   {
-	  /*for (auto it=m_AidToMacAddr.begin(); it != m_AidToMacAddr.end(); ++it){
-		  if (m_AidToMacAddr.find(aid)->second == to)
-			  break;
-		  else if (it == m_AidToMacAddr.end())
-			  aid = -1;
-	  }
-	  if (aid == -1)
-		  NS_LOG_INFO (Simulator::Now().GetMicroSeconds() << " ms: AP cannot forward down data because There is no RAW for this MAC address.");
-	  */
-	  do {aid++;}
-	  while (m_AidToMacAddr.find(aid)->second != to); //TODO optimize search
+	  aid = AidBitmap::GetAid (to);
+	  NS_ASSERT (m_staTable[aid].assigned && m_staTable[aid].address == to);
 
 	  NS_LOG_INFO (Simulator::Now().GetMicroSeconds() << " ms: AP to forward data for [aid=" << aid << "]");
 
@@ -820,27 +968,17 @@ ApWifiMac::SendProbeResp (Mac48Address to)
   m_dca->Queue (packet, hdr);
 }
 
-void
-ApWifiMac::SendAssocResp (Mac48Address to, bool success, uint8_t staType)
+MgtAssocResponseHeader
+ApWifiMac::GetAssocResponse (Mac48Address to, bool success, uint8_t staType)
 {
-  NS_LOG_FUNCTION (this << to << success);
-  WifiMacHeader hdr;
-  hdr.SetAssocResp ();
-  hdr.SetAddr1 (to);
-  hdr.SetAddr2 (GetAddress ());
-  hdr.SetAddr3 (GetAddress ());
-  hdr.SetDsNotFrom ();
-  hdr.SetDsNotTo ();
-  Ptr<Packet> packet = Create<Packet> ();
   MgtAssocResponseHeader assoc;
-  
-  uint8_t mac[6];
-  to.CopyTo (mac);
-  uint8_t aid_l = mac[5];
-  uint8_t aid_h = mac[4] & 0x1f;
-  uint16_t aid = (aid_h << 8) | (aid_l << 0); //assign mac address as AID
-  assoc.SetAID(aid); //
-  m_AidToMacAddr[aid]=to;
+  uint16_t aid = AidBitmap::GetAid (to); //assign mac address as AID
+  assoc.SetAID (aid);
+  if (!m_staTable[aid].assigned){
+    m_staTable[aid].assigned = true;
+    m_nAssignedAids++;
+  }
+  m_staTable[aid].address = to;
 
   StatusCode code;
   if (success)
@@ -857,38 +995,47 @@ ApWifiMac::SendAssocResp (Mac48Address to, bool success, uint8_t staType)
   if (m_htSupported)
     {
       assoc.SetHtCapabilities (GetHtCapabilities ());
-      hdr.SetNoOrder ();
     }
-    //NS_LOG_UNCOND ("ApWifiMac::SendAssocResp =" );
 
-   
   if (m_s1gSupported && success)
     {
       assoc.SetS1gCapabilities (GetS1gCapabilities ());
       //assign AID based on station type, to do.
-       if (staType == 1)
+      if (staType == 1
+          && std::find (m_sensorList.begin (), m_sensorList.end (), aid) == m_sensorList.end ())
         {
-          for (std::vector<uint16_t>::iterator it = m_sensorList.begin(); it != m_sensorList.end(); it++)
-            {
-              if (*it == aid)
-                 goto Addheader;
-            }
           m_sensorList.push_back (aid);
+          m_S1gRawCtr.AddSensorSta (aid);
           NS_LOG_INFO ("m_sensorList =" << m_sensorList.size ());
-  
         }
-       else if (staType == 2)
+      else if (staType == 2
+               && std::find (m_OffloadList.begin (), m_OffloadList.end (), aid) == m_OffloadList.end ())
         {
-           for (std::vector<uint16_t>::iterator it = m_OffloadList.begin(); it != m_OffloadList.end(); it++)
-            {
-                if (*it == aid)
-                  goto Addheader;
-            }
           m_OffloadList.push_back (aid);
+          m_S1gRawCtr.AddOffloadSta (aid);
           NS_LOG_INFO ("m_OffloadList =" << m_OffloadList.size ());
         }
     }
-Addheader:
+  return assoc;
+}
+
+void
+ApWifiMac::SendAssocResp (Mac48Address to, bool success, uint8_t staType)
+{
+  NS_LOG_FUNCTION (this << to << success);
+  WifiMacHeader hdr;
+  hdr.SetAssocResp ();
+  hdr.SetAddr1 (to);
+  hdr.SetAddr2 (GetAddress ());
+  hdr.SetAddr3 (GetAddress ());
+  hdr.SetDsNotFrom ();
+  hdr.SetDsNotTo ();
+  if (m_htSupported)
+    {
+      hdr.SetNoOrder ();
+    }
+  Ptr<Packet> packet = Create<Packet> ();
+  MgtAssocResponseHeader assoc = GetAssocResponse (to, success, staType);
   packet->AddHeader (assoc);
 
   //The standard is not clear on the correct queue for management
@@ -941,12 +1088,12 @@ ApWifiMac::HasPacketsToBlock (uint16_t blockInd , uint16_t PageInd)
        for (uint16_t j = 0; j <= 7; j++) //8 stations in each subblock
         {
            sta_aid = subblock | j;
-           if (m_stationManager->IsAssociated (m_AidToMacAddr.find(sta_aid)->second) && HasPacketsInQueueTo(m_AidToMacAddr.find(sta_aid)->second) )
+           if (IsPaged (sta_aid))
             {
         	   blockBitmap = blockBitmap | (1 << i);
         	   NS_LOG_DEBUG ("[aid=" << sta_aid << "] " << "paged");
         	   // if there is at least one station associated with AP that has FALSE for PageSlicingImplemented within this page then m_PageSliceNum = 31
-        	   if (!m_supportPageSlicingList.at(m_AidToMacAddr[sta_aid]))
+        	   if (!m_staTable[sta_aid].pageSlicing)
         		   m_PageSliceNum = 31;
         	   break;
             }
@@ -967,10 +1114,10 @@ ApWifiMac::HasPacketsToSubBlock (uint16_t subblockInd, uint16_t blockInd , uint1
     for (uint16_t j = 0; j <= 7; j++) //8 stations in each subblock
         {
            sta_aid = subblock | j;
-           if (m_stationManager->IsAssociated (m_AidToMacAddr.find(sta_aid)->second) && HasPacketsInQueueTo(m_AidToMacAddr.find(sta_aid)->second) )
+           if (IsPaged (sta_aid))
              {
                subblockBitmap = subblockBitmap | (1 << j); 
-               m_sleepList[m_AidToMacAddr.find(sta_aid)->second]=false;
+               m_sleepList->Clear (sta_aid);
              } 
         }
     return subblockBitmap;
@@ -981,49 +1128,92 @@ bool
 ApWifiMac::HasPacketsInQueueTo(Mac48Address dest) 
 {           
     //check also if ack received
-    Ptr<const Packet> peekedPacket_VO, peekedPacket_VI, peekedPacket_BE, peekedPacket_BK;
-    WifiMacHeader peekedHdr;
-    Time tstamp;
-        
-    peekedPacket_VO = m_edca.find(AC_VO)->second->GetEdcaQueue()->PeekByAddress (WifiMacHeader::ADDR1, dest);
-    peekedPacket_VI = m_edca.find(AC_VI)->second->GetEdcaQueue()->PeekByAddress (WifiMacHeader::ADDR1, dest);
-    peekedPacket_BE = m_edca.find(AC_BE)->second->GetEdcaQueue()->PeekByAddress (WifiMacHeader::ADDR1, dest);
-    peekedPacket_BK = m_edca.find(AC_BK)->second->GetEdcaQueue()->PeekByAddress (WifiMacHeader::ADDR1, dest);
-        
-    if (peekedPacket_VO != 0 || peekedPacket_VI != 0 || peekedPacket_BE != 0 || peekedPacket_BK != 0 )
-       {
-         return true;
-       }
-    else
-      {
-         return false;
-      }
+    //the expired frames are dropped once per beacon, in SendOneBeacon
+    const StaEntry &sta = m_staTable[AidBitmap::GetAid (dest)];
+    return (sta.buffered[AC_BE] | sta.buffered[AC_BK] | sta.buffered[AC_VI] | sta.buffered[AC_VO]) != 0;
 }
  
 uint16_t ApWifiMac::RpsIndex = 0;
 void
-ApWifiMac::SetaccessList (std::map<Mac48Address, bool> list)
-{
-        Mac48Address stasAddr;
-
-            
-        if (list.size () == 0)
-         {
-            return;
-         }
-              
-        for (uint32_t k = 1; k <= m_totalStaNum; k++)
-          {   
-            stasAddr = m_AidToMacAddr.find(k)->second;
-            //NS_LOG_UNCOND ( "aid "  << k << ", send " << list.find(stasAddr)->second << ", at " << Simulator::Now () << ", size " << list.size ());
-          }     
-               
+ApWifiMac::SetaccessList (Ptr<const AidBitmap> list)
+{
         m_edca.find (AC_VO)->second->SetaccessList (list);
         m_edca.find (AC_VI)->second->SetaccessList (list);
         m_edca.find (AC_BE)->second->SetaccessList (list);
         m_edca.find (AC_BK)->second->SetaccessList (list);
 }
 
+void
+ApWifiMac::UpdateRpsGeneration (void)
+{
+  bool changed = m_rpsGenerations.size () != m_rpsset.rpsset.size ();
+  m_rpsGenerations.resize (m_rpsset.rpsset.size ());
+  for (uint32_t i = 0; i < m_rpsset.rpsset.size (); i++)
+    {
+      uint64_t generation = m_rpsset.rpsset[i]->GetGeneration ();
+      if (m_rpsGenerations[i] != generation)
+        {
+          m_rpsGenerations[i] = generation;
+          changed = true;
+        }
+    }
+  if (changed)
+    {
+      m_rpsGeneration++;
+    }
+}
+
+void
+ApWifiMac::UpdateRawSlotAccess (void)
+{
+  if (m_rawSlotAccessGeneration == m_rpsGeneration)
+    {
+      return;
+    }
+  m_rawSlotAccess.clear ();
+  for (std::vector<RPS *>::iterator it = m_rpsset.rpsset.begin (); it != m_rpsset.rpsset.end (); it++)
+    {
+      std::vector<Ptr<AidBitmap> > slots;
+      for (uint32_t g = 0; g < (*it)->GetNumberOfRawGroups (); g++)
+        {
+          RPS::RawAssignment ass = (*it)->GetRawAssigmentObj (g);
+          uint16_t slotNum = ass.GetSlotNum ();
+          uint32_t base = slots.size ();
+          for (uint16_t i = 0; i < slotNum; i++)
+            {
+              slots.push_back (Create<AidBitmap> ());
+            }
+          if (slotNum == 0)
+            {
+              continue;
+            }
+          for (uint32_t k = ass.GetRawGroupAIDStart (); k <= ass.GetRawGroupAIDEnd () && k < AidBitmap::MAX_AID; k++)
+            {
+              slots[base + (k & 0x03ff) % slotNum]->Set (k); //slot that the station k will be
+            }
+        }
+      m_rawSlotAccess.push_back (slots);
+    }
+  m_rawSlotAccessGeneration = m_rpsGeneration;
+}
+
+void
+ApWifiMac::UpdateBeaconTemplates (void)
+{
+  if (m_beaconTemplatesGeneration == m_rpsGeneration && m_beaconTemplatesInterval == m_beaconInterval)
+    {
+      return;
+    }
+  S1gBeaconCompatibility compatibility;
+  compatibility.SetBeaconInterval (m_beaconInterval.GetMicroSeconds ());
+  m_beaconTemplates.clear ();
+  for (std::vector<RPS *>::iterator it = m_rpsset.rpsset.begin (); it != m_rpsset.rpsset.end (); it++)
+    {
+      m_beaconTemplates.push_back (Create<S1gBeaconTemplate> (compatibility, **it));
+    }
+  m_beaconTemplatesGeneration = m_rpsGeneration;
+  m_beaconTemplatesInterval = m_beaconInterval;
+}
   
 void ApWifiMac::SendOneBeacon (void){
   NS_LOG_FUNCTION (this);
@@ -1042,7 +1232,7 @@ void ApWifiMac::SendOneBeacon (void){
   // debug - print
   #ifdef __SDN_LAB_DEBUG_NN
     __SDN_LAB_AP_WIFI_MAC_PRINT_STATIONLIST(this->stationList, this->settings);
-    __SDN_LAB_AP_WIFI_MAC_PRINT_DATA_TO_STATIONLIST(this->stationList, this->settings);
+    __SDN_LAB_AP_WIFI_MAC_PRINT_DATA_TO_STATIONLIST(this->stationList, this->settings, this->nnDataExporter);
   #endif
 
   // predict the MCS for each station
@@ -1059,10 +1249,16 @@ void ApWifiMac::SendOneBeacon (void){
     hdr.SetAddr3 (GetAddress ()); // for debug
     Ptr<Packet> packet = Create<Packet> ();
     S1gBeaconHeader beacon;
-    S1gBeaconCompatibility compatibility;
-    compatibility.SetBeaconInterval (m_beaconInterval.GetMicroSeconds ());
-    beacon.SetBeaconCompatibility (compatibility);
-    
+
+    // adapt the RAW configuration to the traffic seen since the last update
+    if (m_rawOptimizer != 0 && m_rawOptimizer->NotifyBeacon ()
+        && m_S1gRawCtr.UpdateRAWGroupping (m_rpsset, m_rawOptimizer))
+      {
+        m_rpsUpdatedTrace (m_rpsset);
+      }
+    // the RPSs may also have been replaced or edited in place by the scenario
+    UpdateRpsGeneration ();
+
     // set beacon RPS
     RPS *m_rps;
     if (RpsIndex < m_rpsset.rpsset.size()){
@@ -1075,19 +1271,18 @@ void ApWifiMac::SendOneBeacon (void){
       NS_LOG_INFO ("RpsIndex =" << RpsIndex);
       RpsIndex = 1;
     }
-    beacon.SetRPS (*m_rps);
-
-    Mac48Address stasleepAddr;
-    for (auto i=m_AidToMacAddr.begin(); i != m_AidToMacAddr.end() ; ++i){
-    	// assume all station sleep, then change some to awake state based on downlink data
-    	//This implementation is temporary, should be removed if ps-poll is supported
-
-    	stasleepAddr = i->second;
-    	if (m_stationManager->IsAssociated (stasleepAddr))
-    	{
-    		m_sleepList[stasleepAddr]=true;
-    	}
-    }
+    // the compatibility and RPS elements are serialized once per RAW configuration
+    UpdateBeaconTemplates ();
+    beacon.SetTemplate (m_beaconTemplates.at (RpsIndex - 1));
+
+    // assume all station sleep, then change some to awake state based on downlink data
+    //This implementation is temporary, should be removed if ps-poll is supported
+    *m_sleepList = m_associatedAids;
+    // the buffered frame counters of m_staTable do not account for expiry
+    for (EdcaQueues::iterator i = m_edca.begin (); i != m_edca.end (); ++i)
+      {
+        i->second->GetEdcaQueue ()->DropExpired ();
+      }
 
     // filter when GetPageSlicingActivated() is false
     if (m_DTIMCount == 0 && GetPageSlicingActivated ()) {
@@ -1108,8 +1303,7 @@ void ApWifiMac::SendOneBeacon (void){
     RPS m_rps;
     NS_LOG_UNCOND ("send beacon at" << Simulator::Now ());
     m_S1gRawCtr.deleteRps ();
-    m_rps = m_S1gRawCtr.UpdateRAWGroupping (m_sensorList, m_OffloadList, m_receivedAid, m_beaconInterval.GetMicroSeconds (), m_outputpath);
-    m_receivedAid.clear (); //release storage
+    m_rps = m_S1gRawCtr.UpdateRAWGroupping (m_beaconInterval.GetMicroSeconds (), m_outputpath);
     //m_rps = m_S1gRawCtr.GetRPS ();
     beacon.SetRPS (m_rps); */
       
@@ -1136,12 +1330,6 @@ void ApWifiMac::SendOneBeacon (void){
 
     m_PageIndex = m_pageslice.GetPageindex();
     //m_TIM.SetPageIndex (m_PageIndex);
-    uint64_t numPagedStas (0);
-    for (auto it = m_supportPageSlicingList.begin(); it != m_supportPageSlicingList.end(); ++it){
-    	if (m_stationManager->IsAssociated (it->first) && HasPacketsInQueueTo(it->first) ){
-    	  numPagedStas++;
-    	}
-    }
     //if (!m_DTIMCount && numPagedStas) NS_LOG_DEBUG ("Paged stations: " << (int)numPagedStas);
     /*if (m_pageslice.GetPageSliceCount() == 0 && numPagedStas > 0)// special case
     {
@@ -1189,34 +1377,25 @@ void ApWifiMac::SendOneBeacon (void){
     if (m_pageslice.GetPageBitmapLength()){
     	//uint8_t numBlocksToEncode = m_pageslice.GetPageBitmapLength();
 
+      // the TIM picks the smallest encoding of every block
+      std::vector<uint64_t> blocks;
+      uint8_t firstBlock = m_blockoffset & 0x1f;
       for (uint8_t i = 0; i< NumEncodedBlock; i++){
-        TIM::EncodedBlock * m_encodedBlock = new TIM::EncodedBlock;
-        m_encodedBlock->SetBlockOffset (m_blockoffset & 0x1f); //TODO check
         uint8_t m_blockbitmap = HasPacketsToBlock (m_blockoffset & 0x1f, m_PageIndex);
-        m_encodedBlock->SetBlockBitmap (m_blockbitmap);
-
-        uint8_t subblocklength = 0;
-        uint8_t *  m_subblock; 
-        m_subblock = new uint8_t [8]; //can be released after SetPartialVBitmap
+        uint64_t aids = 0;
         // at most 8 subblock
         for (uint16_t j = 0; j <= 7; j++ ){
             if (m_blockbitmap & (1 << j)){
-              *m_subblock = HasPacketsToSubBlock (j, m_blockoffset & 0x1f, m_PageIndex);
-              subblocklength++; 
-              m_subblock++;
+              aids |= uint64_t (HasPacketsToSubBlock (j, m_blockoffset & 0x1f, m_PageIndex)) << (8 * j);
             }
         }
-        for (uint32_t j = 0; j < subblocklength; j++)
-          m_subblock--;
-        m_encodedBlock->SetEncodedInfo(m_subblock, subblocklength);
-              
+        blocks.push_back (aids);
+
         m_blockoffset++; //actually block id
         NS_ASSERT (m_blockoffset <= m_pageslice.GetBlockOffset () + m_pageslice.GetInformationFieldSize () * 8);
         //block id cannot exceeds the max defined in the page slice  element
-        m_TIM.SetPartialVBitmap (*m_encodedBlock);
-        if (m_encodedBlock)
-          delete m_encodedBlock;
       }
+      m_TIM.SetPartialVBitmap (firstBlock, blocks);
     }
 
     // set TIM
@@ -1281,73 +1460,30 @@ void ApWifiMac::SendOneBeacon (void){
     auto nRaw = m_rps->GetNumberOfRawGroups();
     currentRawGroup = (currentRawGroup + 1) % nRaw;
 
-    uint16_t startaid;
-    uint16_t endaid;
-    Mac48Address stasAddr;
-    //uint16_t offset;
-    uint16_t statsPerSlot;
-    uint16_t statRawSlot;
-
     //NS_LOG_UNCOND ("ap send beacon at " << Simulator::Now ());
 
-    m_accessList.clear ();
-    for (uint16_t i=1; i<= m_totalStaNum;i++){
-      // assume all station sleeps, then change some to awake state based on downlink data
-      //This implementation is temporary, should be removed if ps-poll is supported
-      if (m_AidToMacAddr.size () == 0){
-        break;
-      }
-      stasAddr = m_AidToMacAddr.find(i)->second;
-
-      if (m_stationManager->IsAssociated (stasAddr)){
-        m_accessList[stasAddr]=false;
-      }
-    }
-    //NS_LOG_UNCOND ("m_accessList.size " << m_accessList.size ());
+    // the access bitmaps of this RPS (RpsIndex has been moved to the next RPS)
+    UpdateRawSlotAccess ();
+    const std::vector<Ptr<AidBitmap> > &slotAccess = m_rawSlotAccess.at (RpsIndex - 1);
+    uint32_t slotOrdinal = 0;
 
     // schedule the slot start
     Time timeToSlotStart = Time ();
     for (uint32_t g = 0; g < nRaw; g++){
-      if (m_AidToMacAddr.size () == 0){
+      if (m_nAssignedAids == 0){
         break;
       }
-      startaid = m_rps->GetRawAssigmentObj(g).GetRawGroupAIDStart();
-      endaid = m_rps->GetRawAssigmentObj(g).GetRawGroupAIDEnd();
-      //offset =0; // for test
-      //m_slotNum=m_rps->GetRawAssigmentObj(g).GetSlotNum();
-      statsPerSlot = (endaid - startaid + 1)/m_rps->GetRawAssigmentObj(g).GetSlotNum();
       for (uint32_t i = 0; i < m_rps->GetRawAssigmentObj(g).GetSlotNum(); i++)      {
-        for (uint32_t k = startaid; k <= endaid; k++){
-          statRawSlot = (k & 0x03ff) % m_rps->GetRawAssigmentObj(g).GetSlotNum(); //slot that the station k will be
-          // station is in sot i
-          if (statRawSlot == i ){
-            stasAddr = m_AidToMacAddr.find(k)->second;
-            if (m_stationManager->IsAssociated (stasAddr))
-            {
-              m_accessList[stasAddr]=true;
-            }
-          }
-        }
-        Simulator::Schedule(bufferTimeToAllowBeaconToBeReceived + timeToSlotStart,
-            &ApWifiMac::SetaccessList, this, m_accessList);
-
         Simulator::Schedule(
             bufferTimeToAllowBeaconToBeReceived + timeToSlotStart,
-            &ApWifiMac::OnRAWSlotStart, this, RpsIndex, g + 1, i + 1);
+            &ApWifiMac::OnRAWSlotStart, this, RpsIndex, g + 1, i + 1, Ptr<const AidBitmap> (slotAccess.at (slotOrdinal++)));
         timeToSlotStart += MicroSeconds(500 + m_rps->GetRawAssigmentObj(g).GetSlotDurationCount() * 120);
-
-        for (uint16_t i=1; i<= m_totalStaNum;i++){
-          stasAddr = m_AidToMacAddr.find(i)->second;
-          if (m_stationManager->IsAssociated (stasAddr)){
-            m_accessList[stasAddr]=false;
-          }
-        }
       }
     }
     //NS_LOG_UNCOND(GetAddress () << ", " << startaid << "\t" << endaid << ", at " << Simulator::Now () << ", bufferTimeToAllowBeaconToBeReceived " << bufferTimeToAllowBeaconToBeReceived);
   }
   else{
-    m_receivedAid.clear (); //release storage
+    m_S1gRawCtr.ResetReceived (); //release storage
     hdr.SetBeacon ();
     hdr.SetAddr1 (Mac48Address::GetBroadcast ());
     hdr.SetAddr2 (GetAddress ());
@@ -1371,8 +1507,9 @@ void ApWifiMac::SendOneBeacon (void){
   m_beaconEvent = Simulator::Schedule (m_beaconInterval, &ApWifiMac::SendOneBeacon, this);
 }
 
-void ApWifiMac::OnRAWSlotStart(uint16_t rps, uint8_t rawGroup, uint8_t slot)
+void ApWifiMac::OnRAWSlotStart(uint16_t rps, uint8_t rawGroup, uint8_t slot, Ptr<const AidBitmap> access)
 {
+	SetaccessList (access);
 	LOG_TRAFFIC("AP RAW SLOT START FOR RAW GROUP " << (int)rawGroup << " SLOT " << (int)slot);
 	m_rpsIndexTrace = rps;
 	m_rawGroupTrace = rawGroup;
@@ -1383,6 +1520,105 @@ void ApWifiMac::OnRAWSlotStart(uint16_t rps, uint8_t rawGroup, uint8_t slot)
 
 
 
+bool
+ApWifiMac::RecordAssocRequest (Mac48Address from, const MgtAssocRequestHeader &assocReq)
+{
+  NS_LOG_FUNCTION (this << from);
+  //first, verify that the the station's supported
+  //rate set is compatible with our Basic Rate set
+  SupportedRates rates = assocReq.GetSupportedRates ();
+  for (uint32_t i = 0; i < m_stationManager->GetNBasicModes (); i++)
+    {
+      WifiMode mode = m_stationManager->GetBasicMode (i);
+      if (!rates.IsSupportedRate (mode.GetDataRate ()))
+        {
+          return false;
+        }
+    }
+  if (m_htSupported)
+    {
+      //check that the STA supports all MCSs in Basic MCS Set
+      HtCapabilities htcapabilities = assocReq.GetHtCapabilities ();
+      for (uint32_t i = 0; i < m_stationManager->GetNBasicMcs (); i++)
+        {
+          uint8_t mcs = m_stationManager->GetBasicMcs (i);
+          if (!htcapabilities.IsSupportedMcs (mcs))
+            {
+              return false;
+            }
+        }
+    }
+
+  //station supports all rates in Basic Rate Set.
+  //record all its supported modes in its associated WifiRemoteStation
+  for (uint32_t j = 0; j < m_phy->GetNModes (); j++)
+    {
+      WifiMode mode = m_phy->GetMode (j);
+      if (rates.IsSupportedRate (mode.GetDataRate ()))
+        {
+          m_stationManager->AddSupportedMode (from, mode);
+        }
+    }
+  if (m_htSupported)
+    {
+      HtCapabilities htcapabilities = assocReq.GetHtCapabilities ();
+      m_stationManager->AddStationHtCapabilities (from, htcapabilities);
+      for (uint32_t j = 0; j < m_phy->GetNMcs (); j++)
+        {
+          uint8_t mcs = m_phy->GetMcs (j);
+          if (htcapabilities.IsSupportedMcs (mcs))
+            {
+              m_stationManager->AddSupportedMcs (from, mcs);
+            }
+        }
+    }
+
+  m_stationManager->RecordWaitAssocTxOk (from);
+  m_associatedAids.Clear (AidBitmap::GetAid (from));
+
+  if (m_s1gSupported)
+    {
+      S1gCapabilities s1gcapabilities = assocReq.GetS1gCapabilities ();
+      m_stationManager->AddStationS1gCapabilities (from, s1gcapabilities);
+      m_staTable[AidBitmap::GetAid (from)].pageSlicing = s1gcapabilities.GetPageSlicingSupport () != 0;
+    }
+  return true;
+}
+
+bool
+ApWifiMac::Associate (Mac48Address from, const MgtAssocRequestHeader &assocReq, MgtAssocResponseHeader &assocResp)
+{
+  NS_LOG_FUNCTION (this << from);
+  if (m_stationManager->IsAssociated (from))
+    {
+      assocResp = GetAssocResponse (from, true, m_s1gSupported ? assocReq.GetS1gCapabilities ().GetStaType () : 0);
+      return true;
+    }
+  if (!RecordAssocRequest (from, assocReq))
+    {
+      assocResp = GetAssocResponse (from, false, 0);
+      return false;
+    }
+  assocResp = GetAssocResponse (from, true, m_s1gSupported ? assocReq.GetS1gCapabilities ().GetStaType () : 0);
+  //as if the association response had been acknowledged (TxOk)
+  m_stationManager->RecordGotAssocTxOk (from);
+  m_associatedAids.Set (AidBitmap::GetAid (from));
+  return true;
+}
+
+bool
+ApWifiMac::IsAssociated (uint16_t aid) const
+{
+  return aid < m_staTable.size () && m_staTable[aid].assigned && m_associatedAids.Test (aid);
+}
+
+Mac48Address
+ApWifiMac::GetAssociatedAddress (uint16_t aid) const
+{
+  NS_ASSERT (aid < m_staTable.size ());
+  return m_staTable[aid].address;
+}
+
 void
 ApWifiMac::TxOk (const WifiMacHeader &hdr)
 {
@@ -1394,6 +1630,7 @@ ApWifiMac::TxOk (const WifiMacHeader &hdr)
     {
       NS_LOG_DEBUG ("associated with sta=" << hdr.GetAddr1 ());
       m_stationManager->RecordGotAssocTxOk (hdr.GetAddr1 ());
+      m_associatedAids.Set (AidBitmap::GetAid (hdr.GetAddr1 ()));
     }
 }
 
@@ -1408,6 +1645,7 @@ ApWifiMac::TxFailed (const WifiMacHeader &hdr)
     {
       NS_LOG_DEBUG ("assoc failed with sta=" << hdr.GetAddr1 ());
       m_stationManager->RecordGotAssocTxFailed (hdr.GetAddr1 ());
+      m_associatedAids.Clear (AidBitmap::GetAid (hdr.GetAddr1 ()));
     }
 }
 
@@ -1473,12 +1711,16 @@ void ApWifiMac::Receive (Ptr<Packet> packet, const WifiMacHeader *hdr, PacketCon
             // not QoS Data
             ForwardUp (packet, from, bssid);
           }
-          uint8_t mac[6];
-          from.CopyTo (mac);
-          uint8_t aid_l = mac[5];
-          uint8_t aid_h = mac[4] & 0x1f;
-          uint16_t aid = (aid_h << 8) | (aid_l << 0); //assign mac address as AID
-          m_receivedAid.push_back(aid); //to change
+          // the received AIDs only feed the online RAW optimizer
+          if (m_rawOptimizer != 0)
+            {
+              uint8_t mac[6];
+              from.CopyTo (mac);
+              uint8_t aid_l = mac[5];
+              uint8_t aid_h = mac[4] & 0x1f;
+              uint16_t aid = (aid_h << 8) | (aid_l << 0); //assign mac address as AID
+              m_S1gRawCtr.NotifyReceived (aid);
+            }
         }else if (to.IsGroup ()|| m_stationManager->IsAssociated (to)){
           // not to AP
           NS_LOG_DEBUG ("forwarding frame from=" << from << ", to=" << to);
@@ -1519,77 +1761,23 @@ void ApWifiMac::Receive (Ptr<Packet> packet, const WifiMacHeader *hdr, PacketCon
           return;  //test, avoid repeate assoc
         }
         //NS_LOG_LOGIC ("Received AssocReq "); // for test
-        //first, verify that the the station's supported
-        //rate set is compatible with our Basic Rate set
         MgtAssocRequestHeader assocReq;
-
         packet->RemoveHeader (assocReq);
-
-        SupportedRates rates = assocReq.GetSupportedRates ();
-        bool problem = false;
-        for (uint32_t i = 0; i < m_stationManager->GetNBasicModes (); i++){
-          WifiMode mode = m_stationManager->GetBasicMode (i);
-          if (!rates.IsSupportedRate (mode.GetDataRate ())){
-            problem = true;
-            break;
-          }
-        }
-
-        if (m_htSupported){
-          //check that the STA supports all MCSs in Basic MCS Set
-          HtCapabilities htcapabilities = assocReq.GetHtCapabilities ();
-          for (uint32_t i = 0; i < m_stationManager->GetNBasicMcs (); i++){
-              uint8_t mcs = m_stationManager->GetBasicMcs (i);
-              if (!htcapabilities.IsSupportedMcs (mcs)){
-                problem = true;
-                break;
-              }
-          }
-        }
-  
-        if (problem){
+        if (!RecordAssocRequest (from, assocReq)){
           //One of the Basic Rate set mode is not
           //supported by the station. So, we return an assoc
           //response with an error status.
-          SendAssocResp (hdr->GetAddr2 (), false, 0);
+          SendAssocResp (from, false, 0);
+        }else if (m_s1gSupported){
+          SendAssocResp (from, true, assocReq.GetS1gCapabilities ().GetStaType ());
         }else{
-          //station supports all rates in Basic Rate Set.
-          //record all its supported modes in its associated WifiRemoteStation
-          for (uint32_t j = 0; j < m_phy->GetNModes (); j++){
-            WifiMode mode = m_phy->GetMode (j);
-            if (rates.IsSupportedRate (mode.GetDataRate ())){
-              m_stationManager->AddSupportedMode (from, mode);
-            }
-          }
-          if (m_htSupported){
-            HtCapabilities htcapabilities = assocReq.GetHtCapabilities ();
-            m_stationManager->AddStationHtCapabilities (from,htcapabilities);
-            for (uint32_t j = 0; j < m_phy->GetNMcs (); j++){
-              uint8_t mcs = m_phy->GetMcs (j);
-              if (htcapabilities.IsSupportedMcs (mcs)){
-                m_stationManager->AddSupportedMcs (from, mcs);
-              }
-            }
-          }
-            
-          m_stationManager->RecordWaitAssocTxOk (from);
-          
-          if (m_s1gSupported){
-            S1gCapabilities s1gcapabilities = assocReq.GetS1gCapabilities ();
-            m_stationManager->AddStationS1gCapabilities (from,s1gcapabilities);
-            uint8_t sta_type = s1gcapabilities.GetStaType ();
-            bool pageSlicingSupported = s1gcapabilities.GetPageSlicingSupport() != 0;
-            m_supportPageSlicingList[hdr->GetAddr2 ()] = pageSlicingSupported;
-            SendAssocResp (hdr->GetAddr2 (), true, sta_type);
-          }else{
-            //send assoc response with success status.
-            SendAssocResp (hdr->GetAddr2 (), true, 0);
-          }
-
+          //send assoc response with success status.
+          SendAssocResp (from, true, 0);
         }
         return;
       }else if (hdr->IsDisassociation ()){
         m_stationManager->RecordDisassociated (from);
+        m_associatedAids.Clear (AidBitmap::GetAid (from));
         uint8_t mac[6];
         from.CopyTo (mac);
         uint8_t aid_l = mac[5];
@@ -1600,6 +1788,7 @@ void ApWifiMac::Receive (Ptr<Packet> packet, const WifiMacHeader *hdr, PacketCon
         for (std::vector<uint16_t>::iterator it = m_sensorList.begin(); it != m_sensorList.end(); it++){
             if (*it == aid){
               m_sensorList.erase (it); //remove from association list
+              m_S1gRawCtr.RemoveSensorSta (aid);
               NS_LOG_UNCOND ("erase aid " << aid << " by Ap from m_sensorList ");
               break;
             }
@@ -1620,23 +1809,23 @@ ApWifiMac::DeaggregateAmsduAndForward (Ptr<Packet> aggregatedPacket,
                                        const WifiMacHeader *hdr)
 {
   NS_LOG_FUNCTION (this << aggregatedPacket << hdr);
-  MsduAggregator::DeaggregatedMsdus packets =
-    MsduAggregator::Deaggregate (aggregatedPacket);
-
-  for (MsduAggregator::DeaggregatedMsdusCI i = packets.begin ();
-       i != packets.end (); ++i)
+  AmsduSubframeHeader subframeHdr;
+  Ptr<Packet> msdu = 0;
+  //the last MSDU is aggregatedPacket itself
+  while (msdu != aggregatedPacket && aggregatedPacket->GetSize () > 0)
     {
-      if ((*i).second.GetDestinationAddr () == GetAddress ())
+      msdu = MsduAggregator::RemoveSubframe (aggregatedPacket, &subframeHdr);
+      if (subframeHdr.GetDestinationAddr () == GetAddress ())
         {
-          ForwardUp ((*i).first, (*i).second.GetSourceAddr (),
-                     (*i).second.GetDestinationAddr ());
+          ForwardUp (msdu, subframeHdr.GetSourceAddr (),
+                     subframeHdr.GetDestinationAddr ());
         }
       else
         {
-          Mac48Address from = (*i).second.GetSourceAddr ();
-          Mac48Address to = (*i).second.GetDestinationAddr ();
+          Mac48Address from = subframeHdr.GetSourceAddr ();
+          Mac48Address to = subframeHdr.GetDestinationAddr ();
           NS_LOG_DEBUG ("forwarding QoS frame from=" << from << ", to=" << to);
-          ForwardDown ((*i).first, from, to, hdr->GetQosTid ());
+          ForwardDown (msdu, from, to, hdr->GetQosTid ());
         }
     }
 }
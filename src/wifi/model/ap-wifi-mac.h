@@ -28,6 +28,7 @@
 #include "s1g-capabilities.h"
 #include "amsdu-subframe-header.h"
 #include "supported-rates.h"
+#include "mgt-headers.h"
 #include "ns3/random-variable-stream.h"
 #include "rps.h"
 #include "tim.h"
@@ -51,6 +52,8 @@
 
 namespace ns3 {
 
+class ApPhyListener;
+
 /**
  * \brief Wi-Fi AP state machine
  * \ingroup wifi
@@ -73,6 +76,11 @@ public:
   typedef void (* S1gBeaconTracedCallback)
        (S1gBeaconHeader beacon, RPS::RawAssignment raw);
 
+  TracedCallback<const RPSVector &> m_rpsUpdatedTrace;
+
+  typedef void (* RpsUpdatedCallback)
+       (const RPSVector &rpsset);
+
   ApWifiMac ();
   virtual ~ApWifiMac ();
 
@@ -81,6 +89,11 @@ public:
    */
   virtual void SetWifiRemoteStationManager (Ptr<WifiRemoteStationManager> stationManager);
 
+  /**
+   * \param phy the physical layer attached to this MAC.
+   */
+  virtual void SetWifiPhy (Ptr<WifiPhy> phy);
+
   /**
    * \param linkUp the callback to invoke when the link becomes up.
    */
@@ -142,21 +155,52 @@ public:
    * \return the number of stream indices assigned by this model
    */
   int64_t AssignStreams (int64_t stream);
-  void SetaccessList (std::map<Mac48Address, bool> list);
+  void SetaccessList (Ptr<const AidBitmap> list);
 
   uint8_t GetDTIMPeriod (void) const;
   void SetDTIMPeriod (uint8_t period);
+  /**
+   * \param dest the address of a station
+   * \return true if frames to the station are buffered; expired frames
+   *         count until the next beacon drops them
+   */
   bool HasPacketsInQueueTo(Mac48Address dest);
   uint8_t HasPacketsToSubBlock (uint16_t subblockInd, uint16_t blockInd , uint16_t PageInd);
   uint8_t HasPacketsToBlock (uint16_t blockInd , uint16_t PageInd);
   uint32_t HasPacketsToPage (uint8_t blockstart , uint8_t Page);
 
+  /**
+   * Accept an association request without the over-the-air exchange: the
+   * request is checked and recorded as if it had been received, and the
+   * station is associated as if the response had been acknowledged.
+   *
+   * \param from the address of the STA
+   * \param assocReq the association request of the STA
+   * \param assocResp the association response the STA would receive
+   * \return true if the STA is associated
+   */
+  bool Associate (Mac48Address from, const MgtAssocRequestHeader &assocReq, MgtAssocResponseHeader &assocResp);
+  /**
+   * \param aid the AID of a station
+   * \return true if the station is associated
+   */
+  bool IsAssociated (uint16_t aid) const;
+  /**
+   * \param aid the AID of a station
+   * \return the address the AID was assigned to
+   */
+  Mac48Address GetAssociatedAddress (uint16_t aid) const;
+
 
 private:
   /*** methods ***/
   virtual void Receive (Ptr<Packet> packet, const WifiMacHeader *hdr, SdnLab::PacketContext context);
 
-  void OnRAWSlotStart(uint16_t rps, uint8_t rawGroup, uint8_t slot);
+  /**
+   * Start of a RAW slot: hand the slot access bitmap to the EDCAs and update the RAW traces
+   * (a single event per slot).
+   */
+  void OnRAWSlotStart(uint16_t rps, uint8_t rawGroup, uint8_t slot, Ptr<const AidBitmap> access);
 
   /**
    * The packet we sent was successfully received by the receiver
@@ -221,6 +265,24 @@ private:
    * \param success indicates whether the association was successful or not
    */
   void SendAssocResp (Mac48Address to, bool success, uint8_t staType);
+  /**
+   * Check an association request and, if the STA supports our basic rates,
+   * record its rates and capabilities in the station manager.
+   *
+   * \param from the address of the STA
+   * \param assocReq the association request
+   * \return true if the request can be accepted
+   */
+  bool RecordAssocRequest (Mac48Address from, const MgtAssocRequestHeader &assocReq);
+  /**
+   * Assign the AID of a STA and build its association response.
+   *
+   * \param to the address of the STA
+   * \param success indicates whether the association was successful or not
+   * \param staType the station type (S1G capabilities)
+   * \return the association response
+   */
+  MgtAssocResponseHeader GetAssocResponse (Mac48Address to, bool success, uint8_t staType);
   /**
    * Forward a beacon packet to the beacon special DCF.
    */
@@ -478,14 +540,73 @@ private:
     
   std::vector<uint16_t> m_sensorList; //stations allowed to transmit in last beacon
   std::vector<uint16_t> m_OffloadList;
-  std::vector<uint16_t> m_receivedAid;
-  std::map<uint16_t, Mac48Address> m_AidToMacAddr;
-  std::map<Mac48Address, bool> m_accessList;
-    
-  std::map<Mac48Address, bool> m_sleepList;
-  std::map<Mac48Address, bool> m_supportPageSlicingList;
+  /**
+   * A station of the BSS, stored at its AID in m_staTable.
+   */
+  struct StaEntry
+  {
+    StaEntry ();
+    Mac48Address address;   //!< the MAC address the AID was assigned to
+    bool assigned;          //!< whether the AID has been assigned (association response sent)
+    bool pageSlicing;       //!< whether the station supports page slicing
+    uint32_t buffered[4];   //!< frames in the EDCA queues for the station, per AcIndex
+  };
+  /**
+   * \param aid the AID of the station
+   * \return true if the station is associated and has frames buffered in the EDCA queues
+   */
+  bool IsPaged (uint16_t aid) const;
+  /**
+   * Keep the per-AC buffered frame counters of m_staTable up to date.
+   *
+   * \param queue the EDCA queue
+   * \param hdr the header of the frame entering or leaving the queue
+   * \param delta +1 if the frame entered the queue, -1 if it left
+   */
+  void NotifyQueueOccupancy (const WifiMacQueue *queue, const WifiMacHeader &hdr, int32_t delta);
+  std::vector<StaEntry> m_staTable; //!< the stations, indexed by AID
+  uint32_t m_nAssignedAids;         //!< number of assigned AIDs in m_staTable
+  /**
+   * Advance m_rpsGeneration if m_rpsset, or any of its RPSs, has changed
+   * since the last call.
+   */
+  void UpdateRpsGeneration (void);
+  std::vector<uint64_t> m_rpsGenerations; //!< the generations of the RPSs of m_rpsset at the last call
+  uint64_t m_rpsGeneration;                //!< the generation of the RAW configuration, shared by its caches
+  /**
+   * Rebuild m_rawSlotAccess if the RAW configuration has changed since the
+   * last call.
+   */
+  void UpdateRawSlotAccess (void);
+  /**
+   * RAW slot access bitmaps, rebuilt only when the RAW configuration changes:
+   * m_rawSlotAccess[r][n] holds the AIDs of the n-th slot (counted over all
+   * RAW groups) of the r-th RPS in m_rpsset.
+   */
+  std::vector<std::vector<Ptr<AidBitmap> > > m_rawSlotAccess;
+  uint64_t m_rawSlotAccessGeneration;   //!< the RAW configuration m_rawSlotAccess was built from
+  /**
+   * Rebuild m_beaconTemplates if the RAW configuration or the beacon
+   * interval has changed since the last call.
+   */
+  void UpdateBeaconTemplates (void);
+  std::vector<Ptr<S1gBeaconTemplate> > m_beaconTemplates; //!< pre-serialized beacon elements of every RPS in m_rpsset
+  uint64_t m_beaconTemplatesGeneration;                  //!< the RAW configuration m_beaconTemplates was built from
+  Time m_beaconTemplatesInterval;                        //!< the beacon interval m_beaconTemplates was built with
+
+  AidBitmap m_associatedAids; //!< association bit of m_staTable: stations in state GOT_ASSOC_TX_OK, kept in step with m_stationManager
+  Ptr<AidBitmap> m_sleepList; //!< stations asleep in the current beacon interval (shared with the EDCAs)
 
   S1gRawCtr m_S1gRawCtr;
+  friend class ApPhyListener;
+  Ptr<RawOptimizer> m_rawOptimizer; //!< online RAW optimizer (none: m_rpsset is static)
+  ApPhyListener *m_phyListener;     //!< reports the end of receptions to NotifyRxEnd
+  /**
+   * Count the end of a reception in the current RAW group for m_rawOptimizer.
+   *
+   * \param success whether the frame was received correctly
+   */
+  void NotifyRxEnd (bool success);
   Ptr<DcaTxop> m_beaconDca;                  //!< Dedicated DcaTxop for beacons
   Time m_beaconInterval;                     //!< Interval between beacons
   bool m_enableBeaconGeneration;             //!< Flag if beacons are being generated
@@ -549,6 +670,8 @@ private:
     // 8191 stations: each station has `__SDN_LAB_NNDATA_LEN` data at most
     SdnLab::StationList stationList = SdnLab::StationListFactory::Create(__SDN_LAB_STATIONLIST_MEMORY_COST_REQ(8191, __SDN_LAB_NNDATA_LEN), 8191);
   #endif
+  // NN data exporter (`__SDN_LAB_DEBUG_NN`)
+  SdnLab::NNDataExporter nnDataExporter;
   // context
   SdnLab::PacketContext context = SdnLab::PacketContext();
 };
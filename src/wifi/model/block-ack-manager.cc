@@ -31,6 +31,7 @@
 #include "wifi-mac-queue.h"
 #include "mac-tx-middle.h"
 #include "qos-utils.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -72,15 +73,31 @@ BlockAckManager::~BlockAckManager ()
 {
   NS_LOG_FUNCTION (this);
   m_queue = 0;
-  m_agreements.clear ();
+  for (std::vector<Agreement *>::iterator i = m_agreementList.begin (); i != m_agreementList.end (); i++)
+    {
+      delete *i;
+    }
+  m_agreementList.clear ();
+  m_agreements.Clear ();
   m_retryPackets.clear ();
 }
 
+BlockAckManager::Agreement *
+BlockAckManager::FindAgreement (Mac48Address recipient, uint8_t tid) const
+{
+  const PeerAgreements *peer = m_agreements.Find (recipient);
+  if (peer == 0 || tid >= 16)
+    {
+      return 0;
+    }
+  return peer->tids[tid];
+}
+
 bool
 BlockAckManager::ExistsAgreement (Mac48Address recipient, uint8_t tid) const
 {
   NS_LOG_FUNCTION (this << recipient << static_cast<uint32_t> (tid));
-  return (m_agreements.find (std::make_pair (recipient, tid)) != m_agreements.end ());
+  return (FindAgreement (recipient, tid) != 0);
 }
 
 bool
@@ -88,20 +105,19 @@ BlockAckManager::ExistsAgreementInState (Mac48Address recipient, uint8_t tid,
                                          enum OriginatorBlockAckAgreement::State state) const
 {
   NS_LOG_FUNCTION (this << recipient << static_cast<uint32_t> (tid) << state);
-  AgreementsCI it;
-  it = m_agreements.find (std::make_pair (recipient, tid));
-  if (it != m_agreements.end ())
+  const Agreement *it = FindAgreement (recipient, tid);
+  if (it != 0)
     {
       switch (state)
         {
         case OriginatorBlockAckAgreement::INACTIVE:
-          return it->second.first.IsInactive ();
+          return it->first.IsInactive ();
         case OriginatorBlockAckAgreement::ESTABLISHED:
-          return it->second.first.IsEstablished ();
+          return it->first.IsEstablished ();
         case OriginatorBlockAckAgreement::PENDING:
-          return it->second.first.IsPending ();
+          return it->first.IsPending ();
         case OriginatorBlockAckAgreement::UNSUCCESSFUL:
-          return it->second.first.IsUnsuccessful ();
+          return it->first.IsUnsuccessful ();
         default:
           NS_FATAL_ERROR ("Invalid state for block ack agreement");
         }
@@ -113,7 +129,6 @@ void
 BlockAckManager::CreateAgreement (const MgtAddBaRequestHeader *reqHdr, Mac48Address recipient)
 {
   NS_LOG_FUNCTION (this << reqHdr << recipient);
-  std::pair<Mac48Address, uint8_t> key (recipient, reqHdr->GetTid ());
   OriginatorBlockAckAgreement agreement (recipient, reqHdr->GetTid ());
   agreement.SetStartingSequence (reqHdr->GetStartingSequence ());
   /* For now we assume that originator doesn't use this field. Use of this field
@@ -132,9 +147,13 @@ BlockAckManager::CreateAgreement (const MgtAddBaRequestHeader *reqHdr, Mac48Addr
       agreement.SetDelayedBlockAck ();
     }
   agreement.SetState (OriginatorBlockAckAgreement::PENDING);
-  PacketQueue queue (0);
-  std::pair<OriginatorBlockAckAgreement, PacketQueue> value (agreement, queue);
-  m_agreements.insert (std::make_pair (key, value));
+  NS_ASSERT (reqHdr->GetTid () < 16);
+  Agreement *&slot = m_agreements.Get (recipient).tids[reqHdr->GetTid ()];
+  if (slot == 0)
+    {
+      slot = new Agreement (agreement, PacketQueue ());
+      m_agreementList.push_back (slot);
+    }
   m_blockPackets (recipient, reqHdr->GetTid ());
 }
 
@@ -142,8 +161,8 @@ void
 BlockAckManager::DestroyAgreement (Mac48Address recipient, uint8_t tid)
 {
   NS_LOG_FUNCTION (this << recipient << static_cast<uint32_t> (tid));
-  AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
-  if (it != m_agreements.end ())
+  Agreement *it = FindAgreement (recipient, tid);
+  if (it != 0)
     {
       for (std::list<PacketQueueI>::iterator i = m_retryPackets.begin (); i != m_retryPackets.end (); )
         {
@@ -156,7 +175,10 @@ BlockAckManager::DestroyAgreement (Mac48Address recipient, uint8_t tid)
               i++;
             }
         }
-      m_agreements.erase (it);
+      m_agreements.Find (recipient)->tids[tid] = 0;
+      *std::find (m_agreementList.begin (), m_agreementList.end (), it) = m_agreementList.back ();
+      m_agreementList.pop_back ();
+      delete it;
       //remove scheduled bar
       for (std::list<Bar>::iterator i = m_bars.begin (); i != m_bars.end (); )
         {
@@ -177,10 +199,10 @@ BlockAckManager::UpdateAgreement (const MgtAddBaResponseHeader *respHdr, Mac48Ad
 {
   NS_LOG_FUNCTION (this << respHdr << recipient);
   uint8_t tid = respHdr->GetTid ();
-  AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
-  if (it != m_agreements.end ())
+  Agreement *it = FindAgreement (recipient, tid);
+  if (it != 0)
     {
-      OriginatorBlockAckAgreement& agreement = it->second.first;
+      OriginatorBlockAckAgreement& agreement = it->first;
       agreement.SetBufferSize (respHdr->GetBufferSize () + 1);
       agreement.SetTimeout (respHdr->GetTimeout ());
       agreement.SetAmsduSupport (respHdr->IsAmsduSupported ());
@@ -215,14 +237,14 @@ BlockAckManager::StorePacket (Ptr<const Packet> packet, const WifiMacHeader &hdr
   Mac48Address recipient = hdr.GetAddr1 ();
 
   Item item (packet, hdr, tStamp);
-  AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
-  NS_ASSERT (it != m_agreements.end ());
-  PacketQueueI queueIt = it->second.second.begin ();
-  for (; queueIt != it->second.second.end (); )
+  Agreement *it = FindAgreement (recipient, tid);
+  NS_ASSERT (it != 0);
+  PacketQueueI queueIt = it->second.begin ();
+  for (; queueIt != it->second.end (); )
     {
       if (((hdr.GetSequenceNumber () - queueIt->hdr.GetSequenceNumber () + 4096) % 4096) > 2047)
         {
-          queueIt = it->second.second.insert (queueIt, item);
+          queueIt = it->second.insert (queueIt, item);
           break;
         }
       else
@@ -230,18 +252,18 @@ BlockAckManager::StorePacket (Ptr<const Packet> packet, const WifiMacHeader &hdr
           queueIt++;
         }
     }
-  if (queueIt == it->second.second.end ())
+  if (queueIt == it->second.end ())
     {
-      it->second.second.push_back (item);
+      it->second.push_back (item);
     }
 }
 
 void
 BlockAckManager::CompleteAmpduExchange (Mac48Address recipient, uint8_t tid)
 {
-  AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
-  NS_ASSERT (it != m_agreements.end ());
-  OriginatorBlockAckAgreement &agreement = (*it).second.first;
+  Agreement *it = FindAgreement (recipient, tid);
+  NS_ASSERT (it != 0);
+  OriginatorBlockAckAgreement &agreement = it->first;
   agreement.CompleteExchange ();
 }
 
@@ -268,19 +290,19 @@ BlockAckManager::GetNextPacket (WifiMacHeader &hdr)
               NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
             }
           recipient = (*it)->hdr.GetAddr1 ();
-          AgreementsI agreement = m_agreements.find (std::make_pair (recipient, tid));
-          NS_ASSERT (agreement != m_agreements.end ());
-          if (QosUtilsIsOldPacket (agreement->second.first.GetStartingSequence (),(*it)->hdr.GetSequenceNumber ()))
+          Agreement *agreement = FindAgreement (recipient, tid);
+          NS_ASSERT (agreement != 0);
+          if (QosUtilsIsOldPacket (agreement->first.GetStartingSequence (),(*it)->hdr.GetSequenceNumber ()))
             {
               //Standard says the originator should not send a packet with seqnum < winstart
-              NS_LOG_DEBUG ("The Retry packet have sequence number < WinStartO --> Discard " << (*it)->hdr.GetSequenceNumber () << " " << agreement->second.first.GetStartingSequence ());
-              agreement->second.second.erase ((*it));
+              NS_LOG_DEBUG ("The Retry packet have sequence number < WinStartO --> Discard " << (*it)->hdr.GetSequenceNumber () << " " << agreement->first.GetStartingSequence ());
+              agreement->second.erase ((*it));
               it = m_retryPackets.erase (it);
               continue;
             }
-          else if ((*it)->hdr.GetSequenceNumber () > (agreement->second.first.GetStartingSequence () + 63) % 4096)
+          else if ((*it)->hdr.GetSequenceNumber () > (agreement->first.GetStartingSequence () + 63) % 4096)
             {
-              agreement->second.first.SetStartingSequence ((*it)->hdr.GetSequenceNumber ());
+              agreement->first.SetStartingSequence ((*it)->hdr.GetSequenceNumber ());
             }
           packet = (*it)->packet->Copy ();
           hdr = (*it)->hdr;
@@ -295,7 +317,7 @@ BlockAckManager::GetNextPacket (WifiMacHeader &hdr)
               NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
             }
           recipient = hdr.GetAddr1 ();
-          if (!agreement->second.first.IsHtSupported ()
+          if (!agreement->first.IsHtSupported ()
               && (ExistsAgreementInState (recipient, tid, OriginatorBlockAckAgreement::ESTABLISHED)
                   || SwitchToBlockAckIfNeeded (recipient, tid, hdr.GetSequenceNumber ())))
             {
@@ -311,8 +333,8 @@ BlockAckManager::GetNextPacket (WifiMacHeader &hdr)
                * the use of Block Ack.
                */
               hdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
-              AgreementsI i = m_agreements.find (std::make_pair (recipient, tid));
-              i->second.second.erase (*it);
+              Agreement *i = FindAgreement (recipient, tid);
+              i->second.erase (*it);
             }
           it = m_retryPackets.erase (it);
           NS_LOG_DEBUG ("Removed one packet, retry buffer size = " << m_retryPackets.size () );
@@ -329,25 +351,25 @@ BlockAckManager::PeekNextPacket (WifiMacHeader &hdr, Mac48Address recipient, uin
   NS_LOG_FUNCTION (this);
   Ptr<const Packet> packet = 0;
   CleanupBuffers ();
-  AgreementsI agreement = m_agreements.find (std::make_pair (recipient, tid));
-  NS_ASSERT (agreement != m_agreements.end ());
+  Agreement *agreement = FindAgreement (recipient, tid);
+  NS_ASSERT (agreement != 0);
   std::list<PacketQueueI>::iterator it = m_retryPackets.begin ();
   for (; it != m_retryPackets.end (); it++)
     {
       if ((*it)->hdr.GetAddr1 () == recipient && (*it)->hdr.GetQosTid () == tid)
         {
-          if (QosUtilsIsOldPacket (agreement->second.first.GetStartingSequence (),(*it)->hdr.GetSequenceNumber ()))
+          if (QosUtilsIsOldPacket (agreement->first.GetStartingSequence (),(*it)->hdr.GetSequenceNumber ()))
             {
               //standard says the originator should not send a packet with seqnum < winstart
-              NS_LOG_DEBUG ("The Retry packet have sequence number < WinStartO --> Discard " << (*it)->hdr.GetSequenceNumber () << " " << agreement->second.first.GetStartingSequence ());
-              agreement->second.second.erase ((*it));
+              NS_LOG_DEBUG ("The Retry packet have sequence number < WinStartO --> Discard " << (*it)->hdr.GetSequenceNumber () << " " << agreement->first.GetStartingSequence ());
+              agreement->second.erase ((*it));
               it = m_retryPackets.erase (it);
               it--;
               continue;
             }
-          else if ((*it)->hdr.GetSequenceNumber () > (agreement->second.first.GetStartingSequence () + 63) % 4096)
+          else if ((*it)->hdr.GetSequenceNumber () > (agreement->first.GetStartingSequence () + 63) % 4096)
             {
-              agreement->second.first.SetStartingSequence ((*it)->hdr.GetSequenceNumber ());
+              agreement->first.SetStartingSequence ((*it)->hdr.GetSequenceNumber ());
             }
           packet = (*it)->packet->Copy ();
           hdr = (*it)->hdr;
@@ -355,7 +377,7 @@ BlockAckManager::PeekNextPacket (WifiMacHeader &hdr, Mac48Address recipient, uin
           *tstamp = (*it)->timestamp;
           NS_LOG_INFO ("Retry packet seq = " << hdr.GetSequenceNumber ());
           Mac48Address recipient = hdr.GetAddr1 ();
-          if (!agreement->second.first.IsHtSupported ()
+          if (!agreement->first.IsHtSupported ()
               && (ExistsAgreementInState (recipient, tid, OriginatorBlockAckAgreement::ESTABLISHED)
                   || SwitchToBlockAckIfNeeded (recipient, tid, hdr.GetSequenceNumber ())))
             {
@@ -392,8 +414,8 @@ BlockAckManager::RemovePacket (uint8_t tid, Mac48Address recipient, uint16_t seq
           uint8_t tid = hdr.GetQosTid ();
           Mac48Address recipient = hdr.GetAddr1 ();
 
-          AgreementsI i = m_agreements.find (std::make_pair (recipient, tid));
-          i->second.second.erase ((*it));
+          Agreement *i = FindAgreement (recipient, tid);
+          i->second.erase ((*it));
 
           m_retryPackets.erase (it);
           NS_LOG_DEBUG ("Removed Packet from retry queue = " << hdr.GetSequenceNumber () << " " << (uint32_t) tid << " " << recipient << " Buffer Size = " << m_retryPackets.size ());
@@ -430,15 +452,15 @@ BlockAckManager::GetNBufferedPackets (Mac48Address recipient, uint8_t tid) const
   uint32_t nPackets = 0;
   if (ExistsAgreement (recipient, tid))
     {
-      AgreementsCI it = m_agreements.find (std::make_pair (recipient, tid));
-      PacketQueueCI queueIt = (*it).second.second.begin ();
+      const Agreement *it = FindAgreement (recipient, tid);
+      PacketQueueCI queueIt = it->second.begin ();
       uint16_t currentSeq = 0;
-      while (queueIt != (*it).second.second.end ())
+      while (queueIt != it->second.end ())
         {
           currentSeq = (*queueIt).hdr.GetSequenceNumber ();
           nPackets++;
           /* a fragmented packet must be counted as one packet */
-          while (queueIt != (*it).second.second.end () && (*queueIt).hdr.GetSequenceNumber () == currentSeq)
+          while (queueIt != it->second.end () && (*queueIt).hdr.GetSequenceNumber () == currentSeq)
             {
               queueIt++;
             }
@@ -520,29 +542,29 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
       if (ExistsAgreementInState (recipient, tid, OriginatorBlockAckAgreement::ESTABLISHED))
         {
           bool foundFirstLost = false;
-          AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
-          PacketQueueI queueEnd = it->second.second.end ();
+          Agreement *it = FindAgreement (recipient, tid);
+          PacketQueueI queueEnd = it->second.end ();
 
-          if (it->second.first.m_inactivityEvent.IsRunning ())
+          if (it->first.m_inactivityEvent.IsRunning ())
             {
               /* Upon reception of a block ack frame, the inactivity timer at the
                  originator must be reset.
                  For more details see section 11.5.3 in IEEE802.11e standard */
-              it->second.first.m_inactivityEvent.Cancel ();
-              Time timeout = MicroSeconds (1024 * it->second.first.GetTimeout ());
-              it->second.first.m_inactivityEvent = Simulator::Schedule (timeout,
+              it->first.m_inactivityEvent.Cancel ();
+              Time timeout = MicroSeconds (1024 * it->first.GetTimeout ());
+              it->first.m_inactivityEvent = Simulator::Schedule (timeout,
                                                                         &BlockAckManager::InactivityTimeout,
                                                                         this,
                                                                         recipient, tid);
             }
           if (blockAck->IsBasic ())
             {
-              for (PacketQueueI queueIt = it->second.second.begin (); queueIt != queueEnd; )
+              for (PacketQueueI queueIt = it->second.begin (); queueIt != queueEnd; )
                 {
                   if (blockAck->IsFragmentReceived ((*queueIt).hdr.GetSequenceNumber (),
                                                     (*queueIt).hdr.GetFragmentNumber ()))
                     {
-                      queueIt = it->second.second.erase (queueIt);
+                      queueIt = it->second.erase (queueIt);
                     }
                   else
                     {
@@ -550,7 +572,7 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
                         {
                           foundFirstLost = true;
                           sequenceFirstLost = (*queueIt).hdr.GetSequenceNumber ();
-                          (*it).second.first.SetStartingSequence (sequenceFirstLost);
+                          it->first.SetStartingSequence (sequenceFirstLost);
                         }
 
                       if (!AlreadyExists ((*queueIt).hdr.GetSequenceNumber (),recipient,tid))
@@ -564,7 +586,7 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
             }
           else if (blockAck->IsCompressed ())
             {
-              for (PacketQueueI queueIt = it->second.second.begin (); queueIt != queueEnd; )
+              for (PacketQueueI queueIt = it->second.begin (); queueIt != queueEnd; )
                 {
                   if (blockAck->IsPacketReceived ((*queueIt).hdr.GetSequenceNumber ()))
                     {
@@ -578,7 +600,7 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
                             {
                               m_txOkCallback ((*queueIt).hdr);
                             }
-                          queueIt = it->second.second.erase (queueIt);
+                          queueIt = it->second.erase (queueIt);
                         }
                     }
                   else
@@ -587,7 +609,7 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
                         {
                           foundFirstLost = true;
                           sequenceFirstLost = (*queueIt).hdr.GetSequenceNumber ();
-                          (*it).second.first.SetStartingSequence (sequenceFirstLost);
+                          it->first.SetStartingSequence (sequenceFirstLost);
                         }
                       //notify remote station of unsuccessful transmission
                       m_stationManager->ReportDataFailed ((*queueIt).hdr.GetAddr1 (), &(*queueIt).hdr);
@@ -607,7 +629,7 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
           if ((foundFirstLost && !SwitchToBlockAckIfNeeded (recipient, tid, sequenceFirstLost))
               || (!foundFirstLost && !SwitchToBlockAckIfNeeded (recipient, tid, newSeq)))
             {
-              it->second.first.CompleteExchange ();
+              it->first.CompleteExchange ();
             }
         }
     }
@@ -634,14 +656,14 @@ BlockAckManager::ScheduleBlockAckReqIfNeeded (Mac48Address recipient, uint8_t ti
      packets but some of these packets are dropped due to MSDU lifetime expiration.
    */
   NS_LOG_FUNCTION (this << recipient << static_cast<uint32_t> (tid));
-  AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
-  NS_ASSERT (it != m_agreements.end ());
+  Agreement *it = FindAgreement (recipient, tid);
+  NS_ASSERT (it != 0);
 
-  if ((*it).second.first.IsBlockAckRequestNeeded ()
+  if (it->first.IsBlockAckRequestNeeded ()
       || (GetNRetryNeededPackets (recipient, tid) == 0
           && m_queue->GetNPacketsByTidAndAddress (tid, WifiMacHeader::ADDR1, recipient) == 0))
     {
-      OriginatorBlockAckAgreement &agreement = (*it).second.first;
+      OriginatorBlockAckAgreement &agreement = it->first;
       agreement.CompleteExchange ();
 
       CtrlBAckRequestHeader reqHdr;
@@ -677,22 +699,22 @@ void
 BlockAckManager::NotifyAgreementEstablished (Mac48Address recipient, uint8_t tid, uint16_t startingSeq)
 {
   NS_LOG_FUNCTION (this << recipient << static_cast<uint32_t> (tid) << startingSeq);
-  AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
-  NS_ASSERT (it != m_agreements.end ());
+  Agreement *it = FindAgreement (recipient, tid);
+  NS_ASSERT (it != 0);
 
-  it->second.first.SetState (OriginatorBlockAckAgreement::ESTABLISHED);
-  it->second.first.SetStartingSequence (startingSeq);
+  it->first.SetState (OriginatorBlockAckAgreement::ESTABLISHED);
+  it->first.SetStartingSequence (startingSeq);
 }
 
 void
 BlockAckManager::NotifyAgreementUnsuccessful (Mac48Address recipient, uint8_t tid)
 {
   NS_LOG_FUNCTION (this << recipient << static_cast<uint32_t> (tid));
-  AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
-  NS_ASSERT (it != m_agreements.end ());
-  if (it != m_agreements.end ())
+  Agreement *it = FindAgreement (recipient, tid);
+  NS_ASSERT (it != 0);
+  if (it != 0)
     {
-      it->second.first.SetState (OriginatorBlockAckAgreement::UNSUCCESSFUL);
+      it->first.SetState (OriginatorBlockAckAgreement::UNSUCCESSFUL);
     }
 }
 
@@ -701,8 +723,8 @@ BlockAckManager::NotifyMpduTransmission (Mac48Address recipient, uint8_t tid, ui
 {
   NS_LOG_FUNCTION (this << recipient << static_cast<uint32_t> (tid) << nextSeqNumber);
   Ptr<Packet> bar = 0;
-  AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
-  NS_ASSERT (it != m_agreements.end ());
+  Agreement *it = FindAgreement (recipient, tid);
+  NS_ASSERT (it != 0);
 
   uint16_t nextSeq;
   if (GetNRetryNeededPackets (recipient, tid) > 0)
@@ -713,13 +735,13 @@ BlockAckManager::NotifyMpduTransmission (Mac48Address recipient, uint8_t tid, ui
     {
       nextSeq = nextSeqNumber;
     }
-  it->second.first.NotifyMpduTransmission (nextSeq);
+  it->first.NotifyMpduTransmission (nextSeq);
   if (policy == WifiMacHeader::BLOCK_ACK)
     {
       bar = ScheduleBlockAckReqIfNeeded (recipient, tid);
       if (bar != 0)
         {
-          Bar request (bar, recipient, tid, it->second.first.IsImmediateBlockAck ());
+          Bar request (bar, recipient, tid, it->first.IsImmediateBlockAck ());
           m_bars.push_back (request);
         }
     }
@@ -789,10 +811,10 @@ BlockAckManager::GetNextPacketSize (void) const
 bool BlockAckManager::NeedBarRetransmission (uint8_t tid, uint16_t seqNumber, Mac48Address recipient)
 {
   //The standard says the BAR gets discarded when all MSDUs lifetime expires
-  AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
-  NS_ASSERT (it != m_agreements.end ());
+  Agreement *it = FindAgreement (recipient, tid);
+  NS_ASSERT (it != 0);
   CleanupBuffers ();
-  if ((seqNumber + 63) < it->second.first.GetStartingSequence ())
+  if ((seqNumber + 63) < it->first.GetStartingSequence ())
     {
       return false;
     }
@@ -806,15 +828,16 @@ void
 BlockAckManager::CleanupBuffers (void)
 {
   NS_LOG_FUNCTION (this);
-  for (AgreementsI j = m_agreements.begin (); j != m_agreements.end (); j++)
+  for (std::vector<Agreement *>::iterator k = m_agreementList.begin (); k != m_agreementList.end (); k++)
     {
-      if (j->second.second.empty ())
+      Agreement *j = *k;
+      if (j->second.empty ())
         {
           continue;
         }
       Time now = Simulator::Now ();
-      PacketQueueI end = j->second.second.begin ();
-      for (PacketQueueI i = j->second.second.begin (); i != j->second.second.end (); i++)
+      PacketQueueI end = j->second.begin ();
+      for (PacketQueueI i = j->second.begin (); i != j->second.end (); i++)
         {
           if (i->timestamp + m_maxDelay > now)
             {
@@ -826,8 +849,8 @@ BlockAckManager::CleanupBuffers (void)
               /* remove retry packet iterator if it's present in retry queue */
               for (std::list<PacketQueueI>::iterator it = m_retryPackets.begin (); it != m_retryPackets.end (); )
                 {
-                  if ((*it)->hdr.GetAddr1 () == j->second.first.GetPeer ()
-                      && (*it)->hdr.GetQosTid () == j->second.first.GetTid ()
+                  if ((*it)->hdr.GetAddr1 () == j->first.GetPeer ()
+                      && (*it)->hdr.GetQosTid () == j->first.GetTid ()
                       && (*it)->hdr.GetSequenceNumber () == i->hdr.GetSequenceNumber ())
                     {
                       it = m_retryPackets.erase (it);
@@ -839,8 +862,8 @@ BlockAckManager::CleanupBuffers (void)
                 }
             }
         }
-      j->second.second.erase (j->second.second.begin (), end);
-      j->second.first.SetStartingSequence (end->hdr.GetSequenceNumber ());
+      j->second.erase (j->second.begin (), end);
+      j->first.SetStartingSequence (end->hdr.GetSequenceNumber ());
     }
 }
 
@@ -21,9 +21,9 @@
 #ifndef BLOCK_ACK_MANAGER_H
 #define BLOCK_ACK_MANAGER_H
 
-#include <map>
 #include <list>
 #include <deque>
+#include <vector>
 #include "ns3/packet.h"
 #include "wifi-mac-header.h"
 #include "originator-block-ack-agreement.h"
@@ -31,6 +31,7 @@
 #include "qos-utils.h"
 #include "wifi-mode.h"
 #include "wifi-remote-station-manager.h"
+#include "mac-address-table.h"
 
 namespace ns3 {
 
@@ -383,20 +384,22 @@ private:
    */
   typedef std::list<Item>::const_iterator PacketQueueCI;
   /**
-   * typedef for a map between MAC address and block ACK agreement.
+   * typedef for a block ACK agreement and the packets sent under it.
    */
-  typedef std::map<std::pair<Mac48Address, uint8_t>,
-                   std::pair<OriginatorBlockAckAgreement, PacketQueue> > Agreements;
+  typedef std::pair<OriginatorBlockAckAgreement, PacketQueue> Agreement;
   /**
-   * typedef for an iterator for Agreements.
+   * The agreements with a recipient, by Traffic ID.
    */
-  typedef std::map<std::pair<Mac48Address, uint8_t>,
-                   std::pair<OriginatorBlockAckAgreement, PacketQueue> >::iterator AgreementsI;
+  struct PeerAgreements
+  {
+    Agreement *tids[16]; //!< the agreement of each TID, or 0
+  };
   /**
-   * typedef for a const iterator for Agreements.
+   * \param recipient the recipient of the agreement
+   * \param tid the Traffic ID of the agreement
+   * \return the agreement, or 0 if there is none
    */
-  typedef std::map<std::pair<Mac48Address, uint8_t>,
-                   std::pair<OriginatorBlockAckAgreement, PacketQueue> >::const_iterator AgreementsCI;
+  Agreement * FindAgreement (Mac48Address recipient, uint8_t tid) const;
 
   /**
    * A struct for packet, Wifi header, and timestamp.
@@ -426,7 +429,11 @@ private:
    * Every packet or fragment indicated as correctly received in block ack frame is
    * erased from this data structure. Pushed back in retransmission queue otherwise.
    */
-  Agreements m_agreements;
+  MacAddressTable<PeerAgreements> m_agreements;
+  /**
+   * The same agreements, to visit them all.
+   */
+  std::vector<Agreement *> m_agreementList;
 
   /**
    * This list contains all iterators to stored packets that need to be retransmitted.
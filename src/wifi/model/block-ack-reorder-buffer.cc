@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "block-ack-reorder-buffer.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BlockAckReorderBuffer");
+
+BlockAckReorderBuffer::BlockAckReorderBuffer ()
+  : m_mask (0),
+    m_winStart (0),
+    m_nMpdus (0)
+{
+}
+
+void
+BlockAckReorderBuffer::Init (uint16_t winStart, uint16_t bufferSize, ForwardUpCallback forwardUp)
+{
+  NS_LOG_FUNCTION (this << winStart << bufferSize);
+  uint16_t capacity = 1;
+  while (capacity < bufferSize && capacity < 2048)
+    {
+      capacity *= 2;
+    }
+  m_slots.clear ();
+  m_slots.resize (capacity);
+  for (std::vector<Slot>::iterator i = m_slots.begin (); i != m_slots.end (); i++)
+    {
+      // a single MPDU per MSDU, unless fragmented
+      i->reserve (1);
+    }
+  m_mask = capacity - 1;
+  m_winStart = winStart;
+  m_nMpdus = 0;
+  m_forwardUp = forwardUp;
+}
+
+BlockAckReorderBuffer::Slot &
+BlockAckReorderBuffer::GetSlot (uint16_t seq)
+{
+  return m_slots[seq & m_mask];
+}
+
+bool
+BlockAckReorderBuffer::IsComplete (const Slot &slot)
+{
+  if (slot.empty () || slot.back ().second.IsMoreFragments ())
+    {
+      return false;
+    }
+  // the fragments are sorted and unique: no gap if the last has the last number
+  return slot.back ().second.GetFragmentNumber () == slot.size () - 1;
+}
+
+void
+BlockAckReorderBuffer::Release (Slot &slot)
+{
+  if (IsComplete (slot))
+    {
+      for (Slot::iterator i = slot.begin (); i != slot.end (); i++)
+        {
+          m_forwardUp (i->first, &i->second, SdnLab::PacketContext ());
+        }
+    }
+  m_nMpdus -= slot.size ();
+  slot.clear ();
+}
+
+void
+BlockAckReorderBuffer::Store (Ptr<Packet> packet, const WifiMacHeader &hdr)
+{
+  NS_LOG_FUNCTION (this << packet << hdr.GetSequenceNumber () << (uint32_t)hdr.GetFragmentNumber ());
+  uint16_t seq = hdr.GetSequenceNumber ();
+  uint16_t offset = (seq - m_winStart + 4096) % 4096;
+  if (offset >= 2048)
+    {
+      NS_LOG_DEBUG ("old MPDU seq=" << seq << ", window start=" << m_winStart);
+      return;
+    }
+  if (offset > m_mask)
+    {
+      ForwardBefore ((seq - m_mask + 4096) % 4096);
+    }
+  Slot &slot = GetSlot (seq);
+  Slot::iterator i = slot.begin ();
+  while (i != slot.end () && i->second.GetFragmentNumber () < hdr.GetFragmentNumber ())
+    {
+      i++;
+    }
+  if (i != slot.end () && i->second.GetFragmentNumber () == hdr.GetFragmentNumber ())
+    {
+      NS_LOG_DEBUG ("duplicate MPDU seq=" << seq << ", frag=" << (uint32_t)hdr.GetFragmentNumber ());
+      return;
+    }
+  slot.insert (i, BufferedPacket (packet, hdr));
+  m_nMpdus++;
+}
+
+void
+BlockAckReorderBuffer::ForwardBefore (uint16_t seq)
+{
+  NS_LOG_FUNCTION (this << seq);
+  uint16_t n = (seq - m_winStart + 4096) % 4096;
+  if (n >= 2048)
+    {
+      // behind the window start: already done
+      return;
+    }
+  // only the slots of the window may hold MPDUs
+  uint16_t steps = std::min<uint16_t> (n, m_mask + 1);
+  for (uint16_t k = 0; k < steps && m_nMpdus > 0; k++)
+    {
+      Release (GetSlot ((m_winStart + k) % 4096));
+    }
+  m_winStart = seq;
+}
+
+uint16_t
+BlockAckReorderBuffer::ForwardInOrder (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (m_nMpdus > 0 && IsComplete (GetSlot (m_winStart)))
+    {
+      Release (GetSlot (m_winStart));
+      m_winStart = (m_winStart + 1) % 4096;
+    }
+  return m_winStart;
+}
+
+uint16_t
+BlockAckReorderBuffer::GetWinStart (void) const
+{
+  return m_winStart;
+}
+
+uint32_t
+BlockAckReorderBuffer::GetNMpdus (void) const
+{
+  return m_nMpdus;
+}
+
+} //namespace ns3
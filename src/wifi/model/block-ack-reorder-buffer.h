@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BLOCK_ACK_REORDER_BUFFER_H
+#define BLOCK_ACK_REORDER_BUFFER_H
+
+#include <stdint.h>
+#include <vector>
+#include <utility>
+#include "ns3/packet.h"
+#include "ns3/callback.h"
+#include "wifi-mac-header.h"
+
+// self-defined headers
+#include "Components/PacketContext.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * The reorder buffer of the recipient of a block ack agreement.
+ *
+ * The MPDUs are kept in a circular window of slots indexed by sequence
+ * number modulo the window capacity (the buffer size of the agreement
+ * rounded up to a power of two, so that the index follows the sequence
+ * number across its wrap around). A slot holds the fragments of one
+ * MSDU. The slots and their fragment arrays are allocated once, with
+ * the agreement, and reused by the following sequence numbers.
+ *
+ * The buffer has its own window start, the first sequence number not
+ * forwarded up yet. MPDUs older than it are discarded; an MPDU beyond
+ * the window moves it forward.
+ */
+class BlockAckReorderBuffer
+{
+public:
+  /**
+   * typedef for the callback which forwards the MPDUs up
+   */
+  typedef Callback<void, Ptr<Packet>, const WifiMacHeader*, SdnLab::PacketContext> ForwardUpCallback;
+
+  BlockAckReorderBuffer ();
+
+  /**
+   * Allocate the window.
+   *
+   * \param winStart the starting sequence number of the agreement
+   * \param bufferSize the buffer size of the agreement
+   * \param forwardUp the callback to forward the MPDUs up
+   */
+  void Init (uint16_t winStart, uint16_t bufferSize, ForwardUpCallback forwardUp);
+  /**
+   * Keep an MPDU until it can be forwarded in order.
+   *
+   * \param packet the MPDU, without its header and FCS
+   * \param hdr its header
+   */
+  void Store (Ptr<Packet> packet, const WifiMacHeader &hdr);
+  /**
+   * Forward up the complete MSDUs with a sequence number smaller than
+   * a given one and discard the incomplete ones: the window then starts
+   * at this sequence number (if it was behind).
+   *
+   * \param seq the sequence number
+   */
+  void ForwardBefore (uint16_t seq);
+  /**
+   * Forward up the complete MSDUs from the window start until the first
+   * missing or incomplete one.
+   *
+   * \return the new window start
+   */
+  uint16_t ForwardInOrder (void);
+  /**
+   * \return the window start
+   */
+  uint16_t GetWinStart (void) const;
+  /**
+   * \return the number of MPDUs (fragments) in the buffer
+   */
+  uint32_t GetNMpdus (void) const;
+
+
+private:
+  /**
+   * typedef for an MPDU waiting in the buffer
+   */
+  typedef std::pair<Ptr<Packet>, WifiMacHeader> BufferedPacket;
+  /**
+   * The fragments of the MSDU of a sequence number, by fragment number.
+   */
+  typedef std::vector<BufferedPacket> Slot;
+
+  /**
+   * \param seq a sequence number
+   * \return the slot of the sequence number
+   */
+  Slot & GetSlot (uint16_t seq);
+  /**
+   * \param slot a slot
+   * \return true if the slot holds all the fragments of its MSDU
+   */
+  static bool IsComplete (const Slot &slot);
+  /**
+   * Forward up the MSDU of a slot if it is complete, and empty it.
+   *
+   * \param slot the slot
+   */
+  void Release (Slot &slot);
+
+  std::vector<Slot> m_slots;      //!< the window
+  uint16_t m_mask;                //!< the number of slots minus one
+  uint16_t m_winStart;            //!< the first sequence number not forwarded
+  uint32_t m_nMpdus;              //!< the number of MPDUs in the window
+  ForwardUpCallback m_forwardUp;  //!< the callback to forward the MPDUs up
+};
+
+} //namespace ns3
+
+#endif /* BLOCK_ACK_REORDER_BUFFER_H */
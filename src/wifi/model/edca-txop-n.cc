@@ -497,13 +497,13 @@ EdcaTxopN::RemoveRetransmitPacket (uint8_t tid, Mac48Address recipient, uint16_t
 }
 
 void
-EdcaTxopN::SetaccessList (std::map<Mac48Address, bool> list)
+EdcaTxopN::SetaccessList (Ptr<const AidBitmap> list)
 {
     m_accessList = list;
 }
 
 void
-EdcaTxopN::SetsleepList (std::map<Mac48Address, bool> list)
+EdcaTxopN::SetsleepList (Ptr<const AidBitmap> list)
 {
     m_sleepList = list;
 }
@@ -518,8 +518,7 @@ EdcaTxopN::NotifyAccessGranted (void)
         return;
     }
    //NS_LOG_UNCOND ("EdcaTxopN::NotifyAccessGranted, " << Simulator::Now ()<< ", " << m_low->GetAddress ());
-    int newdata=99;
-    m_AccessQuest_record (Simulator::Now ().GetMicroSeconds (), newdata);
+    NotifyAccessQuest (99);
   if (m_currentPacket == 0)
     {
       if (m_queue->IsEmpty () && !m_baManager->HasPackets ())
@@ -554,7 +553,7 @@ EdcaTxopN::NotifyAccessGranted (void)
           
           //while (1)
            // {
-              if (!(!m_sleepList.find(m_currentHdr.GetAddr1())->second || m_sleepList.size ()== 0)) // "m_sleepList.size ()== 0" for non-ap stations
+              if (m_sleepList != 0 && m_sleepList->Test (AidBitmap::GetAid (m_currentHdr.GetAddr1 ()))) // no sleep list for non-ap stations
               // no sleep 
                 {
             	  return;
@@ -900,8 +899,7 @@ EdcaTxopN::GotAck (double snr, WifiMode txMode)
       || m_currentHdr.IsQosAmsdu ())
     {
       NS_LOG_DEBUG ("got ack. tx done.");
-      int newdata=77;
-      m_AccessQuest_record (Simulator::Now ().GetMicroSeconds (), newdata);
+      NotifyAccessQuest (77);
       if (!m_txOkCallback.IsNull ())
         {
           m_txOkCallback (m_currentHdr);
@@ -1106,6 +1104,15 @@ EdcaTxopN::AccessAllowedIfRaw (bool allowed)
     
 }
 
+void
+EdcaTxopN::NotifyAccessQuest (int event) const
+{
+  if (!m_AccessQuest_record.IsEmpty ())
+    {
+      m_AccessQuest_record (Simulator::Now ().GetMicroSeconds (), event);
+    }
+}
+
 void
 EdcaTxopN::RestartAccessIfNeeded (void)
 {
@@ -1116,8 +1123,7 @@ EdcaTxopN::RestartAccessIfNeeded (void)
       && AccessIfRaw)
     {
       m_manager->RequestAccess (m_dcf);
-        int newdata=10;
-        m_AccessQuest_record (Simulator::Now ().GetMicroSeconds (), newdata);
+      NotifyAccessQuest (10);
     }
 }
 
@@ -1130,8 +1136,7 @@ EdcaTxopN::StartAccessIfNeeded (void)
       && !m_dcf->IsAccessRequested ()
       && AccessIfRaw)    // always TRUE outside RAW
     {
-        int newdata=20;
-        m_AccessQuest_record (Simulator::Now ().GetMicroSeconds (), newdata);
+        NotifyAccessQuest (20);
         m_manager->RequestAccess (m_dcf);
     }
 }
@@ -1159,16 +1164,14 @@ EdcaTxopN::RawStart (Time duration, bool crossSlotBoundaryAllowed)
 
   //NS_LOG_DEBUG("RAW START, duration is " << duration);
 
-  int newdata=66;
-  m_AccessQuest_record (Simulator::Now ().GetMicroSeconds (), newdata);
+  NotifyAccessQuest (66);
 
   m_dcf->RawStart ();
   m_stationManager->RawStart ();
   m_dcf->StartBackoffNow (m_rng->GetNext (0, m_dcf->GetCw ()));
 	if ((!m_queue->IsEmpty () || m_baManager->HasPackets ()) && AccessIfRaw)
 	  {
-		int newdata=30;
-		m_AccessQuest_record (Simulator::Now ().GetMicroSeconds (), newdata);
+		NotifyAccessQuest (30);
 	  }
   StartAccessIfNeededRaw (); //access could start even no packet
   //RestartAccessIfNeeded();
@@ -32,6 +32,7 @@
 #include "dcf.h"
 #include "ctrl-headers.h"
 #include "block-ack-manager.h"
+#include "aid-bitmap.h"
 #include <map>
 #include <list>
 #include "ns3/traced-callback.h"
@@ -494,13 +495,26 @@ public:
   void RawStart (Time duration, bool crossSlotBoundaryAllowed);
   void OutsideRawStart (void);
   
-  void SetaccessList (std::map<Mac48Address, bool> list);
-  void SetsleepList (std::map<Mac48Address, bool> list);
+  /**
+   * \param list the stations (by AID) allowed to access the current RAW slot
+   */
+  void SetaccessList (Ptr<const AidBitmap> list);
+  /**
+   * \param list the stations (by AID) asleep in the current beacon interval,
+   *        0 if sleep is not tracked (non-AP stations)
+   */
+  void SetsleepList (Ptr<const AidBitmap> list);
 
 
 private:
     TracedCallback<double, double > m_AccessQuest_record;
     
+  /**
+   * Fire the AccessQuest trace, if it has sinks.
+   *
+   * \param event the code of the access event
+   */
+  void NotifyAccessQuest (int event) const;
   void DoInitialize ();
   /**
    * This functions are used only to correctly set addresses in a-msdu subframe.
@@ -596,12 +610,12 @@ private:
   struct Bar m_currentBar;
   bool m_ampduExist;
   
-  std::map<Mac48Address, bool> m_accessList;
+  Ptr<const AidBitmap> m_accessList;
   
   TracedCallback<uint32_t> m_collisionTrace;
   TracedCallback<Time,Time> m_transmissionWillCrossRAWBoundary;
 
-  std::map<Mac48Address, bool> m_sleepList;
+  Ptr<const AidBitmap> m_sleepList;
 };
 
 } //namespace ns3
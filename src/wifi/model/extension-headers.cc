@@ -29,6 +29,73 @@
 
 namespace ns3 {
 
+/***********************************************************
+ *          S1G Beacon Template
+ ***********************************************************/
+
+S1gBeaconTemplate::S1gBeaconTemplate (S1gBeaconCompatibility compatibility, const RPS &rps)
+  : m_compatibility (compatibility)
+{
+  Buffer buffer;
+  buffer.AddAtStart (compatibility.GetSerializedSize ());
+  compatibility.Serialize (buffer.Begin ());
+  m_compatibilityBytes.resize (buffer.GetSize ());
+  buffer.CopyData (&m_compatibilityBytes[0], buffer.GetSize ());
+
+  buffer = Buffer ();
+  buffer.AddAtStart (rps.GetSerializedSize ());
+  rps.Serialize (buffer.Begin ());
+  m_rpsBytes.resize (buffer.GetSize ());
+  buffer.CopyData (&m_rpsBytes[0], buffer.GetSize ());
+  m_rps.Deserialize (buffer.Begin ());
+  m_rpsHash = m_rps.GetHash ();
+}
+
+S1gBeaconCompatibility
+S1gBeaconTemplate::GetBeaconCompatibility (void) const
+{
+  return m_compatibility;
+}
+
+const RPS &
+S1gBeaconTemplate::GetRPS (void) const
+{
+  return m_rps;
+}
+
+uint64_t
+S1gBeaconTemplate::GetRpsHash (void) const
+{
+  return m_rpsHash;
+}
+
+uint32_t
+S1gBeaconTemplate::GetCompatibilitySize (void) const
+{
+  return m_compatibilityBytes.size ();
+}
+
+uint32_t
+S1gBeaconTemplate::GetRpsSize (void) const
+{
+  return m_rpsBytes.size ();
+}
+
+Buffer::Iterator
+S1gBeaconTemplate::SerializeCompatibility (Buffer::Iterator i) const
+{
+  i.Write (&m_compatibilityBytes[0], m_compatibilityBytes.size ());
+  return i;
+}
+
+Buffer::Iterator
+S1gBeaconTemplate::SerializeRPS (Buffer::Iterator i) const
+{
+  i.Write (&m_rpsBytes[0], m_rpsBytes.size ());
+  return i;
+}
+
+
 /***********************************************************
  *          S1G Beacon Frame
  ***********************************************************/
@@ -104,6 +171,12 @@ S1gBeaconHeader::SetAuthCtrl (AuthenticationCtrl auth)
    m_auth = auth;
 }
 
+void
+S1gBeaconHeader::SetTemplate (Ptr<const S1gBeaconTemplate> beaconTemplate)
+{
+  m_template = beaconTemplate;
+}
+
 /*
 Mac48Address
 S1gBeaconHeader::GetSA (void) const
@@ -144,6 +217,10 @@ S1gBeaconHeader::GetAccessNetwork (void) const
 S1gBeaconCompatibility
 S1gBeaconHeader::GetBeaconCompatibility (void) const
 {
+  if (m_template != 0)
+    {
+      return m_template->GetBeaconCompatibility ();
+    }
   return m_beaconcompatibility;
 }
 
@@ -162,8 +239,22 @@ S1gBeaconHeader::GetpageSlice (void) const
 RPS
 S1gBeaconHeader::GetRPS (void) const
 {
+  if (m_template != 0)
+    {
+      return m_template->GetRPS ();
+    }
   return m_rps;
 }
+
+uint64_t
+S1gBeaconHeader::GetRpsHash (void) const
+{
+  if (m_template != 0)
+    {
+      return m_template->GetRpsHash ();
+    }
+  return m_rps.GetHash ();
+}
     
 AuthenticationCtrl
 S1gBeaconHeader::GetAuthCtrl (void) const
@@ -205,9 +296,18 @@ S1gBeaconHeader::GetSerializedSize (void) const
   size += 3; // Next TBTT
   size += 4; // Compressed SSID
   size += 1; // Access Network
-  size += m_beaconcompatibility.GetSerializedSize ();
-  size += m_tim.GetSerializedSize ();
-  size += m_rps.GetSerializedSize ();
+  if (m_template != 0)
+    {
+      size += m_template->GetCompatibilitySize ();
+      size += m_tim.GetSerializedSize ();
+      size += m_template->GetRpsSize ();
+    }
+  else
+    {
+      size += m_beaconcompatibility.GetSerializedSize ();
+      size += m_tim.GetSerializedSize ();
+      size += m_rps.GetSerializedSize ();
+    }
   if (!m_tim.GetDTIMCount())
 	  size += m_pageSlice.GetSerializedSize ();
   size += m_auth.GetSerializedSize ();
@@ -230,9 +330,18 @@ S1gBeaconHeader::Serialize (Buffer::Iterator start) const
     
     i.WriteHtolsbU32 (m_compressedssid);
     i.WriteU8 (m_accessnetwork);
-    i = m_beaconcompatibility.Serialize (i);
-    i = m_tim.Serialize (i);
-    i = m_rps.Serialize (i);
+    if (m_template != 0)
+      {
+        i = m_template->SerializeCompatibility (i);
+        i = m_tim.Serialize (i);
+        i = m_template->SerializeRPS (i);
+      }
+    else
+      {
+        i = m_beaconcompatibility.Serialize (i);
+        i = m_tim.Serialize (i);
+        i = m_rps.Serialize (i);
+      }
     if (!m_tim.GetDTIMCount())
     	i = m_pageSlice.Serialize (i);
     i = m_auth.Serialize (i);
@@ -252,6 +361,7 @@ S1gBeaconHeader::Deserialize (Buffer::Iterator start)
     
     m_compressedssid = i.ReadLsbtohU32 ();
     m_accessnetwork = i.ReadU8 ();
+    m_template = 0;
     i = m_beaconcompatibility.Deserialize (i);
     i = m_tim.Deserialize (i);
     i = m_rps.Deserialize (i);
@@ -24,9 +24,12 @@
 #define EXTENSION_HEADERS_H
 
 #include <stdint.h>
+#include <vector>
 
 #include "ns3/header.h"
 #include "ns3/mac48-address.h"
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
 #include "s1g-beacon-compatibility.h"
 #include "tim.h"
 #include "rps.h"
@@ -35,6 +38,54 @@
 
 namespace ns3 {
 
+/**
+ * \ingroup wifi
+ *
+ * The pre-serialized elements of the S1G beacons sent with one RPS.
+ *
+ * The S1G Beacon Compatibility and RPS elements only change with the RAW
+ * configuration, so the AP serializes them once per RPS and every beacon
+ * copies their bytes. Only the fixed fields and the TIM, page slice and
+ * authentication control elements are serialized per beacon.
+ */
+class S1gBeaconTemplate : public SimpleRefCount<S1gBeaconTemplate>
+{
+public:
+  /**
+   * \param compatibility the S1G Beacon Compatibility element
+   * \param rps the RPS element
+   */
+  S1gBeaconTemplate (S1gBeaconCompatibility compatibility, const RPS &rps);
+
+  S1gBeaconCompatibility GetBeaconCompatibility (void) const;
+  /**
+   * \return the RPS element, decoded from the template bytes
+   */
+  const RPS & GetRPS (void) const;
+  /**
+   * \return the hash of the RPS element (RPS::GetHash)
+   */
+  uint64_t GetRpsHash (void) const;
+
+  /**
+   * \return the size of the serialized S1G Beacon Compatibility element
+   */
+  uint32_t GetCompatibilitySize (void) const;
+  /**
+   * \return the size of the serialized RPS element
+   */
+  uint32_t GetRpsSize (void) const;
+  Buffer::Iterator SerializeCompatibility (Buffer::Iterator i) const;
+  Buffer::Iterator SerializeRPS (Buffer::Iterator i) const;
+
+private:
+  S1gBeaconCompatibility m_compatibility;
+  RPS m_rps;                                //!< owns its RAW Assignments, unlike a copy
+  std::vector<uint8_t> m_compatibilityBytes;
+  std::vector<uint8_t> m_rpsBytes;
+  uint64_t m_rpsHash;
+};
+
 /**
  * \ingroup wifi
  * Implement the header for extension frames of type S1G beacon .
@@ -55,6 +106,13 @@ public:
   void SetpageSlice (pageSlice page);
   void SetRPS (RPS rps);
   void SetAuthCtrl (AuthenticationCtrl auth);
+  /**
+   * Take the S1G Beacon Compatibility and RPS elements from a template
+   * instead of SetBeaconCompatibility and SetRPS.
+   *
+   * \param beaconTemplate the pre-serialized elements
+   */
+  void SetTemplate (Ptr<const S1gBeaconTemplate> beaconTemplate);
 
   //Mac48Address GetSA (void) const;
   uint32_t GetTimeStamp (void) const;
@@ -67,6 +125,11 @@ public:
   pageSlice GetpageSlice (void) const;
   RPS GetRPS (void) const;
   AuthenticationCtrl GetAuthCtrl (void) const;
+  /**
+   * \return the hash of the RPS element, to detect an unchanged RAW configuration
+   *         without decoding it
+   */
+  uint64_t GetRpsHash (void) const;
     
   static TypeId GetTypeId (void);
   virtual TypeId GetInstanceTypeId (void) const;
@@ -87,6 +150,7 @@ private:
   RPS m_rps;
   pageSlice m_pageSlice;
   AuthenticationCtrl  m_auth;
+  Ptr<const S1gBeaconTemplate> m_template; //!< replaces m_beaconcompatibility and m_rps if set
 };
 
 
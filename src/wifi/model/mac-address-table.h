@@ -0,0 +1,316 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MAC_ADDRESS_TABLE_H
+#define MAC_ADDRESS_TABLE_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/mac48-address.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * A flat hash table from a peer MAC address to its state.
+ *
+ * The values are stored by value, contiguously, in insertion order
+ * (erasing moves the last value into the hole), and an open-addressing
+ * index of (address, position) slots, probed linearly, locates them. A
+ * lookup thus hashes the address and reads one or two cache lines, where
+ * a std::map walks log(n) nodes.
+ *
+ * Inserting or erasing an entry may move the other values: pointers
+ * returned by Find and Get are only valid until the next insertion or
+ * erasure.
+ */
+template <typename T>
+class MacAddressTable
+{
+public:
+  /** An entry: a peer address and its value. */
+  struct Entry
+  {
+    Mac48Address address; //!< the peer address
+    T value;              //!< the peer state
+  };
+  /** Iterator over the entries, in insertion order. */
+  typedef typename std::vector<Entry>::iterator Iterator;
+  /** Const iterator over the entries, in insertion order. */
+  typedef typename std::vector<Entry>::const_iterator ConstIterator;
+
+  MacAddressTable ()
+    : m_mask (0)
+  {
+  }
+
+  /**
+   * Size the table for a number of entries, so that it does not grow
+   * until it holds more.
+   *
+   * \param n the expected number of entries
+   */
+  void Reserve (uint32_t n)
+  {
+    m_entries.reserve (n);
+    uint32_t size = 8;
+    while (size < 2 * n)
+      {
+        size *= 2;
+      }
+    if (size > m_slots.size ())
+      {
+        Rehash (size);
+      }
+  }
+  /**
+   * \param address the peer address
+   * \return the value of the peer, or 0 if it has none
+   */
+  T * Find (Mac48Address address)
+  {
+    int32_t i = FindIndex (address);
+    return i < 0 ? 0 : &m_entries[i].value;
+  }
+  /**
+   * \param address the peer address
+   * \return the value of the peer, or 0 if it has none
+   */
+  const T * Find (Mac48Address address) const
+  {
+    int32_t i = FindIndex (address);
+    return i < 0 ? 0 : &m_entries[i].value;
+  }
+  /**
+   * \param address the peer address
+   * \return the value of the peer, default-constructed if it had none
+   */
+  T & Get (Mac48Address address)
+  {
+    uint64_t key = GetKey (address);
+    if (m_slots.empty ())
+      {
+        Rehash (8);
+      }
+    uint32_t s = Home (key);
+    while (m_slots[s].position != EMPTY)
+      {
+        if (m_slots[s].key == key)
+          {
+            return m_entries[m_slots[s].position].value;
+          }
+        s = (s + 1) & m_mask;
+      }
+    if (2 * (m_entries.size () + 1) > m_slots.size ())
+      {
+        Rehash (2 * m_slots.size ());
+        s = Home (key);
+        while (m_slots[s].position != EMPTY)
+          {
+            s = (s + 1) & m_mask;
+          }
+      }
+    m_slots[s].key = key;
+    m_slots[s].position = m_entries.size ();
+    Entry entry;
+    entry.address = address;
+    entry.value = T ();
+    m_entries.push_back (entry);
+    return m_entries.back ().value;
+  }
+  /**
+   * \param address the peer address
+   * \return true if the peer had a value, which is now erased
+   */
+  bool Erase (Mac48Address address)
+  {
+    uint64_t key = GetKey (address);
+    int32_t s = FindSlot (key);
+    if (s < 0)
+      {
+        return false;
+      }
+    uint32_t position = m_slots[s].position;
+    uint32_t last = m_entries.size () - 1;
+    if (position != last)
+      {
+        // the last entry fills the hole
+        m_slots[FindSlot (GetKey (m_entries[last].address))].position = position;
+        m_entries[position] = m_entries[last];
+      }
+    m_entries.pop_back ();
+    // shift back the following slots of the cluster which may not be
+    // found any more past the hole
+    uint32_t hole = s;
+    uint32_t next = (hole + 1) & m_mask;
+    while (m_slots[next].position != EMPTY)
+      {
+        uint32_t home = Home (m_slots[next].key);
+        if (((next - home) & m_mask) >= ((next - hole) & m_mask))
+          {
+            m_slots[hole] = m_slots[next];
+            hole = next;
+          }
+        next = (next + 1) & m_mask;
+      }
+    m_slots[hole].position = EMPTY;
+    return true;
+  }
+  /** Erase all the entries, keeping the allocated storage. */
+  void Clear (void)
+  {
+    m_entries.clear ();
+    for (typename std::vector<Slot>::iterator i = m_slots.begin (); i != m_slots.end (); i++)
+      {
+        i->position = EMPTY;
+      }
+  }
+  /**
+   * \return the number of entries
+   */
+  uint32_t GetSize (void) const
+  {
+    return m_entries.size ();
+  }
+  /**
+   * \return an iterator to the first entry
+   */
+  Iterator Begin (void)
+  {
+    return m_entries.begin ();
+  }
+  /**
+   * \return an iterator past the last entry
+   */
+  Iterator End (void)
+  {
+    return m_entries.end ();
+  }
+  /**
+   * \return an iterator to the first entry
+   */
+  ConstIterator Begin (void) const
+  {
+    return m_entries.begin ();
+  }
+  /**
+   * \return an iterator past the last entry
+   */
+  ConstIterator End (void) const
+  {
+    return m_entries.end ();
+  }
+
+private:
+  /** An index slot. */
+  struct Slot
+  {
+    uint64_t key;      //!< the address, as an integer
+    uint32_t position; //!< the position of the entry, or EMPTY
+  };
+  /** The position of an empty slot. */
+  static const uint32_t EMPTY = 0xffffffff;
+
+  /**
+   * \param address a MAC address
+   * \return the address as an integer
+   */
+  static uint64_t GetKey (Mac48Address address)
+  {
+    uint8_t buffer[6];
+    address.CopyTo (buffer);
+    uint64_t key = 0;
+    for (uint32_t i = 0; i < 6; i++)
+      {
+        key = (key << 8) | buffer[i];
+      }
+    return key;
+  }
+  /**
+   * \param key an address key
+   * \return the first slot probed for the key
+   */
+  uint32_t Home (uint64_t key) const
+  {
+    // Fibonacci hashing: allocated addresses only differ in their last bytes
+    return ((key * 0x9e3779b97f4a7c15ULL) >> 32) & m_mask;
+  }
+  /**
+   * \param key an address key
+   * \return the slot of the key, or -1
+   */
+  int32_t FindSlot (uint64_t key) const
+  {
+    if (m_slots.empty ())
+      {
+        return -1;
+      }
+    uint32_t s = Home (key);
+    while (m_slots[s].position != EMPTY)
+      {
+        if (m_slots[s].key == key)
+          {
+            return s;
+          }
+        s = (s + 1) & m_mask;
+      }
+    return -1;
+  }
+  /**
+   * \param address a MAC address
+   * \return the position of the entry of the address, or -1
+   */
+  int32_t FindIndex (Mac48Address address) const
+  {
+    int32_t s = FindSlot (GetKey (address));
+    return s < 0 ? -1 : (int32_t)m_slots[s].position;
+  }
+  /**
+   * Rebuild the index with a number of slots.
+   *
+   * \param size the number of slots, a power of two
+   */
+  void Rehash (uint32_t size)
+  {
+    NS_ASSERT ((size & (size - 1)) == 0);
+    Slot empty;
+    empty.key = 0;
+    empty.position = EMPTY;
+    m_slots.assign (size, empty);
+    m_mask = size - 1;
+    for (uint32_t i = 0; i < m_entries.size (); i++)
+      {
+        uint64_t key = GetKey (m_entries[i].address);
+        uint32_t s = Home (key);
+        while (m_slots[s].position != EMPTY)
+          {
+            s = (s + 1) & m_mask;
+          }
+        m_slots[s].key = key;
+        m_slots[s].position = i;
+      }
+  }
+
+  std::vector<Entry> m_entries; //!< the entries, contiguous
+  std::vector<Slot> m_slots;    //!< the index, at most half full
+  uint32_t m_mask;              //!< the number of slots minus one
+};
+
+} //namespace ns3
+
+#endif /* MAC_ADDRESS_TABLE_H */
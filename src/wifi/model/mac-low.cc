@@ -462,6 +462,14 @@ MacLow::DoDispose (void)
       m_phyMacLowListener = 0;
     }
   m_mpduAggregator = 0;
+  for (MacAddressTable<PeerAgreements>::Iterator i = m_bAckAgreements.Begin (); i != m_bAckAgreements.End (); i++)
+    {
+      for (uint8_t tid = 0; tid < 16; tid++)
+        {
+          delete i->value.tids[tid];
+        }
+    }
+  m_bAckAgreements.Clear ();
   m_sentMpdus = 0;
   m_aggregateQueue = 0;
   m_ampdu = false;
@@ -881,10 +889,10 @@ MacLow::ReceiveError (Ptr<const Packet> packet, double rxSnr)
 
   if (isInAmpdu && m_receivedAtLeastOneMpdu && (ampdu.GetNoOfMpdus () == 1))
     {
-      MpduAggregator::DeaggregatedMpdus packets = MpduAggregator::Deaggregate (pkt);
-      MpduAggregator::DeaggregatedMpdusCI n = packets.begin ();
+      AmpduSubframeHeader subframeHdr;
+      Ptr<Packet> mpdu = MpduAggregator::RemoveSubframe (pkt, &subframeHdr);
       WifiMacHeader hdr;
-      (*n).first->PeekHeader (hdr);
+      mpdu->PeekHeader (hdr);
       if (hdr.IsQosData ())
         {
           NS_LOG_DEBUG ("last a-mpdu subframe detected/sendImmediateBlockAck from=" << hdr.GetAddr2 ());
@@ -1084,18 +1092,16 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
       if (!blockAckReq.IsMultiTid ())
         {
           uint8_t tid = blockAckReq.GetTidInfo ();
-          AgreementsI it = m_bAckAgreements.find (std::make_pair (hdr.GetAddr2 (), tid));
-          if (it != m_bAckAgreements.end ())
+          RecipientAgreement *agreement = FindAgreement (hdr.GetAddr2 (), tid);
+          if (agreement != 0)
             {
               //Update block ack cache
-              BlockAckCachesI i = m_bAckCaches.find (std::make_pair (hdr.GetAddr2 (), tid));
-              NS_ASSERT (i != m_bAckCaches.end ());
-              (*i).second.UpdateWithBlockAckReq (blockAckReq.GetStartingSequence ());
+              agreement->cache.UpdateWithBlockAckReq (blockAckReq.GetStartingSequence ());
 
               NS_ASSERT (m_sendAckEvent.IsExpired ());
               /* See section 11.5.3 in IEEE 802.11 for mean of this timer */
-              ResetBlockAckInactivityTimerIfNeeded (it->second.first);
-              if ((*it).second.first.IsImmediateBlockAck ())
+              ResetBlockAckInactivityTimerIfNeeded (agreement->agreement);
+              if (agreement->agreement.IsImmediateBlockAck ())
                 {
                   NS_LOG_DEBUG ("rx blockAckRequest/sendImmediateBlockAck from=" << hdr.GetAddr2 ());
                   m_sendAckEvent = Simulator::Schedule (GetSifs (),
@@ -1140,9 +1146,9 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
           if (hdr.IsQosAck () && !ampduSubframe)
             {
               NS_LOG_DEBUG ("rx QoS unicast/sendAck from=" << hdr.GetAddr2 ());
-              AgreementsI it = m_bAckAgreements.find (std::make_pair (hdr.GetAddr2 (), hdr.GetQosTid ()));
+              RecipientAgreement *agreement = FindAgreement (hdr.GetAddr2 (), hdr.GetQosTid ());
 
-              RxCompleteBufferedPacketsWithSmallerSequence (it->second.first.GetStartingSequence (),
+              RxCompleteBufferedPacketsWithSmallerSequence (agreement->agreement.GetStartingSequence (),
                                                             hdr.GetAddr2 (), hdr.GetQosTid ());
               RxCompleteBufferedPacketsUntilFirstLost (hdr.GetAddr2 (), hdr.GetQosTid ());
               NS_ASSERT (m_sendAckEvent.IsExpired ());
@@ -1156,9 +1162,9 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
             }
           else if (hdr.IsQosBlockAck ())
             {
-              AgreementsI it = m_bAckAgreements.find (std::make_pair (hdr.GetAddr2 (), hdr.GetQosTid ()));
+              RecipientAgreement *agreement = FindAgreement (hdr.GetAddr2 (), hdr.GetQosTid ());
               /* See section 11.5.3 in IEEE 802.11 for mean of this timer */
-              ResetBlockAckInactivityTimerIfNeeded (it->second.first);
+              ResetBlockAckInactivityTimerIfNeeded (agreement->agreement);
             }
           return;
         }
@@ -2468,28 +2474,29 @@ MacLow::ReceiveMpdu (Ptr<Packet> packet, WifiMacHeader hdr)
           tid = hdr.GetQosTid ();
         }
       uint16_t seqNumber = hdr.GetSequenceNumber ();
-      AgreementsI it = m_bAckAgreements.find (std::make_pair (originator, tid));
-      if (it != m_bAckAgreements.end ())
+      RecipientAgreement *recipient = FindAgreement (originator, tid);
+      if (recipient != 0)
         {
+          BlockAckAgreement &agreement = recipient->agreement;
           //Implement HT immediate Block Ack support for HT Delayed Block Ack is not added yet
-          if (!QosUtilsIsOldPacket ((*it).second.first.GetStartingSequence (), seqNumber))
+          if (!QosUtilsIsOldPacket (agreement.GetStartingSequence (), seqNumber))
             {
               StoreMpduIfNeeded (packet, hdr);
-              if (!IsInWindow (hdr.GetSequenceNumber (), (*it).second.first.GetStartingSequence (), (*it).second.first.GetBufferSize ()))
+              if (!IsInWindow (hdr.GetSequenceNumber (), agreement.GetStartingSequence (), agreement.GetBufferSize ()))
                 {
-                  uint16_t delta = (seqNumber - (*it).second.first.GetWinEnd () + 4096) % 4096;
+                  uint16_t delta = (seqNumber - agreement.GetWinEnd () + 4096) % 4096;
                   if (delta > 1)
                     {
-                      (*it).second.first.SetWinEnd (seqNumber);
-                      int16_t winEnd = (*it).second.first.GetWinEnd ();
-                      int16_t bufferSize = (*it).second.first.GetBufferSize ();
+                      agreement.SetWinEnd (seqNumber);
+                      int16_t winEnd = agreement.GetWinEnd ();
+                      int16_t bufferSize = agreement.GetBufferSize ();
                       uint16_t sum = ((uint16_t)(std::abs (winEnd - bufferSize + 1))) % 4096;
-                      (*it).second.first.SetStartingSequence (sum);
-                      RxCompleteBufferedPacketsWithSmallerSequence ((*it).second.first.GetStartingSequence (), originator, tid);
+                      agreement.SetStartingSequence (sum);
+                      RxCompleteBufferedPacketsWithSmallerSequence (agreement.GetStartingSequence (), originator, tid);
                     }
                 }
               RxCompleteBufferedPacketsUntilFirstLost (originator, tid); //forwards up packets starting from winstart and set winstart to last +1
-              (*it).second.first.SetWinEnd (((*it).second.first.GetStartingSequence () + (*it).second.first.GetBufferSize () - 1) % 4096);
+              agreement.SetWinEnd ((agreement.GetStartingSequence () + agreement.GetBufferSize () - 1) % 4096);
             }
           return true;
         }
@@ -2504,32 +2511,36 @@ MacLow::ReceiveMpdu (Ptr<Packet> packet, WifiMacHeader hdr)
 bool
 MacLow::StoreMpduIfNeeded (Ptr<Packet> packet, WifiMacHeader hdr)
 {
-  AgreementsI it = m_bAckAgreements.find (std::make_pair (hdr.GetAddr2 (), hdr.GetQosTid ()));
-  if (it != m_bAckAgreements.end ())
+  RecipientAgreement *agreement = FindAgreement (hdr.GetAddr2 (), hdr.GetQosTid ());
+  if (agreement != 0)
     {
       WifiMacTrailer fcs;
       packet->RemoveTrailer (fcs);
-      BufferedPacket bufferedPacket (packet, hdr);
-
-      uint16_t endSequence = ((*it).second.first.GetStartingSequence () + 2047) % 4096;
-      uint16_t mappedSeqControl = QosUtilsMapSeqControlToUniqueInteger (hdr.GetSequenceControl (), endSequence);
-
-      BufferedPacketI i = (*it).second.second.begin ();
-      for (; i != (*it).second.second.end ()
-           && QosUtilsMapSeqControlToUniqueInteger ((*i).second.GetSequenceControl (), endSequence) < mappedSeqControl; i++)
-        {
-        }
-      (*it).second.second.insert (i, bufferedPacket);
+      agreement->buffer.Store (packet, hdr);
 
       //Update block ack cache
-      BlockAckCachesI j = m_bAckCaches.find (std::make_pair (hdr.GetAddr2 (), hdr.GetQosTid ()));
-      NS_ASSERT (j != m_bAckCaches.end ());
-      (*j).second.UpdateWithMpdu (&hdr);
+      agreement->cache.UpdateWithMpdu (&hdr);
       return true;
     }
   return false;
 }
 
+MacLow::RecipientAgreement::RecipientAgreement (Mac48Address originator, uint8_t tid)
+  : agreement (originator, tid)
+{
+}
+
+MacLow::RecipientAgreement *
+MacLow::FindAgreement (Mac48Address originator, uint8_t tid) const
+{
+  const PeerAgreements *peer = m_bAckAgreements.Find (originator);
+  if (peer == 0 || tid >= 16)
+    {
+      return 0;
+    }
+  return peer->tids[tid];
+}
+
 void
 MacLow::CreateBlockAckAgreement (const MgtAddBaResponseHeader *respHdr, Mac48Address originator,
                                  uint16_t startingSeq)
@@ -2549,23 +2560,27 @@ MacLow::CreateBlockAckAgreement (const MgtAddBaResponseHeader *respHdr, Mac48Add
   agreement.SetTimeout (respHdr->GetTimeout ());
   agreement.SetStartingSequence (startingSeq);
 
-  std::list<BufferedPacket> buffer (0);
-  AgreementKey key (originator, respHdr->GetTid ());
-  AgreementValue value (agreement, buffer);
-  m_bAckAgreements.insert (std::make_pair (key, value));
-
-  BlockAckCache cache;
-  cache.Init (startingSeq, respHdr->GetBufferSize () + 1);
-  m_bAckCaches.insert (std::make_pair (key, cache));
+  RecipientAgreement *former = FindAgreement (originator, tid);
+  if (former != 0)
+    {
+      // a renewed agreement replaces the former one
+      former->agreement.m_inactivityEvent.Cancel ();
+      DestroyBlockAckAgreement (originator, tid);
+    }
+  RecipientAgreement *recipient = new RecipientAgreement (originator, tid);
+  recipient->agreement = agreement;
+  recipient->cache.Init (startingSeq, respHdr->GetBufferSize () + 1);
+  recipient->buffer.Init (startingSeq, agreement.GetBufferSize (), m_rxCallback);
+  NS_ASSERT (tid < 16);
+  m_bAckAgreements.Get (originator).tids[tid] = recipient;
 
   if (respHdr->GetTimeout () != 0)
     {
-      AgreementsI it = m_bAckAgreements.find (std::make_pair (originator, respHdr->GetTid ()));
       Time timeout = MicroSeconds (1024 * agreement.GetTimeout ());
 
       AcIndex ac = QosUtilsMapTidToAc (agreement.GetTid ());
 
-      it->second.first.m_inactivityEvent = Simulator::Schedule (timeout,
+      recipient->agreement.m_inactivityEvent = Simulator::Schedule (timeout,
                                                                 &MacLowAggregationCapableTransmissionListener::BlockAckInactivityTimeout,
                                                                 m_edcaListeners[ac],
                                                                 originator, tid);
@@ -2575,113 +2590,36 @@ MacLow::CreateBlockAckAgreement (const MgtAddBaResponseHeader *respHdr, Mac48Add
 void
 MacLow::DestroyBlockAckAgreement (Mac48Address originator, uint8_t tid)
 {
-  AgreementsI it = m_bAckAgreements.find (std::make_pair (originator, tid));
-  if (it != m_bAckAgreements.end ())
+  RecipientAgreement *agreement = FindAgreement (originator, tid);
+  if (agreement != 0)
     {
-      RxCompleteBufferedPacketsWithSmallerSequence (it->second.first.GetStartingSequence (), originator, tid);
+      RxCompleteBufferedPacketsWithSmallerSequence (agreement->agreement.GetStartingSequence (), originator, tid);
       RxCompleteBufferedPacketsUntilFirstLost (originator, tid);
-      m_bAckAgreements.erase (it);
-
-      BlockAckCachesI i = m_bAckCaches.find (std::make_pair (originator, tid));
-      NS_ASSERT (i != m_bAckCaches.end ());
-      m_bAckCaches.erase (i);
+      m_bAckAgreements.Find (originator)->tids[tid] = 0;
+      delete agreement;
     }
 }
 
 void
 MacLow::RxCompleteBufferedPacketsWithSmallerSequence (uint16_t seq, Mac48Address originator, uint8_t tid)
 {
-  AgreementsI it = m_bAckAgreements.find (std::make_pair (originator, tid));
-  if (it != m_bAckAgreements.end ())
+  RecipientAgreement *agreement = FindAgreement (originator, tid);
+  if (agreement != 0)
     {
-      uint16_t endSequence = ((*it).second.first.GetStartingSequence () + 2047) % 4096;
-      uint16_t mappedStart = QosUtilsMapSeqControlToUniqueInteger (seq, endSequence);
-      BufferedPacketI last = (*it).second.second.begin ();
-      uint16_t guard = 0;
-      if (last != (*it).second.second.end ())
-        {
-          guard = (*it).second.second.begin ()->second.GetSequenceControl () & 0xfff0;
-        }
-      BufferedPacketI i = (*it).second.second.begin ();
-      for (; i != (*it).second.second.end ()
-           && QosUtilsMapSeqControlToUniqueInteger ((*i).second.GetSequenceNumber (), endSequence) < mappedStart; )
-        {
-          if (guard == (*i).second.GetSequenceControl ())
-            {
-              if (!(*i).second.IsMoreFragments ())
-                {
-                  while (last != i)
-                    {
-                      m_rxCallback ((*last).first, &(*last).second, PacketContext());
-                      last++;
-                    }
-                  m_rxCallback ((*last).first, &(*last).second, PacketContext());
-                  last++;
-                  /* go to next packet */
-                  while (i != (*it).second.second.end () && ((guard >> 4) & 0x0fff) == (*i).second.GetSequenceNumber ())
-                    {
-                      i++;
-                    }
-                  if (i != (*it).second.second.end ())
-                    {
-                      guard = (*i).second.GetSequenceControl () & 0xfff0;
-                      last = i;
-                    }
-                }
-              else
-                {
-                  guard++;
-                }
-            }
-          else
-            {
-              /* go to next packet */
-              while (i != (*it).second.second.end () && ((guard >> 4) & 0x0fff) == (*i).second.GetSequenceNumber ())
-                {
-                  i++;
-                }
-              if (i != (*it).second.second.end ())
-                {
-                  guard = (*i).second.GetSequenceControl () & 0xfff0;
-                  last = i;
-                }
-            }
-        }
-      (*it).second.second.erase ((*it).second.second.begin (), i);
+      agreement->buffer.ForwardBefore (seq);
     }
 }
 
 void
 MacLow::RxCompleteBufferedPacketsUntilFirstLost (Mac48Address originator, uint8_t tid)
 {
-  AgreementsI it = m_bAckAgreements.find (std::make_pair (originator, tid));
-  if (it != m_bAckAgreements.end ())
+  RecipientAgreement *agreement = FindAgreement (originator, tid);
+  if (agreement != 0)
     {
-      uint16_t startingSeqCtrl = ((*it).second.first.GetStartingSequence () << 4) & 0xfff0;
-      uint16_t guard = startingSeqCtrl;
-
-      BufferedPacketI lastComplete = (*it).second.second.begin ();
-      BufferedPacketI i = (*it).second.second.begin ();
-      for (; i != (*it).second.second.end () && guard == (*i).second.GetSequenceControl (); i++)
-        {
-          if (!(*i).second.IsMoreFragments ())
-            {
-              while (lastComplete != i)
-                {
-                  m_rxCallback ((*lastComplete).first, &(*lastComplete).second, PacketContext());
-                  lastComplete++;
-                }
-              m_rxCallback ((*lastComplete).first, &(*lastComplete).second, PacketContext());
-              lastComplete++;
-            }
-          guard = (*i).second.IsMoreFragments () ? (guard + 1) : ((guard + 16) & 0xfff0);
-        }
-      (*it).second.first.SetStartingSequence ((guard >> 4) & 0x0fff);
-      /* All packets already forwarded to WifiMac must be removed from buffer:
-      [begin (), lastComplete) */
-      (*it).second.second.erase ((*it).second.second.begin (), lastComplete);
+      agreement->agreement.SetStartingSequence (agreement->buffer.ForwardInOrder ());
     }
 }
+
 void
 MacLow::SendBlockAckResponse (const CtrlBAckResponseHeader* blockAck, Mac48Address originator, bool immediate,
                               Time duration, WifiMode blockAckReqTxMode)
@@ -2762,18 +2700,17 @@ MacLow::SendBlockAckAfterAmpdu (uint8_t tid, Mac48Address originator, Time durat
   NS_LOG_FUNCTION (this);
   CtrlBAckResponseHeader blockAck;
   uint16_t seqNumber = 0;
-  BlockAckCachesI i = m_bAckCaches.find (std::make_pair (originator, tid));
-  NS_ASSERT (i != m_bAckCaches.end ());
-  seqNumber = (*i).second.GetWinStart ();
+  RecipientAgreement *agreement = FindAgreement (originator, tid);
+  NS_ASSERT (agreement != 0);
+  seqNumber = agreement->cache.GetWinStart ();
 
   bool immediate = true;
-  AgreementsI it = m_bAckAgreements.find (std::make_pair (originator, tid));
   blockAck.SetStartingSequence (seqNumber);
   blockAck.SetTidInfo (tid);
-  immediate = (*it).second.first.IsImmediateBlockAck ();
+  immediate = agreement->agreement.IsImmediateBlockAck ();
   blockAck.SetType (COMPRESSED_BLOCK_ACK);
   NS_LOG_DEBUG ("Got Implicit block Ack Req with seq " << seqNumber);
-  (*i).second.FillBlockAckBitmap (&blockAck);
+  agreement->cache.FillBlockAckBitmap (&blockAck);
 
   SendBlockAckResponse (&blockAck, originator, immediate, duration, blockAckReqTxVector.GetMode  ());
 }
@@ -2789,12 +2726,13 @@ MacLow::SendBlockAckAfterBlockAckRequest (const CtrlBAckRequestHeader reqHdr, Ma
   if (!reqHdr.IsMultiTid ())
     {
       tid = reqHdr.GetTidInfo ();
-      AgreementsI it = m_bAckAgreements.find (std::make_pair (originator, tid));
-      if (it != m_bAckAgreements.end ())
+      RecipientAgreement *recipient = FindAgreement (originator, tid);
+      if (recipient != 0)
         {
+          BlockAckAgreement &agreement = recipient->agreement;
           blockAck.SetStartingSequence (reqHdr.GetStartingSequence ());
           blockAck.SetTidInfo (tid);
-          immediate = (*it).second.first.IsImmediateBlockAck ();
+          immediate = agreement.IsImmediateBlockAck ();
           if (reqHdr.IsBasic ())
             {
               blockAck.SetType (BASIC_BLOCK_ACK);
@@ -2803,9 +2741,7 @@ MacLow::SendBlockAckAfterBlockAckRequest (const CtrlBAckRequestHeader reqHdr, Ma
             {
               blockAck.SetType (COMPRESSED_BLOCK_ACK);
             }
-          BlockAckCachesI i = m_bAckCaches.find (std::make_pair (originator, tid));
-          NS_ASSERT (i != m_bAckCaches.end ());
-          (*i).second.FillBlockAckBitmap (&blockAck);
+          recipient->cache.FillBlockAckBitmap (&blockAck);
           NS_LOG_DEBUG ("Got block Ack Req with seq " << reqHdr.GetStartingSequence ());
 
           if (!m_stationManager->HasHtSupported ())
@@ -2818,13 +2754,13 @@ MacLow::SendBlockAckAfterBlockAckRequest (const CtrlBAckRequestHeader reqHdr, Ma
             }
           else
             {
-              if (!QosUtilsIsOldPacket ((*it).second.first.GetStartingSequence (), reqHdr.GetStartingSequence ()))
+              if (!QosUtilsIsOldPacket (agreement.GetStartingSequence (), reqHdr.GetStartingSequence ()))
                 {
-                  (*it).second.first.SetStartingSequence (reqHdr.GetStartingSequence ());
-                  (*it).second.first.SetWinEnd (((*it).second.first.GetStartingSequence () + (*it).second.first.GetBufferSize () - 1) % 4096);
+                  agreement.SetStartingSequence (reqHdr.GetStartingSequence ());
+                  agreement.SetWinEnd ((agreement.GetStartingSequence () + agreement.GetBufferSize () - 1) % 4096);
                   RxCompleteBufferedPacketsWithSmallerSequence (reqHdr.GetStartingSequence (), originator, tid);
                   RxCompleteBufferedPacketsUntilFirstLost (originator, tid);
-                  (*it).second.first.SetWinEnd (((*it).second.first.GetStartingSequence () + (*it).second.first.GetBufferSize () - 1) % 4096);
+                  agreement.SetWinEnd ((agreement.GetStartingSequence () + agreement.GetBufferSize () - 1) % 4096);
                 }
             }
         }
@@ -2880,25 +2816,26 @@ MacLow::DeaggregateAmpduAndReceive (Ptr<Packet> aggregatedPacket, double rxSnr,
   if (aggregatedPacket->RemovePacketTag (ampdu))
     {
       ampduSubframe = true;
-      MpduAggregator::DeaggregatedMpdus packets = MpduAggregator::Deaggregate (aggregatedPacket);
-      MpduAggregator::DeaggregatedMpdusCI n = packets.begin ();
+      //only the first MPDU is received: no need to split the others
+      AmpduSubframeHeader subframeHdr;
+      Ptr<Packet> mpdu = MpduAggregator::RemoveSubframe (aggregatedPacket, &subframeHdr);
 
       WifiMacHeader firsthdr;
-      (*n).first->PeekHeader (firsthdr);
+      mpdu->PeekHeader (firsthdr);
       NS_LOG_DEBUG ("duration/id=" << firsthdr.GetDuration ());
-      NotifyNav ((*n).first, firsthdr, preamble);
+      NotifyNav (mpdu, firsthdr, preamble);
 
       if (firsthdr.GetAddr1 () == m_self)
         {
           m_receivedAtLeastOneMpdu = true;
           if (firsthdr.IsAck () || firsthdr.IsBlockAck () || firsthdr.IsBlockAckReq ())
             {
-              ReceiveOk ((*n).first, rxSnr, txVector, preamble, ampduSubframe, context);
+              ReceiveOk (mpdu, rxSnr, txVector, preamble, ampduSubframe, context);
             }
           else if (firsthdr.IsData () || firsthdr.IsQosData ())
             {
               NS_LOG_DEBUG ("Deaggregate packet with sequence=" << firsthdr.GetSequenceNumber ());
-              ReceiveOk ((*n).first, rxSnr, txVector, preamble, ampduSubframe, context);
+              ReceiveOk (mpdu, rxSnr, txVector, preamble, ampduSubframe, context);
               if (firsthdr.IsQosAck ())
                 {
                   NS_LOG_DEBUG ("Normal Ack");
@@ -2919,12 +2856,12 @@ MacLow::DeaggregateAmpduAndReceive (Ptr<Packet> aggregatedPacket, double rxSnr,
               NS_FATAL_ERROR ("Sending a BlockAckReq with QosPolicy equal to Normal Ack");
             }
           uint8_t tid = firsthdr.GetQosTid ();
-          AgreementsI it = m_bAckAgreements.find (std::make_pair (firsthdr.GetAddr2 (), tid));
-          if (it != m_bAckAgreements.end ())
+          RecipientAgreement *agreement = FindAgreement (firsthdr.GetAddr2 (), tid);
+          if (agreement != 0)
             {
               NS_ASSERT (m_sendAckEvent.IsExpired ());
               /* See section 11.5.3 in IEEE 802.11 for mean of this timer */
-              ResetBlockAckInactivityTimerIfNeeded (it->second.first);
+              ResetBlockAckInactivityTimerIfNeeded (agreement->agreement);
               NS_LOG_DEBUG ("rx A-MPDU/sendImmediateBlockAck from=" << firsthdr.GetAddr2 ());
               m_sendAckEvent = Simulator::Schedule (GetSifs (),
                                                     &MacLow::SendBlockAckAfterAmpdu, this,
@@ -3022,7 +2959,6 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
               uint16_t blockAckSize = 0;
               bool aggregated = false;
               int i = 0;
-              Ptr<Packet> aggPacket = newPacket->Copy ();
 
               if (!hdr.IsBlockAckReq ())
                 {
@@ -3032,18 +2968,16 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                       peekedHdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
                     }
                   currentSequenceNumber = peekedHdr.GetSequenceNumber ();
-                  newPacket->AddHeader (peekedHdr);
-                  WifiMacTrailer fcs;
-                  newPacket->AddTrailer (fcs);
+                  uint32_t mpduSize = packet->GetSize () + peekedHdr.GetSize () + WIFI_MAC_FCS_LENGTH;
 
-                  aggregated = m_mpduAggregator->Aggregate (newPacket, currentAggregatedPacket);
+                  aggregated = m_mpduAggregator->ReserveSubframe (mpduSize, currentAggregatedPacket);
 
                   if (aggregated)
                     {
-                      NS_LOG_DEBUG ("Adding packet with Sequence number " << peekedHdr.GetSequenceNumber () << " to A-MPDU, packet size = " << newPacket->GetSize () << ", A-MPDU size = " << currentAggregatedPacket->GetSize ());
+                      NS_LOG_DEBUG ("Adding packet with Sequence number " << peekedHdr.GetSequenceNumber () << " to A-MPDU, packet size = " << mpduSize << ", A-MPDU size = " << currentAggregatedPacket->GetSize ());
                       i++;
                       m_sentMpdus++;
-                      m_aggregateQueue->Enqueue (aggPacket, peekedHdr);
+                      m_aggregateQueue->Enqueue (packet, peekedHdr);
                     }
                 }
               else if (hdr.IsBlockAckReq ())
@@ -3071,7 +3005,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                       tempPacket = PerformMsduAggregation (peekedPacket, &peekedHdr, &tstamp, currentAggregatedPacket, blockAckSize);
                       if (tempPacket != 0)  //MSDU aggregation
                         {
-                          peekedPacket = tempPacket->Copy ();
+                          peekedPacket = tempPacket;
                         }
                     }
                 }
@@ -3101,16 +3035,12 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                       peekedHdr.SetQosAckPolicy (WifiMacHeader::BLOCK_ACK);
                     }
 
-                  newPacket = peekedPacket->Copy ();
-                  Ptr<Packet> aggPacket = newPacket->Copy ();
-
-                  newPacket->AddHeader (peekedHdr);
-                  WifiMacTrailer fcs;
-                  newPacket->AddTrailer (fcs);
-                  aggregated = m_mpduAggregator->Aggregate (newPacket, currentAggregatedPacket);
+                  uint32_t mpduSize = peekedPacket->GetSize () + peekedHdr.GetSize () + WIFI_MAC_FCS_LENGTH;
+                  aggregated = m_mpduAggregator->ReserveSubframe (mpduSize, currentAggregatedPacket);
                   if (aggregated)
                     {
-                      m_aggregateQueue->Enqueue (aggPacket, peekedHdr);
+                      //the MPDU is shared with the queues: it is copied when framed in ForwardDown
+                      m_aggregateQueue->Enqueue (peekedPacket, peekedHdr);
                       if (i == 1 && hdr.IsQosData ())
                         {
                           if (!m_txParams.MustSendRts ())
@@ -3122,7 +3052,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                               InsertInTxQueue (packet, hdr, tstamp);
                             }
                         }
-                      NS_LOG_DEBUG ("Adding packet with Sequence number " << peekedHdr.GetSequenceNumber () << " to A-MPDU, packet size = " << newPacket->GetSize () << ", A-MPDU size = " << currentAggregatedPacket->GetSize ());
+                      NS_LOG_DEBUG ("Adding packet with Sequence number " << peekedHdr.GetSequenceNumber () << " to A-MPDU, packet size = " << mpduSize << ", A-MPDU size = " << currentAggregatedPacket->GetSize ());
                       i++;
                       isAmpdu = true;
                       m_sentMpdus++;
@@ -3142,7 +3072,6 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                         {
                           queue->Remove (peekedPacket);
                         }
-                      newPacket = 0;
                     }
                   else
                     {
@@ -3167,7 +3096,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                                   tempPacket = PerformMsduAggregation (peekedPacket, &peekedHdr, &tstamp, currentAggregatedPacket, blockAckSize);
                                   if (tempPacket != 0) //MSDU aggregation
                                     {
-                                      peekedPacket = tempPacket->Copy ();
+                                      peekedPacket = tempPacket;
                                     }
                                 }
                             }
@@ -3191,7 +3120,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                               tempPacket = PerformMsduAggregation (peekedPacket, &peekedHdr, &tstamp, currentAggregatedPacket, blockAckSize);
                               if (tempPacket != 0) //MSDU aggregation
                                 {
-                                  peekedPacket = tempPacket->Copy ();
+                                  peekedPacket = tempPacket;
                                 }
                             }
                         }
@@ -3201,14 +3130,9 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                 {
                   if (hdr.IsBlockAckReq ())
                     {
-                      newPacket = packet->Copy ();
                       peekedHdr = hdr;
-                      Ptr<Packet> aggPacket = newPacket->Copy ();
-                      m_aggregateQueue->Enqueue (aggPacket, peekedHdr);
-                      newPacket->AddHeader (peekedHdr);
-                      WifiMacTrailer fcs;
-                      newPacket->AddTrailer (fcs);
-                      m_mpduAggregator->Aggregate (newPacket, currentAggregatedPacket);
+                      m_aggregateQueue->Enqueue (packet, peekedHdr);
+                      m_mpduAggregator->ReserveSubframe (packet->GetSize () + peekedHdr.GetSize () + WIFI_MAC_FCS_LENGTH, currentAggregatedPacket);
                     }
                   if (qosPolicy == 0)
                     {
@@ -42,6 +42,8 @@
 #include "ns3/nstime.h"
 #include "qos-utils.h"
 #include "block-ack-cache.h"
+#include "block-ack-reorder-buffer.h"
+#include "mac-address-table.h"
 #include "wifi-tx-vector.h"
 #include "mpdu-aggregator.h"
 #include "msdu-aggregator.h"
@@ -1351,20 +1353,36 @@ private:
   /*
    * BlockAck data structures.
    */
-  typedef std::pair<Ptr<Packet>, WifiMacHeader> BufferedPacket;
-  typedef std::list<BufferedPacket>::iterator BufferedPacketI;
-
-  typedef std::pair<Mac48Address, uint8_t> AgreementKey;
-  typedef std::pair<BlockAckAgreement, std::list<BufferedPacket> > AgreementValue;
-
-  typedef std::map<AgreementKey, AgreementValue> Agreements;
-  typedef std::map<AgreementKey, AgreementValue>::iterator AgreementsI;
+  /**
+   * A block ack agreement of which this station is the recipient.
+   */
+  struct RecipientAgreement
+  {
+    /**
+     * \param originator the originator of the agreement
+     * \param tid the Traffic ID of the agreement
+     */
+    RecipientAgreement (Mac48Address originator, uint8_t tid);
 
-  typedef std::map<AgreementKey, BlockAckCache> BlockAckCaches;
-  typedef std::map<AgreementKey, BlockAckCache>::iterator BlockAckCachesI;
+    BlockAckAgreement agreement;   //!< the agreement
+    BlockAckCache cache;           //!< the bitmap sent in the block acks
+    BlockAckReorderBuffer buffer;  //!< the MPDUs waiting to be forwarded in order
+  };
+  /**
+   * The recipient agreements of an originator, by Traffic ID.
+   */
+  struct PeerAgreements
+  {
+    RecipientAgreement *tids[16]; //!< the agreement of each TID, or 0
+  };
+  /**
+   * \param originator the originator of the agreement
+   * \param tid the Traffic ID of the agreement
+   * \return the agreement, or 0 if there is none
+   */
+  RecipientAgreement * FindAgreement (Mac48Address originator, uint8_t tid) const;
 
-  Agreements m_bAckAgreements;
-  BlockAckCaches m_bAckCaches;
+  MacAddressTable<PeerAgreements> m_bAckAgreements; //!< the recipient agreements of each originator
 
   typedef std::map<AcIndex, MacLowAggregationCapableTransmissionListener*> QueueListeners;
   QueueListeners m_edcaListeners;
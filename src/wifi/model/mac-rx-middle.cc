@@ -25,7 +25,6 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/sequence-number.h"
-#include <list>
 
 // 3rd party headers
 #include "Modules/Toolbox/FileManager.h"
@@ -39,136 +38,6 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("MacRxMiddle");
 
-/**
- * A class to keep track of the packet originator status.
- * It recomposes the packet from multiple fragments.
- */
-class OriginatorRxStatus
-{
-private:
-  /**
-   * typedef for a list of fragments (i.e. incomplete Packet).
-   */
-  typedef std::list<Ptr<const Packet> > Fragments;
-  /**
-   * typedef for a const iterator for Fragments
-   */
-  typedef std::list<Ptr<const Packet> >::const_iterator FragmentsCI;
-
-  bool m_defragmenting;
-  uint16_t m_lastSequenceControl;
-  Fragments m_fragments;
-
-
-public:
-  OriginatorRxStatus ()
-  {
-    /* this is a magic value necessary. */
-    m_lastSequenceControl = 0xffff;
-    m_defragmenting = false;
-  }
-  ~OriginatorRxStatus ()
-  {
-    m_fragments.clear ();
-  }
-  /**
-   * Check if we are de-fragmenting packets.
-   *
-   * \return true if we are de-fragmenting packets,
-   *         false otherwise
-   */
-  bool IsDeFragmenting (void)
-  {
-    return m_defragmenting;
-  }
-  /**
-   * We have received a first fragmented packet.
-   * We start the deframentation by saving the first fragment.
-   *
-   * \param packet the first fragmented packet
-   */
-  void AccumulateFirstFragment (Ptr<const Packet> packet)
-  {
-    NS_ASSERT (!m_defragmenting);
-    m_defragmenting = true;
-    m_fragments.push_back (packet);
-  }
-  /**
-   * We have received a last fragment of the fragmented packets
-   * (indicated by the no more fragment field).
-   * We re-construct the packet from the fragments we saved
-   * and return the full packet.
-   *
-   * \param packet the last fragment
-   *
-   * \return the fully reconstructed packet
-   */
-  Ptr<Packet> AccumulateLastFragment (Ptr<const Packet> packet)
-  {
-    NS_ASSERT (m_defragmenting);
-    m_fragments.push_back (packet);
-    m_defragmenting = false;
-    Ptr<Packet> full = Create<Packet> ();
-    for (FragmentsCI i = m_fragments.begin (); i != m_fragments.end (); i++)
-      {
-        full->AddAtEnd (*i);
-      }
-    m_fragments.erase (m_fragments.begin (), m_fragments.end ());
-    return full;
-  }
-  /**
-   * We received a fragmented packet (not first and not last).
-   * We simply save it into our internal list.
-   *
-   * \param packet the received fragment
-   */
-  void AccumulateFragment (Ptr<const Packet> packet)
-  {
-    NS_ASSERT (m_defragmenting);
-    m_fragments.push_back (packet);
-  }
-  /**
-   * Check if the sequence control (i.e. fragment number) is
-   * in order.
-   *
-   * \param sequenceControl the raw sequence control
-   *
-   * \return true if the sequence control is in order,
-   *         false otherwise
-   */
-  bool IsNextFragment (uint16_t sequenceControl)
-  {
-    if ((sequenceControl >> 4) == (m_lastSequenceControl >> 4)
-        && (sequenceControl & 0x0f) == ((m_lastSequenceControl & 0x0f) + 1))
-      {
-        return true;
-      }
-    else
-      {
-        return false;
-      }
-  }
-  /**
-   * Return the last sequence control we received.
-   *
-   * \return the last sequence control
-   */
-  uint16_t GetLastSequenceControl (void)
-  {
-    return m_lastSequenceControl;
-  }
-  /**
-   * Set the last sequence control we received.
-   *
-   * \param sequenceControl the last sequence control we received
-   */
-  void SetSequenceControl (uint16_t sequenceControl)
-  {
-    m_lastSequenceControl = sequenceControl;
-  }
-};
-
-
 MacRxMiddle::MacRxMiddle ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -177,20 +46,13 @@ MacRxMiddle::MacRxMiddle ()
 MacRxMiddle::~MacRxMiddle ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (OriginatorsI i = m_originatorStatus.begin ();
-       i != m_originatorStatus.end (); i++)
-    {
-      delete (*i).second;
-    }
-  m_originatorStatus.erase (m_originatorStatus.begin (),
-                            m_originatorStatus.end ());
-  for (QosOriginatorsI i = m_qosOriginatorStatus.begin ();
-       i != m_qosOriginatorStatus.end (); i++)
-    {
-      delete (*i).second;
-    }
-  m_qosOriginatorStatus.erase (m_qosOriginatorStatus.begin (),
-                               m_qosOriginatorStatus.end ());
+}
+
+void
+MacRxMiddle::Reserve (uint32_t nStations)
+{
+  NS_LOG_FUNCTION (nStations);
+  m_originators.Reserve (nStations);
 }
 
 void
@@ -204,34 +66,20 @@ OriginatorRxStatus *
 MacRxMiddle::Lookup (const WifiMacHeader *hdr)
 {
   NS_LOG_FUNCTION (hdr);
-  OriginatorRxStatus *originator;
-  Mac48Address source = hdr->GetAddr2 ();
+  PeerRxStatus &peer = m_originators.Get (hdr->GetAddr2 ());
   if (hdr->IsQosData ()
       && !hdr->GetAddr2 ().IsGroup ())
     {
       /* only for qos data non-broadcast frames */
-      originator = m_qosOriginatorStatus[std::make_pair (source, hdr->GetQosTid ())];
-      if (originator == 0)
-        {
-          originator = new OriginatorRxStatus ();
-          m_qosOriginatorStatus[std::make_pair (source, hdr->GetQosTid ())] = originator;
-        }
-    }
-  else
-    {
-      /* - management frames
-       * - qos data broadcast frames
-       * - nqos data frames
-       * see section 7.1.3.4.1
-       */
-      originator = m_originatorStatus[source];
-      if (originator == 0)
-        {
-          originator = new OriginatorRxStatus ();
-          m_originatorStatus[source] = originator;
-        }
+      NS_ASSERT (hdr->GetQosTid () < 16);
+      return &peer.qos[hdr->GetQosTid ()];
     }
-  return originator;
+  /* - management frames
+   * - qos data broadcast frames
+   * - nqos data frames
+   * see section 7.1.3.4.1
+   */
+  return &peer.nonQos;
 }
 
 bool
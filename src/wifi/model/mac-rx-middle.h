@@ -21,11 +21,11 @@
 #ifndef MAC_RX_MIDDLE_H
 #define MAC_RX_MIDDLE_H
 
-#include <map>
-#include <utility>
+#include <list>
 #include "ns3/callback.h"
 #include "ns3/mac48-address.h"
 #include "ns3/packet.h"
+#include "mac-address-table.h"
 
 // self-defined headers
 #include "Components/PacketContext.h"
@@ -33,7 +33,137 @@
 namespace ns3 {
 
 class WifiMacHeader;
-class OriginatorRxStatus;
+
+/**
+ * \ingroup wifi
+ *
+ * A class to keep track of the packet originator status.
+ * It recomposes the packet from multiple fragments.
+ */
+class OriginatorRxStatus
+{
+private:
+  /**
+   * typedef for a list of fragments (i.e. incomplete Packet).
+   */
+  typedef std::list<Ptr<const Packet> > Fragments;
+  /**
+   * typedef for a const iterator for Fragments
+   */
+  typedef std::list<Ptr<const Packet> >::const_iterator FragmentsCI;
+
+  bool m_defragmenting;
+  uint16_t m_lastSequenceControl;
+  Fragments m_fragments;
+
+
+public:
+  OriginatorRxStatus ()
+  {
+    /* this is a magic value necessary. */
+    m_lastSequenceControl = 0xffff;
+    m_defragmenting = false;
+  }
+  ~OriginatorRxStatus ()
+  {
+    m_fragments.clear ();
+  }
+  /**
+   * Check if we are de-fragmenting packets.
+   *
+   * \return true if we are de-fragmenting packets,
+   *         false otherwise
+   */
+  bool IsDeFragmenting (void)
+  {
+    return m_defragmenting;
+  }
+  /**
+   * We have received a first fragmented packet.
+   * We start the deframentation by saving the first fragment.
+   *
+   * \param packet the first fragmented packet
+   */
+  void AccumulateFirstFragment (Ptr<const Packet> packet)
+  {
+    NS_ASSERT (!m_defragmenting);
+    m_defragmenting = true;
+    m_fragments.push_back (packet);
+  }
+  /**
+   * We have received a last fragment of the fragmented packets
+   * (indicated by the no more fragment field).
+   * We re-construct the packet from the fragments we saved
+   * and return the full packet.
+   *
+   * \param packet the last fragment
+   *
+   * \return the fully reconstructed packet
+   */
+  Ptr<Packet> AccumulateLastFragment (Ptr<const Packet> packet)
+  {
+    NS_ASSERT (m_defragmenting);
+    m_fragments.push_back (packet);
+    m_defragmenting = false;
+    Ptr<Packet> full = Create<Packet> ();
+    for (FragmentsCI i = m_fragments.begin (); i != m_fragments.end (); i++)
+      {
+        full->AddAtEnd (*i);
+      }
+    m_fragments.erase (m_fragments.begin (), m_fragments.end ());
+    return full;
+  }
+  /**
+   * We received a fragmented packet (not first and not last).
+   * We simply save it into our internal list.
+   *
+   * \param packet the received fragment
+   */
+  void AccumulateFragment (Ptr<const Packet> packet)
+  {
+    NS_ASSERT (m_defragmenting);
+    m_fragments.push_back (packet);
+  }
+  /**
+   * Check if the sequence control (i.e. fragment number) is
+   * in order.
+   *
+   * \param sequenceControl the raw sequence control
+   *
+   * \return true if the sequence control is in order,
+   *         false otherwise
+   */
+  bool IsNextFragment (uint16_t sequenceControl)
+  {
+    if ((sequenceControl >> 4) == (m_lastSequenceControl >> 4)
+        && (sequenceControl & 0x0f) == ((m_lastSequenceControl & 0x0f) + 1))
+      {
+        return true;
+      }
+    else
+      {
+        return false;
+      }
+  }
+  /**
+   * Return the last sequence control we received.
+   *
+   * \return the last sequence control
+   */
+  uint16_t GetLastSequenceControl (void)
+  {
+    return m_lastSequenceControl;
+  }
+  /**
+   * Set the last sequence control we received.
+   *
+   * \param sequenceControl the last sequence control we received
+   */
+  void SetSequenceControl (uint16_t sequenceControl)
+  {
+    m_lastSequenceControl = sequenceControl;
+  }
+};
 
 /**
  * \ingroup wifi
@@ -59,6 +189,12 @@ public:
   void SetForwardCallback (ForwardUpCallback callback);
 
   void Receive (Ptr<Packet> packet, const WifiMacHeader *hdr, SdnLab::PacketContext);
+  /**
+   * Size the originator table for a number of stations.
+   *
+   * \param nStations the expected number of peers
+   */
+  void Reserve (uint32_t nStations);
 
 
 private:
@@ -103,24 +239,15 @@ private:
                                OriginatorRxStatus *originator);
 
   /**
-   * typedef for a map between address and OriginatorRxStatus
-   */
-  typedef std::map <Mac48Address, OriginatorRxStatus *, std::less<Mac48Address> > Originators;
-  /**
-   * typedef for a map between address, OriginatorRxStatus, and Traffic ID
-   */
-  typedef std::map <std::pair<Mac48Address, uint8_t>, OriginatorRxStatus *, std::less<std::pair<Mac48Address,uint8_t> > > QosOriginators;
-  /**
-   * typedef for an interator for Originators
-   */
-  typedef std::map <Mac48Address, OriginatorRxStatus *, std::less<Mac48Address> >::iterator OriginatorsI;
-  /**
-   * typedef for an interator for QosOriginators
+   * The duplicate detection and defragmentation state of a peer.
    */
-  typedef std::map <std::pair<Mac48Address, uint8_t>, OriginatorRxStatus *, std::less<std::pair<Mac48Address,uint8_t> > >::iterator QosOriginatorsI;
+  struct PeerRxStatus
+  {
+    OriginatorRxStatus nonQos;  //!< management, group and non-QoS data frames
+    OriginatorRxStatus qos[16]; //!< QoS data frames, by Traffic ID
+  };
 
-  Originators m_originatorStatus;
-  QosOriginators m_qosOriginatorStatus;
+  MacAddressTable<PeerRxStatus> m_originators; //!< the state of each peer (ADDR2)
   ForwardUpCallback m_callback;
 };
 
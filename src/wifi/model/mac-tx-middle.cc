@@ -34,10 +34,12 @@ MacTxMiddle::MacTxMiddle ()
 
 MacTxMiddle::~MacTxMiddle ()
 {
-  for (std::map<Mac48Address,uint16_t*>::iterator i = m_qosSequences.begin (); i != m_qosSequences.end (); i++)
-    {
-      delete [] i->second;
-    }
+}
+
+void
+MacTxMiddle::Reserve (uint32_t nStations)
+{
+  m_qosSequences.Reserve (nStations);
 }
 
 uint16_t
@@ -49,25 +51,11 @@ MacTxMiddle::GetNextSequenceNumberfor (const WifiMacHeader *hdr)
     {
       uint8_t tid = hdr->GetQosTid ();
       NS_ASSERT (tid < 16);
-      std::map<Mac48Address, uint16_t*>::iterator it = m_qosSequences.find (hdr->GetAddr1 ());
-      if (it != m_qosSequences.end ())
-        {
-          retval = it->second[tid];
-          it->second[tid]++;
-          it->second[tid] %= 4096;
-        }
-      else
-        {
-          retval = 0;
-          std::pair <Mac48Address,uint16_t*> newSeq (hdr->GetAddr1 (), new uint16_t[16]);
-          std::pair <std::map<Mac48Address,uint16_t*>::iterator,bool> newIns = m_qosSequences.insert (newSeq);
-          NS_ASSERT (newIns.second == true);
-          for (uint8_t i = 0; i < 16; i++)
-            {
-              newIns.first->second[i] = 0;
-            }
-          newIns.first->second[tid]++;
-        }
+      // a new peer starts with all its sequence numbers at zero
+      uint16_t *next = m_qosSequences.Get (hdr->GetAddr1 ()).next;
+      retval = next[tid];
+      next[tid]++;
+      next[tid] %= 4096;
     }
   else
     {
@@ -87,10 +75,10 @@ MacTxMiddle::PeekNextSequenceNumberfor (const WifiMacHeader *hdr)
     {
       uint8_t tid = hdr->GetQosTid ();
       NS_ASSERT (tid < 16);
-      std::map<Mac48Address, uint16_t*>::iterator it = m_qosSequences.find (hdr->GetAddr1 ());
-      if (it != m_qosSequences.end ())
+      const QosSequences *sequences = m_qosSequences.Find (hdr->GetAddr1 ());
+      if (sequences != 0)
         {
-          retval = it->second[tid];
+          retval = sequences->next[tid];
         }
       else
         {
@@ -109,10 +97,10 @@ MacTxMiddle::GetNextSeqNumberByTidAndAddress (uint8_t tid, Mac48Address addr) co
 {
   NS_ASSERT (tid < 16);
   uint16_t seq = 0;
-  std::map <Mac48Address,uint16_t*>::const_iterator it = m_qosSequences.find (addr);
-  if (it != m_qosSequences.end ())
+  const QosSequences *sequences = m_qosSequences.Find (addr);
+  if (sequences != 0)
     {
-      return it->second[tid];
+      return sequences->next[tid];
     }
   return seq;
 }
@@ -24,8 +24,8 @@
 #define MAC_TX_MIDDLE_H
 
 #include <stdint.h>
-#include <map>
 #include "ns3/mac48-address.h"
+#include "mac-address-table.h"
 
 namespace ns3 {
 
@@ -65,10 +65,24 @@ public:
    * \return the next sequence number
    */
   uint16_t GetNextSeqNumberByTidAndAddress (uint8_t tid, Mac48Address addr) const;
+  /**
+   * Size the sequence number table for a number of stations.
+   *
+   * \param nStations the expected number of peers
+   */
+  void Reserve (uint32_t nStations);
 
 
 private:
-  std::map <Mac48Address,uint16_t*> m_qosSequences;
+  /**
+   * The next QoS data sequence numbers of a peer, by Traffic ID.
+   */
+  struct QosSequences
+  {
+    uint16_t next[16]; //!< the next sequence number of each TID
+  };
+
+  MacAddressTable<QosSequences> m_qosSequences; //!< sequence numbers of each peer (ADDR1)
   uint16_t m_sequence;
 };
 
@@ -36,6 +36,7 @@
 #include "ns3/double.h"
 #include "ns3/wifi-mac.h"
 #include "ns3/assert.h"
+#include "ns3/abort.h"
 #include <vector>
 
 /*** self-defined headers ***/
@@ -57,7 +58,7 @@ NS_LOG_COMPONENT_DEFINE ("MinstrelWifiManager");
  */
 struct MinstrelWifiRemoteStation : public WifiRemoteStation
 {
-  Time m_nextStatsUpdate;  ///< 10 times every second
+  bool m_active;           ///< sent frames since the last stats update
 
   /**
    * To keep track of the current position in the our random sample table
@@ -80,8 +81,9 @@ struct MinstrelWifiRemoteStation : public WifiRemoteStation
   uint32_t m_err;                ///< retry errors
   uint32_t m_txrate;             ///< current transmit rate
   bool m_initialized;            ///< for initializing tables
-  MinstrelRate m_minstrelTable;  ///< minstrel table
-  SampleRate m_sampleTable;      ///< sample table
+  uint32_t m_nsupported;         ///< modes supported by this station
+  RateInfo m_minstrelTable[MINSTREL_MAX_RATES];  ///< minstrel table
+  const uint32_t *m_sampleTable; ///< sample table (shared, m_nsupported x m_sampleCol)
   unsigned int mcs;             // MCS predicted by NN
 };
 
@@ -139,6 +141,24 @@ MinstrelWifiManager::~MinstrelWifiManager ()
 {
 }
 
+void
+MinstrelWifiManager::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_updateStatsEvent.Cancel ();
+  m_activeStations.clear ();
+  WifiRemoteStationManager::DoDispose ();
+}
+
+void
+MinstrelWifiManager::DoReset (void)
+{
+  NS_LOG_FUNCTION (this);
+  //stations are about to be deleted by the base class
+  m_updateStatsEvent.Cancel ();
+  m_activeStations.clear ();
+}
+
 /*** self-defined methods ***/
 /*** NN based methods ***/
 #if defined(__SDN_LAB_RA_MINSTREL_SNN_VINCENT) || defined(__SDN_LAB_RA_MINSTREL_SNN) || defined(__SDN_LAB_RA_MINSTREL_SNN_PLUS) || defined(__SDN_LAB_RA_MINSTREL_AI_DIST)
@@ -201,22 +221,18 @@ MinstrelWifiManager::AssignStreams (int64_t stream)
 Time
 MinstrelWifiManager::GetCalcTxTime (WifiMode mode) const
 {
-
-  for (TxTime::const_iterator i = m_calcTxTime.begin (); i != m_calcTxTime.end (); i++)
-    {
-      if (mode == i->second)
-        {
-          return i->first;
-        }
-    }
-  NS_ASSERT (false);
-  return Seconds (0);
+  NS_ASSERT (mode.GetUid () < m_calcTxTime.size ());
+  return m_calcTxTime[mode.GetUid ()];
 }
 
 void
 MinstrelWifiManager::AddCalcTxTime (WifiMode mode, Time t)
 {
-  m_calcTxTime.push_back (std::make_pair (t, mode));
+  if (mode.GetUid () >= m_calcTxTime.size ())
+    {
+      m_calcTxTime.resize (mode.GetUid () + 1, Seconds (0));
+    }
+  m_calcTxTime[mode.GetUid ()] = t;
 }
 
 WifiRemoteStation *
@@ -224,7 +240,7 @@ MinstrelWifiManager::DoCreateStation (void) const
 {
   MinstrelWifiRemoteStation *station = new MinstrelWifiRemoteStation ();
 
-  station->m_nextStatsUpdate = Simulator::Now () + m_updateStats;
+  station->m_active = false;
   station->m_col = 0;
   station->m_index = 0;
   station->m_maxTpRate = 0;
@@ -241,6 +257,8 @@ MinstrelWifiManager::DoCreateStation (void) const
   station->m_err = 0;
   station->m_txrate = 0;
   station->m_initialized = false;
+  station->m_nsupported = 0;
+  station->m_sampleTable = 0;
 
   return station;
 }
@@ -254,8 +272,8 @@ MinstrelWifiManager::CheckInit (MinstrelWifiRemoteStation *station)
       //to make sure that the set of supported rates has been initialized
       //before we perform our own initialization.
       m_nsupported = GetNSupported (station);
-      station->m_minstrelTable = MinstrelRate (m_nsupported);
-      station->m_sampleTable = SampleRate (m_nsupported, std::vector<uint32_t> (m_sampleCol));
+      NS_ABORT_MSG_IF (m_nsupported > MINSTREL_MAX_RATES, "Minstrel supports " << MINSTREL_MAX_RATES << " rates at most");
+      station->m_nsupported = m_nsupported;
       InitSampleTable (station);
       RateInit (station);
       station->m_initialized = true;
@@ -474,7 +492,7 @@ MinstrelWifiManager::DoReportDataOk (WifiRemoteStation *st,
 
   station->m_packetCount++;
 
-  if (m_nsupported >= 1)
+  if (station->m_nsupported >= 1)
     {
       station->m_txrate = FindRate (station);
     }
@@ -503,7 +521,7 @@ MinstrelWifiManager::DoReportFinalDataFailed (WifiRemoteStation *st)
 
   NS_LOG_DEBUG ("DoReportFinalDataFailed m_txrate = " << station->m_txrate << ", attempt = " << station->m_minstrelTable[station->m_txrate].numRateAttempt << ", success = " << station->m_minstrelTable[station->m_txrate].numRateSuccess << " (after update).");
 
-  if (m_nsupported >= 1)
+  if (station->m_nsupported >= 1)
     {
       station->m_txrate = FindRate (station);
     }
@@ -527,9 +545,18 @@ MinstrelWifiManager::DoGetDataTxVector (WifiRemoteStation *st,
       CheckInit (station);
 
       //start the rate at half way
-      station->m_txrate = m_nsupported / 2;
+      station->m_txrate = station->m_nsupported / 2;
+    }
+  //the stats of the stations that send are updated together by a single timer
+  if (!station->m_active)
+    {
+      station->m_active = true;
+      m_activeStations.push_back (station);
+      if (!m_updateStatsEvent.IsRunning ())
+        {
+          m_updateStatsEvent = Simulator::Schedule (m_updateStats, &MinstrelWifiManager::UpdateAllStats, this);
+        }
     }
-  UpdateStats (station);
   return WifiTxVector (GetSupported (station, station->m_txrate), GetDefaultTxPowerLevel (), GetLongRetryCount (station), GetShortGuardInterval (station), Min (GetNumberOfReceiveAntennas (station),GetNumberOfTransmitAntennas ()), GetNess (station), GetStbc (station));
 }
 
@@ -593,11 +620,11 @@ uint32_t
 MinstrelWifiManager::GetNextSample (MinstrelWifiRemoteStation *station)
 {
   uint32_t bitrate;
-  bitrate = station->m_sampleTable[station->m_index][station->m_col];
+  bitrate = station->m_sampleTable[station->m_index * m_sampleCol + station->m_col];
   station->m_index++;
 
   //bookeeping for m_index and m_col variables
-  if (station->m_index > (m_nsupported - 2))
+  if (station->m_index > (station->m_nsupported - 2))
     {
       station->m_index = 0;
       station->m_col++;
@@ -658,7 +685,7 @@ uint32_t MinstrelWifiManager::FindRate (MinstrelWifiRemoteStation *station)
             }
 
           //error check
-          if (idx >= m_nsupported)
+          if (idx >= station->m_nsupported)
             {
               NS_LOG_DEBUG ("ALERT!!! ERROR");
             }
@@ -696,27 +723,39 @@ uint32_t MinstrelWifiManager::FindRate (MinstrelWifiRemoteStation *station)
 }
 
 void
-MinstrelWifiManager::UpdateStats (MinstrelWifiRemoteStation *station)
+MinstrelWifiManager::UpdateAllStats (void)
 {
-  if (Simulator::Now () <  station->m_nextStatsUpdate)
+  NS_LOG_FUNCTION (this);
+  std::vector<MinstrelWifiRemoteStation *> stations;
+  stations.swap (m_activeStations);
+  for (std::vector<MinstrelWifiRemoteStation *>::const_iterator i = stations.begin (); i != stations.end (); i++)
     {
-      return;
+      (*i)->m_active = false;
+      UpdateStats (*i);
     }
+  //keep the timer while stations send, the next frame starts it again otherwise
+  if (!stations.empty ())
+    {
+      NS_LOG_DEBUG ("Next update at " << Simulator::Now () + m_updateStats);
+      m_updateStatsEvent = Simulator::Schedule (m_updateStats, &MinstrelWifiManager::UpdateAllStats, this);
+    }
+}
 
+void
+MinstrelWifiManager::UpdateStats (MinstrelWifiRemoteStation *station)
+{
   if (!station->m_initialized)
     {
       return;
     }
   NS_LOG_FUNCTION (this);
-  station->m_nextStatsUpdate = Simulator::Now () + m_updateStats;
-  NS_LOG_DEBUG ("Next update at " << station->m_nextStatsUpdate);
   NS_LOG_DEBUG ("Currently using rate: " << station->m_txrate << " (" << GetSupported (station, station->m_txrate) << ")");
 
   Time txTime;
   uint32_t tempProb;
 
   NS_LOG_DEBUG ("Index-Rate\t\tAttempt\tSuccess");
-  for (uint32_t i = 0; i < m_nsupported; i++)
+  for (uint32_t i = 0; i < station->m_nsupported; i++)
     {
 
       //calculate the perfect tx time for this rate
@@ -796,7 +835,7 @@ MinstrelWifiManager::UpdateStats (MinstrelWifiRemoteStation *station)
   //go find max throughput, second maximum throughput, high probability succ
   NS_LOG_DEBUG ("Finding the maximum throughput, second maximum throughput, and highest probability");
   NS_LOG_DEBUG ("Index-Rate\t\tT-put\tEWMA");
-  for (uint32_t i = 0; i < m_nsupported; i++)
+  for (uint32_t i = 0; i < station->m_nsupported; i++)
     {
       NS_LOG_DEBUG (i << " " << GetSupported (station, i) <<
                     "\t" << station->m_minstrelTable[i].throughput <<
@@ -818,7 +857,7 @@ MinstrelWifiManager::UpdateStats (MinstrelWifiRemoteStation *station)
 
   max_tp = 0;
   //find the second highest max
-  for (uint32_t i = 0; i < m_nsupported; i++)
+  for (uint32_t i = 0; i < station->m_nsupported; i++)
     {
       if ((i != index_max_tp) && (max_tp < station->m_minstrelTable[i].throughput))
         {
@@ -846,7 +885,7 @@ MinstrelWifiManager::RateInit (MinstrelWifiRemoteStation *station)
 {
   NS_LOG_FUNCTION (station);
 
-  for (uint32_t i = 0; i < m_nsupported; i++)
+  for (uint32_t i = 0; i < station->m_nsupported; i++)
     {
       NS_LOG_DEBUG ("Initializing rate index " << i << " " << GetSupported (station, i));
       station->m_minstrelTable[i].numRateAttempt = 0;
@@ -912,7 +951,22 @@ MinstrelWifiManager::InitSampleTable (MinstrelWifiRemoteStation *station)
   station->m_col = station->m_index = 0;
 
   //for off-seting to make rates fall between 0 and numrates
-  uint32_t numSampleRates = m_nsupported;
+  uint32_t numSampleRates = station->m_nsupported;
+
+  //stations with the same supported rates share a sample table
+  SupportedModes modes (numSampleRates);
+  for (uint32_t i = 0; i < numSampleRates; i++)
+    {
+      modes[i] = GetSupported (station, i).GetUid ();
+    }
+  std::map<SupportedModes, SampleRate>::iterator it = m_sampleTables.find (modes);
+  if (it != m_sampleTables.end ())
+    {
+      station->m_sampleTable = &it->second[0];
+      return;
+    }
+  SampleRate &sampleTable = m_sampleTables[modes];
+  sampleTable.assign (numSampleRates * m_sampleCol, 0);
 
   uint32_t newIndex;
   for (uint32_t col = 0; col < m_sampleCol; col++)
@@ -927,13 +981,14 @@ MinstrelWifiManager::InitSampleTable (MinstrelWifiRemoteStation *station)
           newIndex = (i + uv) % numSampleRates;
 
           //this loop is used for filling in other uninitilized places
-          while (station->m_sampleTable[newIndex][col] != 0)
+          while (sampleTable[newIndex * m_sampleCol + col] != 0)
             {
-              newIndex = (newIndex + 1) % m_nsupported;
+              newIndex = (newIndex + 1) % numSampleRates;
             }
-          station->m_sampleTable[newIndex][col] = i;
+          sampleTable[newIndex * m_sampleCol + col] = i;
         }
     }
+  station->m_sampleTable = &sampleTable[0];
 }
 
 void
@@ -941,13 +996,13 @@ MinstrelWifiManager::PrintSampleTable (MinstrelWifiRemoteStation *station)
 {
   NS_LOG_DEBUG ("PrintSampleTable=" << station);
 
-  uint32_t numSampleRates = m_nsupported;
+  uint32_t numSampleRates = station->m_nsupported;
   std::stringstream table;
   for (uint32_t i = 0; i < numSampleRates; i++)
     {
       for (uint32_t j = 0; j < m_sampleCol; j++)
         {
-          table << station->m_sampleTable[i][j] << "\t";
+          table << station->m_sampleTable[i * m_sampleCol + j] << "\t";
         }
       table << std::endl;
     }
@@ -959,7 +1014,7 @@ MinstrelWifiManager::PrintTable (MinstrelWifiRemoteStation *station)
 {
   NS_LOG_DEBUG ("PrintTable=" << station);
 
-  for (uint32_t i = 0; i < m_nsupported; i++)
+  for (uint32_t i = 0; i < station->m_nsupported; i++)
     {
       NS_LOG_DEBUG (i << " (" << GetSupported (station, i) << "): "  << station->m_minstrelTable[i].perfectTxTime << ", retryCount = " << station->m_minstrelTable[i].retryCount << ", adjustedRetryCount = " << station->m_minstrelTable[i].adjustedRetryCount);
     }
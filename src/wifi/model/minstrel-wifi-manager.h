@@ -26,11 +26,19 @@
 #include "ns3/nstime.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/boolean.h"
+#include "ns3/event-id.h"
+#include <map>
 
 namespace ns3 {
 
 struct MinstrelWifiRemoteStation;
 
+/**
+ * The maximal number of rates in a Minstrel table
+ * (S1G: 10 rates at 1 MHz, 9 at 2 MHz and 10 at 4 MHz)
+ */
+static const uint32_t MINSTREL_MAX_RATES = 29;
+
 /**
  * A struct to contain all information related to a data rate
  */
@@ -58,15 +66,15 @@ struct RateInfo
 };
 
 /**
- * Data structure for a Minstrel Rate table
- * A vector of a struct RateInfo
+ * Data structure for a Sample Rate table
+ * A flat (rate x column) table, shared by stations with the same supported rates
  */
-typedef std::vector<struct RateInfo> MinstrelRate;
+typedef std::vector<uint32_t> SampleRate;
+
 /**
- * Data structure for a Sample Rate table
- * A vector of a vector uint32_t
+ * The UIDs of the WifiModes supported by a station, in order
  */
-typedef std::vector<std::vector<uint32_t> > SampleRate;
+typedef std::vector<uint32_t> SupportedModes;
 
 
 /**
@@ -105,6 +113,10 @@ public:
   int64_t AssignStreams (int64_t stream);
 
 
+protected:
+  virtual void DoDispose (void);
+  virtual void DoReset (void);
+
 private:
   //overriden from base class
   virtual WifiRemoteStation * DoCreateStation (void) const;
@@ -147,6 +159,9 @@ private:
   //updating the Minstrel Table every 1/10 seconds
   void UpdateStats (MinstrelWifiRemoteStation *station);
 
+  //updating the Minstrel Tables of the stations that sent frames since the last update (a single timer for all stations)
+  void UpdateAllStats (void);
+
   //initialize Minstrel Table
   void RateInit (MinstrelWifiRemoteStation *station);
 
@@ -180,13 +195,15 @@ private:
   void CheckInit (MinstrelWifiRemoteStation *station);  ///< check for initializations
 
   /**
-   * typedef for a vector of a pair of Time, WifiMode.
-   * (Essentially a list for WifiMode and its corresponding transmission time
-   * to transmit a reference packet.
+   * typedef for a vector of Time indexed by WifiMode UID.
+   * (Essentially the transmission time of a reference packet for each mode.)
    */
-  typedef std::vector<std::pair<Time,WifiMode> > TxTime;
+  typedef std::vector<Time> TxTime;
 
   TxTime m_calcTxTime;      ///< to hold all the calculated TxTime for all modes
+  std::map<SupportedModes, SampleRate> m_sampleTables;  ///< sample tables, keyed by the supported rates
+  std::vector<MinstrelWifiRemoteStation *> m_activeStations;  ///< stations that sent frames since the last update
+  EventId m_updateStatsEvent;  ///< the next update of the Minstrel tables, only while stations send
   Time m_updateStats;       ///< how frequent do we calculate the stats (1/10 seconds)
   double m_lookAroundRate;  ///< the % to try other rates than our current rate
   double m_ewmaLevel;       ///< exponential weighted moving average
@@ -58,6 +58,18 @@ public:
    * specified how and if <i>packet</i> can be added to <i>aggregatedPacket</i>.
    */
   virtual bool Aggregate (Ptr<const Packet> packet, Ptr<Packet> aggregatedPacket) = 0;
+  /**
+   * \param mpduSize size of the MPDU (header and FCS included) we want to insert into <i>aggregatedPacket</i>.
+   * \param aggregatedPacket packet that stands for the A-MPDU being built.
+   *
+   * \return true if the MPDU can be aggregated to <i>aggregatedPacket</i>, false otherwise.
+   *
+   * Same as Aggregate, but only the length of the subframe is added to <i>aggregatedPacket</i>,
+   * as a zero-filled area: the MPDU is not copied. This is used when the MPDUs are kept aside
+   * and framed one by one when they are sent, so that <i>aggregatedPacket</i> only gives the
+   * size of the A-MPDU.
+   */
+  virtual bool ReserveSubframe (uint32_t mpduSize, Ptr<Packet> aggregatedPacket) = 0;
   /**
    * Adds A-MPDU subframe header and padding to each MPDU that is part of an A-MPDU before it is sent.
    */
@@ -85,6 +97,18 @@ public:
    * \return list of deaggragted packets and their A-MPDU subframe headers
    */
   static DeaggregatedMpdus Deaggregate (Ptr<Packet> aggregatedPacket);
+  /**
+   * Removes the first subframe of an A-MPDU, in place.
+   *
+   * \param aggregatedPacket the A-MPDU, with at least one subframe left.
+   * \param hdr the A-MPDU subframe header of the removed subframe.
+   *
+   * \return the MPDU of the subframe. The last subframe is not copied: its
+   * header and padding are removed and <i>aggregatedPacket</i> itself is
+   * returned. The MPDU of another subframe is a fragment which shares the
+   * buffer of <i>aggregatedPacket</i>.
+   */
+  static Ptr<Packet> RemoveSubframe (Ptr<Packet> aggregatedPacket, AmpduSubframeHeader *hdr);
 };
 
 }  //namespace ns3
@@ -81,6 +81,22 @@ MpduStandardAggregator::Aggregate (Ptr<const Packet> packet, Ptr<Packet> aggrega
   return false;
 }
 
+bool
+MpduStandardAggregator::ReserveSubframe (uint32_t mpduSize, Ptr<Packet> aggregatedPacket)
+{
+  NS_LOG_FUNCTION (this << mpduSize);
+  uint32_t padding = CalculatePadding (aggregatedPacket);
+  uint32_t actualSize = aggregatedPacket->GetSize ();
+
+  if ((4 + mpduSize + actualSize + padding) <= m_maxAmpduLength)
+    {
+      //a packet of zeros has no data: the A-MPDU grows its zero area
+      aggregatedPacket->AddAtEnd (Create<Packet> (padding + 4 + mpduSize));
+      return true;
+    }
+  return false;
+}
+
 void
 MpduStandardAggregator::AddHeaderAndPad (Ptr<Packet> packet, bool last)
 {
@@ -47,6 +47,16 @@ public:
    * Returns true if <i>packet</i> can be aggregated to <i>aggregatedPacket</i>, false otherwise.
    */
   virtual bool Aggregate (Ptr<const Packet> packet, Ptr<Packet> aggregatedPacket);
+  /**
+   * \param mpduSize size of the MPDU (header and FCS included) we want to insert into <i>aggregatedPacket</i>.
+   * \param aggregatedPacket packet that stands for the A-MPDU being built.
+   *
+   * \return true if the MPDU can be aggregated to <i>aggregatedPacket</i>,
+   *         false otherwise.
+   *
+   * This method adds the length of an A-MPDU subframe to <i>aggregatedPacket</i>, without the MPDU.
+   */
+  virtual bool ReserveSubframe (uint32_t mpduSize, Ptr<Packet> aggregatedPacket);
   /**
    * Adds A-MPDU subframe header and padding to each MPDU that is part of an A-MPDU before it is sent.
    */
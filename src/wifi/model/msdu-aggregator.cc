@@ -46,28 +46,10 @@ MsduAggregator::Deaggregate (Ptr<Packet> aggregatedPacket)
   DeaggregatedMsdus set;
 
   AmsduSubframeHeader hdr;
-  Ptr<Packet> extractedMsdu = Create<Packet> ();
-  uint32_t maxSize = aggregatedPacket->GetSize ();
-  uint16_t extractedLength;
-  uint32_t padding;
-  uint32_t deserialized = 0;
-
-  while (deserialized < maxSize)
+  Ptr<Packet> extractedMsdu = 0;
+  while (extractedMsdu != aggregatedPacket && aggregatedPacket->GetSize () > 0)
     {
-      deserialized += aggregatedPacket->RemoveHeader (hdr);
-      extractedLength = hdr.GetLength ();
-      extractedMsdu = aggregatedPacket->CreateFragment (0, static_cast<uint32_t> (extractedLength));
-      aggregatedPacket->RemoveAtStart (extractedLength);
-      deserialized += extractedLength;
-
-      padding = (4 - ((extractedLength + 14) % 4 )) % 4;
-
-      if (padding > 0 && deserialized < maxSize)
-        {
-          aggregatedPacket->RemoveAtStart (padding);
-          deserialized += padding;
-        }
-
+      extractedMsdu = RemoveSubframe (aggregatedPacket, &hdr);
       std::pair<Ptr<Packet>, AmsduSubframeHeader> packetHdr (extractedMsdu, hdr);
       set.push_back (packetHdr);
     }
@@ -75,4 +57,28 @@ MsduAggregator::Deaggregate (Ptr<Packet> aggregatedPacket)
   return set;
 }
 
+Ptr<Packet>
+MsduAggregator::RemoveSubframe (Ptr<Packet> aggregatedPacket, AmsduSubframeHeader *hdr)
+{
+  NS_LOG_FUNCTION (aggregatedPacket);
+  aggregatedPacket->RemoveHeader (*hdr);
+  uint32_t length = hdr->GetLength ();
+  uint32_t padding = (4 - ((length + 14) % 4 )) % 4;
+  uint32_t left = aggregatedPacket->GetSize ();
+  NS_ASSERT (left >= length);
+
+  if (left <= length + padding)
+    {
+      //last subframe: the MSDU is what is left, but the padding
+      if (left > length)
+        {
+          aggregatedPacket->RemoveAtEnd (left - length);
+        }
+      return aggregatedPacket;
+    }
+  Ptr<Packet> extractedMsdu = aggregatedPacket->CreateFragment (0, length);
+  aggregatedPacket->RemoveAtStart (length + padding);
+  return extractedMsdu;
+}
+
 } //namespace ns3
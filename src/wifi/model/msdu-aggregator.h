@@ -50,6 +50,18 @@ public:
                           Mac48Address src, Mac48Address dest) = 0;
 
   static DeaggregatedMsdus Deaggregate (Ptr<Packet> aggregatedPacket);
+  /**
+   * Removes the first subframe of an A-MSDU, in place.
+   *
+   * \param aggregatedPacket the A-MSDU, with at least one subframe left.
+   * \param hdr the A-MSDU subframe header of the removed subframe.
+   *
+   * \return the MSDU of the subframe. The last subframe is not copied: its
+   * header and padding are removed and <i>aggregatedPacket</i> itself is
+   * returned. The MSDU of another subframe is a fragment which shares the
+   * buffer of <i>aggregatedPacket</i>.
+   */
+  static Ptr<Packet> RemoveSubframe (Ptr<Packet> aggregatedPacket, AmsduSubframeHeader *hdr);
 };
 
 } //namespace ns3
@@ -0,0 +1,317 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "raw-optimizer.h"
+#include "aid-bitmap.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("RawOptimizer");
+
+NS_OBJECT_ENSURE_REGISTERED (RawOptimizer);
+
+TypeId
+RawOptimizer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RawOptimizer")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<RawOptimizer> ()
+    .AddAttribute ("UpdatePeriod", "The number of beacons between two updates of the RAW configuration.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&RawOptimizer::m_updatePeriod),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("StationsPerSlot", "The number of contending stations aimed at in a RAW slot.",
+                   DoubleValue (2.0),
+                   MakeDoubleAccessor (&RawOptimizer::m_stationsPerSlot),
+                   MakeDoubleChecker<double> (0.1))
+    .AddAttribute ("CollisionThreshold", "The receive error rate of a RAW group above which it gets another slot.",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&RawOptimizer::m_collisionThreshold),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("MaxBoundaryStep", "The number of AIDs a RAW group boundary moves per update at most.",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&RawOptimizer::m_maxBoundaryStep),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxSlotStep", "The number of slots a RAW group gains or loses per update at most.",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&RawOptimizer::m_maxSlotStep),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MinSlotDurationCount", "The slot duration count of the shortest slot (500 + count * 120 us).",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&RawOptimizer::m_minSlotDurationCount),
+                   MakeUintegerChecker<uint32_t> (0, 2047))
+    .AddAttribute ("Smoothing", "The weight of the last update period in the per-AID load.",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&RawOptimizer::m_smoothing),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+  ;
+  return tid;
+}
+
+RawOptimizer::RawOptimizer ()
+  : m_beacons (0),
+    m_traffic (AidBitmap::MAX_AID, 0),
+    m_load (AidBitmap::MAX_AID, 0),
+    m_prefix (AidBitmap::MAX_AID + 1, 0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+RawOptimizer::~RawOptimizer ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RawOptimizer::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<RPS *>::iterator it = m_owned.begin (); it != m_owned.end (); it++)
+    {
+      delete *it;
+    }
+  m_owned.clear ();
+  m_groups.clear ();
+  Object::DoDispose ();
+}
+
+bool
+RawOptimizer::NotifyBeacon (void)
+{
+  return ++m_beacons >= m_updatePeriod;
+}
+
+void
+RawOptimizer::NotifyTraffic (uint16_t aid, uint16_t packets)
+{
+  if (aid < m_traffic.size ())
+    {
+      m_traffic[aid] += packets;
+    }
+}
+
+void
+RawOptimizer::NotifyRxEnd (uint16_t rps, uint8_t rawGroup, bool success)
+{
+  if (rps == 0 || rawGroup == 0)
+    {
+      return;
+    }
+  if (m_groups.size () < rps)
+    {
+      m_groups.resize (rps);
+    }
+  std::vector<GroupStats> &groups = m_groups[rps - 1];
+  if (groups.size () < rawGroup)
+    {
+      GroupStats zero = {0, 0};
+      groups.resize (rawGroup, zero);
+    }
+  if (success)
+    {
+      groups[rawGroup - 1].rxOk++;
+    }
+  else
+    {
+      groups[rawGroup - 1].rxError++;
+    }
+}
+
+bool
+RawOptimizer::Optimize (RPSVector &rpsset)
+{
+  NS_LOG_FUNCTION (this);
+  m_beacons = 0;
+  for (uint32_t aid = 0; aid < m_load.size (); aid++)
+    {
+      m_load[aid] = (1 - m_smoothing) * m_load[aid] + m_smoothing * m_traffic[aid];
+      m_traffic[aid] = 0;
+    }
+
+  bool changed = false;
+  if (m_owned.size () < rpsset.rpsset.size ())
+    {
+      m_owned.resize (rpsset.rpsset.size (), 0);
+    }
+  for (uint32_t r = 0; r < rpsset.rpsset.size (); r++)
+    {
+      RPS *updated = OptimizeRps (rpsset, r);
+      if (updated == 0)
+        {
+          continue;
+        }
+      delete m_owned[r];
+      m_owned[r] = updated;
+      rpsset.rpsset[r] = updated;
+      changed = true;
+    }
+
+  for (uint32_t r = 0; r < m_groups.size (); r++)
+    {
+      GroupStats zero = {0, 0};
+      std::fill (m_groups[r].begin (), m_groups[r].end (), zero);
+    }
+  return changed;
+}
+
+RPS *
+RawOptimizer::OptimizeRps (const RPSVector &rpsset, uint32_t r)
+{
+  const RPS *rps = rpsset.rpsset[r];
+  uint32_t nGroups = rps->GetNumberOfRawGroups ();
+  if (nGroups == 0)
+    {
+      return 0;
+    }
+  std::vector<RPS::RawAssignment> raw (nGroups);
+  for (uint32_t g = 0; g < nGroups; g++)
+    {
+      raw[g] = rps->GetRawAssigmentObj (g);
+    }
+
+  //only RPS elements whose groups split one AID range are rebalanced
+  uint8_t page = raw[0].GetRawGroupPage ();
+  uint32_t lo = raw[0].GetRawGroupAIDStart ();
+  uint32_t hi = raw[nGroups - 1].GetRawGroupAIDEnd ();
+  for (uint32_t g = 0; g < nGroups; g++)
+    {
+      if (raw[g].GetRawGroupPage () != page
+          || raw[g].GetRawGroupAIDStart () > raw[g].GetRawGroupAIDEnd ()
+          || (g > 0 && raw[g].GetRawGroupAIDStart () != raw[g - 1].GetRawGroupAIDEnd () + 1)
+          || raw[g].GetSlotNum () == 0)
+        {
+          return 0;
+        }
+    }
+  //the groups hold 11-bit AID offsets in the page, m_load is indexed by full AID
+  uint32_t base = uint32_t (page) << 11;
+  uint32_t n = hi - lo + 1;
+  m_prefix[0] = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      m_prefix[i + 1] = m_prefix[i] + m_load[base + lo + i];
+    }
+  double total = m_prefix[n];
+  if (total <= 0)
+    {
+      return 0; //nothing observed, nothing to balance
+    }
+
+  //move the group boundaries towards equal load
+  std::vector<uint32_t> start (nGroups), end (nGroups);
+  for (uint32_t g = 0; g < nGroups; g++)
+    {
+      start[g] = raw[g].GetRawGroupAIDStart ();
+      end[g] = raw[g].GetRawGroupAIDEnd ();
+    }
+  for (uint32_t g = 0; g + 1 < nGroups; g++)
+    {
+      //the AID at which the cumulative load reaches the share of the groups up to g
+      double share = total * (g + 1) / nGroups;
+      int64_t target = lo + (std::lower_bound (&m_prefix[1], &m_prefix[n] + 1, share) - &m_prefix[1]);
+      int64_t step = std::max<int64_t> (-int64_t (m_maxBoundaryStep), std::min<int64_t> (m_maxBoundaryStep, target - end[g]));
+      int64_t e = end[g] + step;
+      //every group keeps at least one AID
+      e = std::max<int64_t> (e, start[g]);
+      e = std::min<int64_t> (e, hi - (nGroups - 1 - g));
+      end[g] = e;
+      start[g + 1] = e + 1;
+    }
+
+  //slots follow the expected number of contending stations
+  double opportunities = std::max (1.0, double (m_updatePeriod) / rpsset.rpsset.size ()); //RAW opportunities of this RPS per update
+  uint64_t budget = 0;
+  uint64_t needed = 0;
+  std::vector<uint32_t> slots (nGroups), count (nGroups), minCount (nGroups);
+  std::vector<double> load (nGroups);
+  for (uint32_t g = 0; g < nGroups; g++)
+    {
+      uint32_t cur = raw[g].GetSlotNum ();
+      uint32_t maxSlots = raw[g].GetSlotFormat () ? 7 : 63;
+      budget += cur * (500 + raw[g].GetSlotDurationCount () * 120);
+      load[g] = m_prefix[end[g] - lo + 1] - m_prefix[start[g] - lo];
+
+      double contenders = 0;
+      for (uint32_t aid = start[g]; aid <= end[g]; aid++)
+        {
+          contenders += std::min (1.0, m_load[base + aid] / opportunities);
+        }
+      uint32_t want = std::max<uint32_t> (1, std::ceil (contenders / m_stationsPerSlot));
+      if (r < m_groups.size () && g < m_groups[r].size ())
+        {
+          const GroupStats &stats = m_groups[r][g];
+          if (stats.rxError > m_collisionThreshold * (stats.rxOk + stats.rxError))
+            {
+              want = std::max (want, cur + 1);
+            }
+        }
+      want = std::min (want, cur + m_maxSlotStep);
+      want = std::max (want, cur > m_maxSlotStep ? cur - m_maxSlotStep : 1);
+      slots[g] = std::min (want, maxSlots);
+      minCount[g] = std::min<uint32_t> (m_minSlotDurationCount, raw[g].GetSlotFormat () ? 2047 : 255);
+      needed += slots[g] * (500 + minCount[g] * 120);
+    }
+  //the RAW time of the RPS element is kept: give up slots of the largest groups until the shortest slots fit
+  while (needed > budget)
+    {
+      uint32_t largest = std::max_element (slots.begin (), slots.end ()) - slots.begin ();
+      if (slots[largest] <= 1)
+        {
+          return 0;
+        }
+      slots[largest]--;
+      needed -= 500 + minCount[largest] * 120;
+    }
+
+  //share out the spare RAW time by load
+  bool changed = false;
+  uint64_t spare = budget - needed;
+  for (uint32_t g = 0; g < nGroups; g++)
+    {
+      uint32_t maxCount = raw[g].GetSlotFormat () ? 2047 : 255;
+      double duration = slots[g] * (500 + minCount[g] * 120) + spare * load[g] / total;
+      int64_t c = (int64_t (duration / slots[g]) - 500) / 120;
+      count[g] = std::min<int64_t> (std::max<int64_t> (c, minCount[g]), maxCount);
+      changed |= slots[g] != raw[g].GetSlotNum ()
+        || count[g] != raw[g].GetSlotDurationCount ()
+        || start[g] != raw[g].GetRawGroupAIDStart ()
+        || end[g] != raw[g].GetRawGroupAIDEnd ();
+    }
+  if (!changed)
+    {
+      return 0;
+    }
+
+  RPS *updated = new RPS;
+  for (uint32_t g = 0; g < nGroups; g++)
+    {
+      NS_LOG_DEBUG ("RPS " << r + 1 << " group " << g + 1 << ": AIDs " << start[g] << "-" << end[g]
+                    << ", " << slots[g] << " slots of count " << count[g] << ", load " << load[g]);
+      raw[g].SetSlotNum (slots[g]);
+      raw[g].SetSlotDurationCount (count[g]);
+      raw[g].SetRawGroup (page | (start[g] << 2) | (end[g] << 13));
+      updated->SetRawAssignment (raw[g]);
+    }
+  return updated;
+}
+
+} //namespace ns3
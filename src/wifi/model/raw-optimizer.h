@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RAW_OPTIMIZER_H
+#define RAW_OPTIMIZER_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/object.h"
+#include "rps.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * Online RAW optimizer of an AP.
+ *
+ * Every UpdatePeriod beacons the AP hands it the packets received per AID
+ * (through S1gRawCtr::UpdateRAWGroupping) and it rebalances the RAW groups
+ * of every RPS element with a few greedy steps:
+ *
+ *  - the AID boundaries between neighbouring groups move towards equal load,
+ *    by at most MaxBoundaryStep AIDs per update;
+ *  - the slot count of a group follows its expected number of contending
+ *    stations and grows while the receive error rate of the group is above
+ *    CollisionThreshold, by at most MaxSlotStep per update;
+ *  - the RAW time of the RPS element is shared out over its groups by load.
+ *
+ * The AID span, the number of groups and the total RAW time of every RPS
+ * element are kept, so page slicing and the beacon interval stay valid. An
+ * update costs O(AIDs + groups), whatever the number of stations.
+ */
+class RawOptimizer : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  RawOptimizer ();
+  virtual ~RawOptimizer ();
+
+  /**
+   * Count a beacon.
+   *
+   * \return true if the RAW configuration is due for an update
+   */
+  bool NotifyBeacon (void);
+  /**
+   * \param aid the station
+   * \param packets the packets received from it since the last update
+   */
+  void NotifyTraffic (uint16_t aid, uint16_t packets);
+  /**
+   * Count the end of a reception during a RAW slot.
+   *
+   * \param rps the RPS index (starting at 1, as in ApWifiMac::OnRAWSlotStart)
+   * \param rawGroup the RAW group (starting at 1)
+   * \param success whether the frame was received correctly
+   */
+  void NotifyRxEnd (uint16_t rps, uint8_t rawGroup, bool success);
+  /**
+   * Rebalance the RAW groups.
+   *
+   * The RPS elements that change are replaced by new ones owned by this
+   * object, they stay valid until the next update or until the object is
+   * disposed: the caller must drop them from rpsset before disposing it.
+   *
+   * \param rpsset the RAW configuration of the AP
+   * \return true if rpsset changed
+   */
+  bool Optimize (RPSVector &rpsset);
+
+private:
+  virtual void DoDispose (void);
+
+  /// receive outcomes of a RAW group since the last update
+  struct GroupStats
+  {
+    uint32_t rxOk;
+    uint32_t rxError;
+  };
+
+  /**
+   * \param rpsset the RAW configuration
+   * \param r the RPS element to rebalance
+   * \return the new RPS element, 0 if it is left as it is
+   */
+  RPS * OptimizeRps (const RPSVector &rpsset, uint32_t r);
+
+  uint32_t m_updatePeriod;        //!< beacons between updates
+  double m_stationsPerSlot;       //!< contending stations aimed at per slot
+  double m_collisionThreshold;    //!< error rate above which a group gets another slot
+  uint32_t m_maxBoundaryStep;     //!< AIDs a group boundary moves per update at most
+  uint32_t m_maxSlotStep;         //!< slots a group gains or loses per update at most
+  uint32_t m_minSlotDurationCount; //!< shortest slot (500 + count * 120 us)
+  double m_smoothing;             //!< weight of the last period in the per-AID load
+
+  uint32_t m_beacons;                             //!< beacons since the last update
+  std::vector<uint32_t> m_traffic;                //!< packets since the last update, by AID
+  std::vector<double> m_load;                     //!< smoothed packets per update, by AID
+  std::vector<double> m_prefix;                   //!< scratch prefix sums of m_load
+  std::vector<std::vector<GroupStats> > m_groups; //!< by RPS element and RAW group
+  std::vector<RPS *> m_owned;                     //!< RPS elements created here, by RPS index
+};
+
+} //namespace ns3
+
+#endif /* RAW_OPTIMIZER_H */
@@ -633,14 +633,14 @@ void
 RegularWifiMac::DeaggregateAmsduAndForward (Ptr<Packet> aggregatedPacket,
                                             const WifiMacHeader *hdr)
 {
-  MsduAggregator::DeaggregatedMsdus packets =
-    MsduAggregator::Deaggregate (aggregatedPacket);
-
-  for (MsduAggregator::DeaggregatedMsdusCI i = packets.begin ();
-       i != packets.end (); ++i)
+  AmsduSubframeHeader subframeHdr;
+  Ptr<Packet> msdu = 0;
+  //the last MSDU is aggregatedPacket itself
+  while (msdu != aggregatedPacket && aggregatedPacket->GetSize () > 0)
     {
-      ForwardUp ((*i).first, (*i).second.GetSourceAddr (),
-                 (*i).second.GetDestinationAddr ());
+      msdu = MsduAggregator::RemoveSubframe (aggregatedPacket, &subframeHdr);
+      ForwardUp (msdu, subframeHdr.GetSourceAddr (),
+                 subframeHdr.GetDestinationAddr ());
     }
 }
 
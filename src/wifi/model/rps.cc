@@ -22,6 +22,7 @@
 #include "ns3/assert.h"
 #include "ns3/log.h" //for test
 #include <sstream>
+#include <atomic>
 
 namespace ns3 {
 
@@ -233,6 +234,7 @@ RPS::RawAssignment::GetRawTypeIndex (void) const
 RPS::RPS ()
 {
   m_length = 0;
+  m_generation = NewGeneration ();
 }
 
 RPS::~RPS ()
@@ -277,6 +279,7 @@ RPS::SetRawAssignment (RPS::RawAssignment raw)
 	//m_length++;
 
 	m_rps = &m_rpsarry[0];
+	m_generation = NewGeneration ();
 	//printf (" set m_rps %x\n" , m_rps[6]);
 
 	/*std::cout << "GetRawControl-----" << (unsigned int)assignment.GetRawControl() << std::endl;
@@ -357,6 +360,7 @@ RPS::DeserializeInformationField (Buffer::Iterator start, uint8_t length)
   start.Read (m_rpsarry_temp, length);
   m_rps = m_rpsarry_temp;
   m_length = length;
+  m_generation = NewGeneration ();
   return length;
 }
 
@@ -366,6 +370,32 @@ RPS::GetNumberOfRawGroups () const
 	return m_length / 6;
 }
 
+uint64_t
+RPS::GetHash () const
+{
+  // 64-bit FNV-1a
+  uint64_t hash = 14695981039346656037ULL;
+  for (uint8_t i = 0; i < m_length; i++)
+    {
+      hash = (hash ^ m_rps[i]) * 1099511628211ULL;
+    }
+  return hash ^ m_length;
+}
+
+uint64_t
+RPS::GetGeneration () const
+{
+  return m_generation;
+}
+
+uint64_t
+RPS::NewGeneration ()
+{
+  // shared by the partitions of a multithreaded simulation
+  static std::atomic<uint64_t> next (1);
+  return next++;
+}
+
 ATTRIBUTE_HELPER_CPP (RPS);
 
 std::ostream &
@@ -385,6 +415,7 @@ operator << (std::ostream &os, const RPS &rps)
     operator >> (std::istream &is, RPS &rps)
     {
         is >> rps.m_length;
+        rps.m_generation = RPS::NewGeneration ();
         return is;
     }
 
@@ -123,14 +123,31 @@ public:
   void SerializeInformationField (Buffer::Iterator start) const;
   uint8_t DeserializeInformationField (Buffer::Iterator start, uint8_t length);
   uint8_t GetNumberOfRawGroups (void) const;
+  /**
+   * \return a hash of the RAW Assignments, equal for RPS elements with the same content
+   */
+  uint64_t GetHash (void) const;
+  /**
+   * \return a stamp of the RAW Assignments, renewed whenever they change
+   *
+   * The stamps are unique among all the RPS elements, so a cache built
+   * from an RPS is up to date as long as the stamp it recorded is equal.
+   */
+  uint64_t GetGeneration (void) const;
 
   uint8_t m_length;
+  friend std::istream &operator >> (std::istream &is, RPS &rps);
 private:
   RPS::RawAssignment assignment; //!< RawAssignment subfield
   uint8_t * m_rps; //! Support up to 10 RAW Assignment subfield
   //uint8_t m_rpsarry[12];
     uint8_t m_rpsarry_temp[1200];
   std::vector<uint8_t> m_rpsarry;
+  uint64_t m_generation; //!< stamp of the RAW Assignments
+  /**
+   * \return a new RAW Assignments stamp
+   */
+  static uint64_t NewGeneration (void);
   
   //uint8_t m_length; //!< Total length of all RAW Assignments
 };
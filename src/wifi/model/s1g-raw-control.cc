@@ -46,6 +46,7 @@
 #include <algorithm>    // std::find
 #include <vector>       // std::vector
 #include <fstream>
+#include <sstream>
 #include <string>
 
 #include <stdio.h>
@@ -203,8 +204,125 @@ OffloadStation::GetFailedTransmissionCount (void) const
     return m_offloadFailedCount;
 }
 
+//S1gRawCtrLogger
+#define S1G_RAW_CTR_LOGGER_BUFFER_SIZE 4194304 //flush when 4MB are pending
+
+S1gRawCtrLogger::S1gRawCtrLogger ()
+  : m_entries (S1gRawCtr::MAX_AID),
+    m_enabled (false),
+    m_pending (0)
+{
+  for (std::vector<Entry>::iterator it = m_entries.begin (); it != m_entries.end (); it++)
+    {
+      it->registered = false;
+      it->created = false;
+      it->truncate = false;
+    }
+}
+
+S1gRawCtrLogger::~S1gRawCtrLogger ()
+{
+  Flush ();
+}
+
+void
+S1gRawCtrLogger::SetOutputPath (const std::string &outputpath)
+{
+  if (m_enabled && outputpath != m_outputpath)
+    {
+      Flush ();
+      for (std::vector<uint16_t>::iterator it = m_registered.begin (); it != m_registered.end (); it++)
+        {
+          m_entries[*it].created = false;
+        }
+    }
+  m_outputpath = outputpath;
+  m_enabled = true;
+}
+
+void
+S1gRawCtrLogger::Register (uint16_t aid, bool truncate)
+{
+  NS_ASSERT (aid < m_entries.size ());
+  if (m_entries[aid].registered)
+    {
+      return;
+    }
+  m_entries[aid].registered = true;
+  m_entries[aid].truncate = truncate;
+  m_registered.push_back (aid);
+}
+
+void
+S1gRawCtrLogger::Append (uint16_t aid, const char *line, int len)
+{
+  NS_ASSERT (aid < m_entries.size ());
+  if (!m_enabled || len <= 0)
+    {
+      return;
+    }
+  Register (aid, false);
+  m_entries[aid].buffer.append (line, len);
+  m_pending += len;
+  if (m_pending >= S1G_RAW_CTR_LOGGER_BUFFER_SIZE)
+    {
+      Flush ();
+    }
+}
+
+void
+S1gRawCtrLogger::WriteLine (uint16_t aid, uint64_t c0, uint64_t c1, uint64_t c2)
+{
+  char line[96];
+  int len = snprintf (line, sizeof (line), "%llu\t%llu\t%llu\n", (unsigned long long)c0, (unsigned long long)c1, (unsigned long long)c2);
+  Append (aid, line, len);
+}
+
+void
+S1gRawCtrLogger::WriteLine (uint16_t aid, uint64_t c0, uint64_t c1, uint64_t c2, uint64_t c3)
+{
+  char line[128];
+  int len = snprintf (line, sizeof (line), "%llu\t%llu\t%llu\t%llu\n", (unsigned long long)c0, (unsigned long long)c1, (unsigned long long)c2, (unsigned long long)c3);
+  Append (aid, line, len);
+}
+
+void
+S1gRawCtrLogger::Flush (void)
+{
+  if (!m_enabled)
+    {
+      return;
+    }
+  std::ofstream outputfile;
+  std::ostringstream APId;
+  for (std::vector<uint16_t>::iterator it = m_registered.begin (); it != m_registered.end (); it++)
+    {
+      Entry &entry = m_entries[*it];
+      if (entry.created && entry.buffer.empty ())
+        {
+          continue;
+        }
+      APId.clear ();
+      APId.str ("");
+      APId << (*it);
+      std::string sensorfile = m_outputpath + APId.str () + ".txt";
+      outputfile.open (sensorfile, std::ios::out | ((entry.truncate && !entry.created) ? std::ios::trunc : std::ios::app));
+      outputfile << entry.buffer;
+      outputfile.close ();
+      entry.created = true;
+      entry.buffer.clear ();
+    }
+  m_pending = 0;
+}
+
 //
 S1gRawCtr::S1gRawCtr ()
+  : m_sensorByAid (MAX_AID, nullptr),
+    m_offloadByAid (MAX_AID, nullptr),
+    m_lastTransmissionPos (MAX_AID),
+    m_receivedCount (MAX_AID, 0),
+    m_receivedNum (0),
+    m_mark (MAX_AID, false)
 {
    RpsIndex = 0;
    m_offloadFailedMax = 5;
@@ -225,103 +343,157 @@ S1gRawCtr::S1gRawCtr ()
 
 S1gRawCtr::~S1gRawCtr ()
 {
+  for (StationsCI it = m_stations.begin (); it != m_stations.end (); it++)
+    {
+      delete (*it);
+    }
+  for (OffloadStationsCI it = m_offloadStations.begin (); it != m_offloadStations.end (); it++)
+    {
+      delete (*it);
+    }
+}
+
+void
+S1gRawCtr::AddSensorSta (uint16_t aid)
+{
+  NS_ASSERT (aid < MAX_AID);
+  if (m_sensorByAid[aid] != nullptr)
+    {
+      return;
+    }
+  Sensor * m_sta = new Sensor;
+  m_sta->SetAid (aid);
+  m_sta->EstimateNextTransmissionId (currentId+1);
+  //initialize UpdateInfo struct
+  m_sta->SetEverSuccess (false);
+  m_sta->m_snesorUpdatInfo = (UpdateInfo){currentId,currentId,currentId,false,currentId,currentId,currentId,false};
+  for (uint16_t i = 0; i < m_sta->m_transIntervalListSize; i++)
+    {
+      m_sta->m_transIntervalList.push_back(1);
+    }
+  m_stations.push_back (m_sta);
+  m_sensorByAid[aid] = m_sta;
+  m_logger.Register (aid, false);
+  m_lastTransmissionPos[aid] = m_lastTransmissionList.insert (m_lastTransmissionList.end (), aid);
+  NS_LOG_DEBUG ("initial, aid = " << aid);
 }
 
 void
-S1gRawCtr::UdpateSensorStaInfo (std::vector<uint16_t> m_sensorlist, std::vector<uint16_t> m_receivedAid, std::string outputpath)
+S1gRawCtr::AddOffloadSta (uint16_t aid)
 {
-   //initialization
-  //if sorted queue is empty, put all sensor into queue
-  std::string ApNode;
-  std::ofstream outputfile;
-  std::ostringstream APId;
+  NS_ASSERT (aid < MAX_AID);
+  if (m_offloadByAid[aid] != nullptr)
+    {
+      return;
+    }
+  OffloadStation * m_offloadSta = new OffloadStation;
+  m_offloadSta->SetAid (aid);
+  m_offloadSta->SetOffloadStaActive (true);
+  m_offloadSta->IncreaseFailedTransmissionCount (0);
+  m_offloadStations.push_back (m_offloadSta);
+  m_offloadByAid[aid] = m_offloadSta;
+  m_logger.Register (aid, true);
+  NS_LOG_DEBUG ("m_offloadStations.size () = " << m_offloadStations.size ());
+}
 
-  uint16_t numsensor = m_sensorlist.size (); //need to be improved
-  /*if (m_stations.size() < numsensor)
-     {
-      for (uint16_t i = m_stations.size(); i < numsensor; i++)
-        {
-            Sensor * m_sta = new Sensor;
-            m_sta->SetAid (i+1);
-            m_sta->EstimateNextTransmissionId (currentId+1);
-            //NS_LOG_UNCOND ("initial, set next id = " << currentId);
-            //initialize UpdateInfo struct
-            m_sta->SetEverSuccess (false);
-            m_sta->m_snesorUpdatInfo = (UpdateInfo){currentId,currentId,currentId,false,currentId,currentId,currentId,false};
-            //
-            m_stations.push_back (m_sta); // should create a Dispose function?
-            //
-            APId.clear ();
-            APId.str ("");
-            APId << (i+1);
-            ApNode = APId.str();
-            sensorfile = outputpath + ApNode + ".txt";
-            outputfile.open (sensorfile, std::ios::out | std::ios::trunc);
-            outputfile.close();
-            //
-        }
-     } */
+void
+S1gRawCtr::RemoveSensorSta (uint16_t aid)
+{
+  if (aid >= MAX_AID || m_sensorByAid[aid] == nullptr)
+    {
+      return;
+    }
+  Sensor * m_sta = m_sensorByAid[aid];
+  m_stations.erase (std::find (m_stations.begin (), m_stations.end (), m_sta));
+  m_lastTransmissionList.erase (m_lastTransmissionPos[aid]);
+  m_sensorByAid[aid] = nullptr;
+  delete m_sta;
+  NS_LOG_DEBUG ( "Aid " << aid << " erased from m_stations since disassociated");
+}
 
-    for (std::vector<uint16_t>::iterator ci = m_sensorlist.begin(); ci != m_sensorlist.end(); ci++)
+void
+S1gRawCtr::NotifyReceived (uint16_t aid)
+{
+  if (aid >= MAX_AID)
     {
-        if (LookupSensorSta (*ci) == nullptr)
-        {
-            Sensor * m_sta = new Sensor;
-            m_sta->SetAid (*ci);
-            m_sta->EstimateNextTransmissionId (currentId+1);
-            //NS_LOG_UNCOND ("initial, set next id = " << currentId);
-            //initialize UpdateInfo struct
-            m_sta->SetEverSuccess (false);
-            m_sta->m_snesorUpdatInfo = (UpdateInfo){currentId,currentId,currentId,false,currentId,currentId,currentId,false};
-            for (uint16_t i = 0; i < m_sta->m_transIntervalListSize; i++)
-            {
-                m_sta->m_transIntervalList.push_back(1);
-            }
-            //
-            m_stations.push_back (m_sta); // should create a Dispose function?
-            //
-            APId.clear ();
-            APId.str ("");
-            APId << (*ci);
-            ApNode = APId.str();
-            sensorfile = outputpath + ApNode + ".txt";
-            outputfile.open (sensorfile, std::ios::out | std::ios::app);
-            outputfile.close();
-            //
-            m_lastTransmissionList.push_back (*ci);
-            NS_LOG_UNCOND ("initial, aid = " << *ci);
+      return;
+    }
+  if (m_receivedCount[aid] == 0)
+    {
+      m_receivedList.push_back (aid);
+    }
+  if (m_receivedCount[aid] < 0xffff)
+    {
+      m_receivedCount[aid]++;
+    }
+  m_receivedNum++;
+}
 
-        }
+void
+S1gRawCtr::ResetReceived (void)
+{
+  for (std::vector<uint16_t>::iterator it = m_receivedList.begin (); it != m_receivedList.end (); it++)
+    {
+      m_receivedCount[*it] = 0;
     }
+  m_receivedList.clear ();
+  m_receivedNum = 0;
+}
 
-    bool disassoc;
-    //for (StationsCI it = m_stations.begin(); it != m_stations.end(); it++)
-    StationsCI itcheck = m_stations.begin();
-    for (uint16_t i = 0; i < m_stations.size(); i++)
+void
+S1gRawCtr::Flush (void)
+{
+  m_logger.Flush ();
+}
 
+void
+S1gRawCtr::SyncSensorSta (const std::vector<uint16_t> &m_sensorlist)
+{
+  for (std::vector<uint16_t>::const_iterator ci = m_sensorlist.begin(); ci != m_sensorlist.end(); ci++)
     {
-        disassoc = true;
-        for (std::vector<uint16_t>::iterator ci = m_sensorlist.begin(); ci != m_sensorlist.end(); ci++)
-        {
-            if ((*itcheck)->GetAid ()  == *ci)
-             {
-                 disassoc = false;
-                 if (i < m_stations.size() - 1)
-                     itcheck++;  //avoid itcheck increase to m_sensorlist.end()
-                 break;
-             }
-        }
-
-      if (disassoc == true)
+      AddSensorSta (*ci);
+      m_mark[*ci] = true;
+    }
+  //remove disassociated sensors in one pass
+  StationsCI keep = m_stations.begin ();
+  for (StationsCI it = m_stations.begin (); it != m_stations.end (); it++)
+    {
+      uint16_t aid = (*it)->GetAid ();
+      if (m_mark[aid])
         {
-            NS_LOG_UNCOND ( "Aid " << (*itcheck)->GetAid () << " erased from m_stations since disassociated");
-            m_stations.erase(itcheck);
+          *keep++ = *it;
+          continue;
         }
+      NS_LOG_DEBUG ( "Aid " << aid << " erased from m_stations since disassociated");
+      m_lastTransmissionList.erase (m_lastTransmissionPos[aid]);
+      m_sensorByAid[aid] = nullptr;
+      delete (*it);
+    }
+  m_stations.erase (keep, m_stations.end ());
+  for (std::vector<uint16_t>::const_iterator ci = m_sensorlist.begin(); ci != m_sensorlist.end(); ci++)
+    {
+      m_mark[*ci] = false;
     }
+}
 
+void
+S1gRawCtr::SyncOffloadSta (const std::vector<uint16_t> &m_OffloadList)
+{
+  for (std::vector<uint16_t>::const_iterator ci = m_OffloadList.begin(); ci != m_OffloadList.end(); ci++)
+    {
+      AddOffloadSta (*ci);
+    }
+}
 
+void
+S1gRawCtr::UdpateSensorStaInfo (void)
+{
+    NS_LOG_DEBUG ("m_aidList.size() = " << m_aidList.size() << ", m_receivedAid = " << m_receivedNum << ", m_stations.size() = " << m_stations.size() << ", currentId = " << currentId);
 
-    NS_LOG_UNCOND ("m_aidList.size() = " << m_aidList.size() << ", m_receivedAid = " << m_receivedAid.size () << ", m_stations.size() = " << m_stations.size() << ", currentId = " << currentId);
+    for (std::vector<uint16_t>::iterator it = m_aidList.begin(); it != m_aidList.end(); it++)
+     {
+        m_mark[*it] = true;
+     }
 
     //update transmission interval info, stations allowed to transmit in last beacon
     for (std::vector<uint16_t>::iterator it = m_aidList.begin(); it != m_aidList.end(); it++)
@@ -329,77 +501,35 @@ S1gRawCtr::UdpateSensorStaInfo (std::vector<uint16_t> m_sensorlist, std::vector<
         Sensor * stationTransmit = LookupSensorSta (*it);
          if (stationTransmit == nullptr)
          {
-             return;
+             continue;
          }
 
-         m_receivedsuccess = false;
-         for (std::vector<uint16_t>::iterator ci = m_receivedAid.begin(); ci != m_receivedAid.end(); ci++)
-         {
-
-             if (*ci == *it)
+         if (m_receivedCount[*it] > 0)
+          {
+            stationTransmit->SetTransmissionSuccess (true);
+            if (stationTransmit->GetEverSuccess () == false)
               {
-                //NS_LOG_UNCOND ("stations of aid " << *it << " received");
-                stationTransmit->SetTransmissionSuccess (true);
-                  //output to files.
-                  //write into currentID  coulumn
-                  //write  into allowed to send coulumn
-                  //write  into reaeived to receive coulumn
-                  /* APId.clear ();
-                  APId.str ("");
-                  APId << (*it);
-                  ApNode = APId.str();
-
-                  sensorfile = outputpath + ApNode + ".txt";
-                  outputfile.open (sensorfile, std::ios::out | std::ios::app);
-                  outputfile << currentId << "\t" << "1" << "\t" << "1" << "\n";
-                  outputfile.close(); */
-                  //
-
-                if (stationTransmit->GetEverSuccess () == false)
+                  stationTransmit->m_snesorUpdatInfo = (UpdateInfo){currentId-1,currentId-1,currentId-1,false,currentId-1,currentId-1,currentId-1,false};
+                  stationTransmit->SetEverSuccess (true);
+                  for (std::vector<uint16_t>::iterator ci = stationTransmit->m_transIntervalList.begin(); ci != stationTransmit->m_transIntervalList.end(); ci++)
                   {
-                      stationTransmit->m_snesorUpdatInfo = (UpdateInfo){currentId-1,currentId-1,currentId-1,false,currentId-1,currentId-1,currentId-1,false};
-                      stationTransmit->SetEverSuccess (true);
-                      /*for (uint16_t i = 0; i < stationTransmit->m_transIntervalListSize; i++)
-                      {
-                          stationTransmit->m_transIntervalList.push_back(1);
-                      }*/
-                      for (std::vector<uint16_t>::iterator ci = stationTransmit->m_transIntervalList.begin(); ci != stationTransmit->m_transIntervalList.end(); ci++)
-                      {
-                          (*ci) = 1;
-                      }
+                      (*ci) = 1;
                   }
+              }
 
-                stationTransmit->m_snesorUpdatInfo.lastTryBFpreSuccessId = stationTransmit->m_snesorUpdatInfo.lastTryBFCurrentSuccessId; //update, swith current to pre
-
-                stationTransmit->m_snesorUpdatInfo.preSuccessId = stationTransmit->m_snesorUpdatInfo.CurrentSuccessId; //update, swith current to pre
-                stationTransmit->m_snesorUpdatInfo.CurrentSuccessId = currentId;
-
-                  stationTransmit->m_snesorUpdatInfo.lastTryBFCurrentSuccessId = std::max(stationTransmit->m_snesorUpdatInfo.preSuccessId, stationTransmit->m_snesorUpdatInfo.CurrentUnSuccessId);
+            stationTransmit->m_snesorUpdatInfo.lastTryBFpreSuccessId = stationTransmit->m_snesorUpdatInfo.lastTryBFCurrentSuccessId; //update, swith current to pre
 
-                stationTransmit->m_snesorUpdatInfo.preTrySuccess = stationTransmit->m_snesorUpdatInfo.CurrentTrySuccess;
-                stationTransmit->m_snesorUpdatInfo.CurrentTrySuccess = true;
+            stationTransmit->m_snesorUpdatInfo.preSuccessId = stationTransmit->m_snesorUpdatInfo.CurrentSuccessId; //update, swith current to pre
+            stationTransmit->m_snesorUpdatInfo.CurrentSuccessId = currentId;
 
-                goto EstimateInterval;
-              }
-         }
+            stationTransmit->m_snesorUpdatInfo.lastTryBFCurrentSuccessId = std::max(stationTransmit->m_snesorUpdatInfo.preSuccessId, stationTransmit->m_snesorUpdatInfo.CurrentUnSuccessId);
 
-
-            //NS_LOG_UNCOND ("stations of aid " << *it << " not received");
+            stationTransmit->m_snesorUpdatInfo.preTrySuccess = stationTransmit->m_snesorUpdatInfo.CurrentTrySuccess;
+            stationTransmit->m_snesorUpdatInfo.CurrentTrySuccess = true;
+          }
+         else
+          {
             stationTransmit->SetTransmissionSuccess (false);
-            //output to files.
-            //write into currentID  coulumn
-            //write  into allowed to send coulumn
-            //write  into received to receive coulumn
-           /* APId.clear ();
-            APId.str ("");
-            APId << (*it);
-            ApNode = APId.str();
-
-            sensorfile = outputpath + ApNode + ".txt";
-            outputfile.open (sensorfile, std::ios::out | std::ios::app);
-            outputfile << currentId << "\t" << "1" << "\t" << "0" << "\n";
-            outputfile.close(); */
-            //
 
             stationTransmit->m_snesorUpdatInfo.preUnsuccessId = stationTransmit->m_snesorUpdatInfo.CurrentUnSuccessId; //update, swith current to pre
             stationTransmit->m_snesorUpdatInfo.CurrentUnSuccessId = currentId;
@@ -407,11 +537,7 @@ S1gRawCtr::UdpateSensorStaInfo (std::vector<uint16_t> m_sensorlist, std::vector<
 
             stationTransmit->m_snesorUpdatInfo.preTrySuccess = stationTransmit->m_snesorUpdatInfo.CurrentTrySuccess;
             stationTransmit->m_snesorUpdatInfo.CurrentTrySuccess = false;
-
-    EstimateInterval :
-           //stationTransmit->EstimateTransmissionInterval (currentId);
-           //NS_LOG_UNCOND ("... "); //to do, remove it
-         uint16_t add=0;
+          }
      }
 
     for (std::vector<uint16_t>::iterator it = m_aidList.begin(); it != m_aidList.end(); it++)
@@ -419,97 +545,58 @@ S1gRawCtr::UdpateSensorStaInfo (std::vector<uint16_t> m_sensorlist, std::vector<
         Sensor * stationTransmit = LookupSensorSta (*it);
         if (stationTransmit == nullptr)
           {
-            return;
-          }
-
-        uint16_t m_numReceived = 0;
-        for (std::vector<uint16_t>::iterator ci = m_receivedAid.begin(); ci != m_receivedAid.end(); ci++)
-          {
-            if (*ci == *it)
-             {
-                m_numReceived++;
-             }
+            continue;
           }
 
-        //NS_LOG_UNCOND ("stations of aid " << *it << " received " << m_numReceived << " packets");
-
-         APId.clear ();
-         APId.str ("");
-         APId << (*it);
-         ApNode = APId.str();
-
-         sensorfile = outputpath + ApNode + ".txt";
-         outputfile.open (sensorfile, std::ios::out | std::ios::app);
-         outputfile << currentId << "\t" << "1" << "\t" << m_numReceived << "\t" << stationTransmit->GetTransInOneBeacon () << "\n";
-         outputfile.close();
+        uint16_t m_numReceived = m_receivedCount[*it];
+        m_logger.WriteLine (*it, currentId, 1, m_numReceived, stationTransmit->GetTransInOneBeacon ());
 
-         stationTransmit->SetNumPacketsReceived (m_numReceived);
-         stationTransmit->EstimateTransmissionInterval (currentId, m_beaconInterval);
+        stationTransmit->SetNumPacketsReceived (m_numReceived);
+        stationTransmit->EstimateTransmissionInterval (currentId, m_beaconInterval);
      }
 
- for (std::vector<uint16_t>::iterator ci = m_receivedAid.begin(); ci != m_receivedAid.end(); ci++)
+    //stations that transmitted without being allowed to
+    for (std::vector<uint16_t>::iterator ci = m_receivedList.begin(); ci != m_receivedList.end(); ci++)
     {
-      uint16_t m_numReceived = 0;
-      bool match = false;
-      for (std::vector<uint16_t>::iterator it = m_aidList.begin(); it != m_aidList.end(); it++)
-         {
-             if (*ci == *it)
+        Sensor * stationTransmit = LookupSensorSta (*ci);
+        if (stationTransmit == nullptr || m_mark[*ci])
+          {
+            continue;
+          }
+        m_aidList.push_back (*ci);
+        m_mark[*ci] = true;
+        if (stationTransmit->GetEverSuccess () == false)
+          {
+            stationTransmit->m_snesorUpdatInfo = (UpdateInfo){currentId-1,currentId-1,currentId-1,false,currentId-1,currentId-1,currentId-1,false};
+            stationTransmit->SetEverSuccess (true);
+            for (std::vector<uint16_t>::iterator ct = stationTransmit->m_transIntervalList.begin(); ct != stationTransmit->m_transIntervalList.end(); ct++)
               {
-                match = true;
-                break;
+                (*ct) = 1;
               }
-         }
-
-        Sensor * stationTransmit = LookupSensorSta (*ci);
-    if (stationTransmit != nullptr && !match)
-        {
-            m_aidList.push_back (*ci); //trick, avoid same receiveAid repeate several times
-             if (stationTransmit->GetEverSuccess () == false)
-             {
-                 stationTransmit->m_snesorUpdatInfo = (UpdateInfo){currentId-1,currentId-1,currentId-1,false,currentId-1,currentId-1,currentId-1,false};
-                 stationTransmit->SetEverSuccess (true);
-                 for (std::vector<uint16_t>::iterator ci = stationTransmit->m_transIntervalList.begin(); ci != stationTransmit->m_transIntervalList.end(); ci++)
-                 {
-                     (*ci) = 1;
-                 }
-             }
-             stationTransmit->SetTransmissionSuccess (true);
-
-             stationTransmit->m_snesorUpdatInfo.lastTryBFpreSuccessId = stationTransmit->m_snesorUpdatInfo.lastTryBFCurrentSuccessId; //update, swith current to pre
+          }
+        stationTransmit->SetTransmissionSuccess (true);
 
-             stationTransmit->m_snesorUpdatInfo.preSuccessId = stationTransmit->m_snesorUpdatInfo.CurrentSuccessId; //update, swith current to pre
-             stationTransmit->m_snesorUpdatInfo.CurrentSuccessId = currentId;
+        stationTransmit->m_snesorUpdatInfo.lastTryBFpreSuccessId = stationTransmit->m_snesorUpdatInfo.lastTryBFCurrentSuccessId; //update, swith current to pre
 
-             stationTransmit->m_snesorUpdatInfo.lastTryBFCurrentSuccessId = std::max(stationTransmit->m_snesorUpdatInfo.preSuccessId, stationTransmit->m_snesorUpdatInfo.CurrentUnSuccessId);
+        stationTransmit->m_snesorUpdatInfo.preSuccessId = stationTransmit->m_snesorUpdatInfo.CurrentSuccessId; //update, swith current to pre
+        stationTransmit->m_snesorUpdatInfo.CurrentSuccessId = currentId;
 
-             stationTransmit->m_snesorUpdatInfo.preTrySuccess = stationTransmit->m_snesorUpdatInfo.CurrentTrySuccess;
-             stationTransmit->m_snesorUpdatInfo.CurrentTrySuccess = true;
+        stationTransmit->m_snesorUpdatInfo.lastTryBFCurrentSuccessId = std::max(stationTransmit->m_snesorUpdatInfo.preSuccessId, stationTransmit->m_snesorUpdatInfo.CurrentUnSuccessId);
 
-             //NS_LOG_UNCOND ("stations of aid " << *it << " received " << m_numReceived << " packets");
+        stationTransmit->m_snesorUpdatInfo.preTrySuccess = stationTransmit->m_snesorUpdatInfo.CurrentTrySuccess;
+        stationTransmit->m_snesorUpdatInfo.CurrentTrySuccess = true;
 
-            for (std::vector<uint16_t>::iterator ct = m_receivedAid.begin(); ct != m_receivedAid.end(); ct++)
-            {
-                if (*ci == *ct)
-                {
-                    m_numReceived++;
-                }
-            }
+        uint16_t m_numReceived = m_receivedCount[*ci];
+        m_logger.WriteLine (*ci, currentId, 0, m_numReceived, stationTransmit->GetTransInOneBeacon ());
 
-             APId.clear ();
-             APId.str ("");
-             APId << (*ci);
-             ApNode = APId.str();
-
-             sensorfile = outputpath + ApNode + ".txt";
-             outputfile.open (sensorfile, std::ios::out | std::ios::app);
-             outputfile << currentId << "\t" << "0" << "\t" << m_numReceived << "\t" << stationTransmit->GetTransInOneBeacon () << "\n";
-             outputfile.close();
-
-             stationTransmit->SetNumPacketsReceived (m_numReceived);
-             stationTransmit->EstimateTransmissionInterval (currentId, m_beaconInterval);
-        }
+        stationTransmit->SetNumPacketsReceived (m_numReceived);
+        stationTransmit->EstimateTransmissionInterval (currentId, m_beaconInterval);
     }
 
+    for (std::vector<uint16_t>::iterator it = m_aidList.begin(); it != m_aidList.end(); it++)
+     {
+        m_mark[*it] = false;
+     }
 }
 
 void
@@ -738,59 +825,45 @@ S1gRawCtr::SetSensorAllowedToSend ()
    NS_LOG_UNCOND ("m_numSendSensorWant = " << m_numSendSensorWant << ", numAllowed based on faireness = " << numAllowed);
 
    uint32_t SendNum = 0;
-     
-   std::vector<uint16_t>::iterator it = m_lastTransmissionList.begin();
-   //for (std::vector<uint16_t>::iterator it = m_lastTransmissionList.begin(); it != m_lastTransmissionList.end(); it++)
-    for (uint16_t i = 0; i < m_lastTransmissionList.size (); i++)
+
+   //stations allowed to send move to the back, so the list stays ordered by last transmission
+   uint32_t numListed = m_lastTransmissionList.size ();
+   std::list<uint16_t>::iterator it = m_lastTransmissionList.begin();
+    for (uint32_t i = 0; i < numListed; i++)
      {
-         Sensor * stationTransmit;
-         if (LookupSensorSta (*it) == nullptr) //disassociated station
+         std::list<uint16_t>::iterator position = it++;
+         Sensor * stationTransmit = LookupSensorSta (*position);
+         if (stationTransmit == nullptr) //disassociated station
            {
-             m_lastTransmissionList.erase (it);
-             it++;
+             m_lastTransmissionList.erase (position);
              continue;
            }
-         stationTransmit = LookupSensorSta (*it);
-         it++;
        if (stationTransmit->GetEstimateNextTransmissionId () <= currentId)
         {
            if (SendNum == m_numSendSensorAllowed)
              {
                 stationTransmit->EstimateNextTransmissionId (currentId+1);
                 //Postpone transmission to next interval
-                //NS_LOG_UNCOND ("aid = " << stationTransmit->GetAid () << " not allwed to send, since its full ");
-                //NS_LOG_UNCOND ("update NextTransmissionId to = " << currentId+1);
              }
            else if ( SendNum + stationTransmit->GetTransInOneBeacon () > m_numSendSensorAllowed)
             {
                 stationTransmit->EstimateNextTransmissionId (currentId+1);
                 //Postpone transmission to next interval
-                //NS_LOG_UNCOND ("aid = " << stationTransmit->GetAid () << " not allwed to send, since transmit number is " << stationTransmit->GetTransInOneBeacon () );
-                //NS_LOG_UNCOND ("update NextTransmissionId to = " << currentId+1);
 
                 uint8_t numleft = m_numSendSensorAllowed - SendNum;
                 if (numleft > 0)
                  {
-                     it--;
                      stationTransmit->SetTransInOneBeacon (numleft);
                      m_aidList.push_back(stationTransmit->GetAid ());
-                     std::vector<uint16_t>::iterator position = LookupLastTransmission (stationTransmit->GetAid ());
-                     m_lastTransmissionList.erase (position);
-                     m_lastTransmissionList.push_back (stationTransmit->GetAid ());
+                     m_lastTransmissionList.splice (m_lastTransmissionList.end (), m_lastTransmissionList, position);
                      SendNum = SendNum + numleft;
-                     //NS_LOG_UNCOND ("reset Trans number to = " << numleft << " to send");
                  }
             }
            else
             {
-               it--;
                m_aidList.push_back(stationTransmit->GetAid ());
-               std::vector<uint16_t>::iterator position = LookupLastTransmission (stationTransmit->GetAid ());
-               m_lastTransmissionList.erase (position);
-               m_lastTransmissionList.push_back (stationTransmit->GetAid ());
+               m_lastTransmissionList.splice (m_lastTransmissionList.end (), m_lastTransmissionList, position);
                SendNum = SendNum + stationTransmit->GetTransInOneBeacon ();
-               //NS_LOG_UNCOND ("aid = " << stationTransmit->GetAid () << " allowed to send");
-
             }
          ////put first send stations to m_aidList, choose stations based on last transmission time.
         }
@@ -801,24 +874,11 @@ S1gRawCtr::SetSensorAllowedToSend ()
 
  }
 
-std::vector<uint16_t>::iterator
+std::list<uint16_t>::iterator
 S1gRawCtr::LookupLastTransmission (uint16_t aid)
 {
-
-    for (std::vector<uint16_t>::iterator it = m_lastTransmissionList.begin(); it != m_lastTransmissionList.end(); it++)
-    {
-       // NS_LOG_UNCOND ("m_lastTransmissionList = " << *it);
-    }
-
-  for (std::vector<uint16_t>::iterator it = m_lastTransmissionList.begin(); it != m_lastTransmissionList.end(); it++)
-    {
-        if (aid == *it)
-        {
-            return it;
-        }
-    }
-
-  NS_ASSERT ("ERROR OCUURS");
+  NS_ASSERT (LookupSensorSta (aid) != nullptr);
+  return m_lastTransmissionPos[aid];
 }
 
 
@@ -827,99 +887,29 @@ S1gRawCtr::LookupLastTransmission (uint16_t aid)
 
 //offload
 void
-S1gRawCtr::UdpateOffloadStaInfo (std::vector<uint16_t> m_OffloadList, std::vector<uint16_t> m_receivedAid, std::string outputpath)
-//to do
-//need to change Ap-wifi-mac.cc to get numsensor info
-//need to get successful transmission info.
-//this info can be got from static configuration or via association, should from association
+S1gRawCtr::UdpateOffloadStaInfo (void)
 {
-    //initialization
-    //if sorted queue is empty, put all offload stations into queue
-
-    /*uint16_t offloadstaNum = m_OffloadList.size (); //need to be improved
-    if (m_offloadStations.size() < offloadstaNum)
-    {
-        for (uint16_t i = m_offloadStations.size(); i < offloadstaNum; i++)
-        {
-            OffloadStation * m_offloadSta = new OffloadStation;
-            m_offloadSta->SetAid (6); //for test
-            m_offloadSta->SetOffloadStaActive (true);
-            m_offloadSta->IncreaseFailedTransmissionCount (0);
-            m_offloadStations.push_back (m_offloadSta); // should create a Dispose function?
-            NS_LOG_UNCOND ("m_offloadStations.size () = " << m_offloadStations.size ());
-
-        }
-        //return;
-    } should be removed*/
-
-
-    std::string ApNode;
-    std::ofstream outputfile;
-    std::ostringstream APId;
-
-
-    for (std::vector<uint16_t>::iterator ci = m_OffloadList.begin(); ci != m_OffloadList.end(); ci++)
-     {
-        if (LookupOffloadSta (*ci) == nullptr)
-          {
-              OffloadStation * m_offloadSta = new OffloadStation;
-              m_offloadSta->SetAid (*ci);
-              m_offloadSta->SetOffloadStaActive (true);
-              m_offloadSta->IncreaseFailedTransmissionCount (0);
-              m_offloadStations.push_back (m_offloadSta); // should create a Dispose function?
-              NS_LOG_UNCOND ("m_offloadStations.size () = " << m_offloadStations.size ());
-
-              APId.clear ();
-              APId.str ("");
-              APId << (*ci);
-              ApNode = APId.str();
-              sensorfile = outputpath + ApNode + ".txt";
-              outputfile.open (sensorfile, std::ios::out | std::ios::trunc);
-              outputfile.close();
-          }
-     }
-
     //update active offload stations' info.
     for (std::vector<uint16_t>::iterator it = m_aidOffloadList.begin(); it != m_aidOffloadList.end(); it++)
     {
         OffloadStation * OffloadStaTransmit = LookupOffloadSta (*it);
+        if (OffloadStaTransmit == nullptr)
+          {
+            continue;
+          }
 
-        for (std::vector<uint16_t>::iterator ci = m_receivedAid.begin(); ci != m_receivedAid.end(); ci++)
-        {
-            if (*ci == *it)
-            {
-                //NS_LOG_UNCOND ("stations of aid " << *it << " received, " << *ci);
-                //output to files.
-                APId.clear ();
-                APId.str ("");
-                APId << (*it);
-                ApNode = APId.str();
-                sensorfile = outputpath + ApNode + ".txt";
-                outputfile.open (sensorfile, std::ios::out | std::ios::app);
-                outputfile << currentId << "\t" << "1" << "\t" << "1" << "\n";
-                outputfile.close();
-                //
-                OffloadStaTransmit->SetTransmissionSuccess (true);
-                OffloadStaTransmit->IncreaseFailedTransmissionCount (1);
-                goto FailedMax;
-            }
-        }
-
-        //output to files.
-        //NS_LOG_UNCOND ("stations of aid " << *it << " not received");
-        APId.clear ();
-        APId.str ("");
-        APId << (*it);
-        ApNode = APId.str();
-        sensorfile = outputpath + ApNode + ".txt";
-        outputfile.open (sensorfile, std::ios::out | std::ios::app);
-        outputfile << currentId << "\t" << "1" << "\t" << "0" << "\n";
-        outputfile.close();
-        //
-
-        OffloadStaTransmit->SetTransmissionSuccess (false);
-        OffloadStaTransmit->IncreaseFailedTransmissionCount (0);
-    FailedMax:
+        if (m_receivedCount[*it] > 0)
+          {
+            m_logger.WriteLine (*it, currentId, 1, 1);
+            OffloadStaTransmit->SetTransmissionSuccess (true);
+            OffloadStaTransmit->IncreaseFailedTransmissionCount (1);
+          }
+        else
+          {
+            m_logger.WriteLine (*it, currentId, 1, 0);
+            OffloadStaTransmit->SetTransmissionSuccess (false);
+            OffloadStaTransmit->IncreaseFailedTransmissionCount (0);
+          }
         if (OffloadStaTransmit->GetFailedTransmissionCount () == m_offloadFailedMax)
             OffloadStaTransmit->SetOffloadStaActive (false);
 
@@ -994,35 +984,54 @@ S1gRawCtr::GetRPS ()
 
 // Beacon duration), before that use NGroup=1 and initialize by ap-wifi-mac
 RPS
-S1gRawCtr::UpdateRAWGroupping (std::vector<uint16_t> m_sensorlist, std::vector<uint16_t> m_OffloadList, std::vector<uint16_t> m_receivedAid, uint64_t BeaconInterval, std::string outputpath)
+S1gRawCtr::UpdateRAWGroupping (const std::vector<uint16_t> &m_sensorlist, const std::vector<uint16_t> &m_OffloadList, const std::vector<uint16_t> &m_receivedAid, uint64_t BeaconInterval, const std::string &outputpath)
  {
-     NS_ASSERT ("S1gRawCtr should not be called");
-     
+     m_logger.SetOutputPath (outputpath);
+     SyncSensorSta (m_sensorlist);
+     SyncOffloadSta (m_OffloadList);
+     ResetReceived ();
+     for (std::vector<uint16_t>::const_iterator ci = m_receivedAid.begin(); ci != m_receivedAid.end(); ci++)
+       {
+         NotifyReceived (*ci);
+       }
+     return UpdateRAWGroupping (BeaconInterval, outputpath);
+ }
+
+RPS
+S1gRawCtr::UpdateRAWGroupping (uint64_t BeaconInterval, const std::string &outputpath)
+ {
+     m_logger.SetOutputPath (outputpath);
      m_beaconInterval = BeaconInterval;
      //currentId++; //beaconInterval counter
-     //work here
-     UdpateSensorStaInfo (m_sensorlist,  m_receivedAid, outputpath);
-     UdpateOffloadStaInfo (m_OffloadList, m_receivedAid, outputpath);
-     //NS_LOG_UNCOND ("S1gRawCtr::UpdateRAWGrouppingaa =");
+     UdpateSensorStaInfo ();
+     UdpateOffloadStaInfo ();
+     ResetReceived ();
      currentId++; //next id, actually
      calculateSensorNumWantToSend ();
      calculateActiveOffloadSta ();
-     //NS_LOG_UNCOND ("S1gRawCtr::UpdateRAWGrouppingbb =");
-
 
      calculateMaybeAirtime ();
-     //NS_LOG_UNCOND ("S1gRawCtr::UpdateRAWGrouppingdd =");
 
      SetSensorAllowedToSend ();
      SetOffloadAllowedToSend ();
 
-     //NS_LOG_UNCOND ("S1gRawCtr::UpdateRAWGrouppingcc =");
      m_rps = new RPS;
      configureRAW ();
      RPS m_rpsAP =  GetRPS ();
      return m_rpsAP;
 }
 
+bool
+S1gRawCtr::UpdateRAWGroupping (RPSVector &rpsset, Ptr<RawOptimizer> optimizer)
+{
+  for (std::vector<uint16_t>::const_iterator ci = m_receivedList.begin (); ci != m_receivedList.end (); ci++)
+    {
+      optimizer->NotifyTraffic (*ci, m_receivedCount[*ci]);
+    }
+  ResetReceived ();
+  return optimizer->Optimize (rpsset);
+}
+
 void
 S1gRawCtr::deleteRps ()
 {
@@ -1227,32 +1236,24 @@ S1gRawCtr::configureRAW ( )
     //delete m_rps;
 }
 
-//what if lookup fails, is it possibile?
 Sensor *
 S1gRawCtr::LookupSensorSta (uint16_t aid)
 {
-   for (StationsCI it = m_stations.begin(); it != m_stations.end(); it++)
-   {
-       if (aid == (*it)->GetAid ())
-        {
-           return (*it);
-        }
-   }
-    return nullptr;
+  if (aid >= MAX_AID)
+    {
+      return nullptr;
+    }
+  return m_sensorByAid[aid];
 }
 
-//what if lookup fails, is it possibile?
 OffloadStation *
 S1gRawCtr::LookupOffloadSta (uint16_t aid)
 {
-    for (OffloadStationsCI it = m_offloadStations.begin(); it != m_offloadStations.end(); it++)
+  if (aid >= MAX_AID)
     {
-        if (aid == (*it)->GetAid ())
-        {
-            return (*it);
-        }
+      return nullptr;
     }
-    return nullptr;
+  return m_offloadByAid[aid];
 }
 
 void
@@ -29,6 +29,9 @@
 #include "supported-rates.h"
 #include "ns3/random-variable-stream.h"
 #include "rps.h"
+#include "raw-optimizer.h"
+#include <list>
+#include <string>
 
 namespace ns3 {
     
@@ -154,6 +157,39 @@ private:
     //failure here menas AP receives no packets.
 };
 
+/**
+ * Buffered per-AID output of S1gRawCtr (one "<outputpath><aid>.txt" file per station).
+ * Lines are kept in memory and every file is opened once per flush instead of once per line.
+ */
+class S1gRawCtrLogger
+{
+public:
+  S1gRawCtrLogger ();
+  ~S1gRawCtrLogger ();
+
+  void SetOutputPath (const std::string &outputpath);
+  void Register (uint16_t aid, bool truncate); //the file is created at the next flush
+  void WriteLine (uint16_t aid, uint64_t c0, uint64_t c1, uint64_t c2);
+  void WriteLine (uint16_t aid, uint64_t c0, uint64_t c1, uint64_t c2, uint64_t c3);
+  void Flush (void);
+
+private:
+  struct Entry
+  {
+    std::string buffer; //pending lines
+    bool registered;
+    bool created;       //whether the file has been opened once
+    bool truncate;      //whether the first open truncates the file
+  };
+  void Append (uint16_t aid, const char *line, int len);
+
+  std::vector<Entry> m_entries;    //indexed by AID
+  std::vector<uint16_t> m_registered;
+  std::string m_outputpath;
+  bool m_enabled;                  //no file is touched until an output path is set
+  uint32_t m_pending;              //bytes in all buffers
+};
+
 class S1gRawCtr
 {
 public:
@@ -162,14 +198,32 @@ public:
   S1gRawCtr ();
   virtual ~S1gRawCtr ();
 
-    RPS  UpdateRAWGroupping (std::vector<uint16_t> m_aidlist, std::vector<uint16_t> m_aidOffloadList, std::vector<uint16_t> m_receivedAid, uint64_t BeaconInterval, std::string outputpath);
+  static const uint32_t MAX_AID = 8192; //AIDs are 13 bits
+
+  //event-driven interface, called by the AP as stations associate/disassociate and packets arrive
+  void AddSensorSta (uint16_t aid);
+  void AddOffloadSta (uint16_t aid);
+  void RemoveSensorSta (uint16_t aid);
+  void NotifyReceived (uint16_t aid);
+  void ResetReceived (void);
+  void Flush (void);
+
+  //update with the stations and received AIDs reported since the last call
+  RPS  UpdateRAWGroupping (uint64_t BeaconInterval, const std::string &outputpath);
+  //update with full lists (registries are synchronized with the lists first)
+  RPS  UpdateRAWGroupping (const std::vector<uint16_t> &m_aidlist, const std::vector<uint16_t> &m_aidOffloadList, const std::vector<uint16_t> &m_receivedAid, uint64_t BeaconInterval, const std::string &outputpath);
+  //online update: hand the packets received per AID since the last call to the optimizer, which rebalances rpsset
+  //returns true if rpsset changed
+  bool UpdateRAWGroupping (RPSVector &rpsset, Ptr<RawOptimizer> optimizer);
 
   void configureRAW ();
   RPS GetRPS ();
     
   void deleteRps ();
-  void UdpateSensorStaInfo (std::vector<uint16_t> m_sensorlist, std::vector<uint16_t> m_receivedAid, std::string outputpath); //need to change, controlled by AP
-  void UdpateOffloadStaInfo (std::vector<uint16_t> m_OffloadList, std::vector<uint16_t>  receivedStas, std::string outputpath);
+  void SyncSensorSta (const std::vector<uint16_t> &m_sensorlist);
+  void SyncOffloadSta (const std::vector<uint16_t> &m_OffloadList);
+  void UdpateSensorStaInfo (void);
+  void UdpateOffloadStaInfo (void);
   void calculateActiveOffloadSta ();
   void SetOffloadAllowedToSend ();
   
@@ -182,7 +236,7 @@ public:
   Sensor * LookupSensorSta (uint16_t aid);
   OffloadStation * LookupOffloadSta (uint16_t aid); //can be combined with function LookupSensorSta.
     
-  std::vector<uint16_t>::iterator  LookupLastTransmission (uint16_t aid);
+  std::list<uint16_t>::iterator  LookupLastTransmission (uint16_t aid);
   
     
     typedef std::vector<Sensor *> Stations;
@@ -200,7 +254,7 @@ public:
     std::vector<uint16_t>::iterator m_aidListCI;
     std::vector<uint16_t> m_aidOffloadList;
     std::vector<uint16_t>::iterator m_aidOffloadListCI;
-    std::vector<uint16_t> m_lastTransmissionList;
+    std::list<uint16_t> m_lastTransmissionList; //sensors, least recently allowed to transmit first
     
 private:
     
@@ -234,7 +288,16 @@ private:
     
     bool  m_receivedsuccess;
     
-    std::string  sensorfile;
+    //registries indexed by AID
+    std::vector<Sensor *> m_sensorByAid;
+    std::vector<OffloadStation *> m_offloadByAid;
+    std::vector<std::list<uint16_t>::iterator> m_lastTransmissionPos; //position in m_lastTransmissionList
+    std::vector<uint16_t> m_receivedCount; //packets received since the last update
+    std::vector<uint16_t> m_receivedList;  //AIDs with m_receivedCount > 0, in arrival order
+    uint32_t m_receivedNum;                //packets received since the last update
+    std::vector<bool> m_mark;              //scratch marks (cleared after use)
+
+    S1gRawCtrLogger m_logger;
 };
 
 } //namespace ns3
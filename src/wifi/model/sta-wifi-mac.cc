@@ -173,6 +173,7 @@ StaWifiMac::StaWifiMac ()
   NS_LOG_FUNCTION (this);
   m_rawStart = false;
   m_dataBuffered = false;
+  m_rpsDecoded = false;
   m_aid = 8192;
   uint32_t cwmin = 15;
   uint32_t cwmax = 1023;
@@ -224,6 +225,9 @@ StaWifiMac::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
   m_pspollDca = 0;
+  m_beaconWakeUpEvent.Cancel ();
+  m_outsideRawEvent.Cancel ();
+  m_insideBackoffEvent.Cancel ();
   RegularWifiMac::DoDispose ();
 }
 
@@ -298,6 +302,59 @@ StaWifiMac::ClearDataBuffered()
   m_dataBuffered = false;
 }
 
+void
+StaWifiMac::DecodeRps (const RPS &rps)
+{
+  uint16_t raw_len = rps.GetInformationFieldSize();
+  uint16_t rawAssignment_len = 6;
+  if (raw_len % rawAssignment_len !=0){
+    NS_ASSERT ("RAW configuration incorrect!");
+  }
+  uint8_t RAW_number = raw_len/rawAssignment_len;
+
+  uint16_t m_slotDurationCount=0;
+  uint16_t m_slotNum=0;
+  uint64_t m_currentRAW_start=0;
+  m_lastRawDurationus = MicroSeconds(0);
+  for (uint8_t raw_index=0; raw_index < RAW_number; raw_index++){
+    auto ass = rps.GetRawAssigmentObj(raw_index);
+    // only support Generic Raw (paged STA RAW or not)
+    if (ass.GetRawTypeIndex() == 4){
+      m_pagedStaRaw = true;
+    }else{
+      m_pagedStaRaw = false;
+    }
+    m_currentRAW_start=m_currentRAW_start+(500 + m_slotDurationCount * 120)*m_slotNum;
+    m_slotDurationCount = ass.GetSlotDurationCount();
+    m_slotNum = ass.GetSlotNum();
+
+    m_slotDuration = MicroSeconds(500 + m_slotDurationCount * 120);
+    m_lastRawDurationus = m_lastRawDurationus + m_slotDuration * m_slotNum;
+    m_crossSlotBoundaryAllowed = ass.GetSlotCrossBoundary() == 0x0001;
+
+    //in the page indexed
+    if (ass.GetRawGroupPage() == ((GetAID() >> 11 ) & 0x0003)){
+      uint16_t statsPerSlot = 0;
+      uint16_t statRawSlot = 0;
+
+      uint16_t offset = 0; // for test
+      statsPerSlot = (ass.GetRawGroupAIDEnd() - ass.GetRawGroupAIDStart() + 1)/m_slotNum;
+      //statRawSlot = ((GetAID() & 0x03ff)-raw_start)/statsPerSlot;
+      statRawSlot = ((GetAID() & 0x07ff)+offset)%m_slotNum;
+
+      if ((ass.GetRawGroupAIDStart() <= (GetAID() & 0x07ff)) && ((GetAID() & 0x07ff) <= ass.GetRawGroupAIDEnd())){
+        m_statSlotStart = MicroSeconds((500 + m_slotDurationCount * 120)*statRawSlot+m_currentRAW_start);
+        SetInRAWgroup ();
+        m_currentslotDuration = m_slotDuration; //To support variable time duration among multiple RAWs
+
+        // NS_LOG_UNCOND (Simulator::Now () << ", StaWifiMac:: GetAID() = " << GetAID() <<  ", m_statSlotStart=" << m_statSlotStart << ", m_lastRawDurationus = " << m_lastRawDurationus << ", m_currentslotDuration = " << m_currentslotDuration);
+        //break; //break should not used if multiple RAW is supported
+      }
+      //NS_LOG_UNCOND (Simulator::Now () << ", StaWifiMac:: GetAID() = " << GetAID() << ", raw_start =" << raw_start << ", raw_end=" << raw_end << ", m_statSlotStart=" << m_statSlotStart << ", m_lastRawDurationus = " << m_lastRawDurationus << ", m_currentslotDuration = " << m_currentslotDuration);
+    }
+  }
+}
+
 void
 StaWifiMac::SetInRAWgroup()
 {
@@ -551,71 +608,19 @@ StaWifiMac::SendPspollIfnecessary (void)
 		m_DTIMPeriod = m_TIM.GetDTIMPeriod();
 		m_PageIndex = m_TIM.GetPageIndex();
 
-		uint8_t * partialVBitmap = m_TIM.GetPartialVBitmap();
-		//length =  m_TIM.GetInformationFieldSize ();
-		NS_ASSERT(m_TIM.GetInformationFieldSize() >= 5);
-		//NS_ASSERT (m_TIM.GetInformationFieldSize () >= 2);
-		uint8_t pos = 0;
-		do
+		// the TIM decodes every encoding mode of its Partial Virtual Bitmap
+		if (!m_TIM.IsAidPaged(GetAID()))
 		{
-			uint8_t blockind = ((*partialVBitmap) >> 3) & 0x1f;
-			partialVBitmap++;
-			pos++;
-			uint8_t blockbitmap = *partialVBitmap;
-			if (this->GetAID() == 5 || GetAID() == 9)
-			this->GetSelfPageSliceNum();
-			if (blockind == m_selfBlock)
-			{
-				if ((blockbitmap & (1 << m_selfSubBlock)) == 0) //no packets in subblock
-				{
-					//if not included in the page slice element, wake up for DTIM
-					// reset m_pagedInDtim;
-					m_pagedInDtim = false;
-					GoToSleepCurrentTIM(beacon);
-					return;
-				}
-				else
-				{
-					for (uint8_t j = 0; j <= m_selfSubBlock; j++)
-					{
-						if ((blockbitmap & (0x01 << j)))//==1 is incorrect because sometimes it can be 0000 0010 e.g. 2
-						{
-							partialVBitmap++;
-							pos++;
-						}
-					}
-					uint8_t subblockind = *partialVBitmap;
-					if ((subblockind & (1 << (m_selfAid & 0x0007))) == 0) //no packet for me
-					{
-						m_pagedInDtim = false;
-						GoToSleepCurrentTIM(beacon);
-						return;
-					}
-					else // if has packet, set station to sleep after this beacon
-					{
-						NS_LOG_INFO(
-								"[aid=" << this->GetAID() << "]" << "Downlink packet indicated for me.");
-						// reset m_pagedInDtim;
-						m_pagedInDtim = false;
-						GoToSleepNextTIM(beacon);
-						return;
-					}
-				}
-			}
-			else
-			{
-				for (uint8_t k = 0; k <= 7; k++)
-				{
-					if ((blockbitmap & (1 << k)) == 1)
-					{
-						partialVBitmap++;
-						pos++;
-					}
-				}
-			}
+			//no packets for me; an empty block is not encoded at all
+			m_pagedInDtim = false;
+			GoToSleepCurrentTIM(beacon);
+			return;
 		}
-		while (pos < m_TIM.GetInformationFieldSize() - 3); //only partialVBitmap; exclude DTIM COUNT,DTIM period and bitmap control
-		GoToSleepCurrentTIM(beacon);
+		NS_LOG_INFO(
+				"[aid=" << this->GetAID() << "]" << "Downlink packet indicated for me.");
+		// reset m_pagedInDtim;
+		m_pagedInDtim = false;
+		GoToSleepNextTIM(beacon);
 	}
 
 	void StaWifiMac::GoToSleepNextTIM(S1gBeaconHeader beacon) //to do, merge with GoToSleepCurrentTIM
@@ -1058,6 +1063,39 @@ StaWifiMac::SendDisAssociationRequest (void)
 
 }
 
+MgtAssocRequestHeader
+StaWifiMac::GetAssocRequest (void) const
+{
+  MgtAssocRequestHeader assoc;
+  assoc.SetSsid (GetSsid ());
+  assoc.SetSupportedRates (GetSupportedRates ());
+  if (m_htSupported)
+    {
+      assoc.SetHtCapabilities (GetHtCapabilities ());
+    }
+  if (m_s1gSupported)
+    {
+      assoc.SetS1gCapabilities (GetS1gCapabilities ());
+    }
+  return assoc;
+}
+
+void
+StaWifiMac::Associate (Mac48Address bssid, MgtAssocResponseHeader assocResp)
+{
+  NS_LOG_FUNCTION (this << bssid);
+  SetBssid (bssid);
+  if (m_probeRequestEvent.IsRunning ())
+    {
+      m_probeRequestEvent.Cancel ();
+    }
+  if (m_assocRequestEvent.IsRunning ())
+    {
+      m_assocRequestEvent.Cancel ();
+    }
+  RecordAssocResponse (bssid, assocResp);
+}
+
 void
 StaWifiMac::SendAssociationRequest (void)
 {
@@ -1078,24 +1116,12 @@ if (assocVaule < fastAssocThreshold)
   hdr.SetAddr3 (GetBssid ());
   hdr.SetDsNotFrom ();
   hdr.SetDsNotTo ();
-  Ptr<Packet> packet = Create<Packet> ();
-  MgtAssocRequestHeader assoc;
-  assoc.SetSsid (GetSsid ());
-  assoc.SetSupportedRates (GetSupportedRates ());
   if (m_htSupported)
     {
-      assoc.SetHtCapabilities (GetHtCapabilities ());
       hdr.SetNoOrder ();
     }
-
-  if (m_s1gSupported)
-    {
-        assoc.SetS1gCapabilities (GetS1gCapabilities ());
-        //NS_LOG_UNCOND ("StaWifiMac::SendAssociationRequest (void)");
-
-    }
-
-  packet->AddHeader (assoc);
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (GetAssocRequest ());
 
   //The standard is not clear on the correct queue for management
   //frames if we are a QoS AP. The approach taken here is to always
@@ -1505,58 +1531,20 @@ StaWifiMac::Receive (Ptr<Packet> packet, const WifiMacHeader *hdr, PacketContext
       NS_LOG_DEBUG (m_low->GetAddress() << ",beacon:," << Simulator::Now().GetSeconds());
 
       UnsetInRAWgroup ();
-      uint8_t * rawassign;
-      rawassign = beacon.GetRPS().GetRawAssignment();
-      uint16_t raw_len = beacon.GetRPS().GetInformationFieldSize();
-      uint16_t rawAssignment_len = 6;
-      if (raw_len % rawAssignment_len !=0){
-        NS_ASSERT ("RAW configuration incorrect!");
-      }
-      uint8_t RAW_number = raw_len/rawAssignment_len;
-
-      uint16_t m_slotDurationCount=0;
-      uint16_t m_slotNum=0;
-      uint64_t m_currentRAW_start=0;
-      m_lastRawDurationus = MicroSeconds(0);
-      for (uint8_t raw_index=0; raw_index < RAW_number; raw_index++){
-        auto ass = beacon.GetRPS().GetRawAssigmentObj(raw_index);
-        // only support Generic Raw (paged STA RAW or not)
-        if (ass.GetRawTypeIndex() == 4){
-          m_pagedStaRaw = true;
-        }else{
-          m_pagedStaRaw = false;
-        }
-        m_currentRAW_start=m_currentRAW_start+(500 + m_slotDurationCount * 120)*m_slotNum;
-        m_slotDurationCount = ass.GetSlotDurationCount();
-        m_slotNum = ass.GetSlotNum();
-
-        m_slotDuration = MicroSeconds(500 + m_slotDurationCount * 120);
-        m_lastRawDurationus = m_lastRawDurationus + m_slotDuration * m_slotNum;
-        m_crossSlotBoundaryAllowed = ass.GetSlotCrossBoundary() == 0x0001;
-
-        //in the page indexed
-        if (ass.GetRawGroupPage() == ((GetAID() >> 11 ) & 0x0003)){
-          uint16_t statsPerSlot = 0;
-          uint16_t statRawSlot = 0;
-
-          Ptr<UniformRandomVariable> m_rv = CreateObject<UniformRandomVariable> ();
-          uint16_t offset = m_rv->GetValue (0, 1023);
-          offset =0; // for test
-          statsPerSlot = (ass.GetRawGroupAIDEnd() - ass.GetRawGroupAIDStart() + 1)/m_slotNum;
-          //statRawSlot = ((GetAID() & 0x03ff)-raw_start)/statsPerSlot;
-          statRawSlot = ((GetAID() & 0x07ff)+offset)%m_slotNum;
-
-          if ((ass.GetRawGroupAIDStart() <= (GetAID() & 0x07ff)) && ((GetAID() & 0x07ff) <= ass.GetRawGroupAIDEnd())){
-            m_statSlotStart = MicroSeconds((500 + m_slotDurationCount * 120)*statRawSlot+m_currentRAW_start);
-            SetInRAWgroup ();
-            m_currentslotDuration = m_slotDuration; //To support variable time duration among multiple RAWs
-
-            // NS_LOG_UNCOND (Simulator::Now () << ", StaWifiMac:: GetAID() = " << GetAID() <<  ", m_statSlotStart=" << m_statSlotStart << ", m_lastRawDurationus = " << m_lastRawDurationus << ", m_currentslotDuration = " << m_currentslotDuration);
-            //break; //break should not used if multiple RAW is supported
-          }
-          //NS_LOG_UNCOND (Simulator::Now () << ", StaWifiMac:: GetAID() = " << GetAID() << ", raw_start =" << raw_start << ", raw_end=" << raw_end << ", m_statSlotStart=" << m_statSlotStart << ", m_lastRawDurationus = " << m_lastRawDurationus << ", m_currentslotDuration = " << m_currentslotDuration);
+      // decode the RAW configuration again only when it has changed
+      uint64_t rpsHash = beacon.GetRpsHash ();
+      if (m_rpsDecoded && rpsHash == m_rpsHash && GetAID () == m_rpsAid){
+        if (m_rpsInRawGroup){
+          SetInRAWgroup ();
         }
       }
+      else{
+        DecodeRps (beacon.GetRPS ());
+        m_rpsDecoded = true;
+        m_rpsHash = rpsHash;
+        m_rpsAid = GetAID ();
+        m_rpsInRawGroup = m_inRawGroup;
+      }
       m_rawStart = true; //?
       if (this->IsAssociated())
         S1gTIMReceived(beacon);
@@ -1619,72 +1607,7 @@ StaWifiMac::Receive (Ptr<Packet> packet, const WifiMacHeader *hdr, PacketContext
             {
               m_assocRequestEvent.Cancel ();
             }
-          if (assocResp.GetStatusCode ().IsSuccess ())
-            {
-        	  SetAID (assocResp.GetAID ());
-              SetState (ASSOCIATED);
-	      NS_LOG_DEBUG("[" << this->GetAddress() <<"] is associated and has AID = " << this->GetAID());
-              SupportedRates rates = assocResp.GetSupportedRates ();
-              if (m_htSupported)
-                {
-                  HtCapabilities htcapabilities = assocResp.GetHtCapabilities ();
-                  m_stationManager->AddStationHtCapabilities (hdr->GetAddr2 (),htcapabilities);
-                }
-              
-              if (m_s1gSupported)
-                {
-                  S1gCapabilities s1gcapabilities = assocResp.GetS1gCapabilities ();
-                  NS_LOG_UNCOND (GetAddress () << ", receive " << uint16_t( s1gcapabilities.GetChannelWidth ()));
-                  m_stationManager->AddStationS1gCapabilities (hdr->GetAddr2 (),s1gcapabilities);
-                }
-
-              for (uint32_t i = 0; i < m_phy->GetNModes (); i++)
-                {
-                  WifiMode mode = m_phy->GetMode (i);
-                  for (uint32_t j = 0; j < m_phy->m_deviceRateSet.size (); j++)
-                   {
-                    if (m_phy->m_deviceRateSet[j] == mode )
-                    {
-                       NS_LOG_UNCOND (GetAddress () << ", AddSupportedMode " << hdr->GetAddr2 () << ", " << mode);                        
-                        m_stationManager->AddSupportedMode (hdr->GetAddr2 (), mode);
-                        if (rates.IsBasicRate (mode.GetDataRate ()))
-                        {
-                            m_stationManager->AddBasicMode (mode);
-                        }
-                    }
-                  }
-                  if (rates.IsSupportedRate (mode.GetDataRate ()))
-                    {
-                      m_stationManager->AddSupportedMode (hdr->GetAddr2 (), mode);
-                      if (rates.IsBasicRate (mode.GetDataRate ()))
-                        {
-                          m_stationManager->AddBasicMode (mode);
-                        }
-                    }
-                }
-              if (m_htSupported)
-                {
-                  HtCapabilities htcapabilities = assocResp.GetHtCapabilities ();
-                  for (uint32_t i = 0; i < m_phy->GetNMcs (); i++)
-                    {
-                      uint8_t mcs = m_phy->GetMcs (i);
-                      if (htcapabilities.IsSupportedMcs (mcs))
-                        {
-                          m_stationManager->AddSupportedMcs (hdr->GetAddr2 (), mcs);
-                          //here should add a control to add basic MCS when it is implemented
-                        }
-                    }
-                }
-              if (!m_linkUp.IsNull ())
-                {
-                  m_linkUp ();
-                }
-            }
-          else
-            {
-              NS_LOG_DEBUG ("assoc refused");
-              SetState (REFUSED);
-            }
+          RecordAssocResponse (hdr->GetAddr2 (), assocResp);
         }
       return;
     }
@@ -1695,6 +1618,76 @@ StaWifiMac::Receive (Ptr<Packet> packet, const WifiMacHeader *hdr, PacketContext
   RegularWifiMac::Receive (packet, hdr);
 }
 
+void
+StaWifiMac::RecordAssocResponse (Mac48Address from, MgtAssocResponseHeader assocResp)
+{
+  NS_LOG_FUNCTION (this << from);
+  if (!assocResp.GetStatusCode ().IsSuccess ())
+    {
+      NS_LOG_DEBUG ("assoc refused");
+      SetState (REFUSED);
+      return;
+    }
+  SetAID (assocResp.GetAID ());
+  SetState (ASSOCIATED);
+  NS_LOG_DEBUG ("[" << this->GetAddress () << "] is associated and has AID = " << this->GetAID ());
+  SupportedRates rates = assocResp.GetSupportedRates ();
+  if (m_htSupported)
+    {
+      HtCapabilities htcapabilities = assocResp.GetHtCapabilities ();
+      m_stationManager->AddStationHtCapabilities (from, htcapabilities);
+    }
+
+  if (m_s1gSupported)
+    {
+      S1gCapabilities s1gcapabilities = assocResp.GetS1gCapabilities ();
+      NS_LOG_UNCOND (GetAddress () << ", receive " << uint16_t ( s1gcapabilities.GetChannelWidth ()));
+      m_stationManager->AddStationS1gCapabilities (from, s1gcapabilities);
+    }
+
+  for (uint32_t i = 0; i < m_phy->GetNModes (); i++)
+    {
+      WifiMode mode = m_phy->GetMode (i);
+      for (uint32_t j = 0; j < m_phy->m_deviceRateSet.size (); j++)
+        {
+          if (m_phy->m_deviceRateSet[j] == mode )
+            {
+              NS_LOG_UNCOND (GetAddress () << ", AddSupportedMode " << from << ", " << mode);
+              m_stationManager->AddSupportedMode (from, mode);
+              if (rates.IsBasicRate (mode.GetDataRate ()))
+                {
+                  m_stationManager->AddBasicMode (mode);
+                }
+            }
+        }
+      if (rates.IsSupportedRate (mode.GetDataRate ()))
+        {
+          m_stationManager->AddSupportedMode (from, mode);
+          if (rates.IsBasicRate (mode.GetDataRate ()))
+            {
+              m_stationManager->AddBasicMode (mode);
+            }
+        }
+    }
+  if (m_htSupported)
+    {
+      HtCapabilities htcapabilities = assocResp.GetHtCapabilities ();
+      for (uint32_t i = 0; i < m_phy->GetNMcs (); i++)
+        {
+          uint8_t mcs = m_phy->GetMcs (i);
+          if (htcapabilities.IsSupportedMcs (mcs))
+            {
+              m_stationManager->AddSupportedMcs (from, mcs);
+              //here should add a control to add basic MCS when it is implemented
+            }
+        }
+    }
+  if (!m_linkUp.IsNull ())
+    {
+      m_linkUp ();
+    }
+}
+
 SupportedRates
 StaWifiMac::GetSupportedRates (void) const
 {
@@ -30,6 +30,7 @@
 #include "supported-rates.h"
 #include "amsdu-subframe-header.h"
 #include "s1g-capabilities.h"
+#include "mgt-headers.h"
 #include "ns3/traced-value.h"
 #include "extension-headers.h"
 
@@ -112,6 +113,25 @@ public:
    * Get Station AID.
    */
   uint32_t GetAID (void) const;
+  /**
+   * Return whether we are associated with an AP.
+   *
+   * \return true if we are associated with an AP, false otherwise
+   */
+  bool IsAssociated (void) const;
+  /**
+   * \return the association request this STA sends
+   */
+  MgtAssocRequestHeader GetAssocRequest (void) const;
+  /**
+   * Complete an association without the over-the-air exchange, as if
+   * \p assocResp had just been received from \p bssid (the Assoc trace
+   * fires if the response is a success).
+   *
+   * \param bssid the address of the AP
+   * \param assocResp the association response of the AP
+   */
+  void Associate (Mac48Address bssid, MgtAssocResponseHeader assocResp);
 
     /*void SetPageSlicingSupported (uint8_t support);
     uint8_t GetPageSlicingSupported (void) const;*/
@@ -168,6 +188,14 @@ private:
    * depending on the current association status.
    */
   void TryToEnsureAssociated (void);
+  /**
+   * Record the outcome of an association response: AID, state, and the
+   * rates and capabilities of the AP.
+   *
+   * \param from the address of the AP
+   * \param assocResp the association response
+   */
+  void RecordAssocResponse (Mac48Address from, MgtAssocResponseHeader assocResp);
   /**
    * This method is called after the association timeout occurred. We switch the state to
    * WAIT_ASSOC_RESP and re-send an association request.
@@ -178,12 +206,6 @@ private:
    * WAIT_PROBE_RESP and re-send a probe request.
    */
   void ProbeRequestTimeout (void);
-  /**
-   * Return whether we are associated with an AP.
-   *
-   * \return true if we are associated with an AP, false otherwise
-   */
-  bool IsAssociated (void) const;
   /**
    * Return whether we are waiting for an association response from an AP.
    *
@@ -265,6 +287,17 @@ private:
   void GoToSleepCurrentTIM (S1gBeaconHeader beacon);
   void GoToSleep(Time  sleeptime); 
 
+  /**
+   * Find the RAW slot of this STA in an RPS element.
+   *
+   * \param rps the RPS element of the last beacon
+   */
+  void DecodeRps (const RPS &rps);
+  bool m_rpsDecoded;      //!< the fields below are valid
+  uint64_t m_rpsHash;     //!< hash of the RPS element decoded last
+  uint16_t m_rpsAid;      //!< the AID it was decoded for
+  bool m_rpsInRawGroup;   //!< the STA is in a RAW group of it
+
   Time m_lastRawDurationus;
   Time m_lastRawStart;
   Time m_rawDuration;
@@ -21,12 +21,180 @@
 #include "tim.h"
 #include "ns3/assert.h"
 #include "ns3/log.h" //for test
+#include <algorithm>
+#include <cstring>
 
 namespace ns3 {
     
 	NS_LOG_COMPONENT_DEFINE ("TIM");
 
+/**
+ * Encode the Encoded Block Information of one block (every coding but OLB).
+ *
+ * \param coding the encoding mode
+ * \param bits the AID bitmap of the block
+ * \param info the output, at least 49 octets
+ * \return the number of octets written, 0 if the coding cannot encode the block
+ */
+static uint8_t
+EncodeBlockInfo (enum TIM::BlockCoding coding, uint64_t bits, uint8_t *info)
+{
+  switch (coding)
+    {
+    case TIM::BLOCK_BITMAP:
+      {
+        uint8_t length = 1;
+        info[0] = 0;
+        for (uint8_t j = 0; j <= 7; j++)
+          {
+            uint8_t subblock = (bits >> (8 * j)) & 0xff;
+            if (subblock)
+              {
+                info[0] |= 1 << j;
+                info[length++] = subblock;
+              }
+          }
+        return length;
+      }
+    case TIM::SINGLE_AID:
+      if (bits == 0 || (bits & (bits - 1)) != 0)
+        {
+          return 0;
+        }
+      info[0] = 0;
+      while (!(bits & 1))
+        {
+          bits >>= 1;
+          info[0]++;
+        }
+      return 1;
+    case TIM::ADE:
+      {
+        // the offset of the 1st paged AID in the block, then the differences
+        // to the previous one, all EWL + 1 bits wide
+        uint8_t values[64];
+        uint8_t count = 0;
+        uint8_t largest = 0;
+        for (uint8_t aid = 0, previous = 0; aid < 64; aid++)
+          {
+            if (bits & (uint64_t (1) << aid))
+              {
+                values[count] = count ? aid - previous : aid;
+                largest = std::max (largest, values[count]);
+                previous = aid;
+                count++;
+              }
+          }
+        if (count == 0)
+          {
+            return 0;
+          }
+        uint8_t width = 1;
+        while ((largest >> width) != 0)
+          {
+            width++;
+          }
+        uint8_t length = (count * width + 7) / 8;
+        if (length > 31)
+          {
+            return 0;
+          }
+        info[0] = ((length << 3) & 0xf8) | ((width - 1) & 0x07);
+        std::memset (info + 1, 0, length);
+        for (uint16_t i = 0, bit = 0; i < count; i++)
+          {
+            for (uint8_t b = 0; b < width; b++, bit++)
+              {
+                if (values[i] & (1 << b))
+                  {
+                    info[1 + bit / 8] |= 1 << (bit % 8);
+                  }
+              }
+          }
+        return 1 + length;
+      }
+    default:
+      return 0;
+    }
+}
+
+/**
+ * Decode the Encoded Block Information of one block (every coding but OLB).
+ *
+ * \param coding the encoding mode
+ * \param info the Encoded Block Information
+ * \param available the octets left in the Partial Virtual Bitmap
+ * \param bits the AID bitmap of the block
+ * \return the number of octets read, 0 if the block is malformed
+ */
+static uint8_t
+DecodeBlockInfo (enum TIM::BlockCoding coding, const uint8_t *info, uint8_t available, uint64_t &bits)
+{
+  bits = 0;
+  if (available == 0)
+    {
+      return 0;
+    }
+  switch (coding)
+    {
+    case TIM::BLOCK_BITMAP:
+      {
+        uint8_t length = 1;
+        for (uint8_t j = 0; j <= 7; j++)
+          {
+            if (info[0] & (1 << j))
+              {
+                if (length >= available)
+                  {
+                    return 0;
+                  }
+                bits |= uint64_t (info[length++]) << (8 * j);
+              }
+          }
+        return length;
+      }
+    case TIM::SINGLE_AID:
+      bits = uint64_t (1) << (info[0] & 0x3f);
+      return 1;
+    case TIM::ADE:
+      {
+        uint8_t width = (info[0] & 0x07) + 1;
+        uint8_t length = (info[0] >> 3) & 0x1f;
+        if (1 + length > available)
+          {
+            return 0;
+          }
+        uint16_t aid = 0;
+        for (uint16_t i = 0, bit = 0; bit + width <= length * 8; i++)
+          {
+            uint8_t value = 0;
+            for (uint8_t b = 0; b < width; b++, bit++)
+              {
+                if (info[1 + bit / 8] & (1 << (bit % 8)))
+                  {
+                    value |= 1 << b;
+                  }
+              }
+            // the padding of the last octet decodes as a difference of 0
+            if (i > 0 && value == 0)
+              {
+                break;
+              }
+            aid += value;
+            if (aid > 63)
+              {
+                break;
+              }
+            bits |= uint64_t (1) << aid;
+          }
+        return 1 + length;
+      }
+    default:
+      return 0;
+    }
+}
 TIM::EncodedBlock::EncodedBlock ()
+  : m_blockcontrol (BLOCK_BITMAP)
 {
 }
 
@@ -37,7 +205,7 @@ TIM::EncodedBlock::~EncodedBlock ()
 void
 TIM::EncodedBlock::SetBlockControl (enum BlockCoding coding)
 {
-  m_blockcontrol = 0; // only support Block Bitmap
+  m_blockcontrol = coding;
 }
 
 void
@@ -77,13 +245,15 @@ TIM::EncodedBlock::GetBlockControl (void) const
 {
 switch (m_blockcontrol)
   {
-  case 0:
-    return BLOCK_BITMAP;
-    break;
   case 1:
+    return SINGLE_AID;
+  case 2:
+    return OLB;
+  case 3:
+    return ADE;
+  case 0:
   default:
     return BLOCK_BITMAP;
-    break;
   }
 }
 
@@ -146,6 +316,7 @@ TIM::EncodedBlock::Is (uint8_t info, uint8_t n)
 TIM::TIM ()
 {
   m_length = 0;
+  m_partialVBitmap = m_partialVBitmap_arrary;
 }
 
 TIM::~TIM ()
@@ -223,7 +394,148 @@ TIM::SetPartialVBitmap (TIM::EncodedBlock block)
     i++;
   }
   m_partialVBitmap = m_partialVBitmap_arrary;
-  NS_ASSERT ( m_length < 252);
+  NS_ASSERT ( m_length <= 252);
+}
+
+void
+TIM::SetPartialVBitmap (uint8_t blockOffset, const std::vector<uint64_t> &blocks)
+{
+  static const TIM::BlockCoding codings[] = {BLOCK_BITMAP, SINGLE_AID, ADE};
+  uint8_t info[64];
+  uint16_t n = blocks.size ();
+
+  // cost[i] is the smallest size of blocks i.. and the choice of block i
+  // reaches it: a coding and the inverse flag, or an OLB block up to block span[i]
+  std::vector<uint16_t> cost (n + 1, 0);
+  std::vector<uint8_t> coding (n, BLOCK_BITMAP);
+  std::vector<bool> inverse (n, false);
+  std::vector<uint16_t> span (n, 0);
+  for (uint16_t i = n; i-- > 0;)
+    {
+      span[i] = i;
+      if (blocks[i] == 0)
+        {
+          cost[i] = cost[i + 1];
+          continue;
+        }
+      cost[i] = 0xffff;
+      for (uint8_t inv = 0; inv <= 1; inv++)
+        {
+          for (uint8_t c = 0; c < sizeof (codings) / sizeof (codings[0]); c++)
+            {
+              uint8_t size = EncodeBlockInfo (codings[c], inv ? ~blocks[i] : blocks[i], info);
+              if (size != 0 && 1 + size + cost[i + 1] < cost[i])
+                {
+                  cost[i] = 1 + size + cost[i + 1];
+                  coding[i] = codings[c];
+                  inverse[i] = inv;
+                }
+            }
+        }
+      // the Block Offset of an OLB block cannot wrap around the page
+      uint8_t first = (blockOffset + i) & 0x1f;
+      for (uint16_t j = i; j < n && first + j - i <= 31; j++)
+        {
+          if (blocks[j] == 0)
+            {
+              continue;
+            }
+          uint8_t last = 7;
+          while (((blocks[j] >> (8 * last)) & 0xff) == 0)
+            {
+              last--;
+            }
+          uint16_t length = 8 * (j - i) + last + 1;
+          if (length > 255)
+            {
+              break;
+            }
+          if (2 + length + cost[j + 1] < cost[i])
+            {
+              cost[i] = 2 + length + cost[j + 1];
+              coding[i] = OLB;
+              inverse[i] = false;
+              span[i] = j;
+            }
+        }
+    }
+  NS_ASSERT_MSG (m_length + cost[0] <= 252, "Partial Virtual Bitmap exceeds 252 octets");
+
+  for (uint16_t i = 0; i < n; i++)
+    {
+      if (blocks[i] == 0)
+        {
+          continue;
+        }
+      uint8_t offset = (blockOffset + i) & 0x1f;
+      m_partialVBitmap_arrary[m_length++] = ((offset << 3) & 0xf8) | (inverse[i] ? 0x04 : 0) | (coding[i] & 0x03);
+      if (coding[i] == OLB)
+        {
+          uint8_t *length = &m_partialVBitmap_arrary[m_length++];
+          *length = 0;
+          for (uint16_t j = i; j <= span[i]; j++)
+            {
+              for (uint8_t k = 0; k <= 7 && (j < span[i] || (blocks[j] >> (8 * k)) != 0); k++)
+                {
+                  m_partialVBitmap_arrary[m_length++] = (blocks[j] >> (8 * k)) & 0xff;
+                  (*length)++;
+                }
+            }
+          NS_LOG_DEBUG ("OLB block " << (int)offset << ", " << (int)*length << " subblocks");
+          i = span[i];
+        }
+      else
+        {
+          m_length += EncodeBlockInfo ((enum BlockCoding)coding[i], inverse[i] ? ~blocks[i] : blocks[i],
+                                       &m_partialVBitmap_arrary[m_length]);
+          NS_LOG_DEBUG ("Block " << (int)offset << ", coding " << (int)coding[i] << (inverse[i] ? ", inverse" : ""));
+        }
+    }
+  m_partialVBitmap = m_partialVBitmap_arrary;
+}
+
+bool
+TIM::IsAidPaged (uint16_t aid) const
+{
+  uint8_t block = (aid >> 6) & 0x1f;
+  uint8_t bit = aid & 0x3f;
+  uint8_t pos = 0;
+  // every Encoded Block has at least 2 octets
+  while (pos + 2 <= m_length)
+    {
+      uint8_t control = m_partialVBitmap_arrary[pos++];
+      enum BlockCoding coding = (enum BlockCoding)(control & 0x03);
+      bool inverse = (control & 0x04) != 0;
+      uint8_t offset = (control >> 3) & 0x1f;
+      if (coding == OLB)
+        {
+          uint8_t length = m_partialVBitmap_arrary[pos++];
+          if (pos + length > m_length)
+            {
+              return false;
+            }
+          uint16_t subblock = 8 * (block - offset) + (bit >> 3);
+          if (block >= offset && subblock < 8 * ((length + 7) / 8))
+            {
+              bool paged = subblock < length && (m_partialVBitmap_arrary[pos + subblock] & (1 << (bit & 0x07)));
+              return paged != inverse;
+            }
+          pos += length;
+          continue;
+        }
+      uint64_t bits;
+      uint8_t size = DecodeBlockInfo (coding, &m_partialVBitmap_arrary[pos], m_length - pos, bits);
+      if (size == 0)
+        {
+          return false;
+        }
+      pos += size;
+      if (offset == block)
+        {
+          return ((bits >> bit) & 1) != inverse;
+        }
+    }
+  return false;
 }
 
 
@@ -22,6 +22,7 @@
 #define TIM_H
 
 #include <stdint.h>
+#include <vector>
 #include "ns3/buffer.h"
 #include "ns3/attribute-helper.h"
 #include "ns3/attribute.h"
@@ -44,11 +45,16 @@ public:
   ~TIM ();
 
 
+  /**
+   * The Encoding Mode of an Encoded Block (bits 0-1 of the Block Control
+   * field, bit 2 is the Inverse Bitmap flag).
+   */
   enum BlockCoding
   {
-    BLOCK_BITMAP = 0,
-    SINGAL_AID = 1,
-    // to do
+    BLOCK_BITMAP = 0, //!< Block Bitmap, then the non-zero Subblocks
+    SINGLE_AID = 1,   //!< the 6-bit AID of the only paged STA of the block
+    OLB = 2,          //!< Length, then that many Subblocks, possibly over several blocks
+    ADE = 3,          //!< AID Differential Encoding
   };
   class EncodedBlock
    {
@@ -106,6 +112,22 @@ public:
    * \Set the Partial Virtual Bitmap
    */
   void SetPartialVBitmap (TIM::EncodedBlock block);
+  /**
+   * Encode the paged AIDs of consecutive blocks into the Partial Virtual Bitmap.
+   *
+   * \param blockOffset the index of the first block in the page
+   * \param blocks the AID bitmap of every block (bit 8 * subblock + AID in the subblock)
+   *
+   * Every block gets the smallest of the Block Bitmap, Single AID and ADE
+   * encodings, plain or inverse, and a run of blocks is encoded as one OLB
+   * block when it is smaller. Blocks without paged AIDs are left out.
+   */
+  void SetPartialVBitmap (uint8_t blockOffset, const std::vector<uint64_t> &blocks);
+  /**
+   * \param aid the AID of a station in the page of this TIM
+   * \return true if the Partial Virtual Bitmap indicates buffered traffic for the AID
+   */
+  bool IsAidPaged (uint16_t aid) const;
     
   /**
    * Return the TIM Count.
@@ -157,7 +179,7 @@ private:
   uint8_t m_PageSliceNum;
   uint8_t m_PageIndex;
   TIM::EncodedBlock m_encodeblock; //!< encoded block subfield of partial Virtual Bitmap field
-  uint8_t m_partialVBitmap_arrary[251]; // see 9.4.2.6.1
+  uint8_t m_partialVBitmap_arrary[252]; // see 9.4.2.6.1
   uint8_t * m_partialVBitmap;
 
   uint8_t * subblock; 
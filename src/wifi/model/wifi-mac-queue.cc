@@ -105,12 +105,13 @@ void WifiMacQueue::Enqueue (Ptr<const Packet> packet, const WifiMacHeader &hdr,
   Cleanup ();
   if (m_size == m_maxSize){
     //std::cout << "DROPPING PACKET FROM WIFI MAC QUEUE " << std::endl;
-    m_packetdropped(packet->Copy(), DropReason::MacQueueSizeExceeded);
+    NotifyDropped (packet, DropReason::MacQueueSizeExceeded);
     return;
   }
   Time now = Simulator::Now ();
   m_queue.push_back (Item (packet, hdr, now, context));
   m_size++;
+  NotifyOccupancy (hdr, 1);
 }
 void WifiMacQueue::Enqueue (Ptr<const Packet> packet, const WifiMacHeader &hdr){
   Enqueue(packet, hdr, PacketContext());
@@ -134,7 +135,8 @@ WifiMacQueue::Cleanup (void)
         }
       else
         {
-    	  m_packetdropped(i->packet->Copy(), DropReason::MacQueueDelayExceeded);
+          NotifyDropped (i->packet, DropReason::MacQueueDelayExceeded);
+          NotifyOccupancy (i->hdr, -1);
           i = m_queue.erase (i);
           n++;
         }
@@ -148,6 +150,7 @@ Ptr<const Packet> WifiMacQueue::Dequeue (WifiMacHeader *hdr){
     Item i = m_queue.front ();
     m_queue.pop_front ();
     m_size--;
+    NotifyOccupancy (i.hdr, -1);
     *hdr = i.hdr;
     return i.packet;
   }
@@ -159,6 +162,7 @@ Ptr<const Packet> WifiMacQueue::Dequeue (WifiMacHeader *hdr, PacketContext &cont
     Item i = m_queue.front ();
     m_queue.pop_front ();
     m_size--;
+    NotifyOccupancy (i.hdr, -1);
     *hdr = i.hdr;
     context = i.context;
     return i.packet;
@@ -197,6 +201,7 @@ WifiMacQueue::DequeueByTidAndAddress (WifiMacHeader *hdr, uint8_t tid,
                 {
                   packet = it->packet;
                   *hdr = it->hdr;
+                  NotifyOccupancy (it->hdr, -1);
                   m_queue.erase (it);
                   m_size--;
                   break;
@@ -266,10 +271,47 @@ WifiMacQueue::GetSize (void)
 void
 WifiMacQueue::Flush (void)
 {
+  if (!m_occupancy.IsNull ())
+    {
+      for (PacketQueueI it = m_queue.begin (); it != m_queue.end (); ++it)
+        {
+          m_occupancy (this, it->hdr, -1);
+        }
+    }
   m_queue.erase (m_queue.begin (), m_queue.end ());
   m_size = 0;
 }
 
+void
+WifiMacQueue::DropExpired (void)
+{
+  Cleanup ();
+}
+
+void
+WifiMacQueue::SetOccupancyCallback (OccupancyCallback callback)
+{
+  m_occupancy = callback;
+}
+
+void
+WifiMacQueue::NotifyOccupancy (const WifiMacHeader &hdr, int32_t delta) const
+{
+  if (!m_occupancy.IsNull ())
+    {
+      m_occupancy (this, hdr, delta);
+    }
+}
+
+void
+WifiMacQueue::NotifyDropped (Ptr<const Packet> packet, DropReason reason) const
+{
+  if (!m_packetdropped.IsEmpty ())
+    {
+      m_packetdropped (packet->Copy (), reason);
+    }
+}
+
 Mac48Address
 WifiMacQueue::GetAddressForPacket (enum WifiMacHeader::AddressType type, PacketQueueI it)
 {
@@ -296,6 +338,7 @@ WifiMacQueue::Remove (Ptr<const Packet> packet)
     {
       if (it->packet == packet)
         {
+          NotifyOccupancy (it->hdr, -1);
           m_queue.erase (it);
           m_size--;
           return true;
@@ -309,12 +352,13 @@ void WifiMacQueue::PushFront (Ptr<const Packet> packet, const WifiMacHeader &hdr
   Cleanup ();
   if (m_size == m_maxSize)
     {
-	  m_packetdropped(packet->Copy(), DropReason::MacQueueSizeExceeded);
+      NotifyDropped (packet, DropReason::MacQueueSizeExceeded);
       return;
     }
   Time now = Simulator::Now ();
   m_queue.push_front (Item (packet, hdr, now));
   m_size++;
+  NotifyOccupancy (hdr, 1);
 }
 
 uint32_t
@@ -354,6 +398,7 @@ WifiMacQueue::DequeueFirstAvailable (WifiMacHeader *hdr, Time &timestamp,
           *hdr = it->hdr;
           timestamp = it->tstamp;
           packet = it->packet;
+          NotifyOccupancy (it->hdr, -1);
           m_queue.erase (it);
           m_size--;
           return packet;
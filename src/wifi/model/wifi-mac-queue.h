@@ -62,6 +62,12 @@ public:
 
   typedef void (* PacketDroppedCallback)
                   (Ptr<const Packet> packet, DropReason reason);
+  /**
+   * Callback invoked with the header of every packet entering (+1) or
+   * leaving (-1) the queue, whatever the reason (dequeue, removal, expiry
+   * or flush).
+   */
+  typedef Callback<void, const WifiMacQueue *, const WifiMacHeader &, int32_t> OccupancyCallback;
 
   /**
    * Set the maximum queue size.
@@ -230,6 +236,14 @@ public:
    * \return the current queue size
    */
   uint32_t GetSize (void);
+  /**
+   * Drop the packets that exceeded the maximum delay.
+   */
+  void DropExpired (void);
+  /**
+   * \param callback the callback to invoke when a packet enters or leaves the queue
+   */
+  void SetOccupancyCallback (OccupancyCallback callback);
 
 
 protected:
@@ -280,6 +294,20 @@ protected:
    * \return the address
    */
   Mac48Address GetAddressForPacket (enum WifiMacHeader::AddressType type, PacketQueueI it);
+  /**
+   * Invoke the occupancy callback, if any.
+   *
+   * \param hdr the header of the packet
+   * \param delta +1 if the packet entered the queue, -1 if it left
+   */
+  void NotifyOccupancy (const WifiMacHeader &hdr, int32_t delta) const;
+  /**
+   * Fire the drop trace with a copy of the packet, if it has sinks.
+   *
+   * \param packet the dropped packet
+   * \param reason the reason of the drop
+   */
+  void NotifyDropped (Ptr<const Packet> packet, DropReason reason) const;
 
   PacketQueue m_queue; //!< Packet (struct Item) queue
   uint32_t m_size;     //!< Current queue size
@@ -287,6 +315,7 @@ protected:
   Time m_maxDelay;     //!< Time to live for packets in the queue
 
   TracedCallback<Ptr<const Packet>, DropReason> m_packetdropped;
+  OccupancyCallback m_occupancy; //!< invoked when a packet enters or leaves the queue
 };
 
 } //namespace ns3
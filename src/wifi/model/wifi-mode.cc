@@ -211,17 +211,14 @@ WifiModeFactory::CreateWifiMode (std::string uniqueName,
 WifiMode
 WifiModeFactory::Search (std::string name)
 {
-  WifiModeItemList::const_iterator i;
-  uint32_t j = 0;
-  for (i = m_itemList.begin (); i != m_itemList.end (); i++)
+  WifiModeNameIndex::const_iterator it = m_nameIndex.find (name);
+  if (it != m_nameIndex.end ())
     {
-      if (i->uniqueUid == name)
-        {
-          return WifiMode (j);
-        }
-      j++;
+      return WifiMode (it->second);
     }
 
+  WifiModeItemList::const_iterator i;
+
   //If we get here then a matching WifiMode was not found above. This
   //is a fatal problem, but we try to be helpful by displaying the
   //list of WifiModes that are supported.
@@ -246,18 +243,14 @@ WifiModeFactory::Search (std::string name)
 uint32_t
 WifiModeFactory::AllocateUid (std::string uniqueUid)
 {
-  uint32_t j = 0;
-  for (WifiModeItemList::const_iterator i = m_itemList.begin ();
-       i != m_itemList.end (); i++)
+  WifiModeNameIndex::const_iterator it = m_nameIndex.find (uniqueUid);
+  if (it != m_nameIndex.end ())
     {
-      if (i->uniqueUid == uniqueUid)
-        {
-          return j;
-        }
-      j++;
+      return it->second;
     }
   uint32_t uid = m_itemList.size ();
   m_itemList.push_back (WifiModeItem ());
+  m_nameIndex[uniqueUid] = uid;
   return uid;
 }
 
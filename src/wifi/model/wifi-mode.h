@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <ostream>
 #include "ns3/attribute-helper.h"
 #include "ns3/wifi-phy-standard.h"
@@ -293,6 +294,11 @@ private:
    */
   typedef std::vector<struct WifiModeItem> WifiModeItemList;
   WifiModeItemList m_itemList;
+  /**
+   * typedef for a hash map from the unique name of a WifiMode to its uid.
+   */
+  typedef std::unordered_map<std::string, uint32_t> WifiModeNameIndex;
+  WifiModeNameIndex m_nameIndex; //!< index of m_itemList by name, used by Search and AllocateUid
 };
 
 } //namespace ns3
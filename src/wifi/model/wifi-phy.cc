@@ -27,6 +27,7 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/double.h"
+#include "ns3/boolean.h"
 #include "ns3/uinteger.h"
 #include "ns3/enum.h"
 #include "ns3/trace-source-accessor.h"
@@ -111,6 +112,13 @@ WifiPhy::GetTypeId (void)
                      "in monitor mode to sniff all frames being transmitted",
                      MakeTraceSourceAccessor (&WifiPhy::m_phyMonitorSniffTxTrace),
                      "ns3::WifiPhy::MonitorSnifferTxCallback")
+    .AddAttribute ("TxDurationCache",
+                   "Whether the durations of frames that are not part of an A-MPDU are memoized "
+                   "(keyed by size, mode, preamble, spatial streams, STBC and frequency).",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&WifiPhy::SetTxDurationCacheEnabled,
+                                        &WifiPhy::IsTxDurationCacheEnabled),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -120,6 +128,11 @@ WifiPhy::WifiPhy ()
   NS_LOG_FUNCTION (this);
   m_totalAmpduSize = 0;
   m_totalAmpduNumSymbols = 0;
+  m_txDurationCacheEnabled = true;
+  for (uint32_t i = 0; i < TX_DURATION_CACHE_SIZE; i++)
+    {
+      m_txDurationCache[i].valid = false;
+    }
 }
 
 WifiPhy::~WifiPhy ()
@@ -819,11 +832,69 @@ else
 Time
 WifiPhy::CalculateTxDuration (uint32_t size, WifiTxVector txvector, WifiPreamble preamble, double frequency, uint8_t packetType, uint8_t incFlag)
 {
+  //A-MPDU subframes depend on (and update) the A-MPDU state, so they are never cached
+  if (!m_txDurationCacheEnabled || packetType != 0)
+    {
+      return CalculatePlcpPreambleAndHeaderDuration (txvector, preamble)
+             + GetPayloadDuration (size, txvector, preamble, frequency, packetType, incFlag);
+    }
+
+  uint32_t modeUid = txvector.GetMode ().GetUid ();
+  uint8_t nss = txvector.GetNss ();
+  uint8_t ness = txvector.GetNess ();
+  bool stbc = txvector.IsStbc ();
+  bool shortGuardInterval = txvector.IsShortGuardInterval ();
+  uint32_t index = (size * 2654435761u ^ modeUid * 40503u ^ preamble * 97u ^ nss * 13u
+                    ^ ness * 7u ^ shortGuardInterval * 3u) & (TX_DURATION_CACHE_SIZE - 1);
+  TxDurationCacheEntry &entry = m_txDurationCache[index];
+  if (entry.valid
+      && entry.size == size
+      && entry.modeUid == modeUid
+      && entry.preamble == preamble
+      && entry.nss == nss
+      && entry.ness == ness
+      && entry.stbc == stbc
+      && entry.shortGuardInterval == shortGuardInterval
+      && entry.frequency == frequency)
+    {
+      return entry.duration;
+    }
+
   Time duration = CalculatePlcpPreambleAndHeaderDuration (txvector, preamble)
     + GetPayloadDuration (size, txvector, preamble, frequency, packetType, incFlag);
+  entry.size = size;
+  entry.modeUid = modeUid;
+  entry.preamble = preamble;
+  entry.nss = nss;
+  entry.ness = ness;
+  entry.stbc = stbc;
+  entry.shortGuardInterval = shortGuardInterval;
+  entry.frequency = frequency;
+  entry.duration = duration;
+  entry.valid = true;
   return duration;
 }
 
+void
+WifiPhy::SetTxDurationCacheEnabled (bool enable)
+{
+  NS_LOG_FUNCTION (this << enable);
+  m_txDurationCacheEnabled = enable;
+  if (!enable)
+    {
+      for (uint32_t i = 0; i < TX_DURATION_CACHE_SIZE; i++)
+        {
+          m_txDurationCache[i].valid = false;
+        }
+    }
+}
+
+bool
+WifiPhy::IsTxDurationCacheEnabled (void) const
+{
+  return m_txDurationCacheEnabled;
+}
+
 void
 WifiPhy::NotifyTxBegin (Ptr<const Packet> packet)
 {
@@ -874,6 +945,18 @@ WifiPhy::NotifyMonitorSniffTx (Ptr<const Packet> packet, uint16_t channelFreqMhz
   m_phyMonitorSniffTxTrace (packet, channelFreqMhz, channelNumber, rate, isShortPreamble, txvector);
 }
 
+bool
+WifiPhy::IsMonitorSniffRxTraced (void) const
+{
+  return !m_phyMonitorSniffRxTrace.IsEmpty ();
+}
+
+bool
+WifiPhy::IsMonitorSniffTxTraced (void) const
+{
+  return !m_phyMonitorSniffTxTrace.IsEmpty ();
+}
+
 
 // Clause 15 rates (DSSS)
 
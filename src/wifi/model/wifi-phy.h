@@ -304,6 +304,17 @@ public:
    * \return the total amount of time this PHY will stay busy for the transmission of these bytes.
    */
   Time CalculateTxDuration (uint32_t size, WifiTxVector txvector, enum WifiPreamble preamble, double frequency, uint8_t packetType, uint8_t incFlag);
+  /**
+   * Enable or disable the TX duration cache used by CalculateTxDuration.
+   * Disabling the cache also flushes it.
+   *
+   * \param enable true to memoize the durations of non-A-MPDU frames
+   */
+  void SetTxDurationCacheEnabled (bool enable);
+  /**
+   * \return true if CalculateTxDuration memoizes the durations of non-A-MPDU frames
+   */
+  bool IsTxDurationCacheEnabled (void) const;
 
   /**
    * \param txvector the transmission parameters used for this packet
@@ -1652,6 +1663,11 @@ static WifiMode GetOfdmRate86_666_7MbpsBW16MHz ();
                              uint16_t channelNumber, uint32_t rate,
                              bool isShortPreamble, WifiTxVector txvector,
                              double signalDbm, double noiseDbm);
+  /**
+   * \return true if the MonitorSnifferRx trace has sinks: otherwise the
+   *         arguments of NotifyMonitorSniffRx need not be computed
+   */
+  bool IsMonitorSniffRxTraced (void) const;
 
   /**
    * TracedCallback signature for monitor mode receive events.
@@ -1694,6 +1710,11 @@ static WifiMode GetOfdmRate86_666_7MbpsBW16MHz ();
   void NotifyMonitorSniffTx (Ptr<const Packet> packet, uint16_t channelFreqMhz,
                              uint16_t channelNumber, uint32_t rate,
                              bool isShortPreamble, WifiTxVector txvector);
+  /**
+   * \return true if the MonitorSnifferTx trace has sinks: otherwise the
+   *         arguments of NotifyMonitorSniffTx need not be computed
+   */
+  bool IsMonitorSniffTxTraced (void) const;
 
   /**
    * TracedCallback signature for monitor mode transmit events.
@@ -1887,6 +1908,32 @@ private:
    */
   TracedCallback<Ptr<const Packet>, uint16_t, uint16_t, uint32_t, bool, WifiTxVector> m_phyMonitorSniffTxTrace;
 
+  /**
+   * An entry of the TX duration cache. Only frames that are not part of an
+   * A-MPDU are cached, since A-MPDU subframe durations depend on
+   * m_totalAmpduSize and m_totalAmpduNumSymbols.
+   */
+  struct TxDurationCacheEntry
+  {
+    uint32_t size;      //!< the number of bytes in the packet
+    uint32_t modeUid;   //!< the payload WifiMode UID (also implies the bandwidth)
+    uint8_t preamble;   //!< the WifiPreamble
+    uint8_t nss;        //!< the number of spatial streams
+    uint8_t ness;       //!< the number of extension spatial streams (HT training symbols)
+    bool stbc;          //!< whether STBC is used
+    bool shortGuardInterval; //!< whether the short guard interval is used
+    bool valid;         //!< whether the entry holds a duration
+    double frequency;   //!< the channel center frequency (MHz)
+    Time duration;      //!< the cached CalculateTxDuration result
+  };
+  /**
+   * The number of entries of the (direct-mapped) TX duration cache, a power of 2
+   */
+  static const uint32_t TX_DURATION_CACHE_SIZE = 64;
+
+  TxDurationCacheEntry m_txDurationCache[TX_DURATION_CACHE_SIZE]; //!< TX duration cache indexed by a hash of the key
+  bool m_txDurationCacheEnabled;   //!< whether CalculateTxDuration uses m_txDurationCache
+
   uint32_t m_totalAmpduNumSymbols; //!< Number of symbols previously transmitted for the MPDUs in an A-MPDU, used for the computation of the number of symbols needed for the last MPDU in the A-MPDU
   uint32_t m_totalAmpduSize;       //!< Total size of the previously transmitted MPDUs in an A-MPDU, used for the computation of the number of symbols needed for the last MPDU in the A-MPDU
 };
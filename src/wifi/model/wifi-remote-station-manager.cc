@@ -1490,10 +1490,16 @@ WifiRemoteStationManager::GetDefaultMcs (void) const
   return m_defaultTxMcs;
 }
 
+void
+WifiRemoteStationManager::DoReset (void)
+{
+}
+
 void
 WifiRemoteStationManager::Reset (void)
 {
   NS_LOG_FUNCTION (this);
+  DoReset ();
   for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
     {
       delete (*i);
@@ -631,6 +631,11 @@ public:
 
 protected:
   virtual void DoDispose (void);
+  /**
+   * Invoked by Reset () before all WifiRemoteStation objects are deleted,
+   * so subclasses can drop any reference they keep to them.
+   */
+  virtual void DoReset (void);
   /**
    * Return whether mode associated with the specified station at the specified index.
    *
@@ -26,6 +26,7 @@
 #include "ns3/log.h"
 #include "ns3/pointer.h"
 #include "ns3/object-factory.h"
+#include "ns3/boolean.h"
 #include "yans-wifi-channel.h"
 #include "yans-wifi-phy.h"
 #include "ns3/propagation-loss-model.h"
@@ -44,6 +45,58 @@ NS_LOG_COMPONENT_DEFINE ("YansWifiChannel");
 
 NS_OBJECT_ENSURE_REGISTERED (YansWifiChannel);
 
+/**
+ * Listener for PHY sleep/wakeup events: keeps the awake receivers of
+ * YansWifiChannel up to date.
+ */
+class PhyChannelListener : public ns3::WifiPhyListener
+{
+public:
+  /**
+   * Create a PhyChannelListener for the i-th PHY of the given channel.
+   *
+   * \param channel
+   * \param i
+   */
+  PhyChannelListener (ns3::YansWifiChannel *channel, uint32_t i)
+    : m_channel (channel),
+      m_index (i)
+  {
+  }
+  virtual ~PhyChannelListener ()
+  {
+  }
+  virtual void NotifyRxStart (Time duration)
+  {
+  }
+  virtual void NotifyRxEndOk (void)
+  {
+  }
+  virtual void NotifyRxEndError (void)
+  {
+  }
+  virtual void NotifyTxStart (Time duration, double txPowerDbm)
+  {
+  }
+  virtual void NotifyMaybeCcaBusyStart (Time duration)
+  {
+  }
+  virtual void NotifySwitchingStart (Time duration)
+  {
+  }
+  virtual void NotifySleep (void)
+  {
+    m_channel->NotifySleep (m_index);
+  }
+  virtual void NotifyWakeup (void)
+  {
+    m_channel->NotifyWakeup (m_index);
+  }
+private:
+  ns3::YansWifiChannel *m_channel; //!< the channel to notify
+  uint32_t m_index;                //!< index of the PHY in the channel
+};
+
 TypeId
 YansWifiChannel::GetTypeId (void)
 {
@@ -61,11 +114,25 @@ YansWifiChannel::GetTypeId (void)
                    MakePointerChecker<PropagationDelayModel> ())
 	.AddTraceSource("Transmission", "Fired when something is transmitted on the channel",
 				   MakeTraceSourceAccessor(&YansWifiChannel::m_channelTransmission), "ns3::YansWifiChannel::TransmissionCallback")
+    .AddAttribute ("SleepFiltering", "Do not schedule the reception of a frame for receivers in SLEEP state. "
+                   "A receiver waking up mid-frame still gets the frames it slept through. "
+                   "Sleeping receivers then no longer report a PhyRxDrop for those frames, "
+                   "so it is off by default.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_sleepFiltering),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxPropagationDelay", "The longest propagation delay between two PHYs, "
+                   "used to forget the frames skipped for sleeping receivers once they are off the air.",
+                   TimeValue (MicroSeconds (100)),
+                   MakeTimeAccessor (&YansWifiChannel::m_maxDelay),
+                   MakeTimeChecker ())
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_sleepFiltering (false),
+    m_txSeq (0)
 {
 }
 
@@ -75,6 +142,20 @@ YansWifiChannel::~YansWifiChannel ()
   m_phyList.clear ();
 }
 
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_phyListeners.size (); i++)
+    {
+      m_phyList[i]->UnregisterListener (m_phyListeners[i]);
+      delete m_phyListeners[i];
+    }
+  m_phyListeners.clear ();
+  m_skipped.clear ();
+  WifiChannel::DoDispose ();
+}
+
 void
 YansWifiChannel::SetPropagationLossModel (Ptr<PropagationLossModel> loss)
 {
@@ -91,6 +172,7 @@ void YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, d
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
   uint32_t j = 0;
+  bool skipped = false;
 
   //std::cout<<txVector.GetMode().GetUniqueName()<<std::endl;
   //WifiMode modeTmp = WifiMode("OfdmRate3_6MbpsBW1MHz");
@@ -101,7 +183,10 @@ void YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, d
 
   //txVector.SetMode();
 
-  m_channelTransmission(sender->GetDevice(), packet->Copy());
+  if (!m_channelTransmission.IsEmpty ())
+    {
+      m_channelTransmission (sender->GetDevice (), packet->Copy ());
+    }
   
   for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
     {
@@ -111,108 +196,140 @@ void YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, d
         if ((*i)->GetChannelNumber () != sender->GetChannelNumber ()){
           continue;
         }
-
-        Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-        Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-        double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-        NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                      "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-        Ptr<Packet> copy = packet->Copy ();
-        Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
-        uint32_t dstNode;
-        if (dstNetDevice == 0){
-          dstNode = 0xffffffff;
-        }else{
-          dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
-        }
-        // optimal rate
-        // optimal rate - when AP receives a packet
-        double noise;
-        double rssi; 
-        double snrThreshold;
-        double * snrActual = NULL;
-        bool * isMCSGood = NULL;
-        int mcsIdx;
-        int optimalMcsIdx;
-        uint64_t optimalDataRate = 0;
-        WifiMode optimalMode;
-        uint64_t tmpDataRate = 0;
-        WifiMode tmpWifiMode;
-        Time calibratedTxDuration;
-        if((*i)->GetRxGain() == 3 && this->isOptimal && packet->GetSize()==166){
-          // assign memory
-          snrActual = new double[Mcs::Len()];
-          isMCSGood = new bool[Mcs::Len()];
-          // transfer the actual RSSI in Watts
-          rssi = std::pow(10.0, (rxPowerDbm+3)/10.0)/1000;
-          //std::cout<<"rssi = " << rssi<<std::endl;
-          // find the threshold SNR & actual SNR for each MCS
-          //std::cout<<"Time: "<< Simulator::Now().GetNanoSeconds() <<std::endl;
-          for(mcsIdx = 0; mcsIdx < Mcs::Len(); ++mcsIdx){
-            tmpWifiMode = WifiMode(Mcs::GetModeNameAt(mcsIdx));
-            snrThreshold = (*i)->CalculateSnr(tmpWifiMode, this->optimalBerThreshold);
-            noise = GetNoisePower(tmpWifiMode.GetBandwidth());
-            snrActual[mcsIdx] = rssi/noise;
-            // check whether this MCS pass the threshold
-            if(snrActual[mcsIdx] >= snrThreshold){
-              isMCSGood[mcsIdx] = true;
-            }else{
-              isMCSGood[mcsIdx] = false;
-            }  
-            //std::cout<< " - Threshold(" << mcsIdx << ")" << snrThreshold << ", actual:" << snrActual[mcsIdx]<< ", actual rate: " << tmpWifiMode.GetDataRate()/10000 <<std::endl;
-            //std::cout << "   - noise " << noise << std::endl;
-          }
-          //std::cout<<"Time: "<< Simulator::Now().GetNanoSeconds() <<std::endl;
-          // find the minimal mcs when actual SNR >= SNR threshold
-          for(mcsIdx = 0; mcsIdx < Mcs::Len(); ++mcsIdx){
-            if(isMCSGood[mcsIdx]){
-              tmpWifiMode = WifiMode(Mcs::GetModeNameAt(mcsIdx));
-              tmpDataRate = tmpWifiMode.GetDataRate();
-              if(tmpDataRate > optimalDataRate){
-                optimalDataRate = tmpDataRate;
-                optimalMode = tmpWifiMode;
-                optimalMcsIdx = mcsIdx;
-              }
-            }
-          }
-          //std::cout<<"Packet size is " << packet->GetSize () << "Best MCS Idx: " << optimalMcsIdx << ", name is" << optimalMode.GetUniqueName()<< std::endl;
-          //std::cout<<"Time: "<< Simulator::Now().GetNanoSeconds() <<std::endl;
-          //std::cout<<"Best MCS" << optimalMode.GetUniqueName() << std::endl;
-          // reset Wifi mode in txVector
-          //std::cout<<txVector.GetMode().GetUniqueName() << std::endl;
-          txVector.SetMode(optimalMode);
-          //std::cout<<optimalMode.GetUniqueName()<< ", frequency = " << sender->GetFrequency() << std::endl;
-          //std::cout<<txVector.GetMode().GetUniqueName() << std::endl;
-          // calculate new Tx duration
-          calibratedTxDuration = sender->CalculateTxDuration(packet->GetSize (), txVector, preamble, sender->GetFrequency(), packetType, 1);
-          //std::cout << "Original time: " << duration.GetSeconds() << ", Calibrated Time:" << calibratedTxDuration.GetSeconds() << std::endl;
-          duration = calibratedTxDuration;
-          // release memory
-          delete [] snrActual;
-          delete [] isMCSGood;
+        // sleeping receivers catch up in NotifyWakeup if they wake up before the frame is over
+        if (!m_awake[j]){
+          skipped = true;
+          continue;
         }
-        // update transmission - MCS
-
-        // update transmission - duration
-
-        double *atts = new double[3];
-        *atts = rxPowerDbm;
-        *(atts + 1) = packetType;
-        *(atts + 2) = duration.GetNanoSeconds ();
-        // send to Rx
-        if(context.IsEmpty()){
-          void (YansWifiChannel::*callback)(uint32_t, Ptr<Packet>, double *, WifiTxVector, WifiPreamble) const = NULL;
-          callback = &YansWifiChannel::Receive;
-          Simulator::ScheduleWithContext (dstNode, delay, callback, this, j, copy, atts, txVector, preamble);
-        }else{
-          // record the node index into the context and send
-          context.SetNodeIndex(j);
-          void (YansWifiChannel::*callback)(PacketContext, Ptr<Packet>, double *, WifiTxVector, WifiPreamble) const = NULL;
-          callback = &YansWifiChannel::Receive;
-          Simulator::ScheduleWithContext (dstNode, delay, callback, this, context, copy, atts, txVector, preamble);
+        Deliver (j, sender, senderMobility, packet, txPowerDbm, txVector, preamble, packetType, duration, context, Seconds (0));
+      }
+    }
+  if (skipped){
+    SkippedTx tx;
+    tx.seq = m_txSeq;
+    tx.start = Simulator::Now ();
+    tx.sender = sender;
+    tx.packet = packet;
+    tx.txPowerDbm = txPowerDbm;
+    tx.txVector = txVector;
+    tx.preamble = preamble;
+    tx.packetType = packetType;
+    tx.duration = duration;
+    tx.context = context;
+    m_skipped.push_back (tx);
+  }
+  ++m_txSeq;
+  // forget the skipped transmissions that are off the air for every receiver
+  while (!m_skipped.empty () && m_skipped.front ().start + m_skipped.front ().duration + m_maxDelay < Simulator::Now ()){
+    m_skipped.pop_front ();
+  }
+}
+
+void YansWifiChannel::Deliver (uint32_t j, Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, Ptr<const Packet> packet,
+                               double txPowerDbm, WifiTxVector &txVector, WifiPreamble preamble, uint8_t packetType,
+                               Time &duration, PacketContext context, Time elapsed) const{
+  Ptr<MobilityModel> receiverMobility = m_phyList[j]->GetMobility ()->GetObject<MobilityModel> ();
+  Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+  NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0){
+    dstNode = 0xffffffff;
+  }else{
+    dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+  }
+  // optimal rate
+  // optimal rate - when AP receives a packet
+  double noise;
+  double rssi; 
+  double snrThreshold;
+  double snrActual[__SDN_LAB_MCS_LEN];
+  bool isMCSGood[__SDN_LAB_MCS_LEN];
+  int mcsIdx;
+  int optimalMcsIdx;
+  uint64_t optimalDataRate = 0;
+  WifiMode optimalMode;
+  uint64_t tmpDataRate = 0;
+  WifiMode tmpWifiMode;
+  Time calibratedTxDuration;
+  if(m_phyList[j]->GetRxGain() == 3 && this->isOptimal && packet->GetSize()==166){
+    // transfer the actual RSSI in Watts
+    rssi = std::pow(10.0, (rxPowerDbm+3)/10.0)/1000;
+    //std::cout<<"rssi = " << rssi<<std::endl;
+    // find the threshold SNR & actual SNR for each MCS
+    //std::cout<<"Time: "<< Simulator::Now().GetNanoSeconds() <<std::endl;
+    for(mcsIdx = 0; mcsIdx < Mcs::Len(); ++mcsIdx){
+      tmpWifiMode = Mcs::GetModeAt(mcsIdx);
+      snrThreshold = m_phyList[j]->CalculateSnr(tmpWifiMode, this->optimalBerThreshold);
+      noise = GetNoisePower(tmpWifiMode.GetBandwidth());
+      snrActual[mcsIdx] = rssi/noise;
+      // check whether this MCS pass the threshold
+      if(snrActual[mcsIdx] >= snrThreshold){
+        isMCSGood[mcsIdx] = true;
+      }else{
+        isMCSGood[mcsIdx] = false;
+      }  
+      //std::cout<< " - Threshold(" << mcsIdx << ")" << snrThreshold << ", actual:" << snrActual[mcsIdx]<< ", actual rate: " << tmpWifiMode.GetDataRate()/10000 <<std::endl;
+      //std::cout << "   - noise " << noise << std::endl;
+    }
+    //std::cout<<"Time: "<< Simulator::Now().GetNanoSeconds() <<std::endl;
+    // find the minimal mcs when actual SNR >= SNR threshold
+    for(mcsIdx = 0; mcsIdx < Mcs::Len(); ++mcsIdx){
+      if(isMCSGood[mcsIdx]){
+        tmpWifiMode = Mcs::GetModeAt(mcsIdx);
+        tmpDataRate = tmpWifiMode.GetDataRate();
+        if(tmpDataRate > optimalDataRate){
+          optimalDataRate = tmpDataRate;
+          optimalMode = tmpWifiMode;
+          optimalMcsIdx = mcsIdx;
         }
       }
     }
+    //std::cout<<"Packet size is " << packet->GetSize () << "Best MCS Idx: " << optimalMcsIdx << ", name is" << optimalMode.GetUniqueName()<< std::endl;
+    //std::cout<<"Time: "<< Simulator::Now().GetNanoSeconds() <<std::endl;
+    //std::cout<<"Best MCS" << optimalMode.GetUniqueName() << std::endl;
+    // reset Wifi mode in txVector
+    //std::cout<<txVector.GetMode().GetUniqueName() << std::endl;
+    txVector.SetMode(optimalMode);
+    //std::cout<<optimalMode.GetUniqueName()<< ", frequency = " << sender->GetFrequency() << std::endl;
+    //std::cout<<txVector.GetMode().GetUniqueName() << std::endl;
+    // calculate new Tx duration
+    calibratedTxDuration = sender->CalculateTxDuration(packet->GetSize (), txVector, preamble, sender->GetFrequency(), packetType, 1);
+    //std::cout << "Original time: " << duration.GetSeconds() << ", Calibrated Time:" << calibratedTxDuration.GetSeconds() << std::endl;
+    duration = calibratedTxDuration;
+  }
+  // update transmission - MCS
+
+  // update transmission - duration
+
+  if (elapsed > delay){
+    // the frame reached the PHY while it was asleep: only its energy is left
+    Time remaining = delay + duration - elapsed;
+    if (remaining.IsStrictlyPositive ()){
+      m_phyList[j]->AddSleepingInterference (packet->GetSize (), rxPowerDbm, txVector, preamble, remaining);
+    }
+    return;
+  }
+  delay -= elapsed;
+  Ptr<Packet> copy = packet->Copy ();
+  double *atts = new double[3];
+  *atts = rxPowerDbm;
+  *(atts + 1) = packetType;
+  *(atts + 2) = duration.GetNanoSeconds ();
+  // send to Rx
+  if(context.IsEmpty()){
+    void (YansWifiChannel::*callback)(uint32_t, Ptr<Packet>, double *, WifiTxVector, WifiPreamble) const = NULL;
+    callback = &YansWifiChannel::Receive;
+    Simulator::ScheduleWithContext (dstNode, delay, callback, this, j, copy, atts, txVector, preamble);
+  }else{
+    // record the node index into the context and send
+    context.SetNodeIndex(j);
+    void (YansWifiChannel::*callback)(PacketContext, Ptr<Packet>, double *, WifiTxVector, WifiPreamble) const = NULL;
+    callback = &YansWifiChannel::Receive;
+    Simulator::ScheduleWithContext (dstNode, delay, callback, this, context, copy, atts, txVector, preamble);
+  }
 }
 
 void YansWifiChannel::Receive (uint32_t i, Ptr<Packet> packet, double *atts, WifiTxVector txVector, WifiPreamble preamble) const{
@@ -239,7 +356,47 @@ YansWifiChannel::GetDevice (uint32_t i) const
 void
 YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
 {
+  PhyChannelListener *listener = new PhyChannelListener (this, m_phyList.size ());
   m_phyList.push_back (phy);
+  m_awake.push_back (true);
+  m_sleepSeq.push_back (m_txSeq);
+  m_phyListeners.push_back (listener);
+  phy->RegisterListener (listener);
+}
+
+void
+YansWifiChannel::NotifySleep (uint32_t i)
+{
+  NS_LOG_FUNCTION (this << i);
+  if (!m_sleepFiltering)
+    {
+      return;
+    }
+  m_awake[i] = false;
+  m_sleepSeq[i] = m_txSeq;
+}
+
+void
+YansWifiChannel::NotifyWakeup (uint32_t i)
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_awake[i])
+    {
+      return;
+    }
+  m_awake[i] = true;
+  Ptr<YansWifiPhy> phy = m_phyList[i];
+  for (SkippedTxList::const_iterator it = m_skipped.begin (); it != m_skipped.end (); ++it)
+    {
+      if (it->seq < m_sleepSeq[i] || it->sender == phy || it->sender->GetChannelNumber () != phy->GetChannelNumber ())
+        {
+          continue;
+        }
+      WifiTxVector txVector = it->txVector;
+      Time duration = it->duration;
+      Deliver (i, it->sender, it->sender->GetMobility ()->GetObject<MobilityModel> (), it->packet, it->txPowerDbm,
+               txVector, it->preamble, it->packetType, duration, it->context, Simulator::Now () - it->start);
+    }
 }
 
 int64_t
@@ -22,6 +22,7 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include <vector>
+#include <deque>
 #include <stdint.h>
 #include "ns3/packet.h"
 #include "wifi-channel.h"
@@ -41,6 +42,8 @@ class NetDevice;
 class PropagationLossModel;
 class PropagationDelayModel;
 class YansWifiPhy;
+class MobilityModel;
+class PhyChannelListener;
 
 /**
  * \brief A Yans wifi channel
@@ -111,6 +114,22 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \param i index of the YansWifiPhy in the PHY list
+   *
+   * Invoked by the PHY listener when the i-th PHY goes to sleep: frames sent
+   * from now on are not scheduled for it.
+   */
+  void NotifySleep (uint32_t i);
+  /**
+   * \param i index of the YansWifiPhy in the PHY list
+   *
+   * Invoked by the PHY listener when the i-th PHY wakes up: frames it slept
+   * through and that have not reached it yet are scheduled as usual, frames
+   * already on the air at its antenna are handed to it as interference.
+   */
+  void NotifyWakeup (uint32_t i);
+
 
   /**
    * Change the channel type to optimal (where the MCS is automatically adjusted based on the location between AP and STAs)
@@ -151,6 +170,39 @@ private:
    * A vector of pointers to YansWifiPhy.
    */
   typedef std::vector<Ptr<YansWifiPhy> > PhyList;
+  /**
+   * A transmission some sleeping receivers did not get, kept until it is
+   * off the air so that they can catch up if they wake up mid-frame.
+   */
+  struct SkippedTx
+  {
+    uint64_t seq;                 //!< sequence number of the transmission
+    Time start;                   //!< time the transmission started
+    Ptr<YansWifiPhy> sender;      //!< transmitting PHY
+    Ptr<const Packet> packet;     //!< transmitted packet
+    double txPowerDbm;            //!< transmission power
+    WifiTxVector txVector;        //!< TXVECTOR of the packet
+    WifiPreamble preamble;        //!< preamble of the packet
+    uint8_t packetType;           //!< packet type (A-MPDU)
+    Time duration;                //!< transmission duration
+    SdnLab::PacketContext context; //!< packet context
+  };
+  typedef std::deque<SkippedTx> SkippedTxList;
+
+  virtual void DoDispose (void);
+  /**
+   * Compute the propagation towards the j-th PHY and schedule its Receive.
+   *
+   * \param j index of the receiving YansWifiPhy in the PHY list
+   * \param elapsed time since the transmission started (non-zero when a PHY
+   *        catches up on a transmission it slept through)
+   *
+   * The other parameters are the ones of Send; txVector and duration are
+   * recalibrated in place when the channel is optimal.
+   */
+  void Deliver (uint32_t j, Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, Ptr<const Packet> packet,
+                double txPowerDbm, WifiTxVector &txVector, WifiPreamble preamble, uint8_t packetType,
+                Time &duration, SdnLab::PacketContext context, Time elapsed) const;
   /**
    * This method is scheduled by Send for each associated YansWifiPhy.
    * The method then calls the corresponding YansWifiPhy that the first
@@ -171,6 +223,14 @@ private:
 
   TracedCallback<Ptr<NetDevice>, Ptr<Packet>> m_channelTransmission;
 
+  bool m_sleepFiltering;                              //!< skip receivers in SLEEP state
+  Time m_maxDelay;                                    //!< upper bound of the propagation delay
+  std::vector<bool> m_awake;                          //!< whether the i-th PHY is awake
+  std::vector<uint64_t> m_sleepSeq;                   //!< first transmission the i-th PHY slept through
+  std::vector<PhyChannelListener *> m_phyListeners;   //!< listeners of the PHY sleep/wakeup
+  mutable uint64_t m_txSeq;                           //!< sequence number of the next transmission
+  mutable SkippedTxList m_skipped;                    //!< transmissions skipped for sleeping receivers
+
   double optimalBerThreshold = 10e-6;
   bool isOptimal = false;             // whether the channel is optimal (the channel automatically selects the best MCS)
   double noiseFigure = 0;
@@ -788,6 +788,18 @@ maybeCcaBusy:
     }
 }
 
+void
+YansWifiPhy::AddSleepingInterference (uint32_t size,
+                                      double rxPowerDbm,
+                                      WifiTxVector txVector,
+                                      enum WifiPreamble preamble,
+                                      Time duration)
+{
+  NS_LOG_FUNCTION (this << size << rxPowerDbm << txVector.GetMode () << preamble << duration);
+  rxPowerDbm += m_rxGainDb;
+  m_interference.Add (size, txVector, preamble, duration, DbmToW (rxPowerDbm));
+}
+
 void
 YansWifiPhy::StartReceivePacket (Ptr<Packet> packet,
                                  WifiTxVector txVector,
@@ -855,17 +867,20 @@ void YansWifiPhy::SendPacket (Ptr<const Packet> packet, WifiTxVector txVector, W
       m_interference.NotifyRxEnd ();
     }
   NotifyTxBegin(packet, txDuration);
-  uint32_t dataRate500KbpsUnits;
-  if (txVector.GetMode ().GetModulationClass () == WIFI_MOD_CLASS_HT || txVector.GetMode ().GetModulationClass () == WIFI_MOD_CLASS_S1G)
+  if (IsMonitorSniffTxTraced ())
     {
-      dataRate500KbpsUnits = 128 + WifiModeToMcs (txVector.GetMode ());
-    }
-  else
-    {
-      dataRate500KbpsUnits = txVector.GetMode ().GetDataRate () * txVector.GetNss () / 500000;
+      uint32_t dataRate500KbpsUnits;
+      if (txVector.GetMode ().GetModulationClass () == WIFI_MOD_CLASS_HT || txVector.GetMode ().GetModulationClass () == WIFI_MOD_CLASS_S1G)
+        {
+          dataRate500KbpsUnits = 128 + WifiModeToMcs (txVector.GetMode ());
+        }
+      else
+        {
+          dataRate500KbpsUnits = txVector.GetMode ().GetDataRate () * txVector.GetNss () / 500000;
+        }
+      bool isShortPreamble = (WIFI_PREAMBLE_SHORT == preamble);
+      NotifyMonitorSniffTx (packet, (uint16_t)GetChannelFrequencyMhz (), GetChannelNumber (), dataRate500KbpsUnits, isShortPreamble, txVector);
     }
-  bool isShortPreamble = (WIFI_PREAMBLE_SHORT == preamble);
-  NotifyMonitorSniffTx (packet, (uint16_t)GetChannelFrequencyMhz (), GetChannelNumber (), dataRate500KbpsUnits, isShortPreamble, txVector);
   m_state->SwitchToTx (txDuration, packet, GetPowerDbm (txVector.GetTxPowerLevel ()), txVector, preamble);
   NS_LOG_FUNCTION (this);
   m_channel->Send (this, packet, GetPowerDbm (txVector.GetTxPowerLevel ()) + m_txGainDb, txVector, preamble, packetType, txDuration, context);
@@ -1160,7 +1175,11 @@ YansWifiPhy::RegisterListener (WifiPhyListener *listener)
 void
 YansWifiPhy::UnregisterListener (WifiPhyListener *listener)
 {
-  m_state->UnregisterListener (listener);
+  //the state helper is gone once the PHY is disposed
+  if (m_state != 0)
+    {
+      m_state->UnregisterListener (listener);
+    }
 }
 
 bool
@@ -1334,19 +1353,22 @@ YansWifiPhy::EndReceive (Ptr<Packet> packet, enum WifiPreamble preamble, uint8_t
       if (m_random->GetValue () > snrPer.per)
         {
           NotifyRxEnd (packet);
-          uint32_t dataRate500KbpsUnits;
-          if ((event->GetPayloadMode ().GetModulationClass () == WIFI_MOD_CLASS_HT) || (event->GetPayloadMode ().GetModulationClass () == WIFI_MOD_CLASS_S1G))
-            {
-              dataRate500KbpsUnits = 128 + WifiModeToMcs (event->GetPayloadMode ());
-            }
-          else
+          if (IsMonitorSniffRxTraced ())
             {
-              dataRate500KbpsUnits = event->GetPayloadMode ().GetDataRate () * event->GetTxVector ().GetNss () / 500000;
+              uint32_t dataRate500KbpsUnits;
+              if ((event->GetPayloadMode ().GetModulationClass () == WIFI_MOD_CLASS_HT) || (event->GetPayloadMode ().GetModulationClass () == WIFI_MOD_CLASS_S1G))
+                {
+                  dataRate500KbpsUnits = 128 + WifiModeToMcs (event->GetPayloadMode ());
+                }
+              else
+                {
+                  dataRate500KbpsUnits = event->GetPayloadMode ().GetDataRate () * event->GetTxVector ().GetNss () / 500000;
+                }
+              bool isShortPreamble = (WIFI_PREAMBLE_SHORT == event->GetPreambleType ());
+              double signalDbm = RatioToDb (event->GetRxPowerW ()) + 30;
+              double noiseDbm = RatioToDb (event->GetRxPowerW () / snrPer.snr) - GetRxNoiseFigure () + 30;
+              NotifyMonitorSniffRx (packet, (uint16_t)GetChannelFrequencyMhz (), GetChannelNumber (), dataRate500KbpsUnits, isShortPreamble, event->GetTxVector (), signalDbm, noiseDbm);
             }
-          bool isShortPreamble = (WIFI_PREAMBLE_SHORT == event->GetPreambleType ());
-          double signalDbm = RatioToDb (event->GetRxPowerW ()) + 30;
-          double noiseDbm = RatioToDb (event->GetRxPowerW () / snrPer.snr) - GetRxNoiseFigure () + 30;
-          NotifyMonitorSniffRx (packet, (uint16_t)GetChannelFrequencyMhz (), GetChannelNumber (), dataRate500KbpsUnits, isShortPreamble, event->GetTxVector (), signalDbm, noiseDbm);
           // set context to be received
           isReceived = true;
           context.SetReceived();
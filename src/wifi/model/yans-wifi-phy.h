@@ -120,6 +120,22 @@ public:
                                       uint8_t packetType,
                                       Time rxDuration, 
                                       SdnLab::PacketContext context = SdnLab::PacketContext());
+  /**
+   * Account for a signal which reached this PHY while it was asleep and is
+   * still on the air when it wakes up. The signal is only added to the
+   * interference, as StartReceivePreambleAndHeader does in SLEEP state.
+   *
+   * \param size the size of the packet (bytes)
+   * \param rxPowerDbm the receive power in dBm
+   * \param txVector the TXVECTOR of the packet
+   * \param preamble the preamble of the packet
+   * \param duration the time the signal remains on the air
+   */
+  void AddSleepingInterference (uint32_t size,
+                                double rxPowerDbm,
+                                WifiTxVector txVector,
+                                WifiPreamble preamble,
+                                Time duration);
   /**
    * Starting receiving the payload of a packet (i.e. the first bit of the packet has arrived).
    *
@@ -22,7 +22,10 @@
 #include "ns3/log.h"
 #include "ns3/qos-utils.h"
 #include "ns3/ctrl-headers.h"
+#include "ns3/block-ack-reorder-buffer.h"
+#include "ns3/packet.h"
 #include <list>
+#include <vector>
 
 using namespace ns3;
 
@@ -275,6 +278,90 @@ CtrlBAckResponseHeaderTest::DoRun (void)
 }
 
 
+//Test for the reorder buffer of a block ack recipient
+class BlockAckReorderBufferTest : public TestCase
+{
+public:
+  BlockAckReorderBufferTest ();
+private:
+  virtual void DoRun ();
+  void Store (uint16_t seq, uint8_t frag, bool moreFragments);
+  void ForwardUp (Ptr<Packet> packet, const WifiMacHeader *hdr, SdnLab::PacketContext context);
+  BlockAckReorderBuffer m_buffer;
+  std::vector<uint16_t> m_forwarded; //!< sequence control of the forwarded MPDUs
+};
+
+BlockAckReorderBufferTest::BlockAckReorderBufferTest ()
+  : TestCase ("Check the order of the MPDUs forwarded by the reorder buffer")
+{
+}
+
+void
+BlockAckReorderBufferTest::Store (uint16_t seq, uint8_t frag, bool moreFragments)
+{
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  hdr.SetSequenceNumber (seq);
+  hdr.SetFragmentNumber (frag);
+  if (moreFragments)
+    {
+      hdr.SetMoreFragments ();
+    }
+  else
+    {
+      hdr.SetNoMoreFragments ();
+    }
+  m_buffer.Store (Create<Packet> (10), hdr);
+}
+
+void
+BlockAckReorderBufferTest::ForwardUp (Ptr<Packet> packet, const WifiMacHeader *hdr, SdnLab::PacketContext context)
+{
+  m_forwarded.push_back (hdr->GetSequenceControl ());
+}
+
+void
+BlockAckReorderBufferTest::DoRun (void)
+{
+  m_buffer.Init (4090, 64, MakeCallback (&BlockAckReorderBufferTest::ForwardUp, this));
+
+  Store (4092, 0, false);
+  Store (4091, 0, false);
+  Store (4095, 1, false);
+  Store (4094, 0, false);
+  Store (2, 0, false);
+  NS_TEST_EXPECT_MSG_EQ (m_buffer.ForwardInOrder (), 4090, "4090 is missing");
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded.size (), 0, "nothing should be forwarded");
+
+  Store (4090, 0, false);
+  Store (4092, 0, false);
+  NS_TEST_EXPECT_MSG_EQ (m_buffer.ForwardInOrder (), 4093, "4093 is missing");
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded.size (), 3, "4090 - 4092 should be forwarded once");
+  Store (4091, 0, false);
+  NS_TEST_EXPECT_MSG_EQ (m_buffer.GetNMpdus (), 3, "an old MPDU should be discarded");
+
+  // the first fragment of 4095 completes it
+  Store (4095, 0, true);
+  m_buffer.ForwardBefore (3);
+  NS_TEST_EXPECT_MSG_EQ (m_buffer.GetWinStart (), 3, "wrong window start");
+  NS_TEST_EXPECT_MSG_EQ (m_buffer.GetNMpdus (), 0, "the buffer should be empty");
+
+  // beyond the window: the window moves forward, dropping the incomplete 5
+  Store (5, 0, true);
+  Store (4, 0, false);
+  Store (3 + 64 + 6, 0, false);
+  NS_TEST_EXPECT_MSG_EQ (m_buffer.GetWinStart (), 10, "the window should end at the new MPDU");
+  m_buffer.ForwardBefore (3 + 64 + 7);
+
+  uint16_t expected[] = {4090 << 4, 4091 << 4, 4092 << 4, 4094 << 4, 4095 << 4, (4095 << 4) + 1, 2 << 4, 4 << 4, (3 + 64 + 6) << 4};
+  NS_TEST_ASSERT_MSG_EQ (m_forwarded.size (), sizeof (expected) / sizeof (expected[0]), "wrong number of MPDUs forwarded");
+  for (uint32_t i = 0; i < m_forwarded.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_forwarded[i], expected[i], "MPDU forwarded out of order");
+    }
+}
+
+
 class BlockAckTestSuite : public TestSuite
 {
 public:
@@ -287,6 +374,7 @@ BlockAckTestSuite::BlockAckTestSuite ()
   AddTestCase (new PacketBufferingCaseA, TestCase::QUICK);
   AddTestCase (new PacketBufferingCaseB, TestCase::QUICK);
   AddTestCase (new CtrlBAckResponseHeaderTest, TestCase::QUICK);
+  AddTestCase (new BlockAckReorderBufferTest, TestCase::QUICK);
 }
 
 static BlockAckTestSuite g_blockAckTestSuite;
@@ -277,6 +277,70 @@ TxDurationTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (retval, true, "an 802.11n duration failed");
 }
 
+/**
+ * Check that the TX duration cache of WifiPhy returns the same durations
+ * as an uncached WifiPhy for all S1G modes, sizes and preambles; the sweep
+ * is repeated so that both cache hits and evictions are exercised.
+ */
+class TxDurationCacheTest : public TestCase
+{
+public:
+  TxDurationCacheTest ();
+  virtual ~TxDurationCacheTest ();
+  virtual void DoRun (void);
+};
+
+TxDurationCacheTest::TxDurationCacheTest ()
+  : TestCase ("Wifi TX Duration cache")
+{
+}
+
+TxDurationCacheTest::~TxDurationCacheTest ()
+{
+}
+
+void
+TxDurationCacheTest::DoRun (void)
+{
+  static const uint32_t widths[] = {1, 2, 4, 8, 16};
+  static const uint32_t sizes[] = {14, 20, 76, 100, 256, 1000, 1536};
+  static const WifiPreamble preambles[] = {WIFI_PREAMBLE_S1G_SHORT, WIFI_PREAMBLE_S1G_LONG, WIFI_PREAMBLE_S1G_1M};
+
+  for (uint32_t w = 0; w < sizeof (widths) / sizeof (widths[0]); w++)
+    {
+      Ptr<YansWifiPhy> cached = CreateObject<YansWifiPhy> ();
+      Ptr<YansWifiPhy> uncached = CreateObject<YansWifiPhy> ();
+      cached->SetChannelWidth (widths[w]);
+      uncached->SetChannelWidth (widths[w]);
+      cached->ConfigureStandard (WIFI_PHY_STANDARD_80211ah);
+      uncached->ConfigureStandard (WIFI_PHY_STANDARD_80211ah);
+      uncached->SetTxDurationCacheEnabled (false);
+      NS_TEST_ASSERT_MSG_EQ (cached->IsTxDurationCacheEnabled (), true, "the cache should be enabled by default");
+      double frequency = cached->GetChannelFrequencyMhz ();
+
+      for (uint32_t round = 0; round < 3; round++)
+        {
+          for (uint32_t m = 0; m < cached->GetNModes (); m++)
+            {
+              WifiTxVector txVector;
+              txVector.SetMode (cached->GetMode (m));
+              txVector.SetNss (1);
+              for (uint32_t p = 0; p < sizeof (preambles) / sizeof (preambles[0]); p++)
+                {
+                  for (uint32_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); s++)
+                    {
+                      Time expected = uncached->CalculateTxDuration (sizes[s], txVector, preambles[p], frequency, 0, 0);
+                      Time calculated = cached->CalculateTxDuration (sizes[s], txVector, preambles[p], frequency, 0, 0);
+                      NS_TEST_ASSERT_MSG_EQ (calculated, expected, "cached duration mismatch: width=" << widths[w]
+                                             << " mode=" << txVector.GetMode () << " preamble=" << preambles[p]
+                                             << " size=" << sizes[s]);
+                    }
+                }
+            }
+        }
+    }
+}
+
 
 class TxDurationTestSuite : public TestSuite
 {
@@ -288,6 +352,7 @@ TxDurationTestSuite::TxDurationTestSuite ()
   : TestSuite ("devices-wifi-tx-duration", UNIT)
 {
   AddTestCase (new TxDurationTest, TestCase::QUICK);
+  AddTestCase (new TxDurationCacheTest, TestCase::QUICK);
 }
 
 static TxDurationTestSuite g_txDurationTestSuite;
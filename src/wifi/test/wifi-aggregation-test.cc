@@ -26,6 +26,10 @@
 #include "ns3/mac-low.h"
 #include "ns3/edca-txop-n.h"
 #include "ns3/yans-wifi-phy.h"
+#include "ns3/msdu-aggregator.h"
+#include "ns3/mpdu-aggregator.h"
+
+#include <vector>
 
 using namespace ns3;
 
@@ -176,6 +180,123 @@ TwoLevelAggregationTest::DoRun (void)
 }
 
 
+//-----------------------------------------------------------------------------
+class DeaggregationTest : public TestCase
+{
+public:
+  DeaggregationTest ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param size the packet size
+   * \param seed the first byte
+   * \return a packet of consecutive bytes
+   */
+  Ptr<Packet> CreatePacket (uint32_t size, uint8_t seed);
+  /**
+   * \param packet a packet
+   * \param seed the first byte
+   * \return true if the packet holds consecutive bytes from the seed
+   */
+  bool CheckPacket (Ptr<const Packet> packet, uint8_t seed);
+};
+
+DeaggregationTest::DeaggregationTest ()
+  : TestCase ("Check the in place deaggregation of A-MSDUs and A-MPDUs")
+{
+}
+
+Ptr<Packet>
+DeaggregationTest::CreatePacket (uint32_t size, uint8_t seed)
+{
+  std::vector<uint8_t> bytes (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      bytes[i] = seed + i;
+    }
+  return Create<Packet> (&bytes[0], size);
+}
+
+bool
+DeaggregationTest::CheckPacket (Ptr<const Packet> packet, uint8_t seed)
+{
+  std::vector<uint8_t> bytes (packet->GetSize () + 1);
+  packet->CopyData (&bytes[0], packet->GetSize ());
+  for (uint32_t i = 0; i < packet->GetSize (); i++)
+    {
+      if (bytes[i] != (uint8_t)(seed + i))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+DeaggregationTest::DoRun (void)
+{
+  ObjectFactory factory;
+  uint32_t sizes[] = {100, 37, 1};
+  Mac48Address src ("00:00:00:00:00:01");
+  Mac48Address dest ("00:00:00:00:00:02");
+
+  /*
+   * A-MSDU of three MSDUs: the first two are fragments of the A-MSDU,
+   * the last one is the A-MSDU itself.
+   */
+  factory.SetTypeId ("ns3::MsduStandardAggregator");
+  Ptr<MsduAggregator> msduAggregator = factory.Create<MsduAggregator> ();
+  Ptr<Packet> amsdu = Create<Packet> ();
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      bool aggregated = msduAggregator->Aggregate (CreatePacket (sizes[i], i * 50), amsdu, src, dest);
+      NS_TEST_ASSERT_MSG_EQ (aggregated, true, "MSDU not aggregated");
+    }
+  AmsduSubframeHeader msduHdr;
+  Ptr<Packet> msdu = 0;
+  uint32_t n = 0;
+  while (msdu != amsdu && amsdu->GetSize () > 0)
+    {
+      NS_TEST_ASSERT_MSG_LT (n, 3, "too many MSDUs");
+      msdu = MsduAggregator::RemoveSubframe (amsdu, &msduHdr);
+      NS_TEST_EXPECT_MSG_EQ (msdu->GetSize (), sizes[n], "wrong MSDU size");
+      NS_TEST_EXPECT_MSG_EQ (CheckPacket (msdu, n * 50), true, "wrong MSDU content");
+      NS_TEST_EXPECT_MSG_EQ (msduHdr.GetSourceAddr (), src, "wrong source");
+      NS_TEST_EXPECT_MSG_EQ (msduHdr.GetDestinationAddr (), dest, "wrong destination");
+      NS_TEST_EXPECT_MSG_EQ ((msdu == amsdu), (n == 2), "only the last MSDU is the A-MSDU");
+      n++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (n, 3, "wrong number of MSDUs");
+
+  /*
+   * A-MPDU of the same packets, and the A-MPDU size computed without them.
+   */
+  factory.SetTypeId ("ns3::MpduStandardAggregator");
+  Ptr<MpduAggregator> mpduAggregator = factory.Create<MpduAggregator> ();
+  Ptr<Packet> ampdu = Create<Packet> ();
+  Ptr<Packet> reserved = Create<Packet> ();
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      mpduAggregator->Aggregate (CreatePacket (sizes[i], i * 50), ampdu);
+      mpduAggregator->ReserveSubframe (sizes[i], reserved);
+      NS_TEST_EXPECT_MSG_EQ (reserved->GetSize (), ampdu->GetSize (), "wrong A-MPDU size");
+    }
+  AmpduSubframeHeader mpduHdr;
+  Ptr<Packet> mpdu = 0;
+  n = 0;
+  while (mpdu != ampdu && ampdu->GetSize () > 0)
+    {
+      NS_TEST_ASSERT_MSG_LT (n, 3, "too many MPDUs");
+      mpdu = MpduAggregator::RemoveSubframe (ampdu, &mpduHdr);
+      NS_TEST_EXPECT_MSG_EQ (mpdu->GetSize (), sizes[n], "wrong MPDU size");
+      NS_TEST_EXPECT_MSG_EQ (mpduHdr.GetLength (), sizes[n], "wrong subframe length");
+      NS_TEST_EXPECT_MSG_EQ (CheckPacket (mpdu, n * 50), true, "wrong MPDU content");
+      n++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (n, 3, "wrong number of MPDUs");
+}
+
 //-----------------------------------------------------------------------------
 class WifiAggregationTestSuite : public TestSuite
 {
@@ -187,6 +308,7 @@ WifiAggregationTestSuite::WifiAggregationTestSuite ()
   : TestSuite ("aggregation-wifi", UNIT)
 {
   AddTestCase (new TwoLevelAggregationTest, TestCase::QUICK);
+  AddTestCase (new DeaggregationTest, TestCase::QUICK);
 }
 
 static WifiAggregationTestSuite g_wifiAggregationTestSuite;
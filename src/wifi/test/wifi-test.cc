@@ -36,11 +36,23 @@
 #include "ns3/object-factory.h"
 #include "ns3/dca-txop.h"
 #include "ns3/mac-rx-middle.h"
+#include "ns3/mac-tx-middle.h"
+#include "ns3/mac-address-table.h"
 #include "ns3/pointer.h"
 #include "ns3/rng-seed-manager.h"
 #include "ns3/edca-txop-n.h"
 #include "ns3/config.h"
 #include "ns3/boolean.h"
+#include "ns3/raw-optimizer.h"
+#include "ns3/double.h"
+#include "ns3/ap-wifi-mac.h"
+#include "ns3/sta-wifi-mac.h"
+#include "ns3/s1g-association-helper.h"
+#include "ns3/net-device-container.h"
+#include "ns3/tim.h"
+#include "ns3/extension-headers.h"
+#include <set>
+#include <map>
 
 using namespace ns3;
 
@@ -482,6 +494,675 @@ Bug555TestCase::DoRun (void)
 }
 
 
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that a PHY in SLEEP state is skipped by the channel and still
+ * gets the frames that have not reached it when it wakes up.
+ *
+ * - the receiver wakes up between the start of frame 1 and its arrival:
+ *   frame 1 is received
+ * - the receiver wakes up in the middle of frame 2: frame 2 is not received
+ * - the receiver is awake when frame 3 is sent: frame 3 is received
+ */
+class SleepFilteringTest : public TestCase
+{
+public:
+  SleepFilteringTest ();
+
+  virtual void DoRun (void);
+
+
+private:
+  Ptr<Node> CreateOne (Vector pos, Ptr<YansWifiChannel> channel);
+  void SendOnePacket (Ptr<WifiNetDevice> dev);
+  void Sleep (Ptr<WifiNetDevice> dev);
+  void Wakeup (Ptr<WifiNetDevice> dev);
+  void PhyRxBegin (Ptr<const Packet> p);
+
+  ObjectFactory m_manager;
+  ObjectFactory m_mac;
+  uint32_t m_received; ///< number of receptions started by the receiver
+};
+
+SleepFilteringTest::SleepFilteringTest ()
+  : TestCase ("Skip sleeping receivers in YansWifiChannel"),
+    m_received (0)
+{
+}
+
+void
+SleepFilteringTest::SendOnePacket (Ptr<WifiNetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> (1000);
+  dev->Send (p, dev->GetBroadcast (), 1);
+}
+
+void
+SleepFilteringTest::Sleep (Ptr<WifiNetDevice> dev)
+{
+  dev->GetPhy ()->SetSleepMode ();
+}
+
+void
+SleepFilteringTest::Wakeup (Ptr<WifiNetDevice> dev)
+{
+  dev->GetPhy ()->ResumeFromSleep ();
+}
+
+void
+SleepFilteringTest::PhyRxBegin (Ptr<const Packet> p)
+{
+  m_received++;
+}
+
+Ptr<Node>
+SleepFilteringTest::CreateOne (Vector pos, Ptr<YansWifiChannel> channel)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+
+  Ptr<WifiMac> mac = m_mac.Create<WifiMac> ();
+  mac->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  Ptr<ErrorRateModel> error = CreateObject<YansErrorRateModel> ();
+  phy->SetErrorRateModel (error);
+  phy->SetChannel (channel);
+  phy->SetDevice (dev);
+  phy->SetMobility (mobility);
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<WifiRemoteStationManager> manager = m_manager.Create<WifiRemoteStationManager> ();
+
+  mobility->SetPosition (pos);
+  node->AggregateObject (mobility);
+  mac->SetAddress (Mac48Address::Allocate ());
+  dev->SetMac (mac);
+  dev->SetPhy (phy);
+  dev->SetRemoteStationManager (manager);
+  node->AddDevice (dev);
+
+  return node;
+}
+
+void
+SleepFilteringTest::DoRun (void)
+{
+  m_mac.SetTypeId ("ns3::AdhocWifiMac");
+  m_manager.SetTypeId ("ns3::ConstantRateWifiManager");
+
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetAttribute ("SleepFiltering", BooleanValue (true));
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  Ptr<FixedRssLossModel> propLoss = CreateObject<FixedRssLossModel> ();
+  propLoss->SetRss (-50);
+  channel->SetPropagationLossModel (propLoss);
+
+  Ptr<WifiNetDevice> sender = DynamicCast<WifiNetDevice> (CreateOne (Vector (0.0, 0.0, 0.0), channel)->GetDevice (0));
+  Ptr<WifiNetDevice> receiver = DynamicCast<WifiNetDevice> (CreateOne (Vector (30.0, 0.0, 0.0), channel)->GetDevice (0));
+  receiver->GetPhy ()->TraceConnectWithoutContext ("PhyRxBegin", MakeCallback (&SleepFilteringTest::PhyRxBegin, this));
+
+  //frame 1 arrives 100ns after it is sent
+  Simulator::Schedule (Seconds (0.5), &SleepFilteringTest::Sleep, this, receiver);
+  Simulator::Schedule (Seconds (1.0), &SleepFilteringTest::SendOnePacket, this, sender);
+  Simulator::Schedule (Seconds (1.0) + NanoSeconds (50), &SleepFilteringTest::Wakeup, this, receiver);
+  //frame 2 lasts more than 1ms
+  Simulator::Schedule (Seconds (2.0), &SleepFilteringTest::Sleep, this, receiver);
+  Simulator::Schedule (Seconds (3.0), &SleepFilteringTest::SendOnePacket, this, sender);
+  Simulator::Schedule (Seconds (3.0) + MicroSeconds (500), &SleepFilteringTest::Wakeup, this, receiver);
+  //frame 3
+  Simulator::Schedule (Seconds (5.0), &SleepFilteringTest::SendOnePacket, this, sender);
+
+  Simulator::Stop (Seconds (10.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received, 2, "Frames 1 and 3 should be received, frame 2 should not");
+}
+
+
+//-----------------------------------------------------------------------------
+class RawOptimizerTest : public TestCase
+{
+public:
+  RawOptimizerTest ();
+
+  virtual void DoRun (void);
+
+
+private:
+  /// \return the RAW time of an RPS element (us)
+  static uint32_t GetRawTime (const RPS *rps);
+};
+
+RawOptimizerTest::RawOptimizerTest ()
+  : TestCase ("Rebalance the RAW groups by load and receive errors")
+{
+}
+
+uint32_t
+RawOptimizerTest::GetRawTime (const RPS *rps)
+{
+  uint32_t time = 0;
+  for (uint32_t g = 0; g < rps->GetNumberOfRawGroups (); g++)
+    {
+      RPS::RawAssignment raw = rps->GetRawAssigmentObj (g);
+      time += raw.GetSlotNum () * (500 + raw.GetSlotDurationCount () * 120);
+    }
+  return time;
+}
+
+void
+RawOptimizerTest::DoRun (void)
+{
+  //two groups of 2 slots over AIDs 1-32 and 33-64
+  RPS rps;
+  for (uint32_t g = 0; g < 2; g++)
+    {
+      RPS::RawAssignment raw;
+      raw.SetRawControl (0);
+      raw.SetSlotCrossBoundary (1);
+      raw.SetSlotFormat (0);
+      raw.SetSlotDurationCount (20);
+      raw.SetSlotNum (2);
+      raw.SetRawGroup (((1 + 32 * g) << 2) | ((32 + 32 * g) << 13));
+      rps.SetRawAssignment (raw);
+    }
+  RPSVector rpsset;
+  rpsset.rpsset.push_back (&rps);
+  uint32_t rawTime = GetRawTime (&rps);
+
+  Ptr<RawOptimizer> optimizer = CreateObjectWithAttributes<RawOptimizer> (
+      "UpdatePeriod", UintegerValue (2),
+      "MaxBoundaryStep", UintegerValue (8),
+      "StationsPerSlot", DoubleValue (2.0));
+  NS_TEST_EXPECT_MSG_EQ (optimizer->NotifyBeacon (), false, "No update is due after the first beacon");
+  NS_TEST_EXPECT_MSG_EQ (optimizer->NotifyBeacon (), true, "An update is due after UpdatePeriod beacons");
+
+  //no traffic: nothing to balance
+  NS_TEST_EXPECT_MSG_EQ (optimizer->Optimize (rpsset), false, "The RAW configuration should be kept without traffic");
+  NS_TEST_ASSERT_MSG_EQ (rpsset.rpsset[0], &rps, "The RPS element should be kept without traffic");
+
+  //all the traffic comes from AIDs 1-16
+  for (uint16_t aid = 1; aid <= 16; aid++)
+    {
+      optimizer->NotifyTraffic (aid, 10);
+    }
+  NS_TEST_ASSERT_MSG_EQ (optimizer->Optimize (rpsset), true, "The RAW configuration should change");
+  RPS::RawAssignment first = rpsset.rpsset[0]->GetRawAssigmentObj (0);
+  RPS::RawAssignment second = rpsset.rpsset[0]->GetRawAssigmentObj (1);
+  NS_TEST_EXPECT_MSG_EQ (first.GetRawGroupAIDStart (), 1, "The AID span should be kept");
+  NS_TEST_EXPECT_MSG_EQ (first.GetRawGroupAIDEnd (), 24, "The boundary should move by MaxBoundaryStep towards AID 8");
+  NS_TEST_EXPECT_MSG_EQ (second.GetRawGroupAIDStart (), 25, "The groups should stay contiguous");
+  NS_TEST_EXPECT_MSG_EQ (second.GetRawGroupAIDEnd (), 64, "The AID span should be kept");
+  NS_TEST_EXPECT_MSG_EQ (first.GetSlotNum (), 4, "The loaded group should gain MaxSlotStep slots");
+  NS_TEST_EXPECT_MSG_EQ (second.GetSlotNum (), 1, "The idle group should keep a single slot");
+  NS_TEST_EXPECT_MSG_GT (first.GetSlotDurationCount (), second.GetSlotDurationCount (), "The loaded group should get the spare RAW time");
+  NS_TEST_EXPECT_MSG_EQ ((GetRawTime (rpsset.rpsset[0]) <= rawTime), true, "The RAW time should not grow");
+
+  //receive errors in the idle group get it another slot
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      optimizer->NotifyRxEnd (1, 2, false);
+    }
+  optimizer->NotifyRxEnd (1, 2, true);
+  for (uint16_t aid = 1; aid <= 16; aid++)
+    {
+      optimizer->NotifyTraffic (aid, 10);
+    }
+  NS_TEST_ASSERT_MSG_EQ (optimizer->Optimize (rpsset), true, "The RAW configuration should change");
+  second = rpsset.rpsset[0]->GetRawAssigmentObj (1);
+  NS_TEST_EXPECT_MSG_EQ (second.GetSlotNum (), 2, "The colliding group should gain a slot");
+  NS_TEST_EXPECT_MSG_EQ ((GetRawTime (rpsset.rpsset[0]) <= rawTime), true, "The RAW time should not grow");
+
+  optimizer->Dispose ();
+
+  //the same groups in page 1 follow the traffic of AIDs 2049-2064, not 1-16
+  RPS paged;
+  for (uint32_t g = 0; g < 2; g++)
+    {
+      RPS::RawAssignment raw = rps.GetRawAssigmentObj (g);
+      raw.SetRawGroup (1 | ((1 + 32 * g) << 2) | ((32 + 32 * g) << 13));
+      paged.SetRawAssignment (raw);
+    }
+  rpsset.rpsset[0] = &paged;
+  optimizer = CreateObjectWithAttributes<RawOptimizer> (
+      "UpdatePeriod", UintegerValue (2),
+      "MaxBoundaryStep", UintegerValue (8),
+      "StationsPerSlot", DoubleValue (2.0));
+  for (uint16_t aid = 1; aid <= 16; aid++)
+    {
+      optimizer->NotifyTraffic (aid, 10);
+    }
+  NS_TEST_EXPECT_MSG_EQ (optimizer->Optimize (rpsset), false, "The traffic of page 0 should not move the groups of page 1");
+  for (uint16_t aid = 1; aid <= 16; aid++)
+    {
+      optimizer->NotifyTraffic ((1 << 11) | aid, 10);
+    }
+  NS_TEST_ASSERT_MSG_EQ (optimizer->Optimize (rpsset), true, "The RAW configuration should change");
+  first = rpsset.rpsset[0]->GetRawAssigmentObj (0);
+  NS_TEST_EXPECT_MSG_EQ (first.GetRawGroupPage (), 1, "The page should be kept");
+  NS_TEST_EXPECT_MSG_EQ (first.GetRawGroupAIDEnd (), 24, "The boundary should move towards AID offset 8");
+  rpsset.rpsset.clear ();
+  optimizer->Dispose ();
+}
+
+
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that an association snapshot restores the association of the
+ * STAs it holds on both sides, that the pre-associated mode associates all
+ * STAs, and that both fire the Assoc trace of the STAs.
+ */
+class AssociationSnapshotTest : public TestCase
+{
+public:
+  AssociationSnapshotTest ();
+
+  virtual void DoRun (void);
+
+
+private:
+  Ptr<WifiNetDevice> CreateOne (std::string type, Mac48Address address, Ptr<YansWifiChannel> channel);
+  void Assoc (Mac48Address bssid);
+
+  ObjectFactory m_manager;
+  uint32_t m_assoc; ///< number of Assoc trace calls
+};
+
+AssociationSnapshotTest::AssociationSnapshotTest ()
+  : TestCase ("Save and restore the associations of a BSS"),
+    m_assoc (0)
+{
+}
+
+void
+AssociationSnapshotTest::Assoc (Mac48Address bssid)
+{
+  m_assoc++;
+}
+
+Ptr<WifiNetDevice>
+AssociationSnapshotTest::CreateOne (std::string type, Mac48Address address, Ptr<YansWifiChannel> channel)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+
+  Ptr<WifiMac> mac = factory.Create<WifiMac> ();
+  mac->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->SetErrorRateModel (CreateObject<YansErrorRateModel> ());
+  phy->SetChannel (channel);
+  phy->SetDevice (dev);
+  phy->SetMobility (mobility);
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+
+  node->AggregateObject (mobility);
+  mac->SetAddress (address);
+  dev->SetMac (mac);
+  dev->SetPhy (phy);
+  dev->SetRemoteStationManager (m_manager.Create<WifiRemoteStationManager> ());
+  node->AddDevice (dev);
+  return dev;
+}
+
+void
+AssociationSnapshotTest::DoRun (void)
+{
+  m_manager.SetTypeId ("ns3::ConstantRateWifiManager");
+  std::string snapshot = CreateTempDirFilename ("association-snapshot.txt");
+  Mac48Address apAddress ("00:00:00:00:01:00");
+  Mac48Address sta1Address ("00:00:00:00:00:01");
+  Mac48Address sta2Address ("00:00:00:00:00:02");
+
+  for (uint32_t run = 0; run < 2; run++)
+    {
+      Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+      channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+      channel->SetPropagationLossModel (CreateObject<FixedRssLossModel> ());
+      Ptr<WifiNetDevice> ap = CreateOne ("ns3::ApWifiMac", apAddress, channel);
+      NetDeviceContainer stas;
+      stas.Add (CreateOne ("ns3::StaWifiMac", sta1Address, channel));
+      stas.Add (CreateOne ("ns3::StaWifiMac", sta2Address, channel));
+      Ptr<ApWifiMac> apMac = DynamicCast<ApWifiMac> (ap->GetMac ());
+      Ptr<StaWifiMac> sta1 = DynamicCast<StaWifiMac> (DynamicCast<WifiNetDevice> (stas.Get (0))->GetMac ());
+      Ptr<StaWifiMac> sta2 = DynamicCast<StaWifiMac> (DynamicCast<WifiNetDevice> (stas.Get (1))->GetMac ());
+      sta1->TraceConnectWithoutContext ("Assoc", MakeCallback (&AssociationSnapshotTest::Assoc, this));
+      m_assoc = 0;
+
+      S1gAssociationHelper helper;
+      if (run == 0)
+        {
+          //the warm-up: only the 1st STA gets associated
+          NS_TEST_ASSERT_MSG_EQ (S1gAssociationHelper::Associate (apMac, sta1), true, "The AP should accept the STA");
+          NS_TEST_ASSERT_MSG_EQ (helper.Save (snapshot, ap, stas), 1, "Only the 1st STA is associated");
+        }
+      else
+        {
+          NS_TEST_ASSERT_MSG_EQ (helper.Load (snapshot, ap, stas), 1, "The 1st STA should be restored");
+        }
+      NS_TEST_ASSERT_MSG_EQ (m_assoc, 1, "The Assoc trace should fire once");
+      NS_TEST_ASSERT_MSG_EQ (sta1->IsAssociated (), true, "The 1st STA should be associated");
+      NS_TEST_ASSERT_MSG_EQ (sta1->GetAID (), 1, "The AID follows the address");
+      NS_TEST_ASSERT_MSG_EQ (sta1->GetBssid (), apAddress, "The 1st STA should be in the BSS of the AP");
+      NS_TEST_ASSERT_MSG_EQ (apMac->IsAssociated (1), true, "The AP should count the 1st STA");
+      NS_TEST_ASSERT_MSG_EQ (apMac->GetAssociatedAddress (1), sta1Address, "AID 1 belongs to the 1st STA");
+      NS_TEST_ASSERT_MSG_EQ (sta2->IsAssociated (), false, "The 2nd STA should not be associated");
+      NS_TEST_ASSERT_MSG_EQ (apMac->IsAssociated (2), false, "The AP should not count the 2nd STA");
+      Simulator::Destroy ();
+    }
+
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetPropagationLossModel (CreateObject<FixedRssLossModel> ());
+  Ptr<WifiNetDevice> ap = CreateOne ("ns3::ApWifiMac", apAddress, channel);
+  NetDeviceContainer stas;
+  stas.Add (CreateOne ("ns3::StaWifiMac", sta1Address, channel));
+  stas.Add (CreateOne ("ns3::StaWifiMac", sta2Address, channel));
+  Ptr<ApWifiMac> apMac = DynamicCast<ApWifiMac> (ap->GetMac ());
+  Ptr<StaWifiMac> sta2 = DynamicCast<StaWifiMac> (DynamicCast<WifiNetDevice> (stas.Get (1))->GetMac ());
+  sta2->TraceConnectWithoutContext ("Assoc", MakeCallback (&AssociationSnapshotTest::Assoc, this));
+  m_assoc = 0;
+  NS_TEST_ASSERT_MSG_EQ (S1gAssociationHelper ().PreAssociate (ap, stas), 2, "Both STAs should be pre-associated");
+  NS_TEST_ASSERT_MSG_EQ (m_assoc, 1, "The Assoc trace of the 2nd STA should fire once");
+  NS_TEST_ASSERT_MSG_EQ (sta2->GetAID (), 2, "The AID follows the address");
+  NS_TEST_ASSERT_MSG_EQ (apMac->IsAssociated (1) && apMac->IsAssociated (2), true, "The AP should count both STAs");
+  Simulator::Destroy ();
+}
+
+
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that the TIM picks the smallest encoding of the paged AIDs and
+ * that the STAs decode every encoding after a round trip through a buffer.
+ */
+class TimEncodingTest : public TestCase
+{
+public:
+  TimEncodingTest ();
+
+  virtual void DoRun (void);
+
+
+private:
+  /**
+   * Encode the AIDs of the first blocks of page 0, check the Partial Virtual
+   * Bitmap size and decode it again.
+   */
+  void Check (const std::set<uint16_t> &aids, uint8_t expectedSize, std::string name);
+};
+
+TimEncodingTest::TimEncodingTest ()
+  : TestCase ("Encode the TIM with the smallest encoding of every block")
+{
+}
+
+void
+TimEncodingTest::Check (const std::set<uint16_t> &aids, uint8_t expectedSize, std::string name)
+{
+  std::vector<uint64_t> blocks (8, 0);
+  for (std::set<uint16_t>::const_iterator i = aids.begin (); i != aids.end (); ++i)
+    {
+      blocks[*i >> 6] |= uint64_t (1) << (*i & 0x3f);
+    }
+  TIM tim;
+  tim.SetDTIMCount (0);
+  tim.SetDTIMPeriod (1);
+  tim.SetBitmapControl (0);
+  tim.SetPartialVBitmap (0, blocks);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)tim.m_length, (uint32_t)expectedSize, name << ": unexpected Partial Virtual Bitmap size");
+
+  Buffer buffer;
+  buffer.AddAtStart (tim.GetSerializedSize ());
+  tim.Serialize (buffer.Begin ());
+  TIM received;
+  received.Deserialize (buffer.Begin ());
+  for (uint16_t aid = 0; aid < 64 * 8; aid++)
+    {
+      bool paged = aids.find (aid) != aids.end ();
+      NS_TEST_EXPECT_MSG_EQ (received.IsAidPaged (aid), paged, name << ": AID " << aid);
+    }
+}
+
+void
+TimEncodingTest::DoRun (void)
+{
+  std::set<uint16_t> aids;
+  Check (aids, 0, "no AID");
+
+  aids.insert (5);
+  Check (aids, 2, "single AID");
+
+  //one AID in five subblocks: the AID differences are 4 bits wide
+  aids.clear ();
+  for (uint16_t aid = 64 * 2 + 1; aid < 64 * 2 + 40; aid += 8)
+    {
+      aids.insert (aid);
+    }
+  Check (aids, 5, "ADE");
+
+  //the whole block but one AID
+  aids.clear ();
+  for (uint16_t aid = 64 * 3; aid < 64 * 4; aid++)
+    {
+      if (aid != 64 * 3 + 17)
+        {
+          aids.insert (aid);
+        }
+    }
+  Check (aids, 2, "inverse single AID");
+
+  //every other AID of three blocks: one OLB block of 24 subblocks, then a single AID
+  aids.clear ();
+  for (uint16_t aid = 0; aid < 64 * 3; aid += 2)
+    {
+      aids.insert (aid);
+    }
+  aids.insert (64 * 5 + 63);
+  Check (aids, 2 + 24 + 2, "OLB");
+
+  //the legacy block bitmap
+  aids.clear ();
+  aids.insert (64 * 7 + 3);
+  aids.insert (64 * 7 + 4);
+  aids.insert (64 * 7 + 9);
+  Check (aids, 4, "block bitmap");
+}
+
+
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that a beacon built from a template serializes like one built
+ * from the elements, and that the received RPS hash tells whether the RAW
+ * configuration has changed.
+ */
+class S1gBeaconTemplateTest : public TestCase
+{
+public:
+  S1gBeaconTemplateTest ();
+
+  virtual void DoRun (void);
+
+
+private:
+  /// \return the RPS element of one RAW group over AIDs 1 - aidEnd
+  static RPS MakeRps (uint16_t aidEnd, uint16_t slotNum);
+  /// \return the bytes of a serialized beacon
+  static std::vector<uint8_t> GetBytes (const S1gBeaconHeader &beacon);
+};
+
+S1gBeaconTemplateTest::S1gBeaconTemplateTest ()
+  : TestCase ("Serialize the S1G beacon elements from a template")
+{
+}
+
+RPS
+S1gBeaconTemplateTest::MakeRps (uint16_t aidEnd, uint16_t slotNum)
+{
+  RPS::RawAssignment raw;
+  raw.SetRawControl (0);
+  raw.SetSlotCrossBoundary (1);
+  raw.SetSlotFormat (1);
+  raw.SetSlotDurationCount (100);
+  raw.SetSlotNum (slotNum);
+  raw.SetRawGroup ((aidEnd << 13) | (1 << 2));
+  RPS rps;
+  rps.SetRawAssignment (raw);
+  return rps;
+}
+
+std::vector<uint8_t>
+S1gBeaconTemplateTest::GetBytes (const S1gBeaconHeader &beacon)
+{
+  Buffer buffer;
+  buffer.AddAtStart (beacon.GetSerializedSize ());
+  beacon.Serialize (buffer.Begin ());
+  std::vector<uint8_t> bytes (buffer.GetSize ());
+  buffer.CopyData (&bytes[0], bytes.size ());
+  return bytes;
+}
+
+void
+S1gBeaconTemplateTest::DoRun (void)
+{
+  S1gBeaconCompatibility compatibility;
+  compatibility.SetBeaconInterval (102400);
+  TIM tim;
+  tim.SetDTIMCount (0);
+  tim.SetDTIMPeriod (1);
+  tim.SetBitmapControl (0);
+  RPS rps = MakeRps (32, 4);
+
+  S1gBeaconHeader plain;
+  plain.SetBeaconCompatibility (compatibility);
+  plain.SetTIM (tim);
+  plain.SetRPS (rps);
+  S1gBeaconHeader fromTemplate;
+  fromTemplate.SetTIM (tim);
+  fromTemplate.SetTemplate (Create<S1gBeaconTemplate> (compatibility, rps));
+
+  std::vector<uint8_t> bytes = GetBytes (plain);
+  NS_TEST_ASSERT_MSG_EQ ((GetBytes (fromTemplate) == bytes), true, "A template beacon should serialize like a plain one");
+  NS_TEST_EXPECT_MSG_EQ (fromTemplate.GetRPS ().GetNumberOfRawGroups (), 1, "The template should keep the RPS");
+  NS_TEST_EXPECT_MSG_EQ (fromTemplate.GetBeaconCompatibility ().GetBeaconInterval (), 102400, "The template should keep the beacon interval");
+
+  Buffer buffer;
+  buffer.AddAtStart (bytes.size ());
+  buffer.Begin ().Write (&bytes[0], bytes.size ());
+  S1gBeaconHeader received;
+  received.Deserialize (buffer.Begin ());
+  NS_TEST_EXPECT_MSG_EQ (received.GetRpsHash (), fromTemplate.GetRpsHash (), "The RPS hash should survive the air");
+  NS_TEST_EXPECT_MSG_EQ ((received.GetRpsHash () != MakeRps (32, 6).GetHash ()), true, "Another slot number should change the RPS hash");
+  NS_TEST_EXPECT_MSG_EQ ((received.GetRpsHash () != MakeRps (64, 4).GetHash ()), true, "Another RAW group should change the RPS hash");
+}
+
+
+//-----------------------------------------------------------------------------
+/**
+ * Check the per-peer state of MacRxMiddle and MacTxMiddle, and the flat
+ * address table behind them, for a large BSS.
+ */
+class MacMiddlePeerTableTest : public TestCase
+{
+public:
+  MacMiddlePeerTableTest ();
+  virtual void DoRun (void);
+private:
+  void Receive (Ptr<Packet> packet, const WifiMacHeader *hdr, SdnLab::PacketContext context);
+  uint32_t m_received;
+};
+
+MacMiddlePeerTableTest::MacMiddlePeerTableTest ()
+  : TestCase ("Check the per-peer state of the RX and TX middles"),
+    m_received (0)
+{
+}
+
+void
+MacMiddlePeerTableTest::Receive (Ptr<Packet> packet, const WifiMacHeader *hdr, SdnLab::PacketContext context)
+{
+  m_received++;
+}
+
+void
+MacMiddlePeerTableTest::DoRun (void)
+{
+  const uint32_t nPeers = 3000;
+  std::vector<Mac48Address> peers;
+  for (uint32_t i = 0; i < nPeers; i++)
+    {
+      peers.push_back (Mac48Address::Allocate ());
+    }
+
+  // the table against a std::map, with erasures in the middle of clusters
+  MacAddressTable<uint32_t> table;
+  std::map<Mac48Address, uint32_t> reference;
+  for (uint32_t i = 0; i < nPeers; i++)
+    {
+      table.Get (peers[i]) = i;
+      reference[peers[i]] = i;
+    }
+  for (uint32_t i = 0; i < nPeers; i += 3)
+    {
+      NS_TEST_ASSERT_MSG_EQ (table.Erase (peers[i]), true, "the peer should be erased");
+      reference.erase (peers[i]);
+    }
+  NS_TEST_ASSERT_MSG_EQ (table.Erase (peers[0]), false, "the peer was already erased");
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), reference.size (), "wrong number of entries");
+  for (uint32_t i = 0; i < nPeers; i++)
+    {
+      uint32_t *value = table.Find (peers[i]);
+      if (i % 3 == 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((value == 0), true, "an erased peer should not be found");
+        }
+      else
+        {
+          NS_TEST_ASSERT_MSG_EQ ((value != 0), true, "a peer should be found");
+          NS_TEST_ASSERT_MSG_EQ (*value, i, "wrong value");
+        }
+    }
+
+  // sequence numbers are independent for every peer and TID
+  MacTxMiddle txMiddle;
+  txMiddle.Reserve (nPeers);
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  for (uint32_t round = 0; round < 3; round++)
+    {
+      for (uint32_t i = 0; i < nPeers; i++)
+        {
+          hdr.SetAddr1 (peers[i]);
+          hdr.SetQosTid (i % 8);
+          NS_TEST_ASSERT_MSG_EQ (txMiddle.PeekNextSequenceNumberfor (&hdr), round, "wrong next sequence number");
+          NS_TEST_ASSERT_MSG_EQ (txMiddle.GetNextSequenceNumberfor (&hdr), round, "wrong sequence number");
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (txMiddle.GetNextSeqNumberByTidAndAddress (1, peers[1]), 3, "wrong sequence number of a used TID");
+  NS_TEST_ASSERT_MSG_EQ (txMiddle.GetNextSeqNumberByTidAndAddress (2, peers[1]), 0, "wrong sequence number of an unused TID");
+
+  // a retransmission is a duplicate of its own peer and TID only
+  MacRxMiddle rxMiddle;
+  rxMiddle.Reserve (nPeers);
+  rxMiddle.SetForwardCallback (MakeCallback (&MacMiddlePeerTableTest::Receive, this));
+  hdr.SetAddr1 (Mac48Address ("00:00:00:00:00:01"));
+  hdr.SetSequenceNumber (5);
+  for (uint32_t i = 0; i < nPeers; i++)
+    {
+      hdr.SetAddr2 (peers[i]);
+      hdr.SetQosTid (0);
+      hdr.SetNoRetry ();
+      rxMiddle.Receive (Create<Packet> (10), &hdr, SdnLab::PacketContext ());
+      hdr.SetRetry ();
+      rxMiddle.Receive (Create<Packet> (10), &hdr, SdnLab::PacketContext ());
+      hdr.SetQosTid (1);
+      rxMiddle.Receive (Create<Packet> (10), &hdr, SdnLab::PacketContext ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_received, 2 * nPeers, "wrong number of frames forwarded");
+}
+
 //-----------------------------------------------------------------------------
 class WifiTestSuite : public TestSuite
 {
@@ -496,6 +1177,12 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new QosUtilsIsOldPacketTest, TestCase::QUICK);
   AddTestCase (new InterferenceHelperSequenceTest, TestCase::QUICK); //Bug 991
   AddTestCase (new Bug555TestCase, TestCase::QUICK); //Bug 555
+  AddTestCase (new SleepFilteringTest, TestCase::QUICK);
+  AddTestCase (new RawOptimizerTest, TestCase::QUICK);
+  AddTestCase (new AssociationSnapshotTest, TestCase::QUICK);
+  AddTestCase (new TimEncodingTest, TestCase::QUICK);
+  AddTestCase (new S1gBeaconTemplateTest, TestCase::QUICK);
+  AddTestCase (new MacMiddlePeerTableTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite;
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/mac48-address.h"
+#include "ns3/mac-address-table.h"
+#include <iostream>
+#include <map>
+#include <vector>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+/**
+ * Time the per-frame peer lookup of the flat address table against the
+ * std::map it replaces in MacRxMiddle and MacTxMiddle.
+ *
+ * \param peers the number of peers in the tables
+ * \param lookups the number of lookups to time
+ */
+static void
+RunBench (uint32_t peers, uint32_t lookups)
+{
+  std::vector<Mac48Address> addresses;
+  MacAddressTable<uint32_t> table;
+  std::map<Mac48Address, uint32_t> map;
+  table.Reserve (peers);
+  for (uint32_t i = 0; i < peers; i++)
+    {
+      addresses.push_back (Mac48Address::Allocate ());
+      table.Get (addresses[i]) = i;
+      map[addresses[i]] = i;
+    }
+  // the same pseudo-random order of peers for both
+  uint32_t sumTable = 0;
+  uint32_t sumMap = 0;
+  uint32_t x = 1;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t n = 0; n < lookups; n++)
+    {
+      x = x * 1664525 + 1013904223;
+      sumTable += *table.Find (addresses[(x >> 8) % peers]);
+    }
+  int64_t tableMs = clock.End ();
+  x = 1;
+  clock.Start ();
+  for (uint32_t n = 0; n < lookups; n++)
+    {
+      x = x * 1664525 + 1013904223;
+      sumMap += map.find (addresses[(x >> 8) % peers])->second;
+    }
+  int64_t mapMs = clock.End ();
+  if (sumTable != sumMap)
+    {
+      std::cerr << "Error-- the table and the map disagree" << std::endl;
+      exit (1);
+    }
+  std::cout << peers << " peers, " << lookups << " lookups: table "
+            << tableMs << " ms, std::map " << mapMs << " ms" << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t lookups = 4000000;
+  uint32_t peers = 0;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the peer lookups of MacAddressTable against std::map.\n"
+             "\n"
+             "Without --peers, tables of 64, 1024 and 8192 peers are timed.");
+  cmd.AddValue ("lookups", "number of lookups per table (default 4E6)", lookups);
+  cmd.AddValue ("peers",   "number of peers in the table",              peers);
+  cmd.Parse (argc, argv);
+
+  if (peers != 0)
+    {
+      RunBench (peers, lookups);
+      return 0;
+    }
+  const uint32_t sizes[] = {64, 1024, 8192};
+  for (uint32_t k = 0; k < sizeof (sizes) / sizeof (sizes[0]); k++)
+    {
+      RunBench (sizes[k], lookups);
+    }
+  return 0;
+}
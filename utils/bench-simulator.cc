@@ -73,6 +73,40 @@ private:
   uint32_t m_count;
 };
 
+/**
+ * Replay an event trace recorded with
+ * --ns3::DefaultSimulatorImpl::EventTraceFile=<file>: every event
+ * of the trace is scheduled, with its original delay, when the
+ * simulation reaches the time at which it was scheduled.
+ */
+class TraceBench
+{
+public:
+  TraceBench (std::string filename);
+
+  uint32_t GetSize (void) const
+  {
+    return m_records.size ();
+  }
+
+  void RunBench (void);
+private:
+  void Cb (void);
+  void Issue (void);
+
+  /** A trace record: the schedule and expiration time steps. */
+  struct Record
+  {
+    uint64_t now;
+    uint64_t ts;
+  };
+  std::vector<Record> m_records;
+  uint32_t m_next;
+  uint32_t m_pending;
+  uint32_t m_count;
+  uint64_t m_base;
+};
+
 void
 Bench::RunBench (void) 
 {
@@ -124,6 +158,94 @@ Bench::Cb (void)
 }
 
 
+TraceBench::TraceBench (std::string filename)
+  : m_next (0),
+    m_pending (0),
+    m_count (0),
+    m_base (0)
+{
+  std::ifstream input (filename.c_str (), std::ios::binary);
+  if (!input)
+    {
+      LOGME ("cannot open event trace " << filename);
+      return;
+    }
+  Record record;
+  while (input.read (reinterpret_cast<char *> (&record), sizeof (record)))
+    {
+      m_records.push_back (record);
+    }
+  LOGME ("using event trace from " << filename);
+  LOGME ("found " << m_records.size () << " events");
+}
+
+void
+TraceBench::RunBench (void)
+{
+  SystemWallClockMs time;
+  double init, simu;
+
+  m_next = 0;
+  m_pending = 0;
+  m_count = 0;
+  // the trace starts at the current time of this run
+  m_base = Simulator::Now ().GetTimeStep ();
+  if (!m_records.empty ())
+    {
+      m_base -= m_records[0].now;
+    }
+
+  DEB ("initializing");
+  time.Start ();
+  Issue ();
+  init = time.End ();
+  init /= 1000;
+  uint32_t initial = m_next;
+  DEB ("initialization took " << init << "s");
+
+  DEB ("running");
+  time.Start ();
+  Simulator::Run ();
+  simu = time.End ();
+  simu /= 1000;
+  DEB ("run took " << simu << "s");
+
+  LOG (std::setw (g_fwidth) << init <<
+       std::setw (g_fwidth) << (initial / init) <<
+       std::setw (g_fwidth) << (init / initial) <<
+       std::setw (g_fwidth) << simu <<
+       std::setw (g_fwidth) << (m_count / simu) <<
+       std::setw (g_fwidth) << (simu / m_count));
+}
+
+void
+TraceBench::Issue (void)
+{
+  uint64_t now = Simulator::Now ().GetTimeStep ();
+  while (m_next < m_records.size () && m_records[m_next].now + m_base <= now)
+    {
+      uint64_t ts = m_records[m_next].ts + m_base;
+      Simulator::Schedule (TimeStep (ts > now ? ts - now : 0), &TraceBench::Cb, this);
+      m_pending++;
+      m_next++;
+    }
+  if (m_pending == 0 && m_next < m_records.size ())
+    {
+      // a gap in the trace (removed events are not recorded)
+      Simulator::Schedule (TimeStep (m_records[m_next].now + m_base - now), &TraceBench::Cb, this);
+      m_pending++;
+    }
+}
+
+void
+TraceBench::Cb (void)
+{
+  m_pending--;
+  ++m_count;
+  Issue ();
+}
+
+
 Ptr<RandomVariableStream>
 GetRandomStream (std::string filename)
 {
@@ -186,11 +308,14 @@ int main (int argc, char *argv[])
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedLadder = false;
+  bool schedAll  = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
   uint32_t runs  =       1;
   std::string filename = "";
+  std::string tracename = "";
   
   CommandLine cmd;
   cmd.Usage ("Benchmark the simulator scheduler.\n"
@@ -200,73 +325,127 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "\n"
+             "Alternatively, --trace=\"<filename>\" replays the events of\n"
+             "a simulation run with\n"
+             "  --ns3::DefaultSimulatorImpl::EventTraceFile=\"<filename>\"\n"
+             "(--pop and --total do not apply then).");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
+  cmd.AddValue ("all",   "compare all the schedulers",    schedAll);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
+  cmd.AddValue ("trace", "event trace to replay",         tracename);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
 
-  ObjectFactory factory ("ns3::MapScheduler");
-  if (schedCal)  { factory.SetTypeId ("ns3::CalendarScheduler"); }
-  if (schedHeap) { factory.SetTypeId ("ns3::HeapScheduler");     }
-  if (schedList) { factory.SetTypeId ("ns3::ListScheduler");     }  
-  Simulator::SetScheduler (factory);
+  std::vector<std::string> schedulers;
+  if (schedAll)
+    {
+      schedulers.push_back ("ns3::MapScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::CalendarScheduler");
+      schedulers.push_back ("ns3::LadderScheduler");
+    }
+  else
+    {
+      std::string scheduler = "ns3::MapScheduler";
+      if (schedCal)    { scheduler = "ns3::CalendarScheduler"; }
+      if (schedHeap)   { scheduler = "ns3::HeapScheduler";     }
+      if (schedList)   { scheduler = "ns3::ListScheduler";     }
+      if (schedLadder) { scheduler = "ns3::LadderScheduler";   }
+      schedulers.push_back (scheduler);
+    }
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
 
-  LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
-  LOGME ("population: " << pop);
-  LOGME ("total events: " << total);
+  TraceBench *trace = 0;
+  Bench *bench = 0;
+  if (tracename != "")
+    {
+      trace = new TraceBench (tracename);
+      if (trace->GetSize () == 0)
+        {
+          return 1;
+        }
+    }
+  else
+    {
+      LOGME ("population: " << pop);
+      LOGME ("total events: " << total);
+      bench = new Bench (pop, total);
+      bench->SetRandomStream (GetRandomStream (filename));
+    }
   LOGME ("runs: " << runs);
-  
-  Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
 
-  // table header
-  LOG ("");
-  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
-       std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
-       std::left << std::setw (3 * g_fwidth) << "Simulation:");
-  LOG (std::left << std::setw (g_fwidth) << "" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
-  LOG (std::setfill ('-') <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<
-       std::setfill (' ')
-       );
-       
-  // prime
-  DEB ("priming");
-  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
-  bench->RunBench ();
-
-  bench->SetPopulation (pop);
-  bench->SetTotal (total);
-  for (uint32_t i = 0; i < runs; i++)
+  for (std::vector<std::string>::const_iterator scheduler = schedulers.begin ();
+       scheduler != schedulers.end (); ++scheduler)
     {
-      std::cout << std::setw (g_fwidth) << i;
-      
-      bench->RunBench ();
+      ObjectFactory factory (*scheduler);
+      Simulator::SetScheduler (factory);
+
+      LOG ("");
+      LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
+
+      // table header
+      LOG ("");
+      LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+           std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
+           std::left << std::setw (3 * g_fwidth) << "Simulation:");
+      LOG (std::left << std::setw (g_fwidth) << "" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+      LOG (std::setfill ('-') <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::setfill (' ')
+           );
+
+      // prime
+      DEB ("priming");
+      std::cout << std::left << std::setw (g_fwidth) << "(prime)";
+      if (trace != 0)
+        {
+          trace->RunBench ();
+        }
+      else
+        {
+          bench->RunBench ();
+          bench->SetPopulation (pop);
+          bench->SetTotal (total);
+        }
+      for (uint32_t i = 0; i < runs; i++)
+        {
+          std::cout << std::setw (g_fwidth) << i;
+
+          if (trace != 0)
+            {
+              trace->RunBench ();
+            }
+          else
+            {
+              bench->RunBench ();
+            }
+        }
     }
 
   LOG ("");